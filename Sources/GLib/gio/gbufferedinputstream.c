@@ -29,6 +29,7 @@
 #include "gtask.h"
 #include "gseekable.h"
 #include "gioerror.h"
+#include "gioprivate.h"
 #include <string.h>
 #include "glibintl.h"
 
@@ -60,6 +61,11 @@ struct _GBufferedInputStreamPrivate {
   gsize   pos;
   gsize   end;
   GAsyncReadyCallback outstanding_callback;
+
+  /* Set once slices of @buffer have been handed out with
+   * g_buffered_input_stream_read_bytes_slice(). It then owns @buffer, and
+   * the bytes before @pos must not be overwritten. */
+  GBytes *shared_buffer;
 };
 
 enum {
@@ -126,6 +132,8 @@ static gboolean g_buffered_input_stream_truncate            (GSeekable       *se
 							     GError         **error);
 
 static void compact_buffer (GBufferedInputStream *stream);
+static void release_buffer (GBufferedInputStreamPrivate *priv);
+static void discard_buffer (GBufferedInputStream *stream);
 
 G_DEFINE_TYPE_WITH_CODE (GBufferedInputStream,
 			 g_buffered_input_stream,
@@ -226,7 +234,7 @@ g_buffered_input_stream_set_buffer_size (GBufferedInputStream *stream,
       priv->len = size;
       priv->pos = 0;
       priv->end = in_buffer;
-      g_free (priv->buffer);
+      release_buffer (priv);
       priv->buffer = buffer;
     }
   else
@@ -295,7 +303,7 @@ g_buffered_input_stream_finalize (GObject *object)
   stream = G_BUFFERED_INPUT_STREAM (object);
   priv = stream->priv;
 
-  g_free (priv->buffer);
+  release_buffer (priv);
 
   G_OBJECT_CLASS (g_buffered_input_stream_parent_class)->finalize (object);
 }
@@ -627,6 +635,17 @@ g_buffered_input_stream_peek_buffer (GBufferedInputStream *stream,
   return priv->buffer + priv->pos;
 }
 
+static void
+release_buffer (GBufferedInputStreamPrivate *priv)
+{
+  if (priv->shared_buffer != NULL)
+    g_clear_pointer (&priv->shared_buffer, g_bytes_unref);
+  else
+    g_free (priv->buffer);
+
+  priv->buffer = NULL;
+}
+
 static void
 compact_buffer (GBufferedInputStream *stream)
 {
@@ -637,12 +656,68 @@ compact_buffer (GBufferedInputStream *stream)
 
   current_size = priv->end - priv->pos;
 
-  memmove (priv->buffer, priv->buffer + priv->pos, current_size);
+  if (priv->shared_buffer != NULL)
+    {
+      guint8 *buffer;
+
+      /* Slices may still point into the consumed part of the buffer, so
+       * move the unread data to a fresh one instead. */
+      buffer = g_malloc (priv->len);
+      memcpy (buffer, priv->buffer + priv->pos, current_size);
+      release_buffer (priv);
+      priv->buffer = buffer;
+    }
+  else
+    memmove (priv->buffer, priv->buffer + priv->pos, current_size);
 
   priv->pos = 0;
   priv->end = current_size;
 }
 
+/* Drops everything in the buffer, leaving it empty. */
+static void
+discard_buffer (GBufferedInputStream *stream)
+{
+  stream->priv->pos = stream->priv->end;
+  compact_buffer (stream);
+}
+
+/*
+ * g_buffered_input_stream_read_bytes_slice:
+ * @stream: a #GBufferedInputStream
+ * @count: the number of bytes to read, at most the number of bytes
+ *   available in the buffer
+ *
+ * Consumes @count bytes from the buffer and returns them without copying.
+ *
+ * The returned #GBytes points into the stream’s buffer. The buffer is never
+ * modified in place while such slices exist: when the stream next needs to
+ * compact or resize it, it switches to a new buffer, and the old one is
+ * freed once the last slice is released.
+ *
+ * Returns: (transfer full): the consumed bytes
+ */
+GBytes *
+g_buffered_input_stream_read_bytes_slice (GBufferedInputStream *stream,
+                                          gsize                 count)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+  GBytes *slice;
+
+  g_return_val_if_fail (count <= priv->end - priv->pos, NULL);
+
+  if (count == 0)
+    return g_bytes_new (NULL, 0);
+
+  if (priv->shared_buffer == NULL)
+    priv->shared_buffer = g_bytes_new_take (priv->buffer, priv->len);
+
+  slice = g_bytes_new_from_bytes (priv->shared_buffer, priv->pos, count);
+  priv->pos += count;
+
+  return slice;
+}
+
 static gssize
 g_buffered_input_stream_real_fill (GBufferedInputStream  *stream,
                                    gssize                 count,
@@ -709,8 +784,7 @@ g_buffered_input_stream_skip (GInputStream  *stream,
    * request refill for more
    */
 
-  priv->pos = 0;
-  priv->end = 0;
+  discard_buffer (bstream);
   bytes_skipped = available;
   count -= available;
 
@@ -788,8 +862,7 @@ g_buffered_input_stream_read (GInputStream *stream,
    */
 
   memcpy (buffer, priv->buffer + priv->pos, available);
-  priv->pos = 0;
-  priv->end = 0;
+  discard_buffer (bstream);
   bytes_read = available;
   count -= available;
 
@@ -911,8 +984,7 @@ g_buffered_input_stream_seek (GSeekable     *seekable,
 
   if (g_seekable_seek (base_stream_seekable, offset, type, cancellable, error))
     {
-      priv->pos = 0;
-      priv->end = 0;
+      discard_buffer (bstream);
       return TRUE;
     }
   else
@@ -1001,8 +1073,7 @@ g_buffered_input_stream_read_byte (GBufferedInputStream  *stream,
   if (cancellable)
     g_cancellable_push_current (cancellable);
 
-  priv->pos = 0;
-  priv->end = 0;
+  discard_buffer (stream);
 
   class = G_BUFFERED_INPUT_STREAM_GET_CLASS (stream);
   nread = class->fill (stream, priv->len, cancellable, error);
@@ -1234,8 +1305,7 @@ g_buffered_input_stream_skip_async (GInputStream        *stream,
    * and request refill for more
    */
 
-  priv->pos = 0;
-  priv->end = 0;
+  discard_buffer (bstream);
 
   count -= available;
 
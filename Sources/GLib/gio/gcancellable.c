@@ -47,7 +47,13 @@ struct _GCancellablePrivate
 {
   /* Atomic so that g_cancellable_is_cancelled does not require holding the mutex. */
   gboolean cancelled;
-  /* Access to fields below is protected by cancellable_mutex. */
+
+  /* Per instance, so that unrelated cancellables used on different threads
+   * never contend with each other. */
+  GMutex mutex;
+  GCond cond;
+
+  /* Access to fields below is protected by @mutex. */
   guint cancelled_running : 1;
   guint cancelled_running_waiting : 1;
   unsigned cancelled_emissions;
@@ -62,8 +68,6 @@ static guint signals[LAST_SIGNAL] = { 0 };
 G_DEFINE_TYPE_WITH_PRIVATE (GCancellable, g_cancellable, G_TYPE_OBJECT)
 
 static GPrivate current_cancellable;
-static GMutex cancellable_mutex;
-static GCond cancellable_cond;
 
 static void
 g_cancellable_finalize (GObject *object)
@@ -73,6 +77,9 @@ g_cancellable_finalize (GObject *object)
   if (cancellable->priv->wakeup)
     GLIB_PRIVATE_CALL (g_wakeup_free) (cancellable->priv->wakeup);
 
+  g_mutex_clear (&cancellable->priv->mutex);
+  g_cond_clear (&cancellable->priv->cond);
+
   G_OBJECT_CLASS (g_cancellable_parent_class)->finalize (object);
 }
 
@@ -154,6 +161,8 @@ static void
 g_cancellable_init (GCancellable *cancellable)
 {
   cancellable->priv = g_cancellable_get_instance_private (cancellable);
+  g_mutex_init (&cancellable->priv->mutex);
+  g_cond_init (&cancellable->priv->cond);
 }
 
 /**
@@ -265,10 +274,15 @@ g_cancellable_reset (GCancellable *cancellable)
 
   g_return_if_fail (G_IS_CANCELLABLE (cancellable));
 
-  g_mutex_lock (&cancellable_mutex);
-
   priv = cancellable->priv;
 
+  /* Nothing to wait for: handlers only run while @cancelled is set, and
+   * it is only cleared below, once they have all returned. */
+  if (!g_atomic_int_get (&priv->cancelled))
+    return;
+
+  g_mutex_lock (&priv->mutex);
+
   while (priv->cancelled_running || priv->cancelled_emissions > 0)
     {
       if (priv->cancelled_running)
@@ -277,7 +291,7 @@ g_cancellable_reset (GCancellable *cancellable)
       if (priv->cancelled_emissions > 0)
         priv->cancelled_emissions_waiting = TRUE;
 
-      g_cond_wait (&cancellable_cond, &cancellable_mutex);
+      g_cond_wait (&priv->cond, &priv->mutex);
     }
 
   if (g_atomic_int_exchange (&priv->cancelled, FALSE))
@@ -286,7 +300,7 @@ g_cancellable_reset (GCancellable *cancellable)
         GLIB_PRIVATE_CALL (g_wakeup_acknowledge) (priv->wakeup);
     }
 
-  g_mutex_unlock (&cancellable_mutex);
+  g_mutex_unlock (&priv->mutex);
 }
 
 /**
@@ -409,7 +423,7 @@ g_cancellable_make_pollfd (GCancellable *cancellable, GPollFD *pollfd)
     return FALSE;
   g_return_val_if_fail (G_IS_CANCELLABLE (cancellable), FALSE);
 
-  g_mutex_lock (&cancellable_mutex);
+  g_mutex_lock (&cancellable->priv->mutex);
 
   cancellable->priv->fd_refcount++;
 
@@ -423,7 +437,7 @@ g_cancellable_make_pollfd (GCancellable *cancellable, GPollFD *pollfd)
 
   GLIB_PRIVATE_CALL (g_wakeup_get_pollfd) (cancellable->priv->wakeup, pollfd);
 
-  g_mutex_unlock (&cancellable_mutex);
+  g_mutex_unlock (&cancellable->priv->mutex);
 
   return TRUE;
 }
@@ -456,7 +470,7 @@ g_cancellable_release_fd (GCancellable *cancellable)
 
   priv = cancellable->priv;
 
-  g_mutex_lock (&cancellable_mutex);
+  g_mutex_lock (&priv->mutex);
   g_assert (priv->fd_refcount > 0);
 
   priv->fd_refcount--;
@@ -466,7 +480,7 @@ g_cancellable_release_fd (GCancellable *cancellable)
       priv->wakeup = NULL;
     }
 
-  g_mutex_unlock (&cancellable_mutex);
+  g_mutex_unlock (&priv->mutex);
 }
 
 /**
@@ -500,11 +514,11 @@ g_cancellable_cancel (GCancellable *cancellable)
 
   priv = cancellable->priv;
 
-  g_mutex_lock (&cancellable_mutex);
+  g_mutex_lock (&priv->mutex);
 
   if (g_atomic_int_exchange (&priv->cancelled, TRUE))
     {
-      g_mutex_unlock (&cancellable_mutex);
+      g_mutex_unlock (&priv->mutex);
       return;
     }
 
@@ -513,19 +527,19 @@ g_cancellable_cancel (GCancellable *cancellable)
   if (priv->wakeup)
     GLIB_PRIVATE_CALL (g_wakeup_signal) (priv->wakeup);
 
-  g_mutex_unlock (&cancellable_mutex);
+  g_mutex_unlock (&priv->mutex);
 
   g_object_ref (cancellable);
   g_signal_emit (cancellable, signals[CANCELLED], 0);
 
-  g_mutex_lock (&cancellable_mutex);
+  g_mutex_lock (&priv->mutex);
 
   priv->cancelled_running = FALSE;
   if (priv->cancelled_running_waiting)
-    g_cond_broadcast (&cancellable_cond);
+    g_cond_broadcast (&priv->cond);
   priv->cancelled_running_waiting = FALSE;
 
-  g_mutex_unlock (&cancellable_mutex);
+  g_mutex_unlock (&priv->mutex);
 
   g_object_unref (cancellable);
 }
@@ -571,7 +585,7 @@ g_cancellable_connect (GCancellable   *cancellable,
 
   g_return_val_if_fail (G_IS_CANCELLABLE (cancellable), 0);
 
-  g_mutex_lock (&cancellable_mutex);
+  g_mutex_lock (&cancellable->priv->mutex);
 
   if (g_atomic_int_get (&cancellable->priv->cancelled))
     {
@@ -583,21 +597,21 @@ g_cancellable_connect (GCancellable   *cancellable,
 
       cancellable->priv->cancelled_emissions++;
 
-      g_mutex_unlock (&cancellable_mutex);
+      g_mutex_unlock (&cancellable->priv->mutex);
 
       _callback (cancellable, data);
 
       if (data_destroy_func)
         data_destroy_func (data);
 
-      g_mutex_lock (&cancellable_mutex);
+      g_mutex_lock (&cancellable->priv->mutex);
 
       if (cancellable->priv->cancelled_emissions_waiting)
-        g_cond_broadcast (&cancellable_cond);
+        g_cond_broadcast (&cancellable->priv->cond);
 
       cancellable->priv->cancelled_emissions--;
 
-      g_mutex_unlock (&cancellable_mutex);
+      g_mutex_unlock (&cancellable->priv->mutex);
     }
   else
     {
@@ -606,7 +620,7 @@ g_cancellable_connect (GCancellable   *cancellable,
                                   (GClosureNotify) data_destroy_func,
                                   G_CONNECT_DEFAULT);
 
-      g_mutex_unlock (&cancellable_mutex);
+      g_mutex_unlock (&cancellable->priv->mutex);
     }
 
 
@@ -644,10 +658,10 @@ g_cancellable_disconnect (GCancellable  *cancellable,
   if (handler_id == 0 ||  cancellable == NULL)
     return;
 
-  g_mutex_lock (&cancellable_mutex);
-
   priv = cancellable->priv;
 
+  g_mutex_lock (&priv->mutex);
+
   while (priv->cancelled_running || priv->cancelled_emissions)
     {
       if (priv->cancelled_running)
@@ -656,12 +670,12 @@ g_cancellable_disconnect (GCancellable  *cancellable,
       if (priv->cancelled_emissions)
         priv->cancelled_emissions_waiting = TRUE;
 
-      g_cond_wait (&cancellable_cond, &cancellable_mutex);
+      g_cond_wait (&priv->cond, &priv->mutex);
     }
 
   g_signal_handler_disconnect (cancellable, handler_id);
 
-  g_mutex_unlock (&cancellable_mutex);
+  g_mutex_unlock (&priv->mutex);
 }
 
 typedef struct {
@@ -669,7 +683,7 @@ typedef struct {
 
   GCancellable *cancellable;
   gulong        cancelled_handler;
-  /* Protected by cancellable_mutex: */
+  /* Protected by the mutex of @cancellable: */
   gboolean      resurrected_during_cancellation;
 } GCancellableSource;
 
@@ -691,22 +705,21 @@ cancellable_source_cancelled (GCancellable *cancellable,
   GSource *source = user_data;
   GCancellableSource *cancellable_source = (GCancellableSource *) source;
 
-  g_mutex_lock (&cancellable_mutex);
+  g_mutex_lock (&cancellable->priv->mutex);
 
   /* Drop the reference added in cancellable_source_dispose(); see the comment there.
-   * The reference must be dropped after unlocking @cancellable_mutex since
-   * it could be the final reference, and the dispose function takes
-   * @cancellable_mutex. */
+   * The reference must be dropped after unlocking the mutex since it could
+   * be the final reference, and the dispose function takes the mutex. */
   if (cancellable_source->resurrected_during_cancellation)
     {
       cancellable_source->resurrected_during_cancellation = FALSE;
-      g_mutex_unlock (&cancellable_mutex);
+      g_mutex_unlock (&cancellable->priv->mutex);
       g_source_unref (source);
       return;
     }
 
   g_source_ref (source);
-  g_mutex_unlock (&cancellable_mutex);
+  g_mutex_unlock (&cancellable->priv->mutex);
   g_source_set_ready_time (source, 0);
   g_source_unref (source);
 }
@@ -727,38 +740,41 @@ static void
 cancellable_source_dispose (GSource *source)
 {
   GCancellableSource *cancellable_source = (GCancellableSource *)source;
+  GCancellable *cancellable;
+
+  cancellable = g_steal_pointer (&cancellable_source->cancellable);
+  if (cancellable == NULL)
+    return;
 
-  g_mutex_lock (&cancellable_mutex);
+  g_mutex_lock (&cancellable->priv->mutex);
 
-  if (cancellable_source->cancellable)
+  if (cancellable->priv->cancelled_running)
     {
-      if (cancellable_source->cancellable->priv->cancelled_running)
-        {
-          /* There can be a race here: if thread A has called
-           * g_cancellable_cancel() and has got as far as committing to call
-           * cancellable_source_cancelled(), then thread B drops the final
-           * ref on the GCancellableSource before g_source_ref() is called in
-           * cancellable_source_cancelled(), then cancellable_source_dispose()
-           * will run through and the GCancellableSource will be finalised
-           * before cancellable_source_cancelled() gets to g_source_ref(). It
-           * will then be left in a state where it’s committed to using a
-           * dangling GCancellableSource pointer.
-           *
-           * Eliminate that race by resurrecting the #GSource temporarily, and
-           * then dropping that reference in cancellable_source_cancelled(),
-           * which should be guaranteed to fire because we’re inside a
-           * @cancelled_running block.
-           */
-          g_source_ref (source);
-          cancellable_source->resurrected_during_cancellation = TRUE;
-        }
-
-      g_clear_signal_handler (&cancellable_source->cancelled_handler,
-                              cancellable_source->cancellable);
-      g_clear_object (&cancellable_source->cancellable);
+      /* There can be a race here: if thread A has called
+       * g_cancellable_cancel() and has got as far as committing to call
+       * cancellable_source_cancelled(), then thread B drops the final
+       * ref on the GCancellableSource before g_source_ref() is called in
+       * cancellable_source_cancelled(), then cancellable_source_dispose()
+       * will run through and the GCancellableSource will be finalised
+       * before cancellable_source_cancelled() gets to g_source_ref(). It
+       * will then be left in a state where it’s committed to using a
+       * dangling GCancellableSource pointer.
+       *
+       * Eliminate that race by resurrecting the #GSource temporarily, and
+       * then dropping that reference in cancellable_source_cancelled(),
+       * which should be guaranteed to fire because we’re inside a
+       * @cancelled_running block.
+       */
+      g_source_ref (source);
+      cancellable_source->resurrected_during_cancellation = TRUE;
     }
 
-  g_mutex_unlock (&cancellable_mutex);
+  g_clear_signal_handler (&cancellable_source->cancelled_handler, cancellable);
+
+  g_mutex_unlock (&cancellable->priv->mutex);
+
+  /* Only after unlocking, as this may finalize @cancellable */
+  g_object_unref (cancellable);
 }
 
 static gboolean
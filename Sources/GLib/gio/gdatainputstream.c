@@ -28,6 +28,7 @@
 #include "gcancellable.h"
 #include "gioenumtypes.h"
 #include "gioerror.h"
+#include "gioprivate.h"
 #include "glibintl.h"
 
 #include <string.h>
@@ -624,92 +625,92 @@ scan_for_newline (GDataInputStream *stream,
   GBufferedInputStream *bstream;
   GDataInputStreamPrivate *priv;
   const char *buffer;
-  gsize start, end, peeked;
-  gsize i;
-  gssize found_pos;
-  int newline_len;
-  gsize available, checked;
+  const char *lf, *cr, *p;
+  gsize start, peeked;
+  gsize available;
   gboolean last_saw_cr;
 
   priv = stream->priv;
   
   bstream = G_BUFFERED_INPUT_STREAM (stream);
 
-  checked = *checked_out;
   last_saw_cr = *last_saw_cr_out;
-  found_pos = -1;
-  newline_len = 0;
-  
-  start = checked;
+
+  start = *checked_out;
   buffer = (const char*)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
-  end = available;
-  peeked = end - start;
+  peeked = available - start;
+
+  if (peeked == 0)
+    return -1;
 
-  for (i = 0; checked < available && i < peeked; i++)
+  /* Everything below uses memchr(), which libc implements with wide
+   * loads; log-like input can have thousands of bytes between newlines. */
+  switch (priv->newline_type)
     {
-      switch (priv->newline_type)
+    case G_DATA_STREAM_NEWLINE_TYPE_LF:
+      lf = memchr (buffer, '\n', peeked);
+      if (lf != NULL)
 	{
-	case G_DATA_STREAM_NEWLINE_TYPE_LF:
-	  if (buffer[i] == 10)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR:
-	  if (buffer[i] == 13)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
-	  if (last_saw_cr && buffer[i] == 10)
-	    {
-	      found_pos = start + i - 1;
-	      newline_len = 2;
-	    }
-	  break;
-	default:
-	case G_DATA_STREAM_NEWLINE_TYPE_ANY:
-	  if (buffer[i] == 10) /* LF */
-	    {
-	      if (last_saw_cr)
-		{
-		  /* CR LF */
-		  found_pos = start + i - 1;
-		  newline_len = 2;
-		}
-	      else
-		{
-		  /* LF */
-		  found_pos = start + i;
-		  newline_len = 1;
-		}
-	    }
-	  else if (last_saw_cr)
+	  *newline_len_out = 1;
+	  return start + (lf - buffer);
+	}
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR:
+      cr = memchr (buffer, '\r', peeked);
+      if (cr != NULL)
+	{
+	  *newline_len_out = 1;
+	  return start + (cr - buffer);
+	}
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
+      if (last_saw_cr && buffer[0] == '\n')
+	{
+	  *newline_len_out = 2;
+	  return start - 1;
+	}
+
+      for (p = buffer; (lf = memchr (p, '\n', peeked - (p - buffer))) != NULL; p = lf + 1)
+	{
+	  if (lf > buffer && lf[-1] == '\r')
 	    {
-	      /* Last was cr, this is not LF, end is CR */
-	      found_pos = start + i - 1;
-	      newline_len = 1;
+	      *newline_len_out = 2;
+	      return start + (lf - buffer) - 1;
 	    }
-	  /* Don't check for CR here, instead look at last_saw_cr on next byte */
-	  break;
 	}
-	
-      last_saw_cr = (buffer[i] == 13);
+      break;
+
+    default:
+    case G_DATA_STREAM_NEWLINE_TYPE_ANY:
+      if (last_saw_cr)
+	{
+	  /* The previous scan ended on a CR; it ends the line either on its
+	   * own or together with a following LF. */
+	  *newline_len_out = (buffer[0] == '\n') ? 2 : 1;
+	  return start - 1;
+	}
 
-      if (found_pos != -1)
+      lf = memchr (buffer, '\n', peeked);
+      cr = memchr (buffer, '\r', (lf != NULL) ? (gsize) (lf - buffer) : peeked);
+
+      if (cr != NULL && (gsize) (cr - buffer) + 1 < peeked)
+	{
+	  *newline_len_out = (cr[1] == '\n') ? 2 : 1;
+	  return start + (cr - buffer);
+	}
+      if (lf != NULL)
 	{
-	  *newline_len_out = newline_len;
-	  return found_pos;
+	  *newline_len_out = 1;
+	  return start + (lf - buffer);
 	}
+      /* A CR at the very end: wait for the next byte to decide */
+      break;
     }
 
-  checked = end;
-
-  *checked_out = checked;
-  *last_saw_cr_out = last_saw_cr;
+  *checked_out = available;
+  *last_saw_cr_out = (buffer[peeked - 1] == '\r');
   return -1;
 }
 		  
@@ -736,11 +737,15 @@ scan_for_newline (GDataInputStream *stream,
  *  will be set. If there's no content to read, it will still return
  *  %NULL, but @error won't be set.
  **/
-char *
-g_data_input_stream_read_line (GDataInputStream  *stream,
-			       gsize             *length,
-			       GCancellable      *cancellable,
-			       GError           **error)
+/* Fills the buffer until it holds a complete line, or the rest of the
+ * stream. On success, *found_pos_out is the length of the line, or -1 at
+ * the end of the stream. */
+static gboolean
+fill_for_line (GDataInputStream  *stream,
+	       gssize            *found_pos_out,
+	       int               *newline_len_out,
+	       GCancellable      *cancellable,
+	       GError           **error)
 {
   GBufferedInputStream *bstream;
   gsize checked;
@@ -748,9 +753,6 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
   gssize found_pos;
   gssize res;
   int newline_len;
-  char *line;
-  
-  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);  
 
   bstream = G_BUFFERED_INPUT_STREAM (stream);
 
@@ -767,25 +769,49 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
 
       res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
       if (res < 0)
-	return NULL;
+	return FALSE;
       if (res == 0)
 	{
 	  /* End of stream */
 	  if (g_buffered_input_stream_get_available (bstream) == 0)
-	    {
-	      if (length)
-		*length = 0;
-	      return NULL;
-	    }
+	    found_pos = -1;
 	  else
 	    {
 	      found_pos = checked;
 	      newline_len = 0;
-	      break;
 	    }
+	  break;
 	}
     }
 
+  *found_pos_out = found_pos;
+  *newline_len_out = newline_len;
+  return TRUE;
+}
+
+char *
+g_data_input_stream_read_line (GDataInputStream  *stream,
+			       gsize             *length,
+			       GCancellable      *cancellable,
+			       GError           **error)
+{
+  gssize found_pos;
+  gssize res;
+  int newline_len;
+  char *line;
+  
+  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);  
+
+  if (!fill_for_line (stream, &found_pos, &newline_len, cancellable, error))
+    return NULL;
+
+  if (found_pos == -1)
+    {
+      if (length)
+	*length = 0;
+      return NULL;
+    }
+
   line = g_malloc (found_pos + newline_len + 1);
 
   res = g_input_stream_read (G_INPUT_STREAM (stream),
@@ -846,6 +872,57 @@ g_data_input_stream_read_line_utf8 (GDataInputStream  *stream,
   return res;
 }
 
+/**
+ * g_data_input_stream_read_line_bytes:
+ * @stream: a given #GDataInputStream.
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @error: #GError for error reporting.
+ *
+ * Reads a line from the data input stream, like
+ * g_data_input_stream_read_line(), but without copying it.
+ *
+ * The returned #GBytes refers directly to the stream’s internal buffer,
+ * so this avoids an allocation and a copy per line. Keeping it alive
+ * keeps that buffer alive too, so copy the data if you intend to hold
+ * on to it for long.
+ *
+ * As with g_data_input_stream_read_line(), no encoding checks are
+ * performed and the line does not include the newline.
+ *
+ * Returns: (nullable) (transfer full): the line that was read in, or
+ *  %NULL on error or if there's no content to read. @error is only set
+ *  in the former case.
+ *
+ * Since: 2.80
+ **/
+GBytes *
+g_data_input_stream_read_line_bytes (GDataInputStream  *stream,
+				     GCancellable      *cancellable,
+				     GError           **error)
+{
+  gssize found_pos;
+  gssize res;
+  int newline_len;
+  GBytes *line;
+
+  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);
+
+  if (!fill_for_line (stream, &found_pos, &newline_len, cancellable, error) ||
+      found_pos == -1)
+    return NULL;
+
+  line = g_buffered_input_stream_read_bytes_slice (G_BUFFERED_INPUT_STREAM (stream),
+						   found_pos);
+
+  if (newline_len > 0)
+    {
+      res = g_input_stream_skip (G_INPUT_STREAM (stream), newline_len, NULL, NULL);
+      g_warn_if_fail (res == newline_len);
+    }
+
+  return line;
+}
+
 static gssize
 scan_for_chars (GDataInputStream *stream,
 		gsize            *checked_out,
@@ -853,35 +930,39 @@ scan_for_chars (GDataInputStream *stream,
                 gsize             stop_chars_len)
 {
   GBufferedInputStream *bstream;
-  const char *buffer;
-  gsize start, end, peeked;
+  const guchar *buffer;
+  gsize start, peeked;
   gsize i;
-  gsize available, checked;
-  const char *stop_char;
-  const char *stop_end;
+  gsize available;
 
   bstream = G_BUFFERED_INPUT_STREAM (stream);
-  stop_end = stop_chars + stop_chars_len;
-
-  checked = *checked_out;
 
-  start = checked;
-  buffer = (const char *)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
-  end = available;
-  peeked = end - start;
+  start = *checked_out;
+  buffer = (const guchar *)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
+  peeked = available - start;
 
-  for (i = 0; checked < available && i < peeked; i++)
+  if (stop_chars_len == 1)
     {
-      for (stop_char = stop_chars; stop_char != stop_end; stop_char++)
-	{
-	  if (buffer[i] == *stop_char)
-	    return (start + i);
-	}
+      const guchar *found = memchr (buffer, stop_chars[0], peeked);
+
+      if (found != NULL)
+        return start + (found - buffer);
     }
+  else if (stop_chars_len > 1)
+    {
+      gboolean is_stop_char[256] = { FALSE, };
 
-  checked = end;
+      for (i = 0; i < stop_chars_len; i++)
+        is_stop_char[(guchar) stop_chars[i]] = TRUE;
 
-  *checked_out = checked;
+      for (i = 0; i < peeked; i++)
+        {
+          if (is_stop_char[buffer[i]])
+            return start + i;
+        }
+    }
+
+  *checked_out = available;
   return -1;
 }
 
@@ -948,6 +1029,9 @@ typedef struct
   gchar *stop_chars;
   gsize stop_chars_len;
   gsize length;
+
+  /* Non-zero for g_data_input_stream_read_lines_async() */
+  guint max_lines;
 } GDataInputStreamReadData;
 
 static void
@@ -979,6 +1063,52 @@ g_data_input_stream_read_complete (GTask *task,
   g_object_unref (task);
 }
 
+/* Takes the line that was found, followed by as many further complete
+ * lines as are already buffered, up to data->max_lines. */
+static void
+g_data_input_stream_read_lines_complete (GTask *task,
+                                         gsize  read_length,
+                                         gsize  skip_length)
+{
+  GDataInputStreamReadData *data = g_task_get_task_data (task);
+  GDataInputStream *stream = g_task_get_source_object (task);
+  GPtrArray *lines = NULL;
+  gssize found_pos = read_length;
+  gint newline_len = skip_length;
+
+  if (read_length || skip_length)
+    {
+      lines = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+
+      do
+        {
+          gsize checked = 0;
+          gboolean last_saw_cr = FALSE;
+
+          g_ptr_array_add (lines,
+                           g_buffered_input_stream_read_bytes_slice (G_BUFFERED_INPUT_STREAM (stream),
+                                                                     found_pos));
+          if (newline_len > 0)
+            {
+              gssize bytes;
+
+              /* we already checked the buffer.  this shouldn't fail. */
+              bytes = g_input_stream_skip (G_INPUT_STREAM (stream), newline_len, NULL, NULL);
+              g_assert_cmpint (bytes, ==, newline_len);
+            }
+
+          if (lines->len == data->max_lines)
+            break;
+
+          found_pos = scan_for_newline (stream, &checked, &last_saw_cr, &newline_len);
+        }
+      while (found_pos != -1);
+    }
+
+  g_task_return_pointer (task, lines, (GDestroyNotify) g_ptr_array_unref);
+  g_object_unref (task);
+}
+
 static void
 g_data_input_stream_read_line_ready (GObject      *object,
                                      GAsyncResult *result,
@@ -1008,7 +1138,10 @@ g_data_input_stream_read_line_ready (GObject      *object,
               return;
             }
 
-          g_data_input_stream_read_complete (task, data->checked, 0);
+          if (data->max_lines > 0)
+            g_data_input_stream_read_lines_complete (task, data->checked, 0);
+          else
+            g_data_input_stream_read_complete (task, data->checked, 0);
           return;
         }
 
@@ -1048,7 +1181,10 @@ g_data_input_stream_read_line_ready (GObject      *object,
   else
     {
       /* read the line and the EOL.  no error is possible. */
-      g_data_input_stream_read_complete (task, found_pos, newline_len);
+      if (data->max_lines > 0)
+        g_data_input_stream_read_lines_complete (task, found_pos, newline_len);
+      else
+        g_data_input_stream_read_complete (task, found_pos, newline_len);
     }
 }
 
@@ -1065,6 +1201,7 @@ static void
 g_data_input_stream_read_async (GDataInputStream    *stream,
                                 const gchar         *stop_chars,
                                 gssize               stop_chars_len,
+                                guint                max_lines,
                                 gint                 io_priority,
                                 GCancellable        *cancellable,
                                 GAsyncReadyCallback  callback,
@@ -1084,6 +1221,7 @@ g_data_input_stream_read_async (GDataInputStream    *stream,
   data->stop_chars = g_memdup2 (stop_chars, stop_chars_len_unsigned);
   data->stop_chars_len = stop_chars_len_unsigned;
   data->last_saw_cr = FALSE;
+  data->max_lines = max_lines;
 
   task = g_task_new (stream, cancellable, callback, user_data);
   g_task_set_source_tag (task, g_data_input_stream_read_async);
@@ -1141,10 +1279,52 @@ g_data_input_stream_read_line_async (GDataInputStream    *stream,
   g_return_if_fail (G_IS_DATA_INPUT_STREAM (stream));
   g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-  g_data_input_stream_read_async (stream, NULL, 0, io_priority,
+  g_data_input_stream_read_async (stream, NULL, 0, 0, io_priority,
                                   cancellable, callback, user_data);
 }
 
+/**
+ * g_data_input_stream_read_lines_async:
+ * @stream: a given #GDataInputStream.
+ * @max_lines: the maximum number of lines to return, or 0 for no limit
+ * @io_priority: the [I/O priority][io-priority] of the request
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @callback: (scope async) (closure user_data): callback to call when the request is satisfied.
+ * @user_data: the data to pass to callback function.
+ *
+ * Reads a batch of lines from the data input stream.
+ *
+ * This waits until at least one complete line is available, like
+ * g_data_input_stream_read_line_async(), and then also returns every
+ * further complete line that is already buffered, up to @max_lines in
+ * total. Reading a busy stream this way costs one callback per buffer
+ * fill rather than one per line. The lines are returned as with
+ * g_data_input_stream_read_line_bytes(), without copying.
+ *
+ * It is an error to have two outstanding calls to this function.
+ *
+ * When the operation is finished, @callback will be called. You
+ * can then call g_data_input_stream_read_lines_finish() to get
+ * the result of the operation.
+ *
+ * Since: 2.80
+ */
+void
+g_data_input_stream_read_lines_async (GDataInputStream    *stream,
+                                      guint                max_lines,
+                                      gint                 io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  g_return_if_fail (G_IS_DATA_INPUT_STREAM (stream));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  g_data_input_stream_read_async (stream, NULL, 0,
+                                  (max_lines > 0) ? max_lines : G_MAXUINT,
+                                  io_priority, cancellable, callback, user_data);
+}
+
 /**
  * g_data_input_stream_read_until_async:
  * @stream: a given #GDataInputStream.
@@ -1186,7 +1366,7 @@ g_data_input_stream_read_until_async (GDataInputStream    *stream,
   g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
   g_return_if_fail (stop_chars != NULL);
 
-  g_data_input_stream_read_async (stream, stop_chars, -1, io_priority,
+  g_data_input_stream_read_async (stream, stop_chars, -1, 0, io_priority,
                                   cancellable, callback, user_data);
 }
 
@@ -1222,6 +1402,32 @@ g_data_input_stream_read_line_finish (GDataInputStream  *stream,
   return g_data_input_stream_read_finish (stream, result, length, error);
 }
 
+/**
+ * g_data_input_stream_read_lines_finish:
+ * @stream: a given #GDataInputStream.
+ * @result: the #GAsyncResult that was provided to the callback.
+ * @error: #GError for error reporting.
+ *
+ * Finish an asynchronous call started by
+ * g_data_input_stream_read_lines_async().
+ *
+ * Returns: (nullable) (transfer full) (element-type GBytes): the lines
+ *  that were read in (without the newlines).  On an error, it will
+ *  return %NULL and @error will be set. If there's no content to read,
+ *  it will still return %NULL, but @error won't be set.
+ *
+ * Since: 2.80
+ */
+GPtrArray *
+g_data_input_stream_read_lines_finish (GDataInputStream  *stream,
+                                       GAsyncResult      *result,
+                                       GError           **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 /**
  * g_data_input_stream_read_line_finish_utf8:
  * @stream: a given #GDataInputStream.
@@ -1432,7 +1638,7 @@ g_data_input_stream_read_upto_async (GDataInputStream    *stream,
   g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
   g_return_if_fail (stop_chars != NULL);
 
-  g_data_input_stream_read_async (stream, stop_chars, stop_chars_len, io_priority,
+  g_data_input_stream_read_async (stream, stop_chars, stop_chars_len, 0, io_priority,
                                   cancellable, callback, user_data);
 }
 
@@ -131,6 +131,21 @@ char *                 g_data_input_stream_read_line_finish_utf8(GDataInputStrea
                                                                  GAsyncResult            *result,
                                                                  gsize                   *length,
                                                                  GError                 **error);
+GIO_AVAILABLE_IN_2_80
+GBytes *               g_data_input_stream_read_line_bytes      (GDataInputStream        *stream,
+                                                                 GCancellable            *cancellable,
+                                                                 GError                 **error);
+GIO_AVAILABLE_IN_2_80
+void                   g_data_input_stream_read_lines_async     (GDataInputStream        *stream,
+                                                                 guint                    max_lines,
+                                                                 gint                     io_priority,
+                                                                 GCancellable            *cancellable,
+                                                                 GAsyncReadyCallback      callback,
+                                                                 gpointer                 user_data);
+GIO_AVAILABLE_IN_2_80
+GPtrArray *            g_data_input_stream_read_lines_finish    (GDataInputStream        *stream,
+                                                                 GAsyncResult            *result,
+                                                                 GError                 **error);
 GIO_DEPRECATED_IN_2_56_FOR (g_data_input_stream_read_upto)
 char *                 g_data_input_stream_read_until           (GDataInputStream        *stream,
                                                                  const gchar             *stop_chars,
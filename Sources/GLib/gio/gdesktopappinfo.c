@@ -57,6 +57,8 @@
 #include "gappinfoprivate.h"
 #include "glocalfilemonitor.h"
 #include "gutilsprivate.h"
+#include "gvdb/gvdb-builder.h"
+#include "gvdb/gvdb-reader.h"
 
 #ifdef G_OS_UNIX
 #include "gdocumentportal.h"
@@ -140,6 +142,19 @@ G_DEFINE_TYPE_WITH_CODE (GDesktopAppInfo, g_desktop_app_info, G_TYPE_OBJECT,
 
 /* DesktopFileDir implementation {{{1 */
 
+/* A list of tokens, each followed by the applications it belongs to, as
+ * stored in a desktop file directory index. See desktop_file_dir_indexed_init().
+ */
+typedef struct
+{
+  GVariant                   *tokens_value;  /* (owned) */
+  GVariant                   *postings_value;  /* (owned) */
+  const gchar                *tokens;
+  gsize                       tokens_len;
+  const guint32              *postings;
+  gsize                       n_postings;
+} IndexedTokens;
+
 typedef struct
 {
   gatomicrefcount             ref_count;
@@ -152,6 +167,19 @@ typedef struct
   GHashTable                 *mime_tweaks;
   GHashTable                 *memory_index;
   GHashTable                 *memory_implementations;
+
+  /* Set when @path was loaded from its on-disk index */
+  GvdbTable                  *index;
+  GvdbTable                  *index_mime;
+  GPtrArray                  *index_app_names;  /* weak pointers to the keys of @app_names, in index order */
+  GHashTable                 *index_mime_cache;  /* (element-type utf8 GVariant) */
+  IndexedTokens               index_search;
+  IndexedTokens               index_implementations;
+
+  /* Set when @path was read directly, and an index may be written for it */
+  GVariantBuilder            *index_stamps;  /* a(sx): directories read and their mtimes */
+  gint64                      index_stamp_time;
+  gboolean                    index_stale;
 } DesktopFileDir;
 
 static GPtrArray      *desktop_file_dirs = NULL;
@@ -163,6 +191,8 @@ static const gchar    *gio_launch_desktop_path = NULL;
 
 /* Monitor 'changed' signal handler {{{2 */
 static void desktop_file_dir_reset (DesktopFileDir *dir);
+static gboolean desktop_file_dir_can_index (DesktopFileDir *dir);
+static void desktop_file_dir_write_index (DesktopFileDir *dir);
 
 static DesktopFileDir *
 desktop_file_dir_ref (DesktopFileDir *dir)
@@ -262,7 +292,13 @@ desktop_file_dir_changed (GFileMonitor      *monitor,
     }
 
   if (!do_nothing)
-    desktop_file_dir_reset (dir);
+    {
+      /* The change may not have touched the mtime of any directory, so
+       * rather than trusting the index again, read the files and write
+       * a new one. */
+      dir->index_stale = TRUE;
+      desktop_file_dir_reset (dir);
+    }
 
   g_mutex_unlock (&desktop_file_dir_lock);
 
@@ -753,13 +789,24 @@ merge_directory_results (void)
 
 /* Support for unindexed DesktopFileDirs {{{2 */
 static void
-get_apps_from_dir (GHashTable **apps,
-                   const char  *dirname,
-                   const char  *prefix)
+get_apps_from_dir (GHashTable      **apps,
+                   const char       *dirname,
+                   const char       *prefix,
+                   GVariantBuilder  *stamps)
 {
   const char *basename;
   GDir *dir;
 
+  if (stamps != NULL)
+    {
+      GStatBuf buf;
+
+      /* Taken before reading, so that any change made while reading
+       * shows up as a newer mtime and invalidates the index */
+      if (g_stat (dirname, &buf) == 0)
+        g_variant_builder_add (stamps, "(sx)", dirname, (gint64) buf.st_mtime);
+    }
+
   dir = g_dir_open (dirname, 0, NULL);
 
   if (dir == NULL)
@@ -787,7 +834,7 @@ get_apps_from_dir (GHashTable **apps,
           gchar *subprefix;
 
           subprefix = g_strconcat (prefix, basename, "-", NULL);
-          get_apps_from_dir (apps, filename, subprefix);
+          get_apps_from_dir (apps, filename, subprefix, stamps);
           g_free (subprefix);
         }
 
@@ -897,7 +944,7 @@ desktop_file_dir_unindexed_read_mimeapps_list (DesktopFileDir *dir,
   int i;
 
   key_file = g_key_file_new ();
-  if (!g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL))
+  if (!g_key_file_load_from_file (key_file, filename, G_KEY_FILE_READ_ONLY, NULL))
     {
       g_key_file_free (key_file);
       return;
@@ -1031,8 +1078,14 @@ desktop_file_dir_unindexed_read_mimeapps_lists (DesktopFileDir *dir)
 static void
 desktop_file_dir_unindexed_init (DesktopFileDir *dir)
 {
+  if (desktop_file_dir_can_index (dir))
+    {
+      dir->index_stamps = g_variant_builder_new (G_VARIANT_TYPE ("a(sx)"));
+      dir->index_stamp_time = g_get_real_time () / G_USEC_PER_SEC;
+    }
+
   if (!dir->is_config)
-    get_apps_from_dir (&dir->app_names, dir->path, "");
+    get_apps_from_dir (&dir->app_names, dir->path, "", dir->index_stamps);
 
   desktop_file_dir_unindexed_read_mimeapps_lists (dir);
 }
@@ -1175,17 +1228,16 @@ desktop_file_dir_unindexed_setup_search (DesktopFileDir *dir)
   if (dir->app_names == NULL)
     return;
 
+  /* Masked applications are indexed too, and only skipped when
+   * searching, so that the index does not depend on other directories */
   g_hash_table_iter_init (&iter, dir->app_names);
   while (g_hash_table_iter_next (&iter, &app, &path))
     {
       GKeyFile *key_file;
 
-      if (desktop_file_dir_app_name_is_masked (dir, app))
-        continue;
-
       key_file = g_key_file_new ();
 
-      if (g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, NULL) &&
+      if (g_key_file_load_from_file (key_file, path, G_KEY_FILE_READ_ONLY, NULL) &&
           !g_key_file_get_boolean (key_file, "Desktop Entry", "Hidden", NULL))
         {
           /* Index the interesting keys... */
@@ -1237,6 +1289,9 @@ desktop_file_dir_unindexed_setup_search (DesktopFileDir *dir)
 
       g_key_file_free (key_file);
     }
+
+  if (dir->index_stamps)
+    desktop_file_dir_write_index (dir);
 }
 
 static void
@@ -1272,7 +1327,8 @@ desktop_file_dir_unindexed_search (DesktopFileDir  *dir,
 
       while (mie)
         {
-          add_token_result (mie->app_name, mie->match_category, match_type);
+          if (!desktop_file_dir_app_name_is_masked (dir, mie->app_name))
+            add_token_result (mie->app_name, mie->match_category, match_type);
           mie = mie->next;
         }
     }
@@ -1363,7 +1419,568 @@ desktop_file_dir_unindexed_get_implementations (DesktopFileDir  *dir,
     desktop_file_dir_unindexed_setup_search (dir);
 
   for (mie = g_hash_table_lookup (dir->memory_implementations, interface); mie; mie = mie->next)
-    *results = g_list_prepend (*results, g_strdup (mie->app_name));
+    if (!desktop_file_dir_app_name_is_masked (dir, mie->app_name))
+      *results = g_list_prepend (*results, g_strdup (mie->app_name));
+}
+
+/* Support for indexed DesktopFileDirs {{{2
+ *
+ * Reading a large applications directory means parsing every desktop
+ * file in it, once per process, before the first search.  To avoid that,
+ * the result of doing so is written to a GVDB file in the user's cache
+ * directory, and later processes map that file instead.
+ *
+ * The index holds the desktop IDs and filenames, the search tokens and
+ * Implements= interfaces of the applications, and the MIME associations
+ * of the directory.  It is keyed by the directory, the current languages
+ * and the current desktops, all of which affect its contents.  It stays
+ * valid for as long as the mtimes of the directory and its
+ * subdirectories do not change, which is the case unless desktop files
+ * are modified in place.  That is why the user's own data directory is
+ * never indexed, and why a change notification from the file monitor
+ * makes us ignore the index and write a new one.
+ *
+ * The search tokens are stored as one run of nul-terminated strings and
+ * a parallel array of postings: for each token, the number of
+ * applications that have it, then for each of those its position in
+ * the `apps` list shifted left by 8 bits, ORed with the match category.
+ */
+
+#define DESKTOP_FILE_DIR_INDEX_VERSION 1
+
+static gboolean
+desktop_file_dir_can_index (DesktopFileDir *dir)
+{
+  if (dir->is_config || dir == desktop_file_dir_user_data)
+    return FALSE;
+
+  /* Don’t write files to the user's cache on behalf of another user */
+  if (GLIB_PRIVATE_CALL (g_check_setuid) ())
+    return FALSE;
+
+  return g_getenv ("GIO_DESKTOP_APP_INFO_NO_INDEX") == NULL;
+}
+
+static gchar *
+desktop_file_dir_get_index_key (DesktopFileDir *dir)
+{
+  gchar *languages, *desktops, *key;
+
+  languages = g_strjoinv (":", (gchar **) g_get_language_names ());
+  desktops = g_strjoinv (":", (gchar **) get_lowercase_current_desktops ());
+  key = g_strdup_printf ("%d\n%s\n%s\n%s", DESKTOP_FILE_DIR_INDEX_VERSION,
+                         dir->path, languages, desktops);
+  g_free (languages);
+  g_free (desktops);
+
+  return key;
+}
+
+static gchar *
+desktop_file_dir_get_index_filename (const gchar *key)
+{
+  gchar *hash, *filename;
+
+  hash = g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+  filename = g_build_filename (g_get_user_cache_dir (), "glib-2.0", "desktop-app-info", hash, NULL);
+  g_free (hash);
+
+  return filename;
+}
+
+static GVariant *
+index_get_value (GvdbTable          *table,
+                 const gchar        *name,
+                 const GVariantType *type)
+{
+  GVariant *value;
+
+  value = gvdb_table_get_value (table, name);
+
+  if (value != NULL && !g_variant_is_of_type (value, type))
+    g_clear_pointer (&value, g_variant_unref);
+
+  return value;
+}
+
+static gboolean
+desktop_file_dir_index_is_current (GvdbTable   *table,
+                                   const gchar *key)
+{
+  GVariant *value;
+  GVariantIter iter;
+  const gchar *path;
+  gint64 mtime;
+  gboolean current;
+
+  value = index_get_value (table, "key", G_VARIANT_TYPE_STRING);
+  current = value != NULL && g_str_equal (g_variant_get_string (value, NULL), key);
+  g_clear_pointer (&value, g_variant_unref);
+
+  if (!current)
+    return FALSE;
+
+  value = index_get_value (table, "stamps", G_VARIANT_TYPE ("a(sx)"));
+  if (value == NULL)
+    return FALSE;
+
+  g_variant_iter_init (&iter, value);
+  while (current && g_variant_iter_next (&iter, "(&sx)", &path, &mtime))
+    {
+      GStatBuf buf;
+
+      current = g_stat (path, &buf) == 0 && (gint64) buf.st_mtime == mtime;
+    }
+
+  g_variant_unref (value);
+
+  return current;
+}
+
+static void
+indexed_tokens_clear (IndexedTokens *tokens)
+{
+  g_clear_pointer (&tokens->tokens_value, g_variant_unref);
+  g_clear_pointer (&tokens->postings_value, g_variant_unref);
+  memset (tokens, 0, sizeof (IndexedTokens));
+}
+
+/* Loads a list of tokens and their postings, and checks that it can be
+ * walked without going out of bounds. */
+static gboolean
+indexed_tokens_init (IndexedTokens *tokens,
+                     GvdbTable     *table,
+                     const gchar   *name,
+                     guint          n_apps)
+{
+  gchar *postings_name;
+  const gchar *token, *tokens_end;
+  gsize i;
+
+  postings_name = g_strconcat (name, "-postings", NULL);
+  tokens->tokens_value = index_get_value (table, name, G_VARIANT_TYPE_BYTESTRING);
+  tokens->postings_value = index_get_value (table, postings_name, G_VARIANT_TYPE ("au"));
+  g_free (postings_name);
+
+  if (tokens->tokens_value == NULL || tokens->postings_value == NULL)
+    return FALSE;
+
+  tokens->tokens = g_variant_get_fixed_array (tokens->tokens_value, &tokens->tokens_len, 1);
+  tokens->postings = g_variant_get_fixed_array (tokens->postings_value, &tokens->n_postings, sizeof (guint32));
+
+  token = tokens->tokens;
+  tokens_end = token + tokens->tokens_len;
+  i = 0;
+
+  while (token < tokens_end)
+    {
+      const gchar *token_end;
+      guint32 n, j;
+
+      token_end = memchr (token, '\0', tokens_end - token);
+      if (token_end == NULL || i >= tokens->n_postings)
+        return FALSE;
+
+      n = tokens->postings[i++];
+      if (n > tokens->n_postings - i)
+        return FALSE;
+
+      for (j = 0; j < n; j++)
+        if ((tokens->postings[i + j] >> 8) >= n_apps)
+          return FALSE;
+
+      i += n;
+      token = token_end + 1;
+    }
+
+  return i == tokens->n_postings;
+}
+
+/*< internal >
+ * desktop_file_dir_indexed_init:
+ * @dir: a #DesktopFileDir
+ *
+ * Loads @dir from its index, if there is a current one.
+ *
+ * Returns: %TRUE if @dir was loaded, %FALSE if it needs to be read
+ */
+static gboolean
+desktop_file_dir_indexed_init (DesktopFileDir *dir)
+{
+  GvdbTable *table;
+  GVariant *apps;
+  GVariantIter iter;
+  const gchar *app_name, *filename;
+  gchar *key, *index_filename;
+  gboolean current;
+
+  if (!desktop_file_dir_can_index (dir) || dir->index_stale)
+    return FALSE;
+
+  key = desktop_file_dir_get_index_key (dir);
+  index_filename = desktop_file_dir_get_index_filename (key);
+  table = gvdb_table_new (index_filename, FALSE, NULL);
+  g_free (index_filename);
+
+  current = table != NULL && desktop_file_dir_index_is_current (table, key);
+  g_free (key);
+
+  if (!current)
+    {
+      g_clear_pointer (&table, gvdb_table_free);
+      return FALSE;
+    }
+
+  apps = index_get_value (table, "apps", G_VARIANT_TYPE ("a(ss)"));
+  dir->index_mime = gvdb_table_get_table (table, "mime");
+
+  if (apps == NULL || dir->index_mime == NULL)
+    goto fail;
+
+  dir->app_names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  dir->index_app_names = g_ptr_array_new ();
+
+  g_variant_iter_init (&iter, apps);
+  while (g_variant_iter_next (&iter, "(&s&s)", &app_name, &filename))
+    {
+      gchar *app_name_copy = g_strdup (app_name);
+
+      g_hash_table_insert (dir->app_names, app_name_copy, g_strdup (filename));
+      g_ptr_array_add (dir->index_app_names, app_name_copy);
+    }
+
+  g_clear_pointer (&apps, g_variant_unref);
+
+  /* Duplicates would leave dangling pointers in @index_app_names */
+  if (g_hash_table_size (dir->app_names) != dir->index_app_names->len ||
+      !indexed_tokens_init (&dir->index_search, table, "search", dir->index_app_names->len) ||
+      !indexed_tokens_init (&dir->index_implementations, table, "implementations", dir->index_app_names->len))
+    goto fail;
+
+  dir->index = table;
+  dir->index_mime_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+
+  return TRUE;
+
+fail:
+  g_clear_pointer (&apps, g_variant_unref);
+  g_clear_pointer (&dir->index_mime, gvdb_table_free);
+  g_clear_pointer (&dir->index_app_names, g_ptr_array_unref);
+  g_clear_pointer (&dir->app_names, g_hash_table_unref);
+  indexed_tokens_clear (&dir->index_search);
+  indexed_tokens_clear (&dir->index_implementations);
+  gvdb_table_free (table);
+
+  return FALSE;
+}
+
+static void
+desktop_file_dir_indexed_search (DesktopFileDir *dir,
+                                 const gchar    *search_token)
+{
+  const IndexedTokens *tokens = &dir->index_search;
+  const gchar *token;
+  gsize i = 0;
+
+  for (token = tokens->tokens;
+       token < tokens->tokens + tokens->tokens_len;
+       token += strlen (token) + 1)
+    {
+      const char *p;
+      MatchType match_type;
+      guint32 n, j;
+
+      n = tokens->postings[i++];
+
+      /* As in desktop_file_dir_unindexed_search() */
+      p = strstr (token, search_token);
+      if (p == NULL)
+        {
+          i += n;
+          continue;
+        }
+      else if (p == token && *search_token != '\0')
+        match_type = MATCH_TYPE_PREFIX;
+      else
+        match_type = MATCH_TYPE_SUBSTRING;
+
+      for (j = 0; j < n; j++, i++)
+        {
+          const gchar *app_name = g_ptr_array_index (dir->index_app_names, tokens->postings[i] >> 8);
+
+          if (!desktop_file_dir_app_name_is_masked (dir, app_name))
+            add_token_result (app_name, tokens->postings[i] & 0xff, match_type);
+        }
+    }
+}
+
+static void
+desktop_file_dir_indexed_get_implementations (DesktopFileDir  *dir,
+                                              GList          **results,
+                                              const gchar     *interface)
+{
+  const IndexedTokens *tokens = &dir->index_implementations;
+  const gchar *token;
+  gsize i = 0;
+
+  for (token = tokens->tokens;
+       token < tokens->tokens + tokens->tokens_len;
+       token += strlen (token) + 1)
+    {
+      guint32 n, j;
+
+      n = tokens->postings[i++];
+
+      if (!g_str_equal (token, interface))
+        {
+          i += n;
+          continue;
+        }
+
+      for (j = 0; j < n; j++, i++)
+        {
+          const gchar *app_name = g_ptr_array_index (dir->index_app_names, tokens->postings[i] >> 8);
+
+          if (!desktop_file_dir_app_name_is_masked (dir, app_name))
+            *results = g_list_prepend (*results, g_strdup (app_name));
+        }
+    }
+}
+
+/* Returns the (additions, removals, defaults) of @mime_type, as in
+ * #UnindexedMimeTweaks.  The strings in it remain valid until @dir is
+ * reset. */
+static GVariant *
+desktop_file_dir_indexed_get_tweaks (DesktopFileDir *dir,
+                                     const gchar    *mime_type)
+{
+  GVariant *tweaks;
+
+  tweaks = g_hash_table_lookup (dir->index_mime_cache, mime_type);
+
+  if (tweaks == NULL)
+    {
+      tweaks = index_get_value (dir->index_mime, mime_type, G_VARIANT_TYPE ("(asasas)"));
+
+      if (tweaks != NULL)
+        g_hash_table_insert (dir->index_mime_cache, g_strdup (mime_type), tweaks);
+    }
+
+  return tweaks;
+}
+
+static void
+desktop_file_dir_indexed_mime_lookup (DesktopFileDir *dir,
+                                      const gchar    *mime_type,
+                                      GPtrArray      *hits,
+                                      GPtrArray      *blocklist)
+{
+  GVariant *tweaks;
+  const gchar **additions, **removals;
+  gint i;
+
+  tweaks = desktop_file_dir_indexed_get_tweaks (dir, mime_type);
+
+  if (!tweaks)
+    return;
+
+  g_variant_get (tweaks, "(^a&s^a&sas)", &additions, &removals, NULL);
+
+  /* As in desktop_file_dir_unindexed_mime_lookup() */
+  for (i = 0; additions[i]; i++)
+    {
+      const gchar *app_name = additions[i];
+
+      if (!desktop_file_dir_app_name_is_masked (dir, app_name) &&
+          !array_contains (blocklist, app_name) && !array_contains (hits, app_name))
+        g_ptr_array_add (hits, (gpointer) app_name);
+    }
+
+  for (i = 0; removals[i]; i++)
+    {
+      const gchar *app_name = removals[i];
+
+      if (!desktop_file_dir_app_name_is_masked (dir, app_name) &&
+          !array_contains (blocklist, app_name) && !array_contains (hits, app_name))
+        g_ptr_array_add (blocklist, (gpointer) app_name);
+    }
+
+  g_free (additions);
+  g_free (removals);
+}
+
+static void
+desktop_file_dir_indexed_default_lookup (DesktopFileDir *dir,
+                                         const gchar    *mime_type,
+                                         GPtrArray      *results)
+{
+  GVariant *tweaks;
+  const gchar **defaults;
+  gint i;
+
+  tweaks = desktop_file_dir_indexed_get_tweaks (dir, mime_type);
+
+  if (!tweaks)
+    return;
+
+  g_variant_get (tweaks, "(asas^a&s)", NULL, NULL, &defaults);
+
+  for (i = 0; defaults[i]; i++)
+    {
+      if (!array_contains (results, defaults[i]))
+        g_ptr_array_add (results, (gpointer) defaults[i]);
+    }
+
+  g_free (defaults);
+}
+
+static void
+index_add_tokens (GHashTable  *root,
+                  const gchar *name,
+                  MemoryIndex *mi,
+                  GHashTable  *app_positions)
+{
+  GByteArray *tokens;
+  GArray *postings;
+  GHashTableIter iter;
+  gpointer token, value;
+  gchar *postings_name;
+
+  tokens = g_byte_array_new ();
+  postings = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+  g_hash_table_iter_init (&iter, mi);
+  while (g_hash_table_iter_next (&iter, &token, &value))
+    {
+      MemoryIndexEntry *mie;
+      guint count_pos = postings->len;
+      guint32 n = 0;
+
+      g_byte_array_append (tokens, token, strlen (token) + 1);
+      g_array_append_val (postings, n);
+
+      for (mie = value; mie; mie = mie->next)
+        {
+          guint32 posting;
+
+          posting = GPOINTER_TO_UINT (g_hash_table_lookup (app_positions, mie->app_name)) << 8 |
+                    (mie->match_category & 0xff);
+          g_array_append_val (postings, posting);
+          n++;
+        }
+
+      g_array_index (postings, guint32, count_pos) = n;
+    }
+
+  gvdb_item_set_value (gvdb_hash_table_insert (root, name),
+                       g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE, tokens->data, tokens->len, 1));
+  postings_name = g_strconcat (name, "-postings", NULL);
+  gvdb_item_set_value (gvdb_hash_table_insert (root, postings_name),
+                       g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32, postings->data, postings->len, sizeof (guint32)));
+  g_free (postings_name);
+
+  g_byte_array_unref (tokens);
+  g_array_unref (postings);
+}
+
+static GVariant *
+strv_to_variant (gchar **strv)
+{
+  return g_variant_new_strv ((const gchar * const *) strv, strv ? -1 : 0);
+}
+
+/*< internal >
+ * desktop_file_dir_write_index:
+ * @dir: a #DesktopFileDir which was read directly and set up for search
+ *
+ * Writes the index for @dir, so that later processes need not read it.
+ */
+static void
+desktop_file_dir_write_index (DesktopFileDir *dir)
+{
+  GHashTable *root, *mime, *app_positions;
+  GVariantBuilder apps;
+  GVariant *stamps, *stamp;
+  GVariantIter iter;
+  GHashTableIter hash_iter;
+  gpointer app_name, filename, mime_type, value;
+  gchar *key, *index_filename, *index_dir;
+  GError *local_error = NULL;
+  guint n_apps;
+
+  stamps = g_variant_ref_sink (g_variant_builder_end (dir->index_stamps));
+  g_clear_pointer (&dir->index_stamps, g_variant_builder_unref);
+
+  /* A directory modified within the same second as it was read may have
+   * been modified after it was read, without its mtime showing that */
+  g_variant_iter_init (&iter, stamps);
+  while ((stamp = g_variant_iter_next_value (&iter)))
+    {
+      gint64 mtime;
+
+      g_variant_get_child (stamp, 1, "x", &mtime);
+      g_variant_unref (stamp);
+
+      if (mtime >= dir->index_stamp_time - 1)
+        {
+          g_variant_unref (stamps);
+          return;
+        }
+    }
+
+  key = desktop_file_dir_get_index_key (dir);
+  root = gvdb_hash_table_new (NULL, NULL);
+  gvdb_hash_table_insert_string (root, "key", key);
+  gvdb_item_set_value (gvdb_hash_table_insert (root, "stamps"), stamps);
+  g_variant_unref (stamps);
+
+  app_positions = g_hash_table_new (NULL, NULL);
+  g_variant_builder_init (&apps, G_VARIANT_TYPE ("a(ss)"));
+  n_apps = 0;
+
+  g_hash_table_iter_init (&hash_iter, dir->app_names);
+  while (g_hash_table_iter_next (&hash_iter, &app_name, &filename))
+    {
+      g_hash_table_insert (app_positions, app_name, GUINT_TO_POINTER (n_apps++));
+      g_variant_builder_add (&apps, "(ss)", app_name, filename);
+    }
+
+  gvdb_item_set_value (gvdb_hash_table_insert (root, "apps"), g_variant_builder_end (&apps));
+  index_add_tokens (root, "search", dir->memory_index, app_positions);
+  index_add_tokens (root, "implementations", dir->memory_implementations, app_positions);
+  g_hash_table_unref (app_positions);
+
+  mime = gvdb_hash_table_new (root, "mime");
+  g_hash_table_iter_init (&hash_iter, dir->mime_tweaks);
+  while (g_hash_table_iter_next (&hash_iter, &mime_type, &value))
+    {
+      UnindexedMimeTweaks *tweaks = value;
+
+      gvdb_item_set_value (gvdb_hash_table_insert (mime, mime_type),
+                           g_variant_new ("(@as@as@as)",
+                                          strv_to_variant (tweaks->additions),
+                                          strv_to_variant (tweaks->removals),
+                                          strv_to_variant (tweaks->defaults)));
+    }
+  g_hash_table_unref (mime);
+
+  index_filename = desktop_file_dir_get_index_filename (key);
+  index_dir = g_path_get_dirname (index_filename);
+
+  if (g_mkdir_with_parents (index_dir, 0700) != 0 ||
+      !gvdb_table_write_contents (root, index_filename, FALSE, &local_error))
+    {
+      g_debug ("Failed to write index of %s to %s: %s", dir->path, index_filename,
+               local_error ? local_error->message : g_strerror (errno));
+      g_clear_error (&local_error);
+    }
+  else
+    dir->index_stale = FALSE;
+
+  g_hash_table_unref (root);
+  g_free (index_filename);
+  g_free (index_dir);
+  g_free (key);
 }
 
 /* DesktopFileDir "API" {{{2 */
@@ -1453,6 +2070,14 @@ desktop_file_dir_reset (DesktopFileDir *dir)
       dir->memory_implementations = NULL;
     }
 
+  g_clear_pointer (&dir->index_mime_cache, g_hash_table_unref);
+  g_clear_pointer (&dir->index_app_names, g_ptr_array_unref);
+  g_clear_pointer (&dir->index_mime, gvdb_table_free);
+  g_clear_pointer (&dir->index, gvdb_table_free);
+  indexed_tokens_clear (&dir->index_search);
+  indexed_tokens_clear (&dir->index_implementations);
+  g_clear_pointer (&dir->index_stamps, g_variant_builder_unref);
+
   dir->is_setup = FALSE;
 }
 
@@ -1496,7 +2121,8 @@ desktop_file_dir_init (DesktopFileDir *dir)
                                                      desktop_file_dir_ref (dir),
                                                      closure_notify_cb, NULL);
 
-  desktop_file_dir_unindexed_init (dir);
+  if (!desktop_file_dir_indexed_init (dir))
+    desktop_file_dir_unindexed_init (dir);
 
   dir->is_setup = TRUE;
 }
@@ -1560,7 +2186,10 @@ desktop_file_dir_mime_lookup (DesktopFileDir *dir,
                               GPtrArray      *hits,
                               GPtrArray      *blocklist)
 {
-  desktop_file_dir_unindexed_mime_lookup (dir, mime_type, hits, blocklist);
+  if (dir->index)
+    desktop_file_dir_indexed_mime_lookup (dir, mime_type, hits, blocklist);
+  else
+    desktop_file_dir_unindexed_mime_lookup (dir, mime_type, hits, blocklist);
 }
 
 /*< internal >
@@ -1576,7 +2205,10 @@ desktop_file_dir_default_lookup (DesktopFileDir *dir,
                                  const gchar    *mime_type,
                                  GPtrArray      *results)
 {
-  desktop_file_dir_unindexed_default_lookup (dir, mime_type, results);
+  if (dir->index)
+    desktop_file_dir_indexed_default_lookup (dir, mime_type, results);
+  else
+    desktop_file_dir_unindexed_default_lookup (dir, mime_type, results);
 }
 
 /*< internal >
@@ -1590,7 +2222,10 @@ static void
 desktop_file_dir_search (DesktopFileDir *dir,
                          const gchar    *search_token)
 {
-  desktop_file_dir_unindexed_search (dir, search_token);
+  if (dir->index)
+    desktop_file_dir_indexed_search (dir, search_token);
+  else
+    desktop_file_dir_unindexed_search (dir, search_token);
 }
 
 static void
@@ -1598,7 +2233,10 @@ desktop_file_dir_get_implementations (DesktopFileDir  *dir,
                                       GList          **results,
                                       const gchar     *interface)
 {
-  desktop_file_dir_unindexed_get_implementations (dir, results, interface);
+  if (dir->index)
+    desktop_file_dir_indexed_get_implementations (dir, results, interface);
+  else
+    desktop_file_dir_unindexed_get_implementations (dir, results, interface);
 }
 
 /* Lock/unlock and global setup API {{{2 */
@@ -2055,7 +2693,7 @@ g_desktop_app_info_load_file (GDesktopAppInfo *self)
 
   key_file = g_key_file_new ();
 
-  if (g_key_file_load_from_file (key_file, self->filename, G_KEY_FILE_NONE, NULL))
+  if (g_key_file_load_from_file (key_file, self->filename, G_KEY_FILE_READ_ONLY, NULL))
     retval = g_desktop_app_info_load_from_keyfile (self, key_file);
 
   g_key_file_unref (key_file);
@@ -46,6 +46,11 @@
  * was created in (though if the global default main context is blocked, this
  * may cause notifications to be blocked even if the thread-default
  * context is still running).
+ *
+ * Applications that watch directories in which many files change at
+ * once, such as build trees, can set [property@Gio.FileMonitor:batch-latency]
+ * to receive all of the changes made within a time window in a single
+ * emission of [signal@Gio.FileMonitor::changed-batch] instead.
  **/
 
 #define DEFAULT_RATE_LIMIT_MSECS 800
@@ -61,10 +66,12 @@ enum
 {
   PROP_0,
   PROP_RATE_LIMIT,
-  PROP_CANCELLED
+  PROP_CANCELLED,
+  PROP_BATCH_LATENCY
 };
 
 static guint g_file_monitor_changed_signal;
+static guint g_file_monitor_changed_batch_signal;
 
 static void
 g_file_monitor_set_property (GObject      *object,
@@ -79,6 +86,7 @@ g_file_monitor_set_property (GObject      *object,
   switch (prop_id)
     {
     case PROP_RATE_LIMIT:
+    case PROP_BATCH_LATENCY:
       /* not supported by default */
       break;
 
@@ -107,6 +115,11 @@ g_file_monitor_get_property (GObject    *object,
       //g_mutex_unlock (&fms->lock);
       break;
 
+    case PROP_BATCH_LATENCY:
+      /* batching is not supported by default */
+      g_value_set_int (value, 0);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -154,7 +167,8 @@ g_file_monitor_class_init (GFileMonitorClass *klass)
    * @event_type may be %G_FILE_MONITOR_EVENT_RENAMED,
    * %G_FILE_MONITOR_EVENT_MOVED_IN or %G_FILE_MONITOR_EVENT_MOVED_OUT.
    *
-   * In all cases @file will be a child of the monitored directory.  For
+   * In all cases @file will be a child of the monitored directory, or
+   * any descendant of it if %G_FILE_MONITOR_WATCH_RECURSIVE is in use.  For
    * renames, @file will be the old name and @other_file is the new
    * name.  For "moved in" events, @file is the name of the file that
    * appeared and @other_file is the old name that it was moved from (in
@@ -188,6 +202,36 @@ g_file_monitor_class_init (GFileMonitorClass *klass)
                               G_TYPE_FROM_CLASS (klass),
                               _g_cclosure_marshal_VOID__OBJECT_OBJECT_ENUMv);
 
+  /**
+   * GFileMonitor::changed-batch:
+   * @monitor: a #GFileMonitor.
+   * @changes: (element-type GFile GFileMonitorChangeFlags): a hash table
+   *   mapping each file that changed to the #GFileMonitorChangeFlags
+   *   describing how it changed, stored with GUINT_TO_POINTER()
+   *
+   * Emitted instead of #GFileMonitor::changed when
+   * #GFileMonitor:batch-latency is non-zero, with all of the changes
+   * that were made since the previous emission.
+   *
+   * Each file appears in @changes only once, however many events it
+   * had.  Moves and renames are reported as the deletion of the old
+   * name and the creation of the new one, and there is no equivalent
+   * of %G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT: the end of the batch
+   * serves as one.
+   *
+   * @changes is only valid for the duration of the signal emission.
+   *
+   * Since: 2.80
+   **/
+  g_file_monitor_changed_batch_signal = g_signal_new (I_("changed-batch"),
+                                                      G_TYPE_FILE_MONITOR,
+                                                      G_SIGNAL_RUN_LAST,
+                                                      0,
+                                                      NULL, NULL,
+                                                      NULL,
+                                                      G_TYPE_NONE, 1,
+                                                      G_TYPE_HASH_TABLE);
+
   /**
    * GFileMonitor:rate-limit:
    *
@@ -206,6 +250,23 @@ g_file_monitor_class_init (GFileMonitorClass *klass)
   g_object_class_install_property (object_class, PROP_CANCELLED,
                                    g_param_spec_boolean ("cancelled", NULL, NULL,
                                                          FALSE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GFileMonitor:batch-latency:
+   *
+   * The time, in milliseconds, for which changes are collected before
+   * they are emitted together in #GFileMonitor::changed-batch, or 0 to
+   * emit each of them in #GFileMonitor::changed.
+   *
+   * Monitors which do not support batching ignore this property, and
+   * always report 0 for it.
+   *
+   * Since: 2.80
+   */
+  g_object_class_install_property (object_class, PROP_BATCH_LATENCY,
+                                   g_param_spec_int ("batch-latency", NULL, NULL,
+                                                     0, G_MAXINT, 0, G_PARAM_READWRITE |
+                                                     G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -268,6 +329,34 @@ g_file_monitor_set_rate_limit (GFileMonitor *monitor,
   g_object_set (monitor, "rate-limit", limit_msecs, NULL);
 }
 
+/**
+ * g_file_monitor_set_batch_latency:
+ * @monitor: a #GFileMonitor.
+ * @latency_msecs: the time to collect changes for, in milliseconds,
+ *   or 0 to stop batching them
+ *
+ * Sets the time for which @monitor collects changes before emitting
+ * them together in #GFileMonitor::changed-batch, instead of emitting
+ * #GFileMonitor::changed for each of them.
+ *
+ * Within a batch, the changes to each file are coalesced.  This is much
+ * cheaper than handling every event when many files change at once.
+ *
+ * Check #GFileMonitor:batch-latency after setting it to find out if
+ * @monitor supports batching.
+ *
+ * Since: 2.80
+ */
+void
+g_file_monitor_set_batch_latency (GFileMonitor *monitor,
+                                  gint          latency_msecs)
+{
+  g_return_if_fail (G_IS_FILE_MONITOR (monitor));
+  g_return_if_fail (latency_msecs >= 0);
+
+  g_object_set (monitor, "batch-latency", latency_msecs, NULL);
+}
+
 /**
  * g_file_monitor_emit_event:
  * @monitor: a #GFileMonitor.
@@ -81,6 +81,9 @@ gboolean g_file_monitor_is_cancelled   (GFileMonitor      *monitor);
 GIO_AVAILABLE_IN_ALL
 void     g_file_monitor_set_rate_limit (GFileMonitor      *monitor,
                                         gint               limit_msecs);
+GIO_AVAILABLE_IN_2_80
+void     g_file_monitor_set_batch_latency (GFileMonitor   *monitor,
+                                           gint            latency_msecs);
 
 
 /* For implementations */
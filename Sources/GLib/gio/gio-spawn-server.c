@@ -0,0 +1,425 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * gio-spawn-server: GSubprocessLauncher helper
+ *
+ * A long-lived process which starts children on behalf of a (possibly very
+ * large) application, so that the application does not have to duplicate
+ * its own address space for every launch. Requests arrive on the socket
+ * passed as the first argument; see gspawnserver-private.h for the protocol.
+ *
+ * Children are created with CLONE_PARENT, which makes them children of the
+ * application rather than of this helper. The application can therefore
+ * wait for them and reap them exactly as if it had spawned them itself.
+ *
+ * This helper is designed to be minimal and lightweight.
+ * It does not even link against glib.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "gspawnserver-private.h"
+
+/* The first 64 bytes of the kernel’s struct clone_args (CLONE_ARGS_SIZE_VER0),
+ * spelled out so that we do not depend on new enough kernel headers. */
+struct spawn_clone_args
+{
+  uint64_t flags;
+  uint64_t pidfd;
+  uint64_t child_tid;
+  uint64_t parent_tid;
+  uint64_t exit_signal;
+  uint64_t stack;
+  uint64_t stack_size;
+  uint64_t tls;
+};
+
+static int
+read_all (int     fd,
+          void   *vbuf,
+          size_t  to_read)
+{
+  char *buf = vbuf;
+
+  while (to_read > 0)
+    {
+      ssize_t count = read (fd, buf, to_read);
+
+      if (count == 0)
+        {
+          errno = 0;
+          return -1;
+        }
+      if (count < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return -1;
+        }
+
+      buf += count;
+      to_read -= count;
+    }
+
+  return 0;
+}
+
+static int
+write_all (int         fd,
+           const void *vbuf,
+           size_t      to_write)
+{
+  const char *buf = vbuf;
+
+  while (to_write > 0)
+    {
+      ssize_t count = write (fd, buf, to_write);
+
+      if (count < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return -1;
+        }
+
+      buf += count;
+      to_write -= count;
+    }
+
+  return 0;
+}
+
+/* Like fork(), but the new process becomes a sibling of this one. Its exit
+ * signal is inherited from us, which is SIGCHLD since we were spawned
+ * normally. */
+static pid_t
+fork_as_sibling (void)
+{
+  pid_t pid;
+
+#ifdef SYS_clone3
+  {
+    struct spawn_clone_args args;
+
+    memset (&args, 0, sizeof args);
+    args.flags = CLONE_PARENT;
+
+    pid = syscall (SYS_clone3, &args, sizeof args);
+    if (pid != -1 || errno != ENOSYS)
+      return pid;
+  }
+#endif
+
+#if defined(__s390__) || defined(__CRIS__)
+  pid = syscall (SYS_clone, NULL, CLONE_PARENT, NULL, NULL, NULL);
+#else
+  pid = syscall (SYS_clone, CLONE_PARENT, NULL, NULL, NULL, NULL);
+#endif
+
+  return pid;
+}
+
+static void
+child_report_and_exit (int     report_fd,
+                       int32_t stage)
+{
+  int32_t buf[2];
+
+  buf[0] = stage;
+  buf[1] = errno;
+  write_all (report_fd, buf, sizeof buf);
+
+  _exit (127);
+}
+
+/* Runs in the child: only async-signal-safe calls from here on.
+ *
+ * @sh_argv is the argument vector to run @path as a shell script with,
+ * like execvp() and g_spawn_async() do when it has no #! line. */
+static void
+child_exec (int            report_fd,
+            const char    *path,
+            const char    *cwd,
+            char         **argv,
+            char         **sh_argv,
+            char         **envp,
+            int           *fds,
+            const int32_t *targets,
+            uint32_t       n_fds)
+{
+  int max_target = 2;
+  uint32_t i;
+
+  for (i = 0; i < n_fds; i++)
+    if (targets[i] > max_target)
+      max_target = targets[i];
+
+  /* Move everything above the highest target first, so that no source or
+   * the report pipe is clobbered by an earlier dup2(). The copies are
+   * close-on-exec; dup2() clears that flag on the targets. */
+  report_fd = fcntl (report_fd, F_DUPFD_CLOEXEC, max_target + 1);
+  if (report_fd < 0)
+    _exit (127);
+
+  for (i = 0; i < n_fds; i++)
+    {
+      fds[i] = fcntl (fds[i], F_DUPFD_CLOEXEC, max_target + 1);
+      if (fds[i] < 0)
+        child_report_and_exit (report_fd, G_SPAWN_SERVER_STAGE_DUP);
+    }
+
+  for (i = 0; i < n_fds; i++)
+    if (dup2 (fds[i], targets[i]) < 0)
+      child_report_and_exit (report_fd, G_SPAWN_SERVER_STAGE_DUP);
+
+  signal (SIGPIPE, SIG_DFL);
+
+  if (cwd[0] != '\0' && chdir (cwd) < 0)
+    child_report_and_exit (report_fd, G_SPAWN_SERVER_STAGE_CHDIR);
+
+  execve (path, argv, envp);
+
+  if (errno == ENOEXEC)
+    {
+      execve (sh_argv[0], sh_argv, envp);
+      errno = ENOEXEC;
+    }
+
+  child_report_and_exit (report_fd, G_SPAWN_SERVER_STAGE_EXEC);
+}
+
+/* Splits @n nul-terminated strings off the front of @payload. */
+static char **
+parse_strings (char     **payload,
+               char      *end,
+               uint32_t   n)
+{
+  char **strv;
+  uint32_t i;
+
+  strv = calloc ((size_t) n + 1, sizeof (char *));
+  if (strv == NULL)
+    return NULL;
+
+  for (i = 0; i < n; i++)
+    {
+      char *nul = memchr (*payload, '\0', end - *payload);
+
+      if (nul == NULL)
+        {
+          free (strv);
+          return NULL;
+        }
+
+      strv[i] = *payload;
+      *payload = nul + 1;
+    }
+
+  return strv;
+}
+
+/* Returns -1 when the connection should be dropped. */
+static int
+handle_request (int server_fd)
+{
+  GSpawnServerRequest req;
+  GSpawnServerReply reply = { -1, G_SPAWN_SERVER_STAGE_OK, 0 };
+  union {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int) * G_SPAWN_SERVER_MAX_FDS)];
+  } control;
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  int fds[G_SPAWN_SERVER_MAX_FDS];
+  uint32_t n_fds = 0, i;
+  char *payload = NULL, *p, *end, *path, *cwd;
+  char **argv = NULL, **sh_argv = NULL, **envp = NULL;
+  int32_t *targets;
+  int report[2];
+  ssize_t n;
+  int ret = -1;
+
+  memset (&msg, 0, sizeof msg);
+  iov.iov_base = &req;
+  iov.iov_len = sizeof req;
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof control.buf;
+
+  do
+    n = recvmsg (server_fd, &msg, MSG_CMSG_CLOEXEC);
+  while (n < 0 && errno == EINTR);
+
+  if (n <= 0)
+    return -1;
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg != NULL; cmsg = CMSG_NXTHDR (&msg, cmsg))
+    {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        {
+          uint32_t count = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+
+          for (i = 0; i < count && n_fds < G_SPAWN_SERVER_MAX_FDS; i++)
+            memcpy (&fds[n_fds++], CMSG_DATA (cmsg) + i * sizeof (int), sizeof (int));
+        }
+    }
+
+  if ((size_t) n < sizeof req &&
+      read_all (server_fd, (char *) &req + n, sizeof req - n) < 0)
+    goto out;
+
+  if (req.magic != G_SPAWN_SERVER_MAGIC ||
+      req.n_fds != n_fds ||
+      (msg.msg_flags & MSG_CTRUNC) != 0 ||
+      req.payload_len > G_SPAWN_SERVER_MAX_PAYLOAD ||
+      req.payload_len < n_fds * sizeof (int32_t))
+    goto out;
+
+  payload = malloc ((size_t) req.payload_len + 1);
+  if (payload == NULL || read_all (server_fd, payload, req.payload_len) < 0)
+    goto out;
+  payload[req.payload_len] = '\0';
+
+  /* From here on the stream is in sync again, so errors are reported to
+   * the client rather than dropping the connection. */
+  ret = 0;
+
+  targets = (int32_t *) payload;
+  p = payload + n_fds * sizeof (int32_t);
+  end = payload + req.payload_len;
+
+  path = p;
+  cwd = NULL;
+  if ((p = memchr (p, '\0', end - p)) != NULL)
+    {
+      cwd = ++p;
+      if ((p = memchr (p, '\0', end - p)) != NULL)
+        p++;
+    }
+
+  if (p == NULL ||
+      (argv = parse_strings (&p, end, req.n_argv)) == NULL ||
+      (envp = parse_strings (&p, end, req.n_envp)) == NULL ||
+      path[0] == '\0')
+    {
+      reply.stage = G_SPAWN_SERVER_STAGE_BAD_REQUEST;
+      reply.errnum = EINVAL;
+      goto out;
+    }
+
+  /* The child must not allocate, so build the /bin/sh fallback here:
+   * { "/bin/sh", path, argv[1], …, NULL } */
+  sh_argv = calloc ((size_t) req.n_argv + 2, sizeof (char *));
+  if (sh_argv == NULL)
+    {
+      reply.stage = G_SPAWN_SERVER_STAGE_FORK;
+      reply.errnum = ENOMEM;
+      goto out;
+    }
+  sh_argv[0] = (char *) "/bin/sh";
+  sh_argv[1] = path;
+  for (i = 1; i < req.n_argv; i++)
+    sh_argv[i + 1] = argv[i];
+
+  if (pipe2 (report, O_CLOEXEC) < 0)
+    {
+      reply.stage = G_SPAWN_SERVER_STAGE_FORK;
+      reply.errnum = errno;
+      goto out;
+    }
+
+  reply.pid = fork_as_sibling ();
+
+  if (reply.pid == 0)
+    {
+      close (report[0]);
+      child_exec (report[1], path, cwd, argv, sh_argv, envp, fds, targets, n_fds);
+    }
+
+  close (report[1]);
+
+  if (reply.pid < 0)
+    {
+      reply.stage = G_SPAWN_SERVER_STAGE_FORK;
+      reply.errnum = errno;
+    }
+  else
+    {
+      int32_t buf[2];
+
+      /* The pipe is closed on a successful exec(). */
+      if (read_all (report[0], buf, sizeof buf) == 0)
+        {
+          reply.stage = buf[0];
+          reply.errnum = buf[1];
+        }
+    }
+
+  close (report[0]);
+
+out:
+  for (i = 0; i < n_fds; i++)
+    close (fds[i]);
+  free (argv);
+  free (sh_argv);
+  free (envp);
+  free (payload);
+
+  if (ret == 0 && write_all (server_fd, &reply, sizeof reply) < 0)
+    ret = -1;
+
+  return ret;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int server_fd = 3;
+
+  if (argc > 1)
+    server_fd = atoi (argv[1]);
+
+  /* A client that went away must not kill us; we notice it on the next
+   * read instead. */
+  signal (SIGPIPE, SIG_IGN);
+
+  if (fcntl (server_fd, F_SETFD, FD_CLOEXEC) < 0)
+    return 1;
+
+  while (handle_request (server_fd) == 0)
+    ;
+
+  return 0;
+}
@@ -347,6 +347,13 @@ typedef enum {
  *   monitored directory.  This causes %G_FILE_MONITOR_EVENT_RENAMED,
  *   %G_FILE_MONITOR_EVENT_MOVED_IN and %G_FILE_MONITOR_EVENT_MOVED_OUT
  *   events to be emitted when possible.  Since: 2.46.
+ * @G_FILE_MONITOR_WATCH_RECURSIVE: Watch for changes to any file in the
+ *   tree below a monitored directory, not just to its children.  Events
+ *   are reported for the files in subdirectories too.  Moves within the
+ *   tree may be reported as %G_FILE_MONITOR_EVENT_MOVED_OUT and
+ *   %G_FILE_MONITOR_EVENT_MOVED_IN pairs.  Not supported by all
+ *   backends: monitoring fails with %G_IO_ERROR_NOT_SUPPORTED where it
+ *   is not.  Since: 2.80.
  *
  * Flags used to set what a #GFileMonitor will watch for.
  */
@@ -355,7 +362,8 @@ typedef enum {
   G_FILE_MONITOR_WATCH_MOUNTS     = (1 << 0),
   G_FILE_MONITOR_SEND_MOVED       = (1 << 1),
   G_FILE_MONITOR_WATCH_HARD_LINKS = (1 << 2),
-  G_FILE_MONITOR_WATCH_MOVES      = (1 << 3)
+  G_FILE_MONITOR_WATCH_MOVES      = (1 << 3),
+  G_FILE_MONITOR_WATCH_RECURSIVE GIO_AVAILABLE_ENUMERATOR_IN_2_80 = (1 << 4)
 } GFileMonitorFlags;
 
 
@@ -447,6 +455,36 @@ typedef enum {
   G_FILE_MONITOR_EVENT_MOVED_OUT
 } GFileMonitorEvent;
 
+/**
+ * GFileMonitorChangeFlags:
+ * @G_FILE_MONITOR_CHANGE_NONE: No changes.
+ * @G_FILE_MONITOR_CHANGE_CREATED: the file was created, or moved or
+ *   renamed to its location.
+ * @G_FILE_MONITOR_CHANGE_DELETED: the file was deleted, or moved or
+ *   renamed away from its location.
+ * @G_FILE_MONITOR_CHANGE_CONTENTS: the contents of the file changed.
+ * @G_FILE_MONITOR_CHANGE_ATTRIBUTES: an attribute of the file changed.
+ * @G_FILE_MONITOR_CHANGE_UNMOUNTED: the file location was, or will soon
+ *   be, unmounted.
+ *
+ * The kinds of change that happened to a file during one batch of
+ * #GFileMonitor::changed-batch.  The flags do not say in which order
+ * the changes happened: a file that was created and then deleted has
+ * both %G_FILE_MONITOR_CHANGE_CREATED and %G_FILE_MONITOR_CHANGE_DELETED
+ * set, as does a file that was deleted and then created again.
+ *
+ * Since: 2.80
+ */
+GIO_AVAILABLE_TYPE_IN_2_80
+typedef enum /*< flags >*/ {
+  G_FILE_MONITOR_CHANGE_NONE       = 0,
+  G_FILE_MONITOR_CHANGE_CREATED    = (1 << 0),
+  G_FILE_MONITOR_CHANGE_DELETED    = (1 << 1),
+  G_FILE_MONITOR_CHANGE_CONTENTS   = (1 << 2),
+  G_FILE_MONITOR_CHANGE_ATTRIBUTES = (1 << 3),
+  G_FILE_MONITOR_CHANGE_UNMOUNTED  = (1 << 4)
+} GFileMonitorChangeFlags;
+
 
 /* This enumeration conflicts with GIOError in giochannel.h. However,
  * that is only used as a return value in some deprecated functions.
@@ -2149,6 +2187,24 @@ typedef enum {
   G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL = 255
 } GMemoryMonitorWarningLevel;
 
+/**
+ * GTaskThreadPool:
+ * @G_TASK_THREAD_POOL_IO: The default pool, for tasks which spend most of
+ *   their time blocked in system calls. It grows when tasks are kept waiting.
+ * @G_TASK_THREAD_POOL_CPU: A pool with one thread per processor, for tasks
+ *   which are mostly busy computing.
+ *
+ * The thread pool which g_task_run_in_thread() and
+ * g_task_run_in_thread_sync() run a task in. See g_task_set_thread_pool().
+ *
+ * Since: 2.80
+ */
+GIO_AVAILABLE_TYPE_IN_2_80
+typedef enum {
+  G_TASK_THREAD_POOL_IO,
+  G_TASK_THREAD_POOL_CPU
+} GTaskThreadPool;
+
 G_END_DECLS
 
 #endif /* __GIO_ENUMS_H__ */
@@ -71,6 +71,8 @@ GIO_AVAILABLE_IN_ALL GType g_filesystem_preview_type_get_type (void) G_GNUC_CONS
 #define G_TYPE_FILESYSTEM_PREVIEW_TYPE (g_filesystem_preview_type_get_type ())
 GIO_AVAILABLE_IN_ALL GType g_file_monitor_event_get_type (void) G_GNUC_CONST;
 #define G_TYPE_FILE_MONITOR_EVENT (g_file_monitor_event_get_type ())
+GIO_AVAILABLE_IN_ALL GType g_file_monitor_change_flags_get_type (void) G_GNUC_CONST;
+#define G_TYPE_FILE_MONITOR_CHANGE_FLAGS (g_file_monitor_change_flags_get_type ())
 GIO_AVAILABLE_IN_ALL GType g_io_error_enum_get_type (void) G_GNUC_CONST;
 #define G_TYPE_IO_ERROR_ENUM (g_io_error_enum_get_type ())
 GIO_AVAILABLE_IN_ALL GType g_ask_password_flags_get_type (void) G_GNUC_CONST;
@@ -191,6 +193,8 @@ GIO_AVAILABLE_IN_ALL GType g_pollable_return_get_type (void) G_GNUC_CONST;
 #define G_TYPE_POLLABLE_RETURN (g_pollable_return_get_type ())
 GIO_AVAILABLE_IN_ALL GType g_memory_monitor_warning_level_get_type (void) G_GNUC_CONST;
 #define G_TYPE_MEMORY_MONITOR_WARNING_LEVEL (g_memory_monitor_warning_level_get_type ())
+GIO_AVAILABLE_IN_ALL GType g_task_thread_pool_get_type (void) G_GNUC_CONST;
+#define G_TYPE_TASK_THREAD_POOL (g_task_thread_pool_get_type ())
 
 /* enumerations from "../gio/gresolver.h" */
 GIO_AVAILABLE_IN_ALL GType g_resolver_name_lookup_flags_get_type (void) G_GNUC_CONST;
@@ -21,10 +21,12 @@
 #ifndef __G_IO_PRIVATE_H__
 #define __G_IO_PRIVATE_H__
 
+#include "gbufferedinputstream.h"
 #include "ginputstream.h"
 #include "goutputstream.h"
 #include "gsocketconnection.h"
 #include "gsocketaddress.h"
+#include "gsocketlistener.h"
 
 G_BEGIN_DECLS
 
@@ -34,9 +36,26 @@ gboolean g_output_stream_async_write_is_via_threads (GOutputStream *stream);
 gboolean g_output_stream_async_writev_is_via_threads (GOutputStream *stream);
 gboolean g_output_stream_async_close_is_via_threads (GOutputStream *stream);
 
+GBytes *g_buffered_input_stream_read_bytes_slice (GBufferedInputStream *stream,
+                                                  gsize                 count);
+
 void g_socket_connection_set_cached_remote_address (GSocketConnection *connection,
                                                     GSocketAddress    *address);
 
+GSocket         *g_socket_accept_with_blocking        (GSocket       *socket,
+                                                       gboolean       blocking,
+                                                       GCancellable  *cancellable,
+                                                       GError       **error);
+GPollableReturn  g_socket_receive_vectors_nonblocking (GSocket       *socket,
+                                                       GInputVector  *vectors,
+                                                       gint           num_vectors,
+                                                       gsize         *bytes_read,
+                                                       GError       **error);
+
+GSocket *g_socket_listener_accept_socket_nonblocking (GSocketListener  *listener,
+                                                      GObject         **source_object,
+                                                      GError          **error);
+
 /* POSIX defines IOV_MAX/UIO_MAXIOV as the maximum number of iovecs that can
  * be sent in one go. We define our own version of it here as there are two
  * possible names, and also define a fall-back value if none of the constants
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -29,8 +30,12 @@
 #include <sys/event.h>
 #include <sys/time.h>
 #endif
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 
 #include "giounix-private.h"
+#include "glibintl.h"
 
 #define G_TEMP_FAILURE_RETRY(expression)      \
   ({                                          \
@@ -145,3 +150,132 @@ g_fd_is_regular_file (int fd)
 
   return S_ISREG (st.st_mode);
 }
+
+/*
+ * _g_fd_get_transfer_method:
+ * @fd_in: the file descriptor to read from
+ * @fd_out: the file descriptor to write to
+ * @remaining: (out) (optional): return location for the number of bytes
+ *   left to read from @fd_in, or -1 if unknown
+ *
+ * Checks whether data can be moved from @fd_in to @fd_out entirely inside
+ * the kernel, and if so, which system call to use for it.
+ *
+ * Only sockets and pipes are accepted as destinations; file-to-file copies
+ * are handled separately by g_file_copy(). Pipes are only accepted as a
+ * source when they are in blocking mode, so that an `EAGAIN` from
+ * _g_fd_transfer() always means that @fd_out is full.
+ *
+ * Returns: the transfer method to use, or %G_FD_TRANSFER_NONE
+ */
+GFdTransferMethod
+_g_fd_get_transfer_method (int      fd_in,
+                           int      fd_out,
+                           goffset *remaining)
+{
+#if defined (HAVE_SYS_SENDFILE_H) || defined (HAVE_SPLICE)
+  struct stat st_in, st_out;
+
+  if (remaining)
+    *remaining = -1;
+
+  if (G_TEMP_FAILURE_RETRY (fstat (fd_in, &st_in)) == -1 ||
+      G_TEMP_FAILURE_RETRY (fstat (fd_out, &st_out)) == -1)
+    return G_FD_TRANSFER_NONE;
+
+  if (!S_ISSOCK (st_out.st_mode) && !S_ISFIFO (st_out.st_mode))
+    return G_FD_TRANSFER_NONE;
+
+#ifdef HAVE_SYS_SENDFILE_H
+  if (S_ISREG (st_in.st_mode))
+    {
+      if (remaining)
+        {
+          off_t pos = lseek (fd_in, 0, SEEK_CUR);
+
+          if (pos != (off_t) -1 && pos <= st_in.st_size)
+            *remaining = st_in.st_size - pos;
+        }
+
+      return G_FD_TRANSFER_SENDFILE;
+    }
+#endif
+
+#ifdef HAVE_SPLICE
+  if (S_ISFIFO (st_in.st_mode))
+    {
+      int fl = fcntl (fd_in, F_GETFL);
+
+      if (fl != -1 && (fl & O_NONBLOCK) == 0)
+        return G_FD_TRANSFER_SPLICE;
+    }
+#endif
+#else
+  if (remaining)
+    *remaining = -1;
+#endif
+
+  return G_FD_TRANSFER_NONE;
+}
+
+/*
+ * _g_fd_transfer:
+ * @method: the method returned by _g_fd_get_transfer_method()
+ * @fd_in: the file descriptor to read from
+ * @fd_out: the file descriptor to write to
+ * @count: the maximum number of bytes to move
+ * @error: return location for a #GError
+ *
+ * Moves up to @count bytes from the current position of @fd_in to @fd_out
+ * without copying them through userspace.
+ *
+ * If @fd_out is non-blocking and cannot accept more data,
+ * %G_IO_ERROR_WOULD_BLOCK is returned. If the kernel refuses this
+ * combination of file descriptors, %G_IO_ERROR_NOT_SUPPORTED is returned and
+ * the caller should fall back to a read/write loop.
+ *
+ * Returns: the number of bytes moved, 0 at end of input, or -1 on error
+ */
+gssize
+_g_fd_transfer (GFdTransferMethod   method,
+                int                 fd_in,
+                int                 fd_out,
+                gsize               count,
+                GError            **error)
+{
+  gssize res = -1;
+  int errsv;
+
+  switch (method)
+    {
+#ifdef HAVE_SYS_SENDFILE_H
+    case G_FD_TRANSFER_SENDFILE:
+      res = G_TEMP_FAILURE_RETRY (sendfile (fd_out, fd_in, NULL, count));
+      break;
+#endif
+#ifdef HAVE_SPLICE
+    case G_FD_TRANSFER_SPLICE:
+      res = G_TEMP_FAILURE_RETRY (splice (fd_in, NULL, fd_out, NULL, count, SPLICE_F_MORE));
+      break;
+#endif
+    default:
+      errno = ENOSYS;
+      break;
+    }
+
+  if (res >= 0)
+    return res;
+
+  errsv = errno;
+
+  if (errsv == ENOSYS || errsv == EINVAL || errsv == EOPNOTSUPP)
+    g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                         _("Splice not supported"));
+  else
+    g_set_error (error, G_IO_ERROR,
+                 g_io_error_from_errno (errsv),
+                 _("Error splicing file: %s"),
+                 g_strerror (errsv));
+
+  return -1;
+}
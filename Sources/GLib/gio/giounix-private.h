@@ -25,4 +25,28 @@ G_BEGIN_DECLS
 
 gboolean _g_fd_is_pollable (int fd);
 
+/*< private >
+ * GFdTransferMethod:
+ * @G_FD_TRANSFER_NONE: no kernel-side copy is possible
+ * @G_FD_TRANSFER_SENDFILE: copy from a regular file using sendfile()
+ * @G_FD_TRANSFER_SPLICE: copy from a pipe using splice()
+ *
+ * How _g_fd_transfer() moves data between two file descriptors without
+ * bouncing it through a userspace buffer.
+ */
+typedef enum {
+  G_FD_TRANSFER_NONE,
+  G_FD_TRANSFER_SENDFILE,
+  G_FD_TRANSFER_SPLICE,
+} GFdTransferMethod;
+
+GFdTransferMethod _g_fd_get_transfer_method (int      fd_in,
+                                             int      fd_out,
+                                             goffset *remaining);
+gssize            _g_fd_transfer            (GFdTransferMethod   method,
+                                             int                 fd_in,
+                                             int                 fd_out,
+                                             gsize               count,
+                                             GError            **error);
+
 G_END_DECLS
@@ -0,0 +1,474 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "giouring-private.h"
+
+#if defined (HAVE_LINUX_IO_URING_H)
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+/* A single io_uring instance shared by the whole process, used to perform
+ * file I/O for GTasks without tying up a GTask worker thread for the
+ * duration of each blocking read() or write().
+ *
+ * Requests are submitted straight from the calling thread. A dedicated
+ * thread waits for completions and returns the tasks, which GTask then
+ * dispatches in their own main contexts.
+ *
+ * Every entry point returns %FALSE if the request could not be submitted,
+ * in which case the caller is expected to fall back to a worker thread.
+ */
+
+#if defined (HAVE_LINUX_IO_URING_H) && defined (__NR_io_uring_setup) && defined (__NR_io_uring_enter)
+
+#define RING_ENTRIES 256
+
+typedef struct
+{
+  int fd;
+  pid_t pid;
+
+  GMutex lock;  /* protects the submission queue, n_in_flight and failed */
+  guint n_in_flight;
+  gint failed;  /* (atomic) */
+
+  guint *sq_head;
+  guint *sq_tail;
+  guint *sq_array;
+  guint sq_mask;
+  guint sq_entries;
+  struct io_uring_sqe *sqes;
+
+  guint *cq_head;
+  guint *cq_tail;
+  guint cq_mask;
+  guint cq_entries;
+  struct io_uring_cqe *cqes;
+} GIOUring;
+
+typedef struct
+{
+  gint ref_count;  /* (atomic) */
+  GTask *task;  /* (owned) */
+  GIOUringCompleteFunc complete;
+  GCancellable *cancellable;  /* (nullable) (owned) */
+
+  /* NULL until either the submitter stored the handler ID or the
+   * completion thread claimed the op, see io_uring_op_complete() */
+  gpointer cancelled_id;  /* (atomic) */
+} GIOUringOp;
+
+static gchar op_completed;
+#define OP_COMPLETED ((gpointer) &op_completed)
+
+static gpointer io_uring_completion_thread (gpointer data);
+
+static GIOUring *
+io_uring_get (void)
+{
+  static GIOUring *ring = NULL;
+  static gsize initialised = 0;
+
+  if (g_once_init_enter (&initialised))
+    {
+      GIOUring *r = NULL;
+      struct io_uring_params params;
+      gsize sq_size, cq_size;
+      guint8 *sq_ptr, *cq_ptr;
+      int fd;
+
+      memset (&params, 0, sizeof (params));
+      fd = syscall (__NR_io_uring_setup, RING_ENTRIES, &params);
+
+      /* IORING_FEAT_RW_CUR_POS is what lets an offset of -1 mean “the file
+       * position”, which stream semantics need. */
+      if (fd >= 0 &&
+          (params.features & IORING_FEAT_RW_CUR_POS) &&
+          (params.features & IORING_FEAT_NODROP))
+        {
+          sq_size = params.sq_off.array + params.sq_entries * sizeof (guint);
+          cq_size = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+
+          if (params.features & IORING_FEAT_SINGLE_MMAP)
+            sq_size = cq_size = MAX (sq_size, cq_size);
+
+          sq_ptr = mmap (NULL, sq_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+          if (sq_ptr == MAP_FAILED)
+            goto out;
+
+          if (params.features & IORING_FEAT_SINGLE_MMAP)
+            cq_ptr = sq_ptr;
+          else
+            {
+              cq_ptr = mmap (NULL, cq_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+              if (cq_ptr == MAP_FAILED)
+                {
+                  munmap (sq_ptr, sq_size);
+                  goto out;
+                }
+            }
+
+          r = g_new0 (GIOUring, 1);
+          r->sqes = mmap (NULL, params.sq_entries * sizeof (struct io_uring_sqe),
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd, IORING_OFF_SQES);
+          if (r->sqes == MAP_FAILED)
+            {
+              if (cq_ptr != sq_ptr)
+                munmap (cq_ptr, cq_size);
+              munmap (sq_ptr, sq_size);
+              g_clear_pointer (&r, g_free);
+              goto out;
+            }
+
+          r->fd = fd;
+          r->pid = getpid ();
+          g_mutex_init (&r->lock);
+
+          r->sq_head = (guint *) (sq_ptr + params.sq_off.head);
+          r->sq_tail = (guint *) (sq_ptr + params.sq_off.tail);
+          r->sq_array = (guint *) (sq_ptr + params.sq_off.array);
+          r->sq_mask = *(guint *) (sq_ptr + params.sq_off.ring_mask);
+          r->sq_entries = params.sq_entries;
+
+          r->cq_head = (guint *) (cq_ptr + params.cq_off.head);
+          r->cq_tail = (guint *) (cq_ptr + params.cq_off.tail);
+          r->cq_mask = *(guint *) (cq_ptr + params.cq_off.ring_mask);
+          r->cq_entries = params.cq_entries;
+          r->cqes = (struct io_uring_cqe *) (cq_ptr + params.cq_off.cqes);
+        }
+
+out:
+      if (r != NULL)
+        g_thread_unref (g_thread_new ("gio-uring", io_uring_completion_thread, r));
+      else if (fd >= 0)
+        close (fd);
+
+      ring = r;
+      g_once_init_leave (&initialised, 1);
+    }
+
+  /* The completion thread does not survive fork(). */
+  if (ring != NULL &&
+      (ring->pid != getpid () || g_atomic_int_get (&ring->failed)))
+    return NULL;
+
+  return ring;
+}
+
+static void
+io_uring_op_unref (gpointer data)
+{
+  GIOUringOp *op = data;
+
+  if (!g_atomic_int_dec_and_test (&op->ref_count))
+    return;
+
+  g_clear_object (&op->task);
+  g_clear_object (&op->cancellable);
+  g_free (op);
+}
+
+/* HOLDS: ring->lock
+ *
+ * Returns a zeroed submission queue entry, or %NULL if the ring is full. */
+static struct io_uring_sqe *
+io_uring_get_sqe (GIOUring *ring)
+{
+  guint tail = *ring->sq_tail;
+  struct io_uring_sqe *sqe;
+
+  if (g_atomic_int_get (&ring->failed) ||
+      tail - (guint) g_atomic_int_get ((gint *) ring->sq_head) >= ring->sq_entries ||
+      ring->n_in_flight >= ring->cq_entries)
+    return NULL;
+
+  sqe = &ring->sqes[tail & ring->sq_mask];
+  memset (sqe, 0, sizeof (*sqe));
+
+  return sqe;
+}
+
+/* HOLDS: ring->lock */
+static gboolean
+io_uring_submit (GIOUring            *ring,
+                 struct io_uring_sqe *sqe)
+{
+  guint tail = *ring->sq_tail;
+  guint index = tail & ring->sq_mask;
+  int ret;
+
+  g_assert (sqe == &ring->sqes[index]);
+
+  ring->sq_array[index] = index;
+  g_atomic_int_set ((gint *) ring->sq_tail, tail + 1);
+
+  do
+    ret = syscall (__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0);
+  while (ret < 0 && errno == EINTR);
+
+  if (ret < 0)
+    {
+      /* The entry is still in the queue; take it back, since the caller
+       * is going to fall back to a thread. */
+      g_atomic_int_set ((gint *) ring->sq_tail, tail);
+      return FALSE;
+    }
+
+  ring->n_in_flight++;
+
+  return TRUE;
+}
+
+static void
+io_uring_op_cancelled (GCancellable *cancellable,
+                       gpointer      data)
+{
+  GIOUringOp *op = data;
+  GIOUring *ring = io_uring_get ();
+  struct io_uring_sqe *sqe;
+
+  if (ring == NULL)
+    return;
+
+  /* If the request already finished this fails with ENOENT, which is
+   * fine: its completion will be ignored below. */
+  g_mutex_lock (&ring->lock);
+  sqe = io_uring_get_sqe (ring);
+  if (sqe != NULL)
+    {
+      sqe->opcode = IORING_OP_ASYNC_CANCEL;
+      sqe->fd = -1;
+      sqe->addr = (guint64) (guintptr) op;
+      sqe->user_data = 0;
+      io_uring_submit (ring, sqe);
+    }
+  g_mutex_unlock (&ring->lock);
+}
+
+static void
+io_uring_op_complete (GIOUringOp *op,
+                      gint        result)
+{
+  gpointer cancelled_id;
+
+  /* Whichever of us and the submitter gets here second disconnects. */
+  cancelled_id = g_atomic_pointer_exchange (&op->cancelled_id, OP_COMPLETED);
+  if (cancelled_id != NULL && cancelled_id != OP_COMPLETED)
+    g_cancellable_disconnect (op->cancellable, GPOINTER_TO_SIZE (cancelled_id));
+
+  op->complete (op->task, result);
+  io_uring_op_unref (op);
+}
+
+static gpointer
+io_uring_completion_thread (gpointer data)
+{
+  GIOUring *ring = data;
+
+  while (TRUE)
+    {
+      guint head, tail;
+      gboolean done;
+      int ret;
+
+      ret = syscall (__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+      if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        {
+          /* We can no longer wait for completions. Send new requests to
+           * worker threads, and keep polling the completion queue until the
+           * requests already submitted have come back. */
+          if (!g_atomic_int_get (&ring->failed))
+            {
+              g_debug ("io_uring_enter() failed: %s; not using io_uring any more",
+                       g_strerror (errno));
+              g_mutex_lock (&ring->lock);
+              g_atomic_int_set (&ring->failed, TRUE);
+              g_mutex_unlock (&ring->lock);
+            }
+
+          g_usleep (G_USEC_PER_SEC / 1000);
+        }
+
+      head = *ring->cq_head;
+      tail = (guint) g_atomic_int_get ((gint *) ring->cq_tail);
+
+      while (head != tail)
+        {
+          struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+          GIOUringOp *op = (GIOUringOp *) (guintptr) cqe->user_data;
+          gint result = cqe->res;
+
+          head++;
+          g_atomic_int_set ((gint *) ring->cq_head, head);
+
+          g_mutex_lock (&ring->lock);
+          ring->n_in_flight--;
+          g_mutex_unlock (&ring->lock);
+
+          /* Cancellation requests have no op */
+          if (op != NULL)
+            io_uring_op_complete (op, result);
+        }
+
+      g_mutex_lock (&ring->lock);
+      done = g_atomic_int_get (&ring->failed) && ring->n_in_flight == 0;
+      g_mutex_unlock (&ring->lock);
+
+      if (done)
+        break;
+    }
+
+  return NULL;
+}
+
+static gboolean
+io_uring_rw (guint8                opcode,
+             int                   fd,
+             const void           *buffer,
+             gsize                 count,
+             GTask                *task,
+             GIOUringCompleteFunc  complete)
+{
+  GIOUring *ring = io_uring_get ();
+  struct io_uring_sqe *sqe;
+  GCancellable *cancellable;
+  GIOUringOp *op;
+  gulong cancelled_id;
+
+  if (ring == NULL)
+    return FALSE;
+
+  cancellable = g_task_get_cancellable (task);
+
+  op = g_new0 (GIOUringOp, 1);
+  op->ref_count = cancellable ? 2 : 1;
+  op->task = g_object_ref (task);
+  op->complete = complete;
+  op->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+
+  g_mutex_lock (&ring->lock);
+  sqe = io_uring_get_sqe (ring);
+  if (sqe != NULL)
+    {
+      sqe->opcode = opcode;
+      sqe->fd = fd;
+      sqe->addr = (guint64) (guintptr) buffer;
+      /* io_uring transfers at most 2GiB at a time anyway, like read() */
+      sqe->len = (guint) MIN (count, G_MAXINT32);
+      sqe->off = (guint64) -1;
+      sqe->user_data = (guint64) (guintptr) op;
+
+      if (!io_uring_submit (ring, sqe))
+        sqe = NULL;
+    }
+  g_mutex_unlock (&ring->lock);
+
+  if (sqe == NULL)
+    {
+      op->ref_count = 1;
+      io_uring_op_unref (op);
+      return FALSE;
+    }
+
+  if (cancellable != NULL)
+    {
+      /* This may invoke io_uring_op_cancelled() right away, which is why
+       * the request has to be submitted first. If it does, the handler is
+       * not kept around and the ID is 0. */
+      cancelled_id = g_cancellable_connect (cancellable,
+                                            G_CALLBACK (io_uring_op_cancelled),
+                                            op, io_uring_op_unref);
+
+      /* If the request completed in the meantime, the completion thread
+       * left disconnecting to us. */
+      if (cancelled_id != 0 &&
+          !g_atomic_pointer_compare_and_exchange (&op->cancelled_id, NULL,
+                                                  GSIZE_TO_POINTER (cancelled_id)))
+        g_cancellable_disconnect (cancellable, cancelled_id);
+    }
+
+  return TRUE;
+}
+
+gboolean
+_g_io_uring_is_available (void)
+{
+  return io_uring_get () != NULL;
+}
+
+gboolean
+_g_io_uring_read (int                   fd,
+                  void                 *buffer,
+                  gsize                 count,
+                  GTask                *task,
+                  GIOUringCompleteFunc  complete)
+{
+  return io_uring_rw (IORING_OP_READ, fd, buffer, count, task, complete);
+}
+
+gboolean
+_g_io_uring_write (int                   fd,
+                   const void           *buffer,
+                   gsize                 count,
+                   GTask                *task,
+                   GIOUringCompleteFunc  complete)
+{
+  return io_uring_rw (IORING_OP_WRITE, fd, buffer, count, task, complete);
+}
+
+#else /* !HAVE_LINUX_IO_URING_H */
+
+gboolean
+_g_io_uring_is_available (void)
+{
+  return FALSE;
+}
+
+gboolean
+_g_io_uring_read (int                   fd,
+                  void                 *buffer,
+                  gsize                 count,
+                  GTask                *task,
+                  GIOUringCompleteFunc  complete)
+{
+  return FALSE;
+}
+
+gboolean
+_g_io_uring_write (int                   fd,
+                   const void           *buffer,
+                   gsize                 count,
+                   GTask                *task,
+                   GIOUringCompleteFunc  complete)
+{
+  return FALSE;
+}
+
+#endif /* HAVE_LINUX_IO_URING_H */
@@ -0,0 +1,44 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gio.h"
+
+G_BEGIN_DECLS
+
+/* Called from the io_uring completion thread with the number of bytes
+ * transferred, or a negated errno value. */
+typedef void (* GIOUringCompleteFunc) (GTask *task,
+                                       gint   result);
+
+gboolean _g_io_uring_is_available (void);
+gboolean _g_io_uring_read         (int                   fd,
+                                   void                 *buffer,
+                                   gsize                 count,
+                                   GTask                *task,
+                                   GIOUringCompleteFunc  complete);
+gboolean _g_io_uring_write        (int                   fd,
+                                   const void           *buffer,
+                                   gsize                 count,
+                                   GTask                *task,
+                                   GIOUringCompleteFunc  complete);
+
+G_END_DECLS
@@ -39,6 +39,7 @@
 #include <unistd.h>
 #include "glib-unix.h"
 #include "gfiledescriptorbased.h"
+#include "giouring-private.h"
 #endif
 
 #ifdef G_OS_WIN32
@@ -73,6 +74,27 @@ static gssize     g_local_file_input_stream_read       (GInputStream      *strea
 static gboolean   g_local_file_input_stream_close      (GInputStream      *stream,
 							GCancellable      *cancellable,
 							GError           **error);
+#ifdef G_OS_UNIX
+static void       g_local_file_input_stream_read_async (GInputStream        *stream,
+							void                *buffer,
+							gsize                count,
+							int                  io_priority,
+							GCancellable        *cancellable,
+							GAsyncReadyCallback  callback,
+							gpointer             user_data);
+static gssize     g_local_file_input_stream_read_finish (GInputStream  *stream,
+							 GAsyncResult  *result,
+							 GError       **error);
+static void       g_local_file_input_stream_skip_async (GInputStream        *stream,
+							gsize                count,
+							int                  io_priority,
+							GCancellable        *cancellable,
+							GAsyncReadyCallback  callback,
+							gpointer             user_data);
+static gssize     g_local_file_input_stream_skip_finish (GInputStream  *stream,
+							 GAsyncResult  *result,
+							 GError       **error);
+#endif
 static goffset    g_local_file_input_stream_tell       (GFileInputStream  *stream);
 static gboolean   g_local_file_input_stream_can_seek   (GFileInputStream  *stream);
 static gboolean   g_local_file_input_stream_seek       (GFileInputStream  *stream,
@@ -103,6 +125,12 @@ g_local_file_input_stream_class_init (GLocalFileInputStreamClass *klass)
 
   stream_class->read_fn = g_local_file_input_stream_read;
   stream_class->close_fn = g_local_file_input_stream_close;
+#ifdef G_OS_UNIX
+  stream_class->read_async = g_local_file_input_stream_read_async;
+  stream_class->read_finish = g_local_file_input_stream_read_finish;
+  stream_class->skip_async = g_local_file_input_stream_skip_async;
+  stream_class->skip_finish = g_local_file_input_stream_skip_finish;
+#endif
   file_stream_class->tell = g_local_file_input_stream_tell;
   file_stream_class->can_seek = g_local_file_input_stream_can_seek;
   file_stream_class->seek = g_local_file_input_stream_seek;
@@ -172,6 +200,178 @@ g_local_file_input_stream_read (GInputStream  *stream,
   return res;
 }
 
+#ifdef G_OS_UNIX
+typedef struct {
+  void *buffer;
+  gsize count;
+} ReadData;
+
+static void
+read_async_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  ReadData *data = task_data;
+  GError *error = NULL;
+  gssize nread;
+
+  nread = g_local_file_input_stream_read (source_object, data->buffer, data->count,
+                                          cancellable, &error);
+  if (nread == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, nread);
+}
+
+/* Runs in the io_uring completion thread */
+static void
+read_async_complete (GTask *task,
+                     gint   result)
+{
+  GLocalFileInputStream *file = g_task_get_source_object (task);
+  ReadData *data = g_task_get_task_data (task);
+
+  if (result >= 0)
+    g_task_return_int (task, result);
+  else if (g_task_return_error_if_cancelled (task))
+    ;
+  else if (result == -EINTR || result == -EAGAIN)
+    {
+      if (!_g_io_uring_read (file->priv->fd, data->buffer, data->count,
+                             task, read_async_complete))
+        g_task_run_in_thread (task, read_async_thread);
+    }
+  else
+    g_task_return_new_error (task, G_IO_ERROR,
+                             g_io_error_from_errno (-result),
+                             _("Error reading from file: %s"),
+                             g_strerror (-result));
+}
+
+/* Reads go straight to the kernel through io_uring where possible, rather
+ * than occupying a GTask worker thread each.
+ */
+static void
+g_local_file_input_stream_read_async (GInputStream        *stream,
+                                      void                *buffer,
+                                      gsize                count,
+                                      int                  io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  GLocalFileInputStream *file = G_LOCAL_FILE_INPUT_STREAM (stream);
+  ReadData *data;
+  GTask *task;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_input_stream_read_async);
+  g_task_set_priority (task, io_priority);
+
+  data = g_new (ReadData, 1);
+  data->buffer = buffer;
+  data->count = count;
+  g_task_set_task_data (task, data, g_free);
+
+  if (g_task_return_error_if_cancelled (task))
+    ;
+  else if (!_g_io_uring_read (file->priv->fd, buffer, count, task, read_async_complete))
+    g_task_run_in_thread (task, read_async_thread);
+
+  g_object_unref (task);
+}
+
+static gssize
+g_local_file_input_stream_read_finish (GInputStream  *stream,
+                                       GAsyncResult  *result,
+                                       GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+  g_return_val_if_fail (g_async_result_is_tagged (result, g_local_file_input_stream_read_async), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+
+static void
+skip_async_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  GLocalFileInputStream *file = source_object;
+  gsize count = GPOINTER_TO_SIZE (task_data);
+  off_t start, end;
+  int errsv;
+
+  start = lseek (file->priv->fd, 0, SEEK_CUR);
+  end = start != (off_t)-1 ? lseek (file->priv->fd, 0, SEEK_END) : (off_t)-1;
+
+  if (end != (off_t)-1)
+    {
+      if (end < start)
+        end = start;
+      if (count > (gsize) (end - start))
+        count = end - start;
+
+      if (lseek (file->priv->fd, start + count, SEEK_SET) != (off_t)-1)
+        {
+          g_task_return_int (task, count);
+          return;
+        }
+    }
+
+  errsv = errno;
+  g_task_return_new_error (task, G_IO_ERROR,
+                           g_io_error_from_errno (errsv),
+                           _("Error seeking in file: %s"),
+                           g_strerror (errsv));
+}
+
+/* Since read_async is implemented natively, the default skip_async would
+ * read and throw away the data; seek instead where the file allows it.
+ */
+static void
+g_local_file_input_stream_skip_async (GInputStream        *stream,
+                                      gsize                count,
+                                      int                  io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  GTask *task;
+
+  if (!g_local_file_input_stream_can_seek (G_FILE_INPUT_STREAM (stream)))
+    {
+      G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->
+        skip_async (stream, count, io_priority, cancellable, callback, user_data);
+      return;
+    }
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_input_stream_skip_async);
+  g_task_set_priority (task, io_priority);
+  g_task_set_task_data (task, GSIZE_TO_POINTER (count), NULL);
+  g_task_run_in_thread (task, skip_async_thread);
+  g_object_unref (task);
+}
+
+static gssize
+g_local_file_input_stream_skip_finish (GInputStream  *stream,
+                                       GAsyncResult  *result,
+                                       GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+
+  /* The parent class handles non-seekable files */
+  if (!g_async_result_is_tagged (result, g_local_file_input_stream_skip_async))
+    return G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->
+      skip_finish (stream, result, error);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+#endif
+
 static gboolean
 g_local_file_input_stream_close (GInputStream  *stream,
 				 GCancellable  *cancellable,
@@ -42,6 +42,11 @@
  * also handles merging of CHANGED events and emission of CHANGES_DONE
  * events.
  *
+ * If the monitor has a batch latency then, instead of all that, the
+ * source only records the kinds of changes that each child had, and
+ * emits them all together once the latency has passed since the first
+ * of them.
+ *
  * We use the "priv" pointer in the external struct to store it.
  */
 struct _GFileMonitorSource {
@@ -57,6 +62,9 @@ struct _GFileMonitorSource {
   GHashTable   *pending_changes_table;
   GQueue        event_queue;
   gint64        rate_limit;
+  gint64        batch_latency;
+  GHashTable   *batch; /* child name -> GFileMonitorChangeFlags */
+  gint64        batch_ready_time;
 };
 
 /* PendingChange is a struct to keep track of a file that needs to have
@@ -134,19 +142,37 @@ queued_event_free (QueuedEvent *event)
   g_slice_free (QueuedEvent, event);
 }
 
+static guint
+str_hash0 (gconstpointer str)
+{
+  return str ? g_str_hash (str) : 0;
+}
+
+static gboolean
+str_equal0 (gconstpointer a,
+            gconstpointer b)
+{
+  return g_strcmp0 (a, b) == 0;
+}
+
 static gint64
 g_file_monitor_source_get_ready_time (GFileMonitorSource *fms)
 {
   GSequenceIter *iter;
+  gint64 ready_time = -1;
 
   if (fms->event_queue.length)
     return 0;
 
   iter = g_sequence_get_begin_iter (fms->pending_changes);
-  if (g_sequence_iter_is_end (iter))
-    return -1;
+  if (!g_sequence_iter_is_end (iter))
+    ready_time = pending_change_get_ready_time (g_sequence_get (iter), fms);
 
-  return pending_change_get_ready_time (g_sequence_get (iter), fms);
+  if (g_hash_table_size (fms->batch) > 0 &&
+      (ready_time < 0 || fms->batch_ready_time < ready_time))
+    ready_time = fms->batch_ready_time;
+
+  return ready_time;
 }
 
 static void
@@ -221,6 +247,35 @@ g_file_monitor_source_remove_pending_change (GFileMonitorSource *fms,
   g_sequence_remove (iter);
 }
 
+static GFile *
+g_file_monitor_source_get_child (GFileMonitorSource *fms,
+                                 const gchar        *child)
+{
+  GFile *file = NULL;
+
+  /* recursive monitors report paths relative to the directory */
+  if (child != NULL && fms->dirname != NULL && strchr (child, '/') != NULL)
+    {
+      gchar *filename = g_build_filename (fms->dirname, child, NULL);
+      file = _g_local_file_new (filename);
+      g_free (filename);
+    }
+  else if (child != NULL && fms->dirname != NULL)
+    file = g_local_file_new_from_dirname_and_basename (fms->dirname, child);
+  else if (child != NULL)
+    {
+      gchar *dirname = g_path_get_dirname (fms->filename);
+      file = g_local_file_new_from_dirname_and_basename (dirname, child);
+      g_free (dirname);
+    }
+  else if (fms->dirname)
+    file = _g_local_file_new (fms->dirname);
+  else if (fms->filename)
+    file = _g_local_file_new (fms->filename);
+
+  return file;
+}
+
 static void
 g_file_monitor_source_queue_event (GFileMonitorSource *fms,
                                    GFileMonitorEvent   event_type,
@@ -231,18 +286,7 @@ g_file_monitor_source_queue_event (GFileMonitorSource *fms,
 
   event = g_slice_new (QueuedEvent);
   event->event_type = event_type;
-  if (child != NULL && fms->dirname != NULL)
-    event->child = g_local_file_new_from_dirname_and_basename (fms->dirname, child);
-  else if (child != NULL)
-    {
-      gchar *dirname = g_path_get_dirname (fms->filename);
-      event->child = g_local_file_new_from_dirname_and_basename (dirname, child);
-      g_free (dirname);
-    }
-  else if (fms->dirname)
-    event->child = _g_local_file_new (fms->dirname);
-  else if (fms->filename)
-    event->child = _g_local_file_new (fms->filename);
+  event->child = g_file_monitor_source_get_child (fms, child);
   event->other = other;
   if (other)
     g_object_ref (other);
@@ -330,6 +374,79 @@ g_file_monitor_source_send_synthetic_created (GFileMonitorSource *fms,
   g_file_monitor_source_queue_event (fms, G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT, child, NULL);
 }
 
+/* Records that @child had @change in the current batch, starting the
+ * batch if it is the first change.  Returns %TRUE if this is news.
+ */
+static gboolean
+g_file_monitor_source_batch_change (GFileMonitorSource      *fms,
+                                    const gchar             *child,
+                                    GFileMonitorChangeFlags  change,
+                                    gint64                   event_time)
+{
+  GFileMonitorChangeFlags changes;
+  gpointer value;
+
+  if (g_hash_table_size (fms->batch) == 0)
+    fms->batch_ready_time = event_time + fms->batch_latency;
+
+  if (g_hash_table_lookup_extended (fms->batch, child, NULL, &value))
+    {
+      changes = GPOINTER_TO_UINT (value);
+
+      if ((changes & change) == change)
+        return FALSE;
+
+      g_hash_table_insert (fms->batch, g_strdup (child), GUINT_TO_POINTER (changes | change));
+    }
+  else
+    g_hash_table_insert (fms->batch, g_strdup (child), GUINT_TO_POINTER (change));
+
+  return TRUE;
+}
+
+static gboolean
+g_file_monitor_source_batch_event (GFileMonitorSource *fms,
+                                   GFileMonitorEvent   event_type,
+                                   const gchar        *child,
+                                   const gchar        *rename_to,
+                                   gint64              event_time)
+{
+  switch (event_type)
+    {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+      return g_file_monitor_source_batch_change (fms, child, G_FILE_MONITOR_CHANGE_CREATED, event_time);
+
+    case G_FILE_MONITOR_EVENT_CHANGED:
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+      return g_file_monitor_source_batch_change (fms, child, G_FILE_MONITOR_CHANGE_CONTENTS, event_time);
+
+    case G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED:
+      return g_file_monitor_source_batch_change (fms, child, G_FILE_MONITOR_CHANGE_ATTRIBUTES, event_time);
+
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+      return g_file_monitor_source_batch_change (fms, child, G_FILE_MONITOR_CHANGE_DELETED, event_time);
+
+    case G_FILE_MONITOR_EVENT_RENAMED:
+      /* Only report the names that belong to the monitored file */
+      if (!fms->basename || g_str_equal (child, fms->basename))
+        g_file_monitor_source_batch_change (fms, child, G_FILE_MONITOR_CHANGE_DELETED, event_time);
+      if (!fms->basename || g_str_equal (rename_to, fms->basename))
+        g_file_monitor_source_batch_change (fms, rename_to, G_FILE_MONITOR_CHANGE_CREATED, event_time);
+      return TRUE;
+
+    case G_FILE_MONITOR_EVENT_PRE_UNMOUNT:
+    case G_FILE_MONITOR_EVENT_UNMOUNTED:
+      return g_file_monitor_source_batch_change (fms, child, G_FILE_MONITOR_CHANGE_UNMOUNTED, event_time);
+
+    case G_FILE_MONITOR_EVENT_MOVED:
+      /* was never available in this API */
+    default:
+      g_assert_not_reached ();
+    }
+}
+
 #ifndef G_DISABLE_ASSERT
 static gboolean
 is_basename (const gchar *name)
@@ -351,8 +468,8 @@ g_file_monitor_source_handle_event (GFileMonitorSource *fms,
 {
   gboolean interesting = TRUE;
 
-  g_assert (!child || is_basename (child));
-  g_assert (!rename_to || is_basename (rename_to));
+  g_assert (!child || is_basename (child) || (fms->flags & G_FILE_MONITOR_WATCH_RECURSIVE));
+  g_assert (!rename_to || is_basename (rename_to) || (fms->flags & G_FILE_MONITOR_WATCH_RECURSIVE));
 
   if (fms->basename && (!child || !g_str_equal (child, fms->basename))
                     && (!rename_to || !g_str_equal (rename_to, fms->basename)))
@@ -383,6 +500,15 @@ g_file_monitor_source_handle_event (GFileMonitorSource *fms,
       return TRUE;
     }
 
+  if (fms->batch_latency > 0)
+    {
+      interesting = g_file_monitor_source_batch_event (fms, event_type, child, rename_to, event_time);
+      g_file_monitor_source_update_ready_time (fms);
+      g_mutex_unlock (&fms->lock);
+
+      return interesting;
+    }
+
   switch (event_type)
     {
     case G_FILE_MONITOR_EVENT_CREATED:
@@ -423,26 +549,15 @@ g_file_monitor_source_handle_event (GFileMonitorSource *fms,
       if (fms->flags & (G_FILE_MONITOR_WATCH_MOVES | G_FILE_MONITOR_SEND_MOVED))
         {
           GFile *other_file;
-          const gchar *dirname;
-          gchar *allocated_dirname = NULL;
           GFileMonitorEvent event;
 
           event = (fms->flags & G_FILE_MONITOR_WATCH_MOVES) ? G_FILE_MONITOR_EVENT_RENAMED : G_FILE_MONITOR_EVENT_MOVED;
 
-          if (fms->dirname != NULL)
-            dirname = fms->dirname;
-          else
-            {
-              allocated_dirname = g_path_get_dirname (fms->filename);
-              dirname = allocated_dirname;
-            }
-
-          other_file = g_local_file_new_from_dirname_and_basename (dirname, rename_to);
+          other_file = g_file_monitor_source_get_child (fms, rename_to);
           g_file_monitor_source_file_changes_done (fms, rename_to);
           g_file_monitor_source_send_event (fms, event, child, other_file);
 
           g_object_unref (other_file);
-          g_free (allocated_dirname);
         }
       else
         {
@@ -509,6 +624,69 @@ g_file_monitor_source_set_rate_limit (GFileMonitorSource *fms,
   return changed;
 }
 
+static gint64
+g_file_monitor_source_get_batch_latency (GFileMonitorSource *fms)
+{
+  gint64 batch_latency;
+
+  g_mutex_lock (&fms->lock);
+  batch_latency = fms->batch_latency;
+  g_mutex_unlock (&fms->lock);
+
+  return batch_latency;
+}
+
+static gboolean
+g_file_monitor_source_set_batch_latency (GFileMonitorSource *fms,
+                                         gint64              batch_latency)
+{
+  gboolean changed;
+
+  g_mutex_lock (&fms->lock);
+
+  if (batch_latency != fms->batch_latency)
+    {
+      fms->batch_latency = batch_latency;
+
+      /* A batch that was already started is still emitted when it is
+       * due, even if batching is now turned off.
+       */
+      changed = TRUE;
+    }
+  else
+    changed = FALSE;
+
+  g_mutex_unlock (&fms->lock);
+
+  return changed;
+}
+
+static void
+g_file_monitor_source_emit_batch (GFileMonitorSource *fms,
+                                  GHashTable         *batch)
+{
+  GFileMonitor *instance;
+  GHashTable *changes;
+  GHashTableIter iter;
+  gpointer child, value;
+
+  instance = g_weak_ref_get (&fms->instance_ref);
+  if (instance == NULL)
+    return;
+
+  changes = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal, g_object_unref, NULL);
+
+  g_hash_table_iter_init (&iter, batch);
+  while (g_hash_table_iter_next (&iter, &child, &value))
+    g_hash_table_insert (changes, g_file_monitor_source_get_child (fms, child), value);
+
+  if (!g_file_monitor_is_cancelled (instance))
+    g_signal_emit_by_name (instance, "changed-batch", changes);
+
+  g_hash_table_unref (changes);
+  g_object_unref (instance);
+}
+
 static gboolean
 g_file_monitor_source_dispatch (GSource     *source,
                                 GSourceFunc  callback,
@@ -517,6 +695,7 @@ g_file_monitor_source_dispatch (GSource     *source,
   GFileMonitorSource *fms = (GFileMonitorSource *) source;
   QueuedEvent *event;
   GQueue event_queue;
+  GHashTable *batch = NULL;
   gint64 now;
   GFileMonitor *instance = NULL;
 
@@ -568,6 +747,13 @@ g_file_monitor_source_dispatch (GSource     *source,
   memcpy (&event_queue, &fms->event_queue, sizeof event_queue);
   memset (&fms->event_queue, 0, sizeof fms->event_queue);
 
+  /* And the batch, if it is complete */
+  if (g_hash_table_size (fms->batch) > 0 && fms->batch_ready_time <= now)
+    {
+      batch = fms->batch;
+      fms->batch = g_hash_table_new_full (str_hash0, str_equal0, g_free, NULL);
+    }
+
   g_file_monitor_source_update_ready_time (fms);
 
   g_mutex_unlock (&fms->lock);
@@ -585,6 +771,12 @@ g_file_monitor_source_dispatch (GSource     *source,
       queued_event_free (event);
     }
 
+  if (batch != NULL)
+    {
+      g_file_monitor_source_emit_batch (fms, batch);
+      g_hash_table_unref (batch);
+    }
+
   return TRUE;
 }
 
@@ -607,6 +799,8 @@ g_file_monitor_source_dispose (GFileMonitorSource *fms)
   while ((event = g_queue_pop_head (&fms->event_queue)))
     queued_event_free (event);
 
+  g_hash_table_remove_all (fms->batch);
+
   g_assert (g_sequence_is_empty (fms->pending_changes));
   g_assert (g_hash_table_size (fms->pending_changes_table) == 0);
   g_assert (fms->event_queue.length == 0);
@@ -634,6 +828,7 @@ g_file_monitor_source_finalize (GSource *source)
 
   g_hash_table_unref (fms->pending_changes_table);
   g_sequence_free (fms->pending_changes);
+  g_hash_table_unref (fms->batch);
 
   g_free (fms->dirname);
   g_free (fms->basename);
@@ -642,19 +837,6 @@ g_file_monitor_source_finalize (GSource *source)
   g_mutex_clear (&fms->lock);
 }
 
-static guint
-str_hash0 (gconstpointer str)
-{
-  return str ? g_str_hash (str) : 0;
-}
-
-static gboolean
-str_equal0 (gconstpointer a,
-            gconstpointer b)
-{
-  return g_strcmp0 (a, b) == 0;
-}
-
 static GFileMonitorSource *
 g_file_monitor_source_new (gpointer           instance,
                            const gchar       *filename,
@@ -680,6 +862,7 @@ g_file_monitor_source_new (gpointer           instance,
   fms->pending_changes = g_sequence_new (pending_change_free);
   fms->pending_changes_table = g_hash_table_new (str_hash0, str_equal0);
   fms->rate_limit = DEFAULT_RATE_LIMIT;
+  fms->batch = g_hash_table_new_full (str_hash0, str_equal0, g_free, NULL);
   fms->flags = flags;
 
   if (is_directory)
@@ -709,6 +892,7 @@ G_DEFINE_ABSTRACT_TYPE (GLocalFileMonitor, g_local_file_monitor, G_TYPE_FILE_MON
 enum {
   PROP_0,
   PROP_RATE_LIMIT,
+  PROP_BATCH_LATENCY,
 };
 
 static void
@@ -716,14 +900,27 @@ g_local_file_monitor_get_property (GObject *object, guint prop_id,
                                    GValue *value, GParamSpec *pspec)
 {
   GLocalFileMonitor *monitor = G_LOCAL_FILE_MONITOR (object);
-  gint64 rate_limit;
+  gint64 rate_limit, batch_latency;
 
-  g_assert (prop_id == PROP_RATE_LIMIT);
+  switch (prop_id)
+    {
+    case PROP_RATE_LIMIT:
+      rate_limit = g_file_monitor_source_get_rate_limit (monitor->source);
+      rate_limit /= G_TIME_SPAN_MILLISECOND;
+
+      g_value_set_int (value, rate_limit);
+      break;
 
-  rate_limit = g_file_monitor_source_get_rate_limit (monitor->source);
-  rate_limit /= G_TIME_SPAN_MILLISECOND;
+    case PROP_BATCH_LATENCY:
+      batch_latency = g_file_monitor_source_get_batch_latency (monitor->source);
+      batch_latency /= G_TIME_SPAN_MILLISECOND;
 
-  g_value_set_int (value, rate_limit);
+      g_value_set_int (value, batch_latency);
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
 }
 
 static void
@@ -731,15 +928,29 @@ g_local_file_monitor_set_property (GObject *object, guint prop_id,
                                    const GValue *value, GParamSpec *pspec)
 {
   GLocalFileMonitor *monitor = G_LOCAL_FILE_MONITOR (object);
-  gint64 rate_limit;
+  gint64 rate_limit, batch_latency;
+
+  switch (prop_id)
+    {
+    case PROP_RATE_LIMIT:
+      rate_limit = g_value_get_int (value);
+      rate_limit *= G_TIME_SPAN_MILLISECOND;
 
-  g_assert (prop_id == PROP_RATE_LIMIT);
+      if (g_file_monitor_source_set_rate_limit (monitor->source, rate_limit))
+        g_object_notify (object, "rate-limit");
+      break;
+
+    case PROP_BATCH_LATENCY:
+      batch_latency = g_value_get_int (value);
+      batch_latency *= G_TIME_SPAN_MILLISECOND;
 
-  rate_limit = g_value_get_int (value);
-  rate_limit *= G_TIME_SPAN_MILLISECOND;
+      if (g_file_monitor_source_set_batch_latency (monitor->source, batch_latency))
+        g_object_notify (object, "batch-latency");
+      break;
 
-  if (g_file_monitor_source_set_rate_limit (monitor->source, rate_limit))
-    g_object_notify (object, "rate-limit");
+    default:
+      g_assert_not_reached ();
+    }
 }
 
 #ifndef G_OS_WIN32
@@ -773,22 +984,24 @@ g_local_file_monitor_mounts_changed (GUnixMountMonitor *mount_monitor,
 }
 #endif
 
-static void
-g_local_file_monitor_start (GLocalFileMonitor *local_monitor,
-                            const gchar       *filename,
-                            gboolean           is_directory,
-                            GFileMonitorFlags  flags,
-                            GMainContext      *context)
+static gboolean
+g_local_file_monitor_start (GLocalFileMonitor  *local_monitor,
+                            const gchar        *filename,
+                            gboolean            is_directory,
+                            GFileMonitorFlags   flags,
+                            GMainContext       *context,
+                            GError            **error)
 {
   GLocalFileMonitorClass *class = G_LOCAL_FILE_MONITOR_GET_CLASS (local_monitor);
   GFileMonitorSource *source;
 
-  g_return_if_fail (G_IS_LOCAL_FILE_MONITOR (local_monitor));
+  g_return_val_if_fail (G_IS_LOCAL_FILE_MONITOR (local_monitor), FALSE);
 
   g_assert (!local_monitor->source);
 
   source = g_file_monitor_source_new (local_monitor, filename, is_directory, flags);
   local_monitor->source = source; /* owns the ref */
+  local_monitor->flags = flags;
 
   if (is_directory && !class->mount_notify && (flags & G_FILE_MONITOR_WATCH_MOUNTS))
     {
@@ -816,9 +1029,14 @@ g_local_file_monitor_start (GLocalFileMonitor *local_monitor,
 
   g_source_attach ((GSource *) source, context);
 
-  G_LOCAL_FILE_MONITOR_GET_CLASS (local_monitor)->start (local_monitor,
-                                                         source->dirname, source->basename, source->filename,
-                                                         source);
+  if (is_directory && (flags & G_FILE_MONITOR_WATCH_RECURSIVE))
+    return class->start_recursive (local_monitor, source->dirname, source, error);
+
+  class->start (local_monitor,
+                source->dirname, source->basename, source->filename,
+                source);
+
+  return TRUE;
 }
 
 static void
@@ -856,12 +1074,14 @@ static void g_local_file_monitor_class_init (GLocalFileMonitorClass *class)
   gobject_class->finalize = g_local_file_monitor_finalize;
 
   g_object_class_override_property (gobject_class, PROP_RATE_LIMIT, "rate-limit");
+  g_object_class_override_property (gobject_class, PROP_BATCH_LATENCY, "batch-latency");
 }
 
 static GLocalFileMonitor *
-g_local_file_monitor_new (gboolean   is_remote_fs,
-                          gboolean   is_directory,
-                          GError   **error)
+g_local_file_monitor_new (gboolean            is_remote_fs,
+                          gboolean            is_directory,
+                          GFileMonitorFlags   flags,
+                          GError            **error)
 {
   GType type = G_TYPE_INVALID;
 
@@ -883,6 +1103,21 @@ g_local_file_monitor_new (gboolean   is_remote_fs,
       return NULL;
     }
 
+  if (is_directory && (flags & G_FILE_MONITOR_WATCH_RECURSIVE))
+    {
+      GLocalFileMonitorClass *class = g_type_class_ref (type);
+      gboolean supports_recursive = class->start_recursive != NULL;
+
+      g_type_class_unref (class);
+
+      if (!supports_recursive)
+        {
+          g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               _("Recursive file monitoring is not supported"));
+          return NULL;
+        }
+    }
+
   return g_object_new (type, NULL);
 }
 
@@ -897,10 +1132,11 @@ g_local_file_monitor_new_for_path (const gchar        *pathname,
 
   is_remote_fs = g_local_file_is_nfs_home (pathname);
 
-  monitor = g_local_file_monitor_new (is_remote_fs, is_directory, error);
+  monitor = g_local_file_monitor_new (is_remote_fs, is_directory, flags, error);
 
-  if (monitor)
-    g_local_file_monitor_start (monitor, pathname, is_directory, flags, g_main_context_get_thread_default ());
+  if (monitor &&
+      !g_local_file_monitor_start (monitor, pathname, is_directory, flags, g_main_context_get_thread_default (), error))
+    g_clear_object (&monitor);
 
   return G_FILE_MONITOR (monitor);
 }
@@ -919,7 +1155,7 @@ g_local_file_monitor_new_in_worker (const gchar           *pathname,
 
   is_remote_fs = g_local_file_is_nfs_home (pathname);
 
-  monitor = g_local_file_monitor_new (is_remote_fs, is_directory, error);
+  monitor = g_local_file_monitor_new (is_remote_fs, is_directory, flags, error);
 
   if (monitor)
     {
@@ -927,7 +1163,8 @@ g_local_file_monitor_new_in_worker (const gchar           *pathname,
         g_signal_connect_data (monitor, "changed", G_CALLBACK (callback),
                                user_data, destroy_user_data, G_CONNECT_DEFAULT);
 
-      g_local_file_monitor_start (monitor, pathname, is_directory, flags, GLIB_PRIVATE_CALL(g_get_worker_context) ());
+      if (!g_local_file_monitor_start (monitor, pathname, is_directory, flags, GLIB_PRIVATE_CALL(g_get_worker_context) (), error))
+        g_clear_object (&monitor);
     }
 
   return G_FILE_MONITOR (monitor);
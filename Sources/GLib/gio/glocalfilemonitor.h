@@ -49,6 +49,7 @@ struct _GLocalFileMonitor
   GFileMonitorSource *source;
   GUnixMountMonitor  *mount_monitor;
   gboolean            was_mounted;
+  GFileMonitorFlags   flags;
 };
 
 struct _GLocalFileMonitorClass
@@ -63,6 +64,12 @@ struct _GLocalFileMonitorClass
                              GFileMonitorSource *source);
 
   gboolean mount_notify;
+
+  /* %G_FILE_MONITOR_WATCH_RECURSIVE; %NULL if not supported */
+  gboolean (* start_recursive) (GLocalFileMonitor   *local_monitor,
+                                const gchar         *dirname,
+                                GFileMonitorSource  *source,
+                                GError             **error);
 };
 
 #ifdef G_OS_UNIX
@@ -45,6 +45,7 @@
 #ifdef G_OS_UNIX
 #include <unistd.h>
 #include "gfiledescriptorbased.h"
+#include "giouring-private.h"
 #include <sys/uio.h>
 #endif
 
@@ -115,6 +116,16 @@ static gboolean   g_local_file_output_stream_writev       (GOutputStream       *
 							   gsize               *bytes_written,
 							   GCancellable        *cancellable,
 							   GError             **error);
+static void       g_local_file_output_stream_write_async  (GOutputStream       *stream,
+							   const void          *buffer,
+							   gsize                count,
+							   int                  io_priority,
+							   GCancellable        *cancellable,
+							   GAsyncReadyCallback  callback,
+							   gpointer             user_data);
+static gssize     g_local_file_output_stream_write_finish (GOutputStream       *stream,
+							   GAsyncResult        *result,
+							   GError             **error);
 #endif
 static gboolean   g_local_file_output_stream_close        (GOutputStream      *stream,
 							   GCancellable       *cancellable,
@@ -167,6 +178,8 @@ g_local_file_output_stream_class_init (GLocalFileOutputStreamClass *klass)
   stream_class->write_fn = g_local_file_output_stream_write;
 #ifdef G_OS_UNIX
   stream_class->writev_fn = g_local_file_output_stream_writev;
+  stream_class->write_async = g_local_file_output_stream_write_async;
+  stream_class->write_finish = g_local_file_output_stream_write_finish;
 #endif
   stream_class->close_fn = g_local_file_output_stream_close;
   file_stream_class->query_info = g_local_file_output_stream_query_info;
@@ -229,6 +242,98 @@ g_local_file_output_stream_write (GOutputStream  *stream,
   return res;
 }
 
+#ifdef G_OS_UNIX
+typedef struct {
+  const void *buffer;
+  gsize count;
+} WriteData;
+
+static void
+write_async_thread (GTask        *task,
+                    gpointer      source_object,
+                    gpointer      task_data,
+                    GCancellable *cancellable)
+{
+  WriteData *data = task_data;
+  GError *error = NULL;
+  gssize nwritten;
+
+  nwritten = g_local_file_output_stream_write (source_object, data->buffer, data->count,
+                                               cancellable, &error);
+  if (nwritten == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, nwritten);
+}
+
+/* Runs in the io_uring completion thread */
+static void
+write_async_complete (GTask *task,
+                      gint   result)
+{
+  GLocalFileOutputStream *file = g_task_get_source_object (task);
+  WriteData *data = g_task_get_task_data (task);
+
+  if (result >= 0)
+    g_task_return_int (task, result);
+  else if (g_task_return_error_if_cancelled (task))
+    ;
+  else if (result == -EINTR || result == -EAGAIN)
+    {
+      if (!_g_io_uring_write (file->priv->fd, data->buffer, data->count,
+                              task, write_async_complete))
+        g_task_run_in_thread (task, write_async_thread);
+    }
+  else
+    g_task_return_new_error (task, G_IO_ERROR,
+                             g_io_error_from_errno (-result),
+                             _("Error writing to file: %s"),
+                             g_strerror (-result));
+}
+
+/* See g_local_file_input_stream_read_async() */
+static void
+g_local_file_output_stream_write_async (GOutputStream       *stream,
+                                        const void          *buffer,
+                                        gsize                count,
+                                        int                  io_priority,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  GLocalFileOutputStream *file = G_LOCAL_FILE_OUTPUT_STREAM (stream);
+  WriteData *data;
+  GTask *task;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_output_stream_write_async);
+  g_task_set_priority (task, io_priority);
+
+  data = g_new (WriteData, 1);
+  data->buffer = buffer;
+  data->count = count;
+  g_task_set_task_data (task, data, g_free);
+
+  if (g_task_return_error_if_cancelled (task))
+    ;
+  else if (!_g_io_uring_write (file->priv->fd, buffer, count, task, write_async_complete))
+    g_task_run_in_thread (task, write_async_thread);
+
+  g_object_unref (task);
+}
+
+static gssize
+g_local_file_output_stream_write_finish (GOutputStream  *stream,
+                                         GAsyncResult   *result,
+                                         GError        **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+  g_return_val_if_fail (g_async_result_is_tagged (result, g_local_file_output_stream_write_async), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+#endif
+
 /* On Windows there is no equivalent API for files. The closest API to that is
  * WriteFileGather() but it is useless in general: it requires, among other
  * things, that each chunk is the size of a whole page and in memory aligned
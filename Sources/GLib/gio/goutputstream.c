@@ -31,6 +31,13 @@
 #include "gioprivate.h"
 #include "glibintl.h"
 #include "gpollableoutputstream.h"
+#include "gsocketoutputstream.h"
+
+#ifdef G_OS_UNIX
+#include <errno.h>
+#include "gfiledescriptorbased.h"
+#include "giounix-private.h"
+#endif
 
 /**
  * GOutputStream:
@@ -105,6 +112,16 @@ static void     g_output_stream_real_splice_async  (GOutputStream             *s
 static gssize   g_output_stream_real_splice_finish (GOutputStream             *stream,
 						    GAsyncResult              *result,
 						    GError                   **error);
+static void     real_splice_async_with_progress    (GOutputStream             *stream,
+						    GInputStream              *source,
+						    GOutputStreamSpliceFlags   flags,
+						    int                        io_priority,
+						    GCancellable              *cancellable,
+						    GFileProgressCallback      progress_callback,
+						    gpointer                   progress_callback_data,
+						    GDestroyNotify             progress_callback_data_free,
+						    GAsyncReadyCallback        callback,
+						    gpointer                   data);
 static void     g_output_stream_real_flush_async   (GOutputStream             *stream,
 						    int                        io_priority,
 						    GCancellable              *cancellable,
@@ -757,12 +774,165 @@ g_output_stream_splice (GOutputStream             *stream,
   return bytes_copied;
 }
 
+#ifdef G_OS_UNIX
+
+/* Upper bound on a single sendfile()/splice() call, so that cancellation and
+ * progress reporting stay responsive on large transfers. */
+#define SPLICE_FD_TRANSFER_CHUNK (1024 * 1024)
+
+static GFdTransferMethod
+splice_get_fd_transfer_method (GOutputStream *stream,
+                               GInputStream  *source,
+                               int           *fd_in,
+                               int           *fd_out,
+                               goffset       *remaining)
+{
+  if (!G_IS_FILE_DESCRIPTOR_BASED (source) ||
+      !G_IS_FILE_DESCRIPTOR_BASED (stream))
+    return G_FD_TRANSFER_NONE;
+
+  *fd_in = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (source));
+  *fd_out = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (stream));
+
+  return _g_fd_get_transfer_method (*fd_in, *fd_out, remaining);
+}
+
+static gboolean
+splice_wait_writable (GOutputStream  *stream,
+                      int             fd,
+                      GCancellable   *cancellable,
+                      GError        **error)
+{
+  GPollFD poll_fds[2];
+  int nfds, res, errsv;
+
+  /* Go through the socket so that its timeout is honoured. */
+  if (G_IS_SOCKET_OUTPUT_STREAM (stream))
+    {
+      GSocket *socket = NULL;
+      gboolean ret;
+
+      g_object_get (stream, "socket", &socket, NULL);
+      ret = g_socket_condition_wait (socket, G_IO_OUT, cancellable, error);
+      g_object_unref (socket);
+
+      return ret;
+    }
+
+  poll_fds[0].fd = fd;
+  poll_fds[0].events = G_IO_OUT;
+  nfds = 1;
+  if (g_cancellable_make_pollfd (cancellable, &poll_fds[1]))
+    nfds++;
+
+  do
+    {
+      res = g_poll (poll_fds, nfds, -1);
+      errsv = errno;
+    }
+  while (res == -1 && errsv == EINTR);
+
+  if (nfds == 2)
+    g_cancellable_release_fd (cancellable);
+
+  if (res == -1)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   _("Error writing to file descriptor: %s"),
+                   g_strerror (errsv));
+      return FALSE;
+    }
+
+  return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
+/* Tries to copy @source into @stream with sendfile() or splice(). Returns
+ * %FALSE without touching either stream if that is not possible and the
+ * caller should use the read/write loop instead; otherwise @res is set to
+ * whether the copy succeeded. */
+static gboolean
+splice_via_fd_transfer (GOutputStream          *stream,
+                        GInputStream           *source,
+                        GFileProgressCallback   progress_callback,
+                        gpointer                progress_callback_data,
+                        GCancellable           *cancellable,
+                        gsize                  *bytes_copied,
+                        gboolean               *res,
+                        GError                **error)
+{
+  GFdTransferMethod method;
+  goffset total;
+  int fd_in, fd_out;
+
+  method = splice_get_fd_transfer_method (stream, source, &fd_in, &fd_out, &total);
+  if (method == G_FD_TRANSFER_NONE)
+    return FALSE;
+
+  if (!g_input_stream_set_pending (source, error))
+    {
+      *res = FALSE;
+      return TRUE;
+    }
+
+  *res = TRUE;
+  while (*res)
+    {
+      GError *my_error = NULL;
+      gssize n;
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        {
+          *res = FALSE;
+          break;
+        }
+
+      n = _g_fd_transfer (method, fd_in, fd_out,
+                          SPLICE_FD_TRANSFER_CHUNK, &my_error);
+      if (n == 0)
+        break;
+
+      if (n > 0)
+        {
+          *bytes_copied += n;
+          if (progress_callback)
+            progress_callback (*bytes_copied, total, progress_callback_data);
+          continue;
+        }
+
+      if (g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+        {
+          g_error_free (my_error);
+          *res = splice_wait_writable (stream, fd_out, cancellable, error);
+        }
+      else if (*bytes_copied == 0 &&
+               g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        {
+          g_error_free (my_error);
+          g_input_stream_clear_pending (source);
+          return FALSE;
+        }
+      else
+        {
+          g_propagate_error (error, my_error);
+          *res = FALSE;
+        }
+    }
+
+  g_input_stream_clear_pending (source);
+
+  return TRUE;
+}
+
+#endif /* G_OS_UNIX */
+
 static gssize
-g_output_stream_real_splice (GOutputStream             *stream,
-                             GInputStream              *source,
-                             GOutputStreamSpliceFlags   flags,
-                             GCancellable              *cancellable,
-                             GError                   **error)
+splice_with_progress (GOutputStream             *stream,
+                      GInputStream              *source,
+                      GOutputStreamSpliceFlags   flags,
+                      GFileProgressCallback      progress_callback,
+                      gpointer                   progress_callback_data,
+                      GCancellable              *cancellable,
+                      GError                   **error)
 {
   GOutputStreamClass *class = G_OUTPUT_STREAM_GET_CLASS (stream);
   gssize n_read, n_written;
@@ -771,6 +941,18 @@ g_output_stream_real_splice (GOutputStream             *stream,
   gboolean res;
 
   bytes_copied = 0;
+
+#ifdef G_OS_UNIX
+  if (splice_via_fd_transfer (stream, source,
+                              progress_callback, progress_callback_data,
+                              cancellable, &bytes_copied, &res, error))
+    {
+      if (bytes_copied > G_MAXSSIZE)
+        bytes_copied = G_MAXSSIZE;
+      goto notsupported;
+    }
+#endif
+
   if (class->write_fn == NULL)
     {
       g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
@@ -809,6 +991,9 @@ g_output_stream_real_splice (GOutputStream             *stream,
 
       if (bytes_copied > G_MAXSSIZE)
 	bytes_copied = G_MAXSSIZE;
+
+      if (res && progress_callback)
+        progress_callback (bytes_copied, -1, progress_callback_data);
     }
   while (res);
 
@@ -835,6 +1020,17 @@ g_output_stream_real_splice (GOutputStream             *stream,
   return -1;
 }
 
+static gssize
+g_output_stream_real_splice (GOutputStream             *stream,
+                             GInputStream              *source,
+                             GOutputStreamSpliceFlags   flags,
+                             GCancellable              *cancellable,
+                             GError                   **error)
+{
+  return splice_with_progress (stream, source, flags, NULL, NULL,
+                               cancellable, error);
+}
+
 /* Must always be called inside
  * g_output_stream_set_pending()/g_output_stream_clear_pending(). */
 static gboolean
@@ -1722,6 +1918,65 @@ async_ready_splice_callback_wrapper (GObject      *source_object,
   g_object_unref (task);
 }
 
+static void
+splice_async_internal (GOutputStream            *stream,
+                       GInputStream             *source,
+                       GOutputStreamSpliceFlags  flags,
+                       int                       io_priority,
+                       GCancellable             *cancellable,
+                       GFileProgressCallback     progress_callback,
+                       gpointer                  progress_callback_data,
+                       GDestroyNotify            progress_callback_data_free,
+                       GAsyncReadyCallback       callback,
+                       gpointer                  user_data)
+{
+  GOutputStreamClass *class;
+  GTask *task;
+  GError *error = NULL;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_output_stream_splice_async);
+  g_task_set_priority (task, io_priority);
+  g_task_set_task_data (task, g_object_ref (source), g_object_unref);
+
+  if (g_input_stream_is_closed (source))
+    {
+      g_task_return_new_error_literal (task,
+                                       G_IO_ERROR, G_IO_ERROR_CLOSED,
+                                       _("Source stream is already closed"));
+      g_object_unref (task);
+      goto out;
+    }
+  
+  if (!g_output_stream_set_pending (stream, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      goto out;
+    }
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  if (progress_callback != NULL &&
+      class->splice_async == g_output_stream_real_splice_async)
+    {
+      /* The splice owns the progress data from here on */
+      real_splice_async_with_progress (stream, source, flags, io_priority,
+                                       cancellable,
+                                       progress_callback, progress_callback_data,
+                                       progress_callback_data_free,
+                                       async_ready_splice_callback_wrapper, task);
+      return;
+    }
+
+  class->splice_async (stream, source, flags, io_priority, cancellable,
+                       async_ready_splice_callback_wrapper, task);
+
+out:
+  if (progress_callback_data_free != NULL)
+    progress_callback_data_free (progress_callback_data);
+}
+
 /**
  * g_output_stream_splice_async:
  * @stream: a #GOutputStream.
@@ -1750,38 +2005,67 @@ g_output_stream_splice_async (GOutputStream            *stream,
 			      GAsyncReadyCallback       callback,
 			      gpointer                  user_data)
 {
-  GOutputStreamClass *class;
-  GTask *task;
-  GError *error = NULL;
-
   g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
   g_return_if_fail (G_IS_INPUT_STREAM (source));
 
-  task = g_task_new (stream, cancellable, callback, user_data);
-  g_task_set_source_tag (task, g_output_stream_splice_async);
-  g_task_set_priority (task, io_priority);
-  g_task_set_task_data (task, g_object_ref (source), g_object_unref);
-
-  if (g_input_stream_is_closed (source))
-    {
-      g_task_return_new_error_literal (task,
-                                       G_IO_ERROR, G_IO_ERROR_CLOSED,
-                                       _("Source stream is already closed"));
-      g_object_unref (task);
-      return;
-    }
-  
-  if (!g_output_stream_set_pending (stream, &error))
-    {
-      g_task_return_error (task, error);
-      g_object_unref (task);
-      return;
-    }
+  splice_async_internal (stream, source, flags, io_priority, cancellable,
+                         NULL, NULL, NULL, callback, user_data);
+}
 
-  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+/**
+ * g_output_stream_splice_with_progress_async:
+ * @stream: a #GOutputStream.
+ * @source: a #GInputStream.
+ * @flags: a set of #GOutputStreamSpliceFlags.
+ * @io_priority: the io priority of the request.
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @progress_callback: (nullable) (scope notified) (closure progress_callback_data) (destroy progress_callback_data_free):
+ *   function to call with progress information, or %NULL
+ * @progress_callback_data: user data to pass to @progress_callback
+ * @progress_callback_data_free: (nullable): function to free
+ *   @progress_callback_data once @progress_callback will not be
+ *   called any more, or %NULL
+ * @callback: (scope async) (closure user_data): a #GAsyncReadyCallback
+ *   to call when the request is satisfied
+ * @user_data: the data to pass to callback function
+ *
+ * Splices a stream asynchronously, like g_output_stream_splice_async(), and
+ * reports progress as data is copied.
+ *
+ * @progress_callback is called in the thread-default main context of the
+ * thread that started the operation, with the number of bytes copied so far.
+ * The total is the number of bytes left in @source when the splice started
+ * if that is known (for example when @source reads from a regular file),
+ * and -1 otherwise.
+ *
+ * Progress is only reported when @stream uses the default splice
+ * implementation; subclasses that override #GOutputStreamClass.splice_async
+ * are spliced without progress information.
+ *
+ * When the operation is finished @callback will be called. You can then
+ * call g_output_stream_splice_finish() to get the result of the operation.
+ *
+ * Since: 2.80
+ **/
+void
+g_output_stream_splice_with_progress_async (GOutputStream            *stream,
+                                            GInputStream             *source,
+                                            GOutputStreamSpliceFlags  flags,
+                                            int                       io_priority,
+                                            GCancellable             *cancellable,
+                                            GFileProgressCallback     progress_callback,
+                                            gpointer                  progress_callback_data,
+                                            GDestroyNotify            progress_callback_data_free,
+                                            GAsyncReadyCallback       callback,
+                                            gpointer                  user_data)
+{
+  g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+  g_return_if_fail (G_IS_INPUT_STREAM (source));
 
-  class->splice_async (stream, source, flags, io_priority, cancellable,
-                       async_ready_splice_callback_wrapper, task);
+  splice_async_internal (stream, source, flags, io_priority, cancellable,
+                         progress_callback, progress_callback_data,
+                         progress_callback_data_free,
+                         callback, user_data);
 }
 
 /**
@@ -2660,11 +2944,16 @@ typedef struct {
   gsize bytes_copied;
   GError *error;
   guint8 *buffer;
+  GFileProgressCallback progress_cb;
+  gpointer progress_cb_data;
+  GDestroyNotify progress_cb_data_free;
 } SpliceData;
 
 static void
 free_splice_data (SpliceData *op)
 {
+  if (op->progress_cb_data_free != NULL)
+    op->progress_cb_data_free (op->progress_cb_data);
   g_clear_pointer (&op->buffer, g_free);
   g_object_unref (op->source);
   g_clear_error (&op->error);
@@ -2783,6 +3072,9 @@ real_splice_async_write_cb (GObject      *source,
   if (op->bytes_copied > G_MAXSSIZE)
     op->bytes_copied = G_MAXSSIZE;
 
+  if (op->progress_cb)
+    op->progress_cb (op->bytes_copied, -1, op->progress_cb_data);
+
   if (op->n_written < op->n_read)
     {
       class->write_async (g_task_get_source_object (task),
@@ -2828,6 +3120,52 @@ real_splice_async_read_cb (GObject      *source,
                       real_splice_async_write_cb, task);
 }
 
+typedef struct {
+  GTask *task;
+  goffset current_num_bytes;
+  goffset total_num_bytes;
+} SpliceProgressData;
+
+static void
+splice_progress_data_free (SpliceProgressData *progress)
+{
+  g_object_unref (progress->task);
+  g_free (progress);
+}
+
+static gboolean
+splice_async_progress_in_main (gpointer user_data)
+{
+  SpliceProgressData *progress = user_data;
+  SpliceData *op = g_task_get_task_data (progress->task);
+
+  op->progress_cb (progress->current_num_bytes,
+                   progress->total_num_bytes,
+                   op->progress_cb_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+splice_async_progress_callback (goffset  current_num_bytes,
+                                goffset  total_num_bytes,
+                                gpointer user_data)
+{
+  GTask *task = user_data;
+  SpliceProgressData *progress;
+
+  progress = g_new (SpliceProgressData, 1);
+  progress->task = g_object_ref (task);
+  progress->current_num_bytes = current_num_bytes;
+  progress->total_num_bytes = total_num_bytes;
+
+  g_main_context_invoke_full (g_task_get_context (task),
+                              g_task_get_priority (task),
+                              splice_async_progress_in_main,
+                              progress,
+                              (GDestroyNotify) splice_progress_data_free);
+}
+
 static void
 splice_async_thread (GTask        *task,
                      gpointer      source_object,
@@ -2841,26 +3179,51 @@ splice_async_thread (GTask        *task,
   gssize bytes_copied;
 
   class = G_OUTPUT_STREAM_GET_CLASS (stream);
-  
-  bytes_copied = class->splice (stream,
-                                op->source,
-                                op->flags,
-                                cancellable,
-                                &error);
+
+  if (class->splice == g_output_stream_real_splice)
+    bytes_copied = splice_with_progress (stream,
+                                         op->source,
+                                         op->flags,
+                                         op->progress_cb ? splice_async_progress_callback : NULL,
+                                         task,
+                                         cancellable,
+                                         &error);
+  else
+    bytes_copied = class->splice (stream,
+                                  op->source,
+                                  op->flags,
+                                  cancellable,
+                                  &error);
   if (bytes_copied == -1)
     g_task_return_error (task, error);
   else
     g_task_return_int (task, bytes_copied);
 }
 
+static gboolean
+splice_can_use_fd_transfer (GOutputStream *stream,
+                            GInputStream  *source)
+{
+#ifdef G_OS_UNIX
+  int fd_in, fd_out;
+
+  return splice_get_fd_transfer_method (stream, source, &fd_in, &fd_out, NULL) != G_FD_TRANSFER_NONE;
+#else
+  return FALSE;
+#endif
+}
+
 static void
-g_output_stream_real_splice_async (GOutputStream             *stream,
-                                   GInputStream              *source,
-                                   GOutputStreamSpliceFlags   flags,
-                                   int                        io_priority,
-                                   GCancellable              *cancellable,
-                                   GAsyncReadyCallback        callback,
-                                   gpointer                   user_data)
+real_splice_async_with_progress (GOutputStream             *stream,
+                                 GInputStream              *source,
+                                 GOutputStreamSpliceFlags   flags,
+                                 int                        io_priority,
+                                 GCancellable              *cancellable,
+                                 GFileProgressCallback      progress_callback,
+                                 gpointer                   progress_callback_data,
+                                 GDestroyNotify             progress_callback_data_free,
+                                 GAsyncReadyCallback        callback,
+                                 gpointer                   user_data)
 {
   GTask *task;
   SpliceData *op;
@@ -2870,9 +3233,15 @@ g_output_stream_real_splice_async (GOutputStream             *stream,
   g_task_set_task_data (task, op, (GDestroyNotify)free_splice_data);
   op->flags = flags;
   op->source = g_object_ref (source);
-
-  if (g_input_stream_async_read_is_via_threads (source) &&
-      g_output_stream_async_write_is_via_threads (stream))
+  op->progress_cb = progress_callback;
+  op->progress_cb_data = progress_callback_data;
+  op->progress_cb_data_free = progress_callback_data_free;
+
+  /* A kernel-side copy between file descriptors may block on disk I/O, so
+   * it always runs in a worker thread. */
+  if (splice_can_use_fd_transfer (stream, source) ||
+      (g_input_stream_async_read_is_via_threads (source) &&
+       g_output_stream_async_write_is_via_threads (stream)))
     {
       g_task_run_in_thread (task, splice_async_thread);
       g_object_unref (task);
@@ -2887,6 +3256,20 @@ g_output_stream_real_splice_async (GOutputStream             *stream,
     }
 }
 
+static void
+g_output_stream_real_splice_async (GOutputStream             *stream,
+                                   GInputStream              *source,
+                                   GOutputStreamSpliceFlags   flags,
+                                   int                        io_priority,
+                                   GCancellable              *cancellable,
+                                   GAsyncReadyCallback        callback,
+                                   gpointer                   user_data)
+{
+  real_splice_async_with_progress (stream, source, flags, io_priority,
+                                   cancellable, NULL, NULL, NULL,
+                                   callback, user_data);
+}
+
 static gssize
 g_output_stream_real_splice_finish (GOutputStream  *stream,
                                     GAsyncResult   *result,
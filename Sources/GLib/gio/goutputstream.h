@@ -282,6 +282,17 @@ void     g_output_stream_splice_async  (GOutputStream             *stream,
 					GCancellable              *cancellable,
 					GAsyncReadyCallback        callback,
 					gpointer                   user_data);
+GIO_AVAILABLE_IN_2_80
+void     g_output_stream_splice_with_progress_async (GOutputStream            *stream,
+                                                     GInputStream             *source,
+                                                     GOutputStreamSpliceFlags  flags,
+                                                     int                       io_priority,
+                                                     GCancellable             *cancellable,
+                                                     GFileProgressCallback     progress_callback,
+                                                     gpointer                  progress_callback_data,
+                                                     GDestroyNotify            progress_callback_data_free,
+                                                     GAsyncReadyCallback       callback,
+                                                     gpointer                  user_data);
 GIO_AVAILABLE_IN_ALL
 gssize   g_output_stream_splice_finish (GOutputStream             *stream,
 					GAsyncResult              *result,
@@ -49,12 +49,18 @@ static gssize   g_pollable_input_stream_default_read_nonblocking (GPollableInput
 								  void                  *buffer,
 								  gsize                  count,
 								  GError               **error);
+static GPollableReturn g_pollable_input_stream_default_readv_nonblocking (GPollableInputStream  *stream,
+									  GInputVector          *vectors,
+									  gsize                  n_vectors,
+									  gsize                 *bytes_read,
+									  GError               **error);
 
 static void
 g_pollable_input_stream_default_init (GPollableInputStreamInterface *iface)
 {
-  iface->can_poll         = g_pollable_input_stream_default_can_poll;
-  iface->read_nonblocking = g_pollable_input_stream_default_read_nonblocking;
+  iface->can_poll          = g_pollable_input_stream_default_can_poll;
+  iface->read_nonblocking  = g_pollable_input_stream_default_read_nonblocking;
+  iface->readv_nonblocking = g_pollable_input_stream_default_readv_nonblocking;
 }
 
 static gboolean
@@ -166,6 +172,67 @@ g_pollable_input_stream_default_read_nonblocking (GPollableInputStream  *stream,
     read_fn (G_INPUT_STREAM (stream), buffer, count, NULL, error);
 }
 
+static GPollableReturn
+g_pollable_input_stream_default_readv_nonblocking (GPollableInputStream  *stream,
+						   GInputVector          *vectors,
+						   gsize                  n_vectors,
+						   gsize                 *bytes_read,
+						   GError               **error)
+{
+  gsize _bytes_read = 0;
+  GPollableInputStreamInterface *iface = G_POLLABLE_INPUT_STREAM_GET_INTERFACE (stream);
+  gsize i;
+  GError *err = NULL;
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      gssize res;
+
+      /* Would we overflow here? In that case simply return and let the caller
+       * handle this like a short read */
+      if (_bytes_read > G_MAXSIZE - vectors[i].size)
+        break;
+
+      if (vectors[i].size == 0)
+        continue;
+
+      res = iface->read_nonblocking (stream, vectors[i].buffer, vectors[i].size, &err);
+      if (res == -1)
+        {
+          if (bytes_read)
+            *bytes_read = _bytes_read;
+
+          /* If something was read already we handle this like a short read;
+           * the next call will report the same condition again */
+          if (_bytes_read > 0)
+            {
+              g_clear_error (&err);
+              return G_POLLABLE_RETURN_OK;
+            }
+          else if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+              g_clear_error (&err);
+              return G_POLLABLE_RETURN_WOULD_BLOCK;
+            }
+          else
+            {
+              g_propagate_error (error, err);
+              return G_POLLABLE_RETURN_FAILED;
+            }
+        }
+
+      _bytes_read += res;
+      /* a short read (or end of file) ends the loop here */
+      if ((gsize) res < vectors[i].size)
+        break;
+    }
+
+  if (bytes_read)
+    *bytes_read = _bytes_read;
+
+  return G_POLLABLE_RETURN_OK;
+}
+
 /**
  * g_pollable_input_stream_read_nonblocking: (virtual read_nonblocking)
  * @stream: a #GPollableInputStream
@@ -229,3 +296,97 @@ g_pollable_input_stream_read_nonblocking (GPollableInputStream  *stream,
 
   return res;
 }
+
+/**
+ * g_pollable_input_stream_readv_nonblocking: (virtual readv_nonblocking)
+ * @stream: a #GPollableInputStream
+ * @vectors: (array length=n_vectors): the buffer containing the #GInputVectors
+ *     to read into.
+ * @n_vectors: the number of vectors to read into
+ * @bytes_read: (out) (optional): location to store the number of bytes that
+ *     were read from the stream
+ * @cancellable: (nullable): a #GCancellable, or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Attempts to read into the @n_vectors @vectors from @stream, filling
+ * them in order, as with g_pollable_input_stream_read_nonblocking(). If
+ * @stream is not currently readable, this will immediately return
+ * %G_POLLABLE_RETURN_WOULD_BLOCK, and you can use
+ * g_pollable_input_stream_create_source() to create a #GSource that will be
+ * triggered when @stream is readable. @error will *not* be set in that case.
+ *
+ * Streams backed by a socket fill all vectors with a single system call,
+ * which makes this cheaper than several calls to
+ * g_pollable_input_stream_read_nonblocking() when reading, for example, a
+ * fixed-size header followed by a payload.
+ *
+ * On %G_POLLABLE_RETURN_OK, a @bytes_read of 0 means that the end of the
+ * stream has been reached (unless all @vectors were empty).
+ *
+ * Note that since this method never blocks, you cannot actually
+ * use @cancellable to cancel it. However, it will return an error
+ * if @cancellable has already been cancelled when you call, which
+ * may happen if you call this method after a source triggers due
+ * to having been cancelled.
+ *
+ * The behaviour of this method is undefined if
+ * g_pollable_input_stream_can_poll() returns %FALSE for @stream.
+ *
+ * Returns: %G_POLLABLE_RETURN_OK on success, %G_POLLABLE_RETURN_WOULD_BLOCK
+ * if the stream is not currently readable (and @error is *not* set), or
+ * %G_POLLABLE_RETURN_FAILED if there was an error in which case @error will
+ * be set.
+ *
+ * Since: 2.80
+ */
+GPollableReturn
+g_pollable_input_stream_readv_nonblocking (GPollableInputStream  *stream,
+					   GInputVector          *vectors,
+					   gsize                  n_vectors,
+					   gsize                 *bytes_read,
+					   GCancellable          *cancellable,
+					   GError               **error)
+{
+  GPollableInputStreamInterface *iface;
+  GPollableReturn res;
+  gsize _bytes_read = 0;
+
+  if (bytes_read)
+    *bytes_read = 0;
+
+  g_return_val_if_fail (G_IS_POLLABLE_INPUT_STREAM (stream), G_POLLABLE_RETURN_FAILED);
+  g_return_val_if_fail (vectors != NULL || n_vectors == 0, G_POLLABLE_RETURN_FAILED);
+  g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), G_POLLABLE_RETURN_FAILED);
+  g_return_val_if_fail (error == NULL || *error == NULL, G_POLLABLE_RETURN_FAILED);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return G_POLLABLE_RETURN_FAILED;
+
+  if (n_vectors == 0)
+    return G_POLLABLE_RETURN_OK;
+
+  iface = G_POLLABLE_INPUT_STREAM_GET_INTERFACE (stream);
+  g_return_val_if_fail (iface->readv_nonblocking != NULL, G_POLLABLE_RETURN_FAILED);
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = iface->
+    readv_nonblocking (stream, vectors, n_vectors, &_bytes_read, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  if (res == G_POLLABLE_RETURN_FAILED)
+    g_warn_if_fail (error == NULL || (*error != NULL && !g_error_matches (*error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)));
+  else if (res == G_POLLABLE_RETURN_WOULD_BLOCK)
+    g_warn_if_fail (error == NULL || *error == NULL);
+
+  /* in case of not-OK nothing must've been read */
+  g_warn_if_fail (res == G_POLLABLE_RETURN_OK || _bytes_read == 0);
+
+  if (bytes_read)
+    *bytes_read = _bytes_read;
+
+  return res;
+}
@@ -44,6 +44,8 @@ typedef struct _GPollableInputStreamInterface GPollableInputStreamInterface;
  * @create_source: Creates a #GSource to poll the stream
  * @read_nonblocking: Does a non-blocking read or returns
  *   %G_IO_ERROR_WOULD_BLOCK
+ * @readv_nonblocking: Does a vectored non-blocking read, or returns
+ *   %G_POLLABLE_RETURN_WOULD_BLOCK. Since: 2.80
  *
  * The interface for pollable input streams.
  *
@@ -56,6 +58,12 @@ typedef struct _GPollableInputStreamInterface GPollableInputStreamInterface;
  * implementation may return %TRUE when the stream is not actually
  * readable.
  *
+ * The default implementation of @readv_nonblocking calls
+ * g_pollable_input_stream_read_nonblocking() for each vector, and converts
+ * its return value and error (if set) to a #GPollableReturn. You should
+ * override this where possible, so that a single system call can fill
+ * several buffers.
+ *
  * Since: 2.28
  */
 struct _GPollableInputStreamInterface
@@ -72,6 +80,11 @@ struct _GPollableInputStreamInterface
 				    void                  *buffer,
 				    gsize                  count,
 				    GError               **error);
+  GPollableReturn (*readv_nonblocking) (GPollableInputStream  *stream,
+					GInputVector          *vectors,
+					gsize                  n_vectors,
+					gsize                 *bytes_read,
+					GError               **error);
 };
 
 GIO_AVAILABLE_IN_ALL
@@ -93,6 +106,14 @@ gssize   g_pollable_input_stream_read_nonblocking (GPollableInputStream  *stream
 						   GCancellable          *cancellable,
 						   GError               **error);
 
+GIO_AVAILABLE_IN_2_80
+GPollableReturn g_pollable_input_stream_readv_nonblocking (GPollableInputStream  *stream,
+							   GInputVector          *vectors,
+							   gsize                  n_vectors,
+							   gsize                 *bytes_read,
+							   GCancellable          *cancellable,
+							   GError               **error);
+
 G_END_DECLS
 
 
@@ -68,9 +68,10 @@
 
 typedef enum {
   PROP_TIMEOUT = 1,
+  PROP_CACHE_TTL,
 } GResolverProperty;
 
-static GParamSpec *props[PROP_TIMEOUT + 1] = { NULL, };
+static GParamSpec *props[PROP_CACHE_TTL + 1] = { NULL, };
 
 enum {
   RELOAD,
@@ -79,9 +80,20 @@ enum {
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+typedef struct {
+  GList *addrs;  /* (owned) (element-type GInetAddress) */
+  gint64 expiry_time;
+} GResolverCacheEntry;
+
 struct _GResolverPrivate {
   unsigned timeout_ms;
 
+  GMutex cache_mutex;
+  unsigned cache_ttl;  /* protected by @cache_mutex */
+  GHashTable *cache;  /* (nullable) (owned) (element-type utf8 GResolverCacheEntry); protected by @cache_mutex */
+  guint64 cache_hits;  /* protected by @cache_mutex */
+  guint64 cache_misses;  /* protected by @cache_mutex */
+
 #ifdef G_OS_UNIX
   GMutex mutex;
   time_t resolv_conf_timestamp;  /* protected by @mutex */
@@ -170,6 +182,9 @@ g_resolver_get_property (GObject    *object,
     case PROP_TIMEOUT:
       g_value_set_uint (value, g_resolver_get_timeout (self));
       break;
+    case PROP_CACHE_TTL:
+      g_value_set_uint (value, g_resolver_get_cache_ttl (self));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -188,6 +203,9 @@ g_resolver_set_property (GObject      *object,
     case PROP_TIMEOUT:
       g_resolver_set_timeout (self, g_value_get_uint (value));
       break;
+    case PROP_CACHE_TTL:
+      g_resolver_set_cache_ttl (self, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -196,9 +214,12 @@ g_resolver_set_property (GObject      *object,
 static void
 g_resolver_finalize (GObject *object)
 {
-#ifdef G_OS_UNIX
   GResolver *resolver = G_RESOLVER (object);
 
+  g_clear_pointer (&resolver->priv->cache, g_hash_table_unref);
+  g_mutex_clear (&resolver->priv->cache_mutex);
+
+#ifdef G_OS_UNIX
   g_mutex_clear (&resolver->priv->mutex);
 #endif
 
@@ -240,6 +261,31 @@ g_resolver_class_init (GResolverClass *resolver_class)
                        0, G_MAXUINT, 0,
                        G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GResolver:cache-ttl:
+   *
+   * How long successful hostname lookups are cached, in seconds.
+   *
+   * When this is non-zero, g_resolver_lookup_by_name() and its variants
+   * return the addresses of a recent successful lookup of the same
+   * hostname (with the same #GResolverNameLookupFlags) without querying
+   * the system resolver again. Failed lookups are never cached. The cache
+   * is flushed when the system resolver configuration changes (see
+   * #GResolver::reload), or when this property is changed.
+   *
+   * System name lookups do not report the TTL of the underlying DNS
+   * records, so this should be kept short; it is intended for programs
+   * which connect to the same few hosts many times a minute.
+   *
+   * If this is `0` (the default), no caching is done.
+   *
+   * Since: 2.80
+   */
+  props[PROP_CACHE_TTL] =
+    g_param_spec_uint ("cache-ttl", NULL, NULL,
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, G_N_ELEMENTS (props), props);
 
   /**
@@ -268,6 +314,8 @@ g_resolver_init (GResolver *resolver)
 
   resolver->priv = g_resolver_get_instance_private (resolver);
 
+  g_mutex_init (&resolver->priv->cache_mutex);
+
 #ifdef G_OS_UNIX
   if (stat (_PATH_RESCONF, &st) == 0)
     resolver->priv->resolv_conf_timestamp = st.st_mtime;
@@ -332,6 +380,101 @@ g_resolver_set_default (GResolver *resolver)
   G_UNLOCK (default_resolver);
 }
 
+static void
+cache_entry_free (GResolverCacheEntry *entry)
+{
+  g_resolver_free_addresses (entry->addrs);
+  g_free (entry);
+}
+
+static gchar *
+cache_key (const gchar              *hostname,
+           GResolverNameLookupFlags  flags)
+{
+  return g_strdup_printf ("%x:%s", (guint) flags, hostname);
+}
+
+static void
+cache_flush (GResolver *resolver)
+{
+  g_mutex_lock (&resolver->priv->cache_mutex);
+  if (resolver->priv->cache)
+    g_hash_table_remove_all (resolver->priv->cache);
+  g_mutex_unlock (&resolver->priv->cache_mutex);
+}
+
+/* Returns a copy of the cached addresses for @hostname, or %NULL on a miss
+ * or if caching is disabled. Updates the hit/miss statistics. */
+static GList *
+cache_lookup (GResolver                *resolver,
+              const gchar              *hostname,
+              GResolverNameLookupFlags  flags)
+{
+  GResolverPrivate *priv = resolver->priv;
+  GResolverCacheEntry *entry;
+  GList *addrs = NULL;
+  gchar *key;
+
+  g_mutex_lock (&priv->cache_mutex);
+
+  if (priv->cache_ttl == 0)
+    {
+      g_mutex_unlock (&priv->cache_mutex);
+      return NULL;
+    }
+
+  key = cache_key (hostname, flags);
+  entry = priv->cache ? g_hash_table_lookup (priv->cache, key) : NULL;
+
+  if (entry && entry->expiry_time <= g_get_monotonic_time ())
+    {
+      g_hash_table_remove (priv->cache, key);
+      entry = NULL;
+    }
+
+  if (entry)
+    {
+      addrs = g_list_copy_deep (entry->addrs, (GCopyFunc) g_object_ref, NULL);
+      priv->cache_hits++;
+    }
+  else
+    priv->cache_misses++;
+
+  g_mutex_unlock (&priv->cache_mutex);
+  g_free (key);
+
+  return addrs;
+}
+
+static void
+cache_insert (GResolver                *resolver,
+              const gchar              *hostname,
+              GResolverNameLookupFlags  flags,
+              GList                    *addrs)
+{
+  GResolverPrivate *priv = resolver->priv;
+  GResolverCacheEntry *entry;
+
+  g_mutex_lock (&priv->cache_mutex);
+
+  if (priv->cache_ttl == 0 || addrs == NULL)
+    {
+      g_mutex_unlock (&priv->cache_mutex);
+      return;
+    }
+
+  if (priv->cache == NULL)
+    priv->cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                         (GDestroyNotify) cache_entry_free);
+
+  entry = g_new0 (GResolverCacheEntry, 1);
+  entry->addrs = g_list_copy_deep (addrs, (GCopyFunc) g_object_ref, NULL);
+  entry->expiry_time = g_get_monotonic_time () + (gint64) priv->cache_ttl * G_USEC_PER_SEC;
+  g_hash_table_replace (priv->cache, cache_key (hostname, flags), entry);
+
+  g_mutex_unlock (&priv->cache_mutex);
+}
+
 static void
 maybe_emit_reload (GResolver *resolver)
 {
@@ -345,6 +488,7 @@ maybe_emit_reload (GResolver *resolver)
         {
           resolver->priv->resolv_conf_timestamp = st.st_mtime;
           g_mutex_unlock (&resolver->priv->mutex);
+          cache_flush (resolver);
           g_signal_emit (resolver, signals[RELOAD], 0);
         }
       else
@@ -532,6 +676,13 @@ lookup_by_name_real (GResolver                 *resolver,
 
   maybe_emit_reload (resolver);
 
+  addrs = cache_lookup (resolver, hostname, flags);
+  if (addrs)
+    {
+      g_free (ascii_hostname);
+      return addrs;
+    }
+
   if (flags != G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT)
     {
       if (!G_RESOLVER_GET_CLASS (resolver)->lookup_by_name_with_flags)
@@ -550,6 +701,7 @@ lookup_by_name_real (GResolver                 *resolver,
       lookup_by_name (resolver, hostname, cancellable, error);
 
   remove_duplicates (addrs);
+  cache_insert (resolver, hostname, flags, addrs);
 
   g_free (ascii_hostname);
   return addrs;
@@ -639,6 +791,51 @@ g_resolver_lookup_by_name_with_flags (GResolver                 *resolver,
                               error);
 }
 
+typedef struct {
+  gchar *hostname;
+  GResolverNameLookupFlags flags;
+} CachingLookupData;
+
+static void
+caching_lookup_data_free (CachingLookupData *data)
+{
+  g_free (data->hostname);
+  g_free (data);
+}
+
+/* Completes a lookup started with caching enabled: collects the result from
+ * the implementation, stores it, and hands it on through the outer task,
+ * which lookup_by_name_finish_real() recognises by its source tag. */
+static void
+caching_lookup_cb (GObject      *source_object,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+  GResolver *resolver = G_RESOLVER (source_object);
+  GTask *task = user_data;
+  CachingLookupData *data = g_task_get_task_data (task);
+  GError *error = NULL;
+  GList *addrs;
+
+  if (data->flags != G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT)
+    addrs = G_RESOLVER_GET_CLASS (resolver)->
+      lookup_by_name_with_flags_finish (resolver, result, &error);
+  else
+    addrs = G_RESOLVER_GET_CLASS (resolver)->
+      lookup_by_name_finish (resolver, result, &error);
+
+  if (addrs)
+    {
+      remove_duplicates (addrs);
+      cache_insert (resolver, data->hostname, data->flags, addrs);
+      g_task_return_pointer (task, addrs, (GDestroyNotify) g_resolver_free_addresses);
+    }
+  else
+    g_task_return_error (task, error);
+
+  g_object_unref (task);
+}
+
 static void
 lookup_by_name_async_real (GResolver                *resolver,
                            const gchar              *hostname,
@@ -690,6 +887,49 @@ lookup_by_name_async_real (GResolver                *resolver,
 
   maybe_emit_reload (resolver);
 
+  addrs = cache_lookup (resolver, hostname, flags);
+  if (addrs)
+    {
+      GTask *task;
+
+      task = g_task_new (resolver, cancellable, callback, user_data);
+      g_task_set_source_tag (task, lookup_by_name_async_real);
+      g_task_set_name (task, "[gio] resolver lookup");
+      g_task_return_pointer (task, addrs, (GDestroyNotify) g_resolver_free_addresses);
+      g_object_unref (task);
+      g_free (ascii_hostname);
+      return;
+    }
+
+  if (g_resolver_get_cache_ttl (resolver) > 0 &&
+      (flags == G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT ||
+       G_RESOLVER_GET_CLASS (resolver)->lookup_by_name_with_flags_async != NULL))
+    {
+      CachingLookupData *data;
+      GTask *task;
+
+      data = g_new0 (CachingLookupData, 1);
+      data->hostname = g_strdup (hostname);
+      data->flags = flags;
+
+      task = g_task_new (resolver, cancellable, callback, user_data);
+      g_task_set_source_tag (task, lookup_by_name_async_real);
+      g_task_set_name (task, "[gio] resolver lookup");
+      g_task_set_task_data (task, data, (GDestroyNotify) caching_lookup_data_free);
+
+      if (flags != G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT)
+        G_RESOLVER_GET_CLASS (resolver)->
+          lookup_by_name_with_flags_async (resolver, hostname, flags, cancellable,
+                                           caching_lookup_cb, task);
+      else
+        G_RESOLVER_GET_CLASS (resolver)->
+          lookup_by_name_async (resolver, hostname, cancellable,
+                                caching_lookup_cb, task);
+
+      g_free (ascii_hostname);
+      return;
+    }
+
   if (flags != G_RESOLVER_NAME_LOOKUP_FLAGS_DEFAULT)
     {
       if (G_RESOLVER_GET_CLASS (resolver)->lookup_by_name_with_flags_async == NULL)
@@ -732,7 +972,7 @@ lookup_by_name_finish_real (GResolver     *resolver,
     return NULL;
   else if (g_async_result_is_tagged (result, lookup_by_name_async_real))
     {
-      /* Handle the stringified-IP-addr case */
+      /* Handle the stringified-IP-addr and cached cases */
       return g_task_propagate_pointer (G_TASK (result), error);
     }
 
@@ -1357,6 +1597,95 @@ g_resolver_set_timeout (GResolver *resolver,
   g_object_notify_by_pspec (G_OBJECT (resolver), props[PROP_TIMEOUT]);
 }
 
+/**
+ * g_resolver_get_cache_ttl:
+ * @resolver: a #GResolver
+ *
+ * Gets how long successful hostname lookups are cached. See
+ * #GResolver:cache-ttl.
+ *
+ * Returns: the cache lifetime, in seconds, or `0` if caching is disabled
+ *
+ * Since: 2.80
+ */
+unsigned
+g_resolver_get_cache_ttl (GResolver *resolver)
+{
+  GResolverPrivate *priv = g_resolver_get_instance_private (resolver);
+  unsigned ttl;
+
+  g_return_val_if_fail (G_IS_RESOLVER (resolver), 0);
+
+  g_mutex_lock (&priv->cache_mutex);
+  ttl = priv->cache_ttl;
+  g_mutex_unlock (&priv->cache_mutex);
+
+  return ttl;
+}
+
+/**
+ * g_resolver_set_cache_ttl:
+ * @resolver: a #GResolver
+ * @ttl_seconds: cache lifetime in seconds, or `0` to disable caching
+ *
+ * Sets how long successful hostname lookups are cached, and flushes any
+ * currently cached results. See #GResolver:cache-ttl.
+ *
+ * Since: 2.80
+ */
+void
+g_resolver_set_cache_ttl (GResolver *resolver,
+                          unsigned   ttl_seconds)
+{
+  GResolverPrivate *priv = g_resolver_get_instance_private (resolver);
+
+  g_return_if_fail (G_IS_RESOLVER (resolver));
+
+  g_mutex_lock (&priv->cache_mutex);
+  if (priv->cache_ttl == ttl_seconds)
+    {
+      g_mutex_unlock (&priv->cache_mutex);
+      return;
+    }
+
+  priv->cache_ttl = ttl_seconds;
+  g_clear_pointer (&priv->cache, g_hash_table_unref);
+  g_mutex_unlock (&priv->cache_mutex);
+
+  g_object_notify_by_pspec (G_OBJECT (resolver), props[PROP_CACHE_TTL]);
+}
+
+/**
+ * g_resolver_get_cache_stats:
+ * @resolver: a #GResolver
+ * @n_hits: (out) (optional): return location for the number of lookups
+ *   answered from the cache
+ * @n_misses: (out) (optional): return location for the number of lookups
+ *   which had to query the system resolver while caching was enabled
+ *
+ * Gets statistics about the hostname lookup cache. Lookups of IP address
+ * literals and of `localhost` never reach the cache and are not counted.
+ * See #GResolver:cache-ttl.
+ *
+ * Since: 2.80
+ */
+void
+g_resolver_get_cache_stats (GResolver *resolver,
+                            guint64   *n_hits,
+                            guint64   *n_misses)
+{
+  GResolverPrivate *priv = g_resolver_get_instance_private (resolver);
+
+  g_return_if_fail (G_IS_RESOLVER (resolver));
+
+  g_mutex_lock (&priv->cache_mutex);
+  if (n_hits)
+    *n_hits = priv->cache_hits;
+  if (n_misses)
+    *n_misses = priv->cache_misses;
+  g_mutex_unlock (&priv->cache_mutex);
+}
+
 /**
  * g_resolver_error_quark:
  *
@@ -283,6 +283,16 @@ GIO_AVAILABLE_IN_2_78
 void       g_resolver_set_timeout                      (GResolver                 *resolver,
                                                         unsigned                   timeout_ms);
 
+GIO_AVAILABLE_IN_2_80
+unsigned   g_resolver_get_cache_ttl                    (GResolver                 *resolver);
+GIO_AVAILABLE_IN_2_80
+void       g_resolver_set_cache_ttl                    (GResolver                 *resolver,
+                                                        unsigned                   ttl_seconds);
+GIO_AVAILABLE_IN_2_80
+void       g_resolver_get_cache_stats                  (GResolver                 *resolver,
+                                                        guint64                   *n_hits,
+                                                        guint64                   *n_misses);
+
 /**
  * G_RESOLVER_ERROR:
  *
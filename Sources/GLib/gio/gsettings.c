@@ -2811,6 +2811,65 @@ g_settings_bind (GSettings          *settings,
                                 get_mapping, set_mapping, NULL, NULL);
 }
 
+/**
+ * g_settings_bind_many:
+ * @settings: a #GSettings object
+ * @object: (type GObject.Object): a #GObject
+ * @flags: flags for the bindings
+ * @first_key: the first key to bind
+ * @...: the name of the property to bind @first_key to, followed by
+ *     further key and property name pairs, terminated by %NULL
+ *
+ * Creates bindings between several keys in the @settings object and
+ * properties of @object, as if by calling g_settings_bind() for each
+ * pair with the same @flags.
+ *
+ * This is a convenience for objects with many settings-backed
+ * properties.  The parsed schema information for each key is shared
+ * by all #GSettings objects using the schema, so no per-key decoding
+ * of the compiled schema happens here beyond the first use of a key.
+ *
+ * |[<!-- language="C" -->
+ *   g_settings_bind_many (settings, window, G_SETTINGS_BIND_DEFAULT,
+ *                         "width", "default-width",
+ *                         "height", "default-height",
+ *                         "maximized", "maximized",
+ *                         NULL);
+ * ]|
+ *
+ * Since: 2.80
+ */
+void
+g_settings_bind_many (GSettings          *settings,
+                      gpointer            object,
+                      GSettingsBindFlags  flags,
+                      const gchar        *first_key,
+                      ...)
+{
+  const gchar *key;
+  va_list ap;
+
+  g_return_if_fail (G_IS_SETTINGS (settings));
+  g_return_if_fail (G_IS_OBJECT (object));
+
+  va_start (ap, first_key);
+
+  for (key = first_key; key != NULL; key = va_arg (ap, const gchar *))
+    {
+      const gchar *property = va_arg (ap, const gchar *);
+
+      if (property == NULL)
+        {
+          g_critical ("g_settings_bind_many: no property given for key '%s'", key);
+          break;
+        }
+
+      g_settings_bind (settings, key, object, property, flags);
+    }
+
+  va_end (ap);
+}
+
 /**
  * g_settings_bind_with_mapping: (skip)
  * @settings: a #GSettings object
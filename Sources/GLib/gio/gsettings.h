@@ -312,6 +312,12 @@ void                    g_settings_bind                                 (GSettin
                                                                          gpointer                 object,
                                                                          const gchar             *property,
                                                                          GSettingsBindFlags       flags);
+GIO_AVAILABLE_IN_2_80
+void                    g_settings_bind_many                            (GSettings               *settings,
+                                                                         gpointer                 object,
+                                                                         GSettingsBindFlags       flags,
+                                                                         const gchar             *first_key,
+                                                                         ...) G_GNUC_NULL_TERMINATED;
 GIO_AVAILABLE_IN_ALL
 void                    g_settings_bind_with_mapping                    (GSettings               *settings,
                                                                          const gchar             *key,
@@ -153,6 +153,14 @@ struct _GSettingsSchema
 
   GSettingsSchema *extends;
 
+  /* Schemas are shared between all users in the process (see
+   * g_settings_schema_source_lookup()), so the lazily-built parts
+   * below are protected by @lock.
+   */
+  GMutex lock;
+  GHashTable *keys;  /* interned name → parsed GSettingsSchemaKey */
+  gchar **key_names;
+
   gint ref_count;
 };
 
@@ -188,6 +196,12 @@ struct _GSettingsSchemaSource
   GvdbTable *table;
   GHashTable **text_tables;
 
+  /* id → GSettingsSchema (not owned); entries are removed when the
+   * schema is finalized
+   */
+  GMutex schemas_lock;
+  GHashTable *schemas;
+
   gint ref_count;
 };
 
@@ -239,6 +253,9 @@ g_settings_schema_source_unref (GSettingsSchemaSource *source)
           g_free (source->text_tables);
         }
 
+      g_hash_table_unref (source->schemas);
+      g_mutex_clear (&source->schemas_lock);
+
       g_slice_free (GSettingsSchemaSource, source);
     }
 }
@@ -306,6 +323,8 @@ g_settings_schema_source_new_from_directory (const gchar            *directory,
   source->parent = parent ? g_settings_schema_source_ref (parent) : NULL;
   source->text_tables = NULL;
   source->table = table;
+  g_mutex_init (&source->schemas_lock);
+  source->schemas = g_hash_table_new (g_str_hash, g_str_equal);
   source->ref_count = 1;
 
   return source;
@@ -402,6 +421,39 @@ g_settings_schema_source_get_default (void)
   return schema_sources;
 }
 
+/* Takes a reference on @schema, unless it is already being finalized */
+static gboolean
+g_settings_schema_try_ref (GSettingsSchema *schema)
+{
+  gint ref_count;
+
+  do
+    {
+      ref_count = g_atomic_int_get (&schema->ref_count);
+
+      if (ref_count == 0)
+        return FALSE;
+    }
+  while (!g_atomic_int_compare_and_exchange (&schema->ref_count, ref_count, ref_count + 1));
+
+  return TRUE;
+}
+
+static GSettingsSchema *
+g_settings_schema_source_get_cached (GSettingsSchemaSource *source,
+                                     const gchar           *schema_id)
+{
+  GSettingsSchema *schema;
+
+  g_mutex_lock (&source->schemas_lock);
+  schema = g_hash_table_lookup (source->schemas, schema_id);
+  if (schema && !g_settings_schema_try_ref (schema))
+    schema = NULL;
+  g_mutex_unlock (&source->schemas_lock);
+
+  return schema;
+}
+
 /**
  * g_settings_schema_source_lookup:
  * @source: a #GSettingsSchemaSource
@@ -419,7 +471,11 @@ g_settings_schema_source_get_default (void)
  *
  * If the schema isn't found, %NULL is returned.
  *
- * Returns: (nullable) (transfer full): a new #GSettingsSchema
+ * Schemas are shared: as long as a reference to the #GSettingsSchema
+ * for @schema_id is held, looking it up again returns that same
+ * instance, so its parsed key information is only built once.
+ *
+ * Returns: (nullable) (transfer full): a #GSettingsSchema
  *
  * Since: 2.32
  **/
@@ -429,24 +485,34 @@ g_settings_schema_source_lookup (GSettingsSchemaSource *source,
                                  gboolean               recursive)
 {
   GSettingsSchema *schema;
+  GSettingsSchema *cached;
   GvdbTable *table;
   const gchar *extends;
 
   g_return_val_if_fail (source != NULL, NULL);
   g_return_val_if_fail (schema_id != NULL, NULL);
 
+  if ((schema = g_settings_schema_source_get_cached (source, schema_id)))
+    return schema;
+
   table = gvdb_table_get_table (source->table, schema_id);
 
   if (table == NULL && recursive)
     for (source = source->parent; source; source = source->parent)
-      if ((table = gvdb_table_get_table (source->table, schema_id)))
-        break;
+      {
+        if ((schema = g_settings_schema_source_get_cached (source, schema_id)))
+          return schema;
+
+        if ((table = gvdb_table_get_table (source->table, schema_id)))
+          break;
+      }
 
   if (table == NULL)
     return NULL;
 
   schema = g_slice_new0 (GSettingsSchema);
   schema->source = g_settings_schema_source_ref (source);
+  g_mutex_init (&schema->lock);
   schema->ref_count = 1;
   schema->id = g_strdup (schema_id);
   schema->table = table;
@@ -464,6 +530,22 @@ g_settings_schema_source_lookup (GSettingsSchemaSource *source,
         g_warning ("Schema '%s' extends schema '%s' but we could not find it", schema_id, extends);
     }
 
+  /* Someone else may have built the same schema in the meantime */
+  g_mutex_lock (&source->schemas_lock);
+  cached = g_hash_table_lookup (source->schemas, schema->id);
+  if (cached == NULL || !g_settings_schema_try_ref (cached))
+    {
+      g_hash_table_replace (source->schemas, schema->id, schema);
+      cached = NULL;
+    }
+  g_mutex_unlock (&source->schemas_lock);
+
+  if (cached)
+    {
+      g_settings_schema_unref (schema);
+      schema = cached;
+    }
+
   return schema;
 }
 
@@ -941,9 +1023,20 @@ g_settings_schema_unref (GSettingsSchema *schema)
 {
   if (g_atomic_int_dec_and_test (&schema->ref_count))
     {
+      GSettingsSchemaSource *source = schema->source;
+
+      g_mutex_lock (&source->schemas_lock);
+      if (g_hash_table_lookup (source->schemas, schema->id) == schema)
+        g_hash_table_remove (source->schemas, schema->id);
+      g_mutex_unlock (&source->schemas_lock);
+
       if (schema->extends)
         g_settings_schema_unref (schema->extends);
 
+      g_clear_pointer (&schema->keys, g_hash_table_unref);
+      g_strfreev (schema->key_names);
+      g_mutex_clear (&schema->lock);
+
       g_settings_schema_source_unref (schema->source);
       gvdb_table_free (schema->table);
       g_free (schema->items);
@@ -1058,6 +1151,9 @@ g_settings_schema_has_key (GSettingsSchema *schema,
   return gvdb_table_has_value (schema->table, key);
 }
 
+static const GQuark *g_settings_schema_list_locked (GSettingsSchema *schema,
+                                                   gint            *n_items);
+
 /**
  * g_settings_schema_list_children:
  * @schema: a #GSettingsSchema
@@ -1120,30 +1216,40 @@ g_settings_schema_list_children (GSettingsSchema *schema)
 gchar **
 g_settings_schema_list_keys (GSettingsSchema *schema)
 {
-  const GQuark *keys;
   gchar **strv;
-  gint n_keys;
-  gint i, j;
 
   g_return_val_if_fail (schema != NULL, NULL);
 
-  keys = g_settings_schema_list (schema, &n_keys);
-  strv = g_new (gchar *, n_keys + 1);
-  for (i = j = 0; i < n_keys; i++)
+  g_mutex_lock (&schema->lock);
+
+  if (schema->key_names == NULL)
     {
-      const gchar *key = g_quark_to_string (keys[i]);
+      const GQuark *keys;
+      gint n_keys;
+      gint i, j;
 
-      if (!g_str_has_suffix (key, "/"))
-        strv[j++] = g_strdup (key);
+      keys = g_settings_schema_list_locked (schema, &n_keys);
+      schema->key_names = g_new (gchar *, n_keys + 1);
+      for (i = j = 0; i < n_keys; i++)
+        {
+          const gchar *key = g_quark_to_string (keys[i]);
+
+          if (!g_str_has_suffix (key, "/"))
+            schema->key_names[j++] = g_strdup (key);
+        }
+      schema->key_names[j] = NULL;
     }
-  strv[j] = NULL;
+
+  strv = g_strdupv (schema->key_names);
+
+  g_mutex_unlock (&schema->lock);
 
   return strv;
 }
 
-const GQuark *
-g_settings_schema_list (GSettingsSchema *schema,
-                        gint            *n_items)
+static const GQuark *
+g_settings_schema_list_locked (GSettingsSchema *schema,
+                               gint            *n_items)
 {
   if (schema->items == NULL)
     {
@@ -1245,6 +1351,20 @@ g_settings_schema_list (GSettingsSchema *schema,
   return schema->items;
 }
 
+const GQuark *
+g_settings_schema_list (GSettingsSchema *schema,
+                        gint            *n_items)
+{
+  const GQuark *items;
+
+  /* once built, the list is never changed or freed while @schema lives */
+  g_mutex_lock (&schema->lock);
+  items = g_settings_schema_list_locked (schema, n_items);
+  g_mutex_unlock (&schema->lock);
+
+  return items;
+}
+
 /**
  * g_settings_schema_get_id:
  * @schema: a #GSettingsSchema
@@ -1271,20 +1391,23 @@ endian_fixup (GVariant **value)
 #endif
 }
 
-void
-g_settings_schema_key_init (GSettingsSchemaKey *key,
-                            GSettingsSchema    *schema,
-                            const gchar        *name)
+/* Decodes the entry for @name from the compiled schema.  The result
+ * does not hold a reference on @schema; it is kept in @schema's key
+ * cache and copied out by g_settings_schema_key_init().
+ */
+static GSettingsSchemaKey *
+g_settings_schema_key_parse (GSettingsSchema *schema,
+                             const gchar     *name)
 {
+  GSettingsSchemaKey *key;
   GVariantIter *iter;
   GVariant *data;
   guchar code;
 
-  memset (key, 0, sizeof *key);
-
   iter = g_settings_schema_get_value (schema, name);
 
-  key->schema = g_settings_schema_ref (schema);
+  key = g_slice_new0 (GSettingsSchemaKey);
+  key->schema = schema;
   key->default_value = g_variant_iter_next_value (iter);
   endian_fixup (&key->default_value);
   key->type = g_variant_get_type (key->default_value);
@@ -1334,6 +1457,54 @@ g_settings_schema_key_init (GSettingsSchemaKey *key,
     }
 
   g_variant_iter_free (iter);
+
+  return key;
+}
+
+static void
+g_settings_schema_key_free_parsed (gpointer data)
+{
+  GSettingsSchemaKey *key = data;
+
+  g_clear_pointer (&key->minimum, g_variant_unref);
+  g_clear_pointer (&key->maximum, g_variant_unref);
+  g_clear_pointer (&key->desktop_overrides, g_variant_unref);
+  g_variant_unref (key->default_value);
+
+  g_slice_free (GSettingsSchemaKey, key);
+}
+
+void
+g_settings_schema_key_init (GSettingsSchemaKey *key,
+                            GSettingsSchema    *schema,
+                            const gchar        *name)
+{
+  GSettingsSchemaKey *parsed;
+
+  g_mutex_lock (&schema->lock);
+
+  if (schema->keys == NULL)
+    schema->keys = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                          g_settings_schema_key_free_parsed);
+
+  parsed = g_hash_table_lookup (schema->keys, name);
+  if (parsed == NULL)
+    {
+      parsed = g_settings_schema_key_parse (schema, name);
+      g_hash_table_insert (schema->keys, (gpointer) parsed->name, parsed);
+    }
+
+  g_mutex_unlock (&schema->lock);
+
+  *key = *parsed;
+  key->schema = g_settings_schema_ref (schema);
+  g_variant_ref (key->default_value);
+  if (key->minimum)
+    g_variant_ref (key->minimum);
+  if (key->maximum)
+    g_variant_ref (key->maximum);
+  if (key->desktop_overrides)
+    g_variant_ref (key->desktop_overrides);
 }
 
 void
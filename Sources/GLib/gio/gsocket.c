@@ -2923,6 +2923,21 @@ GSocket *
 g_socket_accept (GSocket       *socket,
 		 GCancellable  *cancellable,
 		 GError       **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), NULL);
+
+  return g_socket_accept_with_blocking (socket, socket->priv->blocking,
+                                        cancellable, error);
+}
+
+/* Like g_socket_accept(), but lets the caller override the socket's
+ * blocking mode, so that a backlog of pending connections can be drained
+ * without waiting once it runs dry. */
+GSocket *
+g_socket_accept_with_blocking (GSocket       *socket,
+                               gboolean       blocking,
+                               GCancellable  *cancellable,
+                               GError       **error)
 {
 #ifdef HAVE_ACCEPT4
   gboolean try_accept4 = TRUE;
@@ -2977,7 +2992,7 @@ g_socket_accept (GSocket       *socket,
             {
               win32_unset_event_mask (socket, FD_ACCEPT);
 
-              if (socket->priv->blocking)
+              if (blocking)
                 {
                   if (!g_socket_condition_wait (socket,
                                                 G_IO_IN, cancellable, error))
@@ -3509,6 +3524,41 @@ g_socket_receive_with_blocking (GSocket       *socket,
                                         blocking ? -1 : 0, cancellable, error);
 }
 
+/* Scatter-read into @vectors with a single recvmsg() call, without
+ * blocking. Used by #GSocketInputStream to implement readv_nonblocking. */
+GPollableReturn
+g_socket_receive_vectors_nonblocking (GSocket       *socket,
+                                      GInputVector  *vectors,
+                                      gint           num_vectors,
+                                      gsize         *bytes_read,
+                                      GError       **error)
+{
+  GError *local_error = NULL;
+  gssize res;
+
+  *bytes_read = 0;
+
+  res = g_socket_receive_message_with_timeout (socket, NULL,
+                                               vectors, num_vectors,
+                                               NULL, NULL, NULL, 0,
+                                               NULL, &local_error);
+  if (res < 0)
+    {
+      if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+        {
+          g_error_free (local_error);
+          return G_POLLABLE_RETURN_WOULD_BLOCK;
+        }
+
+      g_propagate_error (error, local_error);
+      return G_POLLABLE_RETURN_FAILED;
+    }
+
+  *bytes_read = res;
+
+  return G_POLLABLE_RETURN_OK;
+}
+
 /**
  * g_socket_receive_bytes_from:
  * @socket: a #GSocket
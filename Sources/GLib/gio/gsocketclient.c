@@ -82,6 +82,11 @@
  * As `GSocketClient` is a lightweight object, you don't need to cache it. You
  * can just create a new one any time you need one.
  *
+ * The exception is when connection pooling is enabled with
+ * [method@Gio.SocketClient.set_pool_max_idle]: connections handed back with
+ * [method@Gio.SocketClient.release_connection] are kept by the client, and
+ * later connects to the same destination reuse them.
+ *
  * Since: 2.22
  */
 
@@ -105,7 +110,9 @@ enum
   PROP_ENABLE_PROXY,
   PROP_TLS,
   PROP_TLS_VALIDATION_FLAGS,
-  PROP_PROXY_RESOLVER
+  PROP_PROXY_RESOLVER,
+  PROP_POOL_MAX_IDLE,
+  PROP_POOL_IDLE_TIMEOUT
 };
 
 struct _GSocketClientPrivate
@@ -120,8 +127,36 @@ struct _GSocketClientPrivate
   gboolean tls;
   GTlsCertificateFlags tls_validation_flags;
   GProxyResolver *proxy_resolver;
+
+  GMutex pool_mutex;
+  guint pool_max_idle;  /* protected by @pool_mutex */
+  guint pool_idle_timeout;  /* protected by @pool_mutex */
+  GHashTable *pool;  /* (nullable) (owned) (element-type utf8 GQueue<PooledConnection>); protected by @pool_mutex */
+  guint64 pool_n_reused;  /* protected by @pool_mutex */
+  guint64 pool_n_created;  /* protected by @pool_mutex */
 };
 
+typedef struct
+{
+  GSocketConnection *connection;  /* (owned) */
+  gint64 release_time;
+} PooledConnection;
+
+static GQuark pool_key_quark;
+
+static void
+pooled_connection_free (PooledConnection *pooled)
+{
+  g_object_unref (pooled->connection);
+  g_free (pooled);
+}
+
+static void
+pool_queue_free (GQueue *queue)
+{
+  g_queue_free_full (queue, (GDestroyNotify) pooled_connection_free);
+}
+
 G_DEFINE_TYPE_WITH_PRIVATE (GSocketClient, g_socket_client, G_TYPE_OBJECT)
 
 static GSocket *
@@ -220,6 +255,7 @@ g_socket_client_init (GSocketClient *client)
 						     g_str_equal,
 						     g_free,
 						     NULL);
+  g_mutex_init (&client->priv->pool_mutex);
 }
 
 /**
@@ -245,6 +281,8 @@ g_socket_client_finalize (GObject *object)
 
   g_clear_object (&client->priv->local_address);
   g_clear_object (&client->priv->proxy_resolver);
+  g_clear_pointer (&client->priv->pool, g_hash_table_unref);
+  g_mutex_clear (&client->priv->pool_mutex);
 
   G_OBJECT_CLASS (g_socket_client_parent_class)->finalize (object);
 
@@ -299,6 +337,14 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 	g_value_set_object (value, g_socket_client_get_proxy_resolver (client));
 	break;
 
+      case PROP_POOL_MAX_IDLE:
+	g_value_set_uint (value, g_socket_client_get_pool_max_idle (client));
+	break;
+
+      case PROP_POOL_IDLE_TIMEOUT:
+	g_value_set_uint (value, g_socket_client_get_pool_idle_timeout (client));
+	break;
+
       default:
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -352,6 +398,14 @@ G_GNUC_END_IGNORE_DEPRECATIONS
       g_socket_client_set_proxy_resolver (client, g_value_get_object (value));
       break;
 
+    case PROP_POOL_MAX_IDLE:
+      g_socket_client_set_pool_max_idle (client, g_value_get_uint (value));
+      break;
+
+    case PROP_POOL_IDLE_TIMEOUT:
+      g_socket_client_set_pool_idle_timeout (client, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -785,6 +839,359 @@ g_socket_client_set_proxy_resolver (GSocketClient  *client,
     g_object_ref (client->priv->proxy_resolver);
 }
 
+/**
+ * g_socket_client_get_pool_max_idle:
+ * @client: a #GSocketClient.
+ *
+ * Gets the maximum number of idle connections @client keeps per
+ * destination. See g_socket_client_set_pool_max_idle().
+ *
+ * Returns: the maximum number of pooled connections per destination, or
+ *   `0` if connection pooling is disabled
+ *
+ * Since: 2.80
+ */
+guint
+g_socket_client_get_pool_max_idle (GSocketClient *client)
+{
+  guint max_idle;
+
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), 0);
+
+  g_mutex_lock (&client->priv->pool_mutex);
+  max_idle = client->priv->pool_max_idle;
+  g_mutex_unlock (&client->priv->pool_mutex);
+
+  return max_idle;
+}
+
+/**
+ * g_socket_client_set_pool_max_idle:
+ * @client: a #GSocketClient.
+ * @max_idle: the maximum number of idle connections to keep per
+ *   destination, or `0` to disable connection pooling
+ *
+ * Enables connection pooling on @client, and limits the number of idle
+ * connections kept for each destination.
+ *
+ * When pooling is enabled, connections handed back with
+ * g_socket_client_release_connection() are kept open, and a later
+ * g_socket_client_connect() (or any of its variants) to the same
+ * connectable, with the same socket, proxy and TLS settings, returns one
+ * of them instead of resolving and connecting again. Only the
+ * %G_SOCKET_CLIENT_COMPLETE event is emitted for a reused connection.
+ *
+ * Pooled connections are dropped once they have been idle for longer than
+ * #GSocketClient:pool-idle-timeout, or when the peer has closed them or
+ * sent unsolicited data.
+ *
+ * Setting this to `0` (the default) disables pooling and closes all idle
+ * connections.
+ *
+ * Since: 2.80
+ */
+void
+g_socket_client_set_pool_max_idle (GSocketClient *client,
+                                   guint          max_idle)
+{
+  GHashTable *pool = NULL;
+
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  g_mutex_lock (&client->priv->pool_mutex);
+  if (client->priv->pool_max_idle == max_idle)
+    {
+      g_mutex_unlock (&client->priv->pool_mutex);
+      return;
+    }
+
+  client->priv->pool_max_idle = max_idle;
+  if (max_idle == 0)
+    pool = g_steal_pointer (&client->priv->pool);
+  g_mutex_unlock (&client->priv->pool_mutex);
+
+  /* Close the dropped connections outside the lock */
+  g_clear_pointer (&pool, g_hash_table_unref);
+
+  g_object_notify (G_OBJECT (client), "pool-max-idle");
+}
+
+/**
+ * g_socket_client_get_pool_idle_timeout:
+ * @client: a #GSocketClient.
+ *
+ * Gets how long pooled connections may stay idle. See
+ * g_socket_client_set_pool_idle_timeout().
+ *
+ * Returns: the idle timeout, in seconds
+ *
+ * Since: 2.80
+ */
+guint
+g_socket_client_get_pool_idle_timeout (GSocketClient *client)
+{
+  guint idle_timeout;
+
+  g_return_val_if_fail (G_IS_SOCKET_CLIENT (client), 0);
+
+  g_mutex_lock (&client->priv->pool_mutex);
+  idle_timeout = client->priv->pool_idle_timeout;
+  g_mutex_unlock (&client->priv->pool_mutex);
+
+  return idle_timeout;
+}
+
+/**
+ * g_socket_client_set_pool_idle_timeout:
+ * @client: a #GSocketClient.
+ * @idle_timeout: the idle timeout, in seconds
+ *
+ * Sets how long a connection may sit in the pool of @client before it
+ * is discarded rather than reused. Expired connections are closed the
+ * next time the pool is used. The default is 60 seconds.
+ *
+ * This has no effect unless pooling is enabled with
+ * g_socket_client_set_pool_max_idle().
+ *
+ * Since: 2.80
+ */
+void
+g_socket_client_set_pool_idle_timeout (GSocketClient *client,
+                                       guint          idle_timeout)
+{
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  g_mutex_lock (&client->priv->pool_mutex);
+  if (client->priv->pool_idle_timeout == idle_timeout)
+    {
+      g_mutex_unlock (&client->priv->pool_mutex);
+      return;
+    }
+
+  client->priv->pool_idle_timeout = idle_timeout;
+  g_mutex_unlock (&client->priv->pool_mutex);
+
+  g_object_notify (G_OBJECT (client), "pool-idle-timeout");
+}
+
+/**
+ * g_socket_client_get_pool_stats:
+ * @client: a #GSocketClient.
+ * @n_reused: (out) (optional): return location for the number of
+ *   connections taken from the pool
+ * @n_created: (out) (optional): return location for the number of new
+ *   connections established while pooling was enabled
+ *
+ * Gets connection pool statistics for @client. The pool hit rate is
+ * @n_reused / (@n_reused + @n_created).
+ *
+ * Since: 2.80
+ */
+void
+g_socket_client_get_pool_stats (GSocketClient *client,
+                                guint64       *n_reused,
+                                guint64       *n_created)
+{
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+
+  g_mutex_lock (&client->priv->pool_mutex);
+  if (n_reused)
+    *n_reused = client->priv->pool_n_reused;
+  if (n_created)
+    *n_created = client->priv->pool_n_created;
+  g_mutex_unlock (&client->priv->pool_mutex);
+}
+
+/* Connections may only be shared between requests which would have produced
+ * equivalent connections, so the key covers the destination as well as every
+ * client setting that affects how the connection is made. Returns %NULL if
+ * pooling is disabled or @connectable cannot be identified by a string. */
+static gchar *
+pool_key_new (GSocketClient      *client,
+              GSocketConnectable *connectable)
+{
+  GSocketConnectableIface *iface = G_SOCKET_CONNECTABLE_GET_IFACE (connectable);
+  gchar *destination, *local_address = NULL, *key;
+
+  if (g_socket_client_get_pool_max_idle (client) == 0 ||
+      iface->to_string == NULL)
+    return NULL;
+
+  destination = g_socket_connectable_to_string (connectable);
+  if (client->priv->local_address)
+    local_address = g_socket_connectable_to_string (G_SOCKET_CONNECTABLE (client->priv->local_address));
+
+  key = g_strdup_printf ("%s|%s|%d/%d/%d|%s|%p|%d/%u|%s",
+                         G_OBJECT_TYPE_NAME (connectable), destination,
+                         client->priv->family, client->priv->type,
+                         client->priv->protocol,
+                         client->priv->enable_proxy ? "proxy" : "direct",
+                         client->priv->proxy_resolver,
+                         client->priv->tls, client->priv->tls_validation_flags,
+                         local_address ? local_address : "");
+
+  g_free (destination);
+  g_free (local_address);
+
+  return key;
+}
+
+static gboolean
+pooled_connection_is_usable (PooledConnection *pooled,
+                             gint64            now,
+                             guint             idle_timeout)
+{
+  GSocket *socket;
+
+  if (now - pooled->release_time > (gint64) idle_timeout * G_USEC_PER_SEC)
+    return FALSE;
+
+  if (g_io_stream_is_closed (G_IO_STREAM (pooled->connection)) ||
+      g_io_stream_has_pending (G_IO_STREAM (pooled->connection)))
+    return FALSE;
+
+  socket = g_socket_connection_get_socket (pooled->connection);
+  if (g_socket_is_closed (socket) || !g_socket_is_connected (socket))
+    return FALSE;
+
+  /* An idle connection should have nothing to read; if it does, the peer
+   * has either closed it or sent data nobody will consume. */
+  return g_socket_condition_check (socket, G_IO_IN | G_IO_ERR | G_IO_HUP) == 0;
+}
+
+/* Returns a pooled connection for @key, if there is a usable one. The most
+ * recently released connection is preferred, as it is the least likely to
+ * have been timed out by the peer. */
+static GSocketConnection *
+pool_take (GSocketClient *client,
+           const gchar   *key)
+{
+  GSocketConnection *connection = NULL;
+  GQueue *queue;
+  GList *dropped = NULL;
+  gint64 now = g_get_monotonic_time ();
+
+  g_mutex_lock (&client->priv->pool_mutex);
+
+  queue = client->priv->pool ? g_hash_table_lookup (client->priv->pool, key) : NULL;
+  while (queue != NULL && connection == NULL && !g_queue_is_empty (queue))
+    {
+      PooledConnection *pooled = g_queue_pop_head (queue);
+
+      if (pooled_connection_is_usable (pooled, now, client->priv->pool_idle_timeout))
+        {
+          connection = g_steal_pointer (&pooled->connection);
+          g_free (pooled);
+        }
+      else
+        dropped = g_list_prepend (dropped, pooled);
+    }
+
+  if (connection)
+    client->priv->pool_n_reused++;
+
+  g_mutex_unlock (&client->priv->pool_mutex);
+
+  g_list_free_full (dropped, (GDestroyNotify) pooled_connection_free);
+
+  return connection;
+}
+
+/* Marks a newly established @connection as eligible for the pool, taking
+ * ownership of @key. */
+static void
+pool_adopt (GSocketClient     *client,
+            GSocketConnection *connection,
+            gchar             *key)
+{
+  g_object_set_qdata_full (G_OBJECT (connection), pool_key_quark, key, g_free);
+
+  g_mutex_lock (&client->priv->pool_mutex);
+  client->priv->pool_n_created++;
+  g_mutex_unlock (&client->priv->pool_mutex);
+}
+
+/**
+ * g_socket_client_release_connection:
+ * @client: a #GSocketClient.
+ * @connection: a #GSocketConnection returned by one of @client's connect
+ *   functions
+ *
+ * Hands @connection back to @client for reuse once the caller is done with
+ * it. The caller must leave the connection in a state where it can be used
+ * for an unrelated request: no unread data and no partially written
+ * messages. The caller should drop its own reference afterwards, and must
+ * not use @connection again.
+ *
+ * If pooling is disabled (see g_socket_client_set_pool_max_idle()), if
+ * @connection was not made by @client while pooling was enabled, or if the
+ * pool for its destination is full, this does nothing, and @connection is
+ * closed as usual when its last reference is dropped.
+ *
+ * Since: 2.80
+ */
+void
+g_socket_client_release_connection (GSocketClient     *client,
+                                    GSocketConnection *connection)
+{
+  const gchar *key;
+  GQueue *queue;
+  PooledConnection *pooled;
+  GList *dropped = NULL;
+  gint64 now;
+
+  g_return_if_fail (G_IS_SOCKET_CLIENT (client));
+  g_return_if_fail (G_IS_SOCKET_CONNECTION (connection));
+
+  key = g_object_get_qdata (G_OBJECT (connection), pool_key_quark);
+  if (key == NULL)
+    return;
+
+  pooled = g_new0 (PooledConnection, 1);
+  pooled->connection = g_object_ref (connection);
+  pooled->release_time = now = g_get_monotonic_time ();
+
+  g_mutex_lock (&client->priv->pool_mutex);
+
+  if (client->priv->pool_max_idle == 0 ||
+      !pooled_connection_is_usable (pooled, now, client->priv->pool_idle_timeout))
+    {
+      g_mutex_unlock (&client->priv->pool_mutex);
+      pooled_connection_free (pooled);
+      return;
+    }
+
+  if (client->priv->pool == NULL)
+    client->priv->pool = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                (GDestroyNotify) pool_queue_free);
+
+  queue = g_hash_table_lookup (client->priv->pool, key);
+  if (queue == NULL)
+    {
+      queue = g_queue_new ();
+      g_hash_table_insert (client->priv->pool, g_strdup (key), queue);
+    }
+
+  g_queue_push_head (queue, pooled);
+
+  /* Evict the longest-idle connections beyond the limit, and any which
+   * have expired in the meantime */
+  while (!g_queue_is_empty (queue))
+    {
+      PooledConnection *oldest = g_queue_peek_tail (queue);
+
+      if (g_queue_get_length (queue) <= client->priv->pool_max_idle &&
+          now - oldest->release_time <= (gint64) client->priv->pool_idle_timeout * G_USEC_PER_SEC)
+        break;
+
+      dropped = g_list_prepend (dropped, g_queue_pop_tail (queue));
+    }
+
+  g_mutex_unlock (&client->priv->pool_mutex);
+
+  g_list_free_full (dropped, (GDestroyNotify) pooled_connection_free);
+}
+
 static void
 g_socket_client_class_init (GSocketClientClass *class)
 {
@@ -794,6 +1201,8 @@ g_socket_client_class_init (GSocketClientClass *class)
   gobject_class->set_property = g_socket_client_set_property;
   gobject_class->get_property = g_socket_client_get_property;
 
+  pool_key_quark = g_quark_from_static_string ("gio-socket-client-pool-key");
+
   /**
    * GSocketClient::event:
    * @client: the #GSocketClient
@@ -1013,6 +1422,37 @@ g_socket_client_class_init (GSocketClientClass *class)
                                                         G_PARAM_CONSTRUCT |
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketClient:pool-max-idle:
+   *
+   * The maximum number of idle connections kept for reuse per
+   * destination, or `0` to disable connection pooling. See
+   * g_socket_client_set_pool_max_idle().
+   *
+   * Since: 2.80
+   */
+  g_object_class_install_property (gobject_class, PROP_POOL_MAX_IDLE,
+                                   g_param_spec_uint ("pool-max-idle", NULL, NULL,
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_CONSTRUCT |
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketClient:pool-idle-timeout:
+   *
+   * How long a pooled connection may stay idle before it is discarded,
+   * in seconds.
+   *
+   * Since: 2.80
+   */
+  g_object_class_install_property (gobject_class, PROP_POOL_IDLE_TIMEOUT,
+                                   g_param_spec_uint ("pool-idle-timeout", NULL, NULL,
+                                                      0, G_MAXUINT, 60,
+                                                      G_PARAM_CONSTRUCT |
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -1131,6 +1571,20 @@ g_socket_client_connect (GSocketClient       *client,
   GSocketAddressEnumerator *enumerator = NULL;
   SocketClientErrorInfo *error_info;
   gboolean ever_resolved = FALSE;
+  gchar *pool_key;
+
+  pool_key = pool_key_new (client, connectable);
+  if (pool_key != NULL)
+    {
+      GSocketConnection *pooled = pool_take (client, pool_key);
+
+      if (pooled != NULL)
+        {
+          g_free (pool_key);
+          g_socket_client_emit_event (client, G_SOCKET_CLIENT_COMPLETE, connectable, G_IO_STREAM (pooled));
+          return pooled;
+        }
+    }
 
   error_info = socket_client_error_info_new ();
 
@@ -1320,6 +1774,9 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 
   if (!connection)
     g_propagate_error (error, g_steal_pointer (&error_info->best_error));
+  else if (pool_key)
+    pool_adopt (client, G_SOCKET_CONNECTION (connection), g_steal_pointer (&pool_key));
+  g_free (pool_key);
   socket_client_error_info_free (error_info);
 
   g_socket_client_emit_event (client, G_SOCKET_CLIENT_COMPLETE, connectable, connection);
@@ -1494,6 +1951,7 @@ typedef struct
   GSocketClient *client;
 
   GSocketConnectable *connectable;
+  gchar *pool_key;  /* (nullable) (owned) */
   GSocketAddressEnumerator *enumerator;
   GCancellable *enumeration_cancellable;
   GCancellable *enumeration_parent_cancellable;  /* (nullable) (owned) */
@@ -1519,6 +1977,7 @@ g_socket_client_async_connect_data_free (GSocketClientAsyncConnectData *data)
 {
   data->task = NULL;
   g_clear_object (&data->connectable);
+  g_clear_pointer (&data->pool_key, g_free);
   g_clear_object (&data->enumerator);
 
   g_cancellable_disconnect (data->enumeration_parent_cancellable, data->enumeration_cancelled_id);
@@ -1647,6 +2106,8 @@ g_socket_client_async_connect_complete (ConnectionAttempt *attempt)
   else
     {
       g_debug ("GSocketClient: Connection successful!");
+      if (data->pool_key)
+        pool_adopt (data->client, G_SOCKET_CONNECTION (attempt->connection), g_steal_pointer (&data->pool_key));
       g_socket_client_emit_event (data->client, G_SOCKET_CLIENT_COMPLETE, data->connectable, attempt->connection);
       g_task_return_pointer (data->task, g_steal_pointer (&attempt->connection), g_object_unref);
     }
@@ -2146,12 +2607,34 @@ g_socket_client_connect_async (GSocketClient       *client,
 			       gpointer             user_data)
 {
   GSocketClientAsyncConnectData *data;
+  gchar *pool_key;
 
   g_return_if_fail (G_IS_SOCKET_CLIENT (client));
 
+  pool_key = pool_key_new (client, connectable);
+  if (pool_key != NULL)
+    {
+      GSocketConnection *pooled = pool_take (client, pool_key);
+
+      if (pooled != NULL)
+        {
+          GTask *task;
+
+          g_free (pool_key);
+
+          task = g_task_new (client, cancellable, callback, user_data);
+          g_task_set_source_tag (task, g_socket_client_connect_async);
+          g_socket_client_emit_event (client, G_SOCKET_CLIENT_COMPLETE, connectable, G_IO_STREAM (pooled));
+          g_task_return_pointer (task, pooled, g_object_unref);
+          g_object_unref (task);
+          return;
+        }
+    }
+
   data = g_slice_new0 (GSocketClientAsyncConnectData);
   data->client = client;
   data->connectable = g_object_ref (connectable);
+  data->pool_key = g_steal_pointer (&pool_key);
   data->error_info = socket_client_error_info_new ();
 
   if (can_use_proxy (client))
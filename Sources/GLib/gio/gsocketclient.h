@@ -194,6 +194,24 @@ GIO_AVAILABLE_IN_ALL
 void			g_socket_client_add_application_proxy		(GSocketClient        *client,
 									 const gchar          *protocol);
 
+GIO_AVAILABLE_IN_2_80
+guint                   g_socket_client_get_pool_max_idle               (GSocketClient        *client);
+GIO_AVAILABLE_IN_2_80
+void                    g_socket_client_set_pool_max_idle               (GSocketClient        *client,
+                                                                         guint                 max_idle);
+GIO_AVAILABLE_IN_2_80
+guint                   g_socket_client_get_pool_idle_timeout           (GSocketClient        *client);
+GIO_AVAILABLE_IN_2_80
+void                    g_socket_client_set_pool_idle_timeout           (GSocketClient        *client,
+                                                                         guint                 idle_timeout);
+GIO_AVAILABLE_IN_2_80
+void                    g_socket_client_release_connection              (GSocketClient        *client,
+                                                                         GSocketConnection    *connection);
+GIO_AVAILABLE_IN_2_80
+void                    g_socket_client_get_pool_stats                  (GSocketClient        *client,
+                                                                         guint64              *n_reused,
+                                                                         guint64              *n_created);
+
 G_END_DECLS
 
 #endif /* __G_SOCKET_CLIENT_H___ */
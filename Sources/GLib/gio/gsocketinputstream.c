@@ -31,6 +31,7 @@
 #include "gpollableinputstream.h"
 #include "gioerror.h"
 #include "gfiledescriptorbased.h"
+#include "gioprivate.h"
 
 struct _GSocketInputStreamPrivate
 {
@@ -168,6 +169,26 @@ g_socket_input_stream_pollable_read_nonblocking (GPollableInputStream  *pollable
 					 NULL, error);
 }
 
+static GPollableReturn
+g_socket_input_stream_pollable_readv_nonblocking (GPollableInputStream  *pollable,
+                                                  GInputVector          *vectors,
+                                                  gsize                  n_vectors,
+                                                  gsize                 *bytes_read,
+                                                  GError               **error)
+{
+  GSocketInputStream *input_stream = G_SOCKET_INPUT_STREAM (pollable);
+
+  /* Clamp the number of vectors if more given than we can read in one go.
+   * The caller has to handle short reads anyway.
+   */
+  if (n_vectors > G_IOV_MAX)
+    n_vectors = G_IOV_MAX;
+
+  return g_socket_receive_vectors_nonblocking (input_stream->priv->socket,
+                                               vectors, n_vectors,
+                                               bytes_read, error);
+}
+
 #ifdef G_OS_UNIX
 static int
 g_socket_input_stream_get_fd (GFileDescriptorBased *fd_based)
@@ -210,6 +231,7 @@ g_socket_input_stream_pollable_iface_init (GPollableInputStreamInterface *iface)
   iface->is_readable = g_socket_input_stream_pollable_is_readable;
   iface->create_source = g_socket_input_stream_pollable_create_source;
   iface->read_nonblocking = g_socket_input_stream_pollable_read_nonblocking;
+  iface->readv_nonblocking = g_socket_input_stream_pollable_readv_nonblocking;
 }
 
 static void
@@ -28,6 +28,8 @@
 #include "config.h"
 #include "gsocketlistener.h"
 
+#include <errno.h>
+
 #include <gio/gioenumtypes.h>
 #include <gio/gtask.h>
 #include <gio/gcancellable.h>
@@ -37,6 +39,7 @@
 #include <gio/gsocket.h>
 #include <gio/gsocketconnection.h>
 #include <gio/ginetsocketaddress.h>
+#include "gioprivate.h"
 #include "glibintl.h"
 #include "gmarshal-internal.h"
 
@@ -783,6 +786,52 @@ g_socket_listener_accept (GSocketListener  *listener,
   return connection;
 }
 
+/* Accepts a connection which is already pending on one of the listener's
+ * sockets, without waiting. Returns %NULL with %G_IO_ERROR_WOULD_BLOCK once
+ * no socket has anything queued. This lets #GSocketService drain a burst of
+ * connections per main loop wakeup rather than taking one per wakeup. */
+GSocket *
+g_socket_listener_accept_socket_nonblocking (GSocketListener  *listener,
+                                             GObject         **source_object,
+                                             GError          **error)
+{
+  guint i;
+
+  g_return_val_if_fail (G_IS_SOCKET_LISTENER (listener), NULL);
+
+  if (!check_listener (listener, error))
+    return NULL;
+
+  for (i = 0; i < listener->priv->sockets->len; i++)
+    {
+      GSocket *accept_socket = listener->priv->sockets->pdata[i];
+      GSocket *socket;
+      GError *local_error = NULL;
+
+      socket = g_socket_accept_with_blocking (accept_socket, FALSE,
+                                              NULL, &local_error);
+      if (socket != NULL)
+        {
+          if (source_object)
+            *source_object = g_object_get_qdata (G_OBJECT (accept_socket), source_quark);
+          return socket;
+        }
+
+      if (!g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK) ||
+          i == listener->priv->sockets->len - 1)
+        {
+          g_propagate_error (error, local_error);
+          return NULL;
+        }
+
+      g_error_free (local_error);
+    }
+
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK,
+                       g_strerror (EAGAIN));
+  return NULL;
+}
+
 typedef struct
 {
   GList *sources;  /* (element-type GSource) */
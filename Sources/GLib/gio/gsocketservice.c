@@ -61,6 +61,7 @@
 #include <gio/gio.h>
 #include "gsocketlistener.h"
 #include "gsocketconnection.h"
+#include "gioprivate.h"
 #include "glibintl.h"
 #include "gmarshal-internal.h"
 
@@ -83,6 +84,10 @@ enum
   PROP_ACTIVE
 };
 
+/* Upper bound on the number of connections accepted per main loop
+ * wakeup, so that a flood of clients cannot starve other sources. */
+#define G_SOCKET_SERVICE_ACCEPT_BATCH 32
+
 static void g_socket_service_ready (GObject      *object,
 				    GAsyncResult *result,
 				    gpointer      user_data);
@@ -385,8 +390,28 @@ g_socket_service_ready (GObject      *object,
     }
   else
     {
+      guint i;
+
       g_socket_service_incoming (service, connection, source_object);
       g_object_unref (connection);
+
+      /* A wakeup usually means more than one client is queued under load;
+       * take the rest of the backlog now rather than paying a main loop
+       * iteration and a fresh set of accept sources for each of them. */
+      for (i = 1; i < G_SOCKET_SERVICE_ACCEPT_BATCH && get_active (service); i++)
+        {
+          GSocket *socket;
+
+          socket = g_socket_listener_accept_socket_nonblocking (listener, &source_object, NULL);
+          if (socket == NULL)
+            break;
+
+          connection = g_socket_connection_factory_create_connection (socket);
+          g_object_unref (socket);
+
+          g_socket_service_incoming (service, connection, source_object);
+          g_object_unref (connection);
+        }
     }
 
   G_LOCK (active);
@@ -0,0 +1,86 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Wire protocol between GIO and gio-spawn-server. Both ends always run on
+ * the same machine, so everything is in host byte order.
+ *
+ * A request is a #GSpawnServerRequest, with the file descriptors to pass to
+ * the child attached as `SCM_RIGHTS`, followed by @payload_len bytes:
+ *
+ *  - @n_fds `int32_t` target file descriptor numbers, one per passed fd;
+ *  - the nul-terminated path of the program to execute;
+ *  - the nul-terminated working directory, empty to keep the server’s;
+ *  - @n_argv nul-terminated arguments;
+ *  - @n_envp nul-terminated `NAME=value` environment entries.
+ *
+ * The server answers each request with a #GSpawnServerReply.
+ */
+
+#define G_SPAWN_SERVER_MAGIC 0x47535331u /* "GSS1" */
+#define G_SPAWN_SERVER_MAX_FDS 253 /* SCM_MAX_FD */
+#define G_SPAWN_SERVER_MAX_PAYLOAD (64 * 1024 * 1024)
+
+typedef struct {
+  uint32_t magic;
+  uint32_t n_fds;
+  uint32_t n_argv;
+  uint32_t n_envp;
+  uint32_t payload_len;
+} GSpawnServerRequest;
+
+typedef enum {
+  G_SPAWN_SERVER_STAGE_OK,
+  G_SPAWN_SERVER_STAGE_FORK,
+  G_SPAWN_SERVER_STAGE_DUP,
+  G_SPAWN_SERVER_STAGE_CHDIR,
+  G_SPAWN_SERVER_STAGE_EXEC,
+  G_SPAWN_SERVER_STAGE_BAD_REQUEST,
+} GSpawnServerStage;
+
+typedef struct {
+  int32_t pid;    /* -1 if no child was created */
+  int32_t stage;  /* a GSpawnServerStage */
+  int32_t errnum; /* errno of the failing stage */
+} GSpawnServerReply;
+
+#ifdef GIO_COMPILATION
+
+#include "gio.h"
+
+G_BEGIN_DECLS
+
+gboolean _g_spawn_server_spawn (const gchar         *working_directory,
+                                const gchar         *program,
+                                const gchar * const *argv,
+                                const gchar * const *envp,
+                                const gint          *source_fds,
+                                const gint          *target_fds,
+                                gsize                n_fds,
+                                GPid                *child_pid,
+                                GError             **error);
+
+G_END_DECLS
+
+#endif /* GIO_COMPILATION */
@@ -0,0 +1,411 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gspawnserver-private.h"
+#include "gsocket.h"
+#include "gunixfdlist.h"
+#include "gunixfdmessage.h"
+#include "glibintl.h"
+#include "glib-private.h"
+#include "glib/gspawn-private.h"
+
+#ifdef __linux__
+
+/* The spawn server is shared by the whole process and started on first use.
+ * Requests are strictly sequential; the lock is held for the round trip,
+ * which only lasts until the child has called exec(). */
+static GMutex server_lock;
+static GSocket *server_socket = NULL;
+static GPid server_pid = 0;
+static gboolean server_unavailable = FALSE;
+
+static const gchar *
+get_server_path (void)
+{
+  const gchar *path = NULL;
+
+  /* Allow test suite to specify path to gio-spawn-server */
+  if (!GLIB_PRIVATE_CALL (g_check_setuid) ())
+    path = g_getenv ("GIO_SPAWN_SERVER");
+
+  /* Allow build system to specify path to gio-spawn-server */
+  if (path == NULL && g_file_test (GIO_SPAWN_SERVER, G_FILE_TEST_IS_EXECUTABLE))
+    path = GIO_SPAWN_SERVER;
+
+  return path;
+}
+
+static void
+server_stop_locked (void)
+{
+  g_clear_object (&server_socket);
+
+  /* The server exits as soon as it sees its socket close. */
+  if (server_pid != 0)
+    {
+      while (waitpid (server_pid, NULL, 0) < 0 && errno == EINTR)
+        ;
+      g_spawn_close_pid (server_pid);
+      server_pid = 0;
+    }
+}
+
+static gboolean
+server_ensure_locked (void)
+{
+  const gchar *path;
+  const gchar *argv[3];
+  gint sv[2];
+  gint target_fd = 3;
+  GError *local_error = NULL;
+
+  if (server_socket != NULL)
+    return TRUE;
+
+  if (server_unavailable)
+    return FALSE;
+
+  path = get_server_path ();
+  if (path == NULL)
+    {
+      server_unavailable = TRUE;
+      return FALSE;
+    }
+
+  if (socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) < 0)
+    return FALSE;
+
+  argv[0] = path;
+  argv[1] = "3";
+  argv[2] = NULL;
+
+  if (!g_spawn_async_with_pipes_and_fds (NULL, argv, NULL,
+                                         G_SPAWN_DO_NOT_REAP_CHILD |
+                                         G_SPAWN_STDIN_FROM_DEV_NULL,
+                                         NULL, NULL,
+                                         -1, -1, -1,
+                                         &sv[1], &target_fd, 1,
+                                         &server_pid,
+                                         NULL, NULL, NULL,
+                                         &local_error))
+    {
+      g_debug ("Failed to start spawn server %s: %s", path, local_error->message);
+      g_clear_error (&local_error);
+      close (sv[0]);
+      close (sv[1]);
+      server_unavailable = TRUE;
+      return FALSE;
+    }
+
+  close (sv[1]);
+
+  server_socket = g_socket_new_from_fd (sv[0], &local_error);
+  if (server_socket == NULL)
+    {
+      g_debug ("Failed to wrap spawn server socket: %s", local_error->message);
+      g_clear_error (&local_error);
+      close (sv[0]);
+      server_stop_locked ();
+      server_unavailable = TRUE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+server_send_locked (const GSpawnServerRequest  *req,
+                    const GByteArray           *payload,
+                    GUnixFDList                *fd_list,
+                    GError                    **error)
+{
+  GSocketControlMessage *message;
+  GOutputVector vectors[2];
+  gsize total, sent;
+  gssize res;
+
+  vectors[0].buffer = req;
+  vectors[0].size = sizeof *req;
+  vectors[1].buffer = payload->data;
+  vectors[1].size = payload->len;
+  total = vectors[0].size + vectors[1].size;
+
+  message = g_unix_fd_message_new_with_fd_list (fd_list);
+  res = g_socket_send_message (server_socket, NULL, vectors, 2,
+                               &message, 1, G_SOCKET_MSG_NONE,
+                               NULL, error);
+  g_object_unref (message);
+  if (res < 0)
+    return FALSE;
+
+  /* A large environment may not fit in the socket buffer in one go. */
+  for (sent = res; sent < total; sent += res)
+    {
+      const guint8 *p;
+      gsize remaining;
+
+      if (sent < sizeof *req)
+        {
+          p = (const guint8 *) req + sent;
+          remaining = sizeof *req - sent;
+        }
+      else
+        {
+          p = payload->data + (sent - sizeof *req);
+          remaining = total - sent;
+        }
+
+      res = g_socket_send (server_socket, (const gchar *) p, remaining, NULL, error);
+      if (res < 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+server_receive_locked (GSpawnServerReply  *reply,
+                       GError            **error)
+{
+  gsize received = 0;
+
+  while (received < sizeof *reply)
+    {
+      gssize res;
+
+      res = g_socket_receive (server_socket,
+                              (gchar *) reply + received,
+                              sizeof *reply - received,
+                              NULL, error);
+      if (res < 0)
+        return FALSE;
+      if (res == 0)
+        {
+          g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CONNECTION_CLOSED,
+                               _("Connection closed"));
+          return FALSE;
+        }
+
+      received += res;
+    }
+
+  return TRUE;
+}
+
+static void
+append_string (GByteArray  *payload,
+               const gchar *str)
+{
+  g_byte_array_append (payload, (const guint8 *) str, strlen (str) + 1);
+}
+
+#endif /* __linux__ */
+
+/*
+ * _g_spawn_server_spawn:
+ * @working_directory: (nullable): the child’s current working directory,
+ *   or %NULL to use the current working directory of this process
+ * @program: absolute or relative path of the program to execute
+ * @argv: the child’s argument vector
+ * @envp: the child’s environment
+ * @source_fds: file descriptors to pass to the child
+ * @target_fds: the numbers @source_fds should have in the child
+ * @n_fds: the length of @source_fds and @target_fds
+ * @child_pid: (out): return location for the child’s process ID
+ * @error: return location for a #GError
+ *
+ * Starts @program through gio-spawn-server. No PATH lookup is done. Only
+ * the file descriptors in @source_fds are open in the child, so they must
+ * include its stdin, stdout and stderr.
+ *
+ * The child is a direct child of this process, and must be reaped with a
+ * child watch just like one started by g_spawn_async_with_pipes_and_fds()
+ * with %G_SPAWN_DO_NOT_REAP_CHILD.
+ *
+ * If the spawn server cannot be used, %G_IO_ERROR_NOT_SUPPORTED is returned
+ * and the caller should spawn the child itself. Failures of the child
+ * itself are reported with the same #GSpawnError codes as g_spawn_async().
+ *
+ * Returns: %TRUE on success, %FALSE if @error is set
+ */
+gboolean
+_g_spawn_server_spawn (const gchar         *working_directory,
+                       const gchar         *program,
+                       const gchar * const *argv,
+                       const gchar * const *envp,
+                       const gint          *source_fds,
+                       const gint          *target_fds,
+                       gsize                n_fds,
+                       GPid                *child_pid,
+                       GError             **error)
+{
+#ifdef __linux__
+  GSpawnServerRequest req;
+  GSpawnServerReply reply;
+  GByteArray *payload;
+  GUnixFDList *fd_list;
+  gchar **inherited_env = NULL;
+  g_autofree gchar *current_dir = NULL;
+  GError *local_error = NULL;
+  gboolean ok;
+  gsize i;
+
+  if (n_fds > G_SPAWN_SERVER_MAX_FDS)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           "Too many file descriptors for the spawn server");
+      return FALSE;
+    }
+
+  if (envp == NULL)
+    envp = (const gchar * const *) (inherited_env = g_get_environ ());
+
+  fd_list = g_unix_fd_list_new ();
+  for (i = 0; i < n_fds; i++)
+    {
+      if (g_unix_fd_list_append (fd_list, source_fds[i], error) < 0)
+        {
+          g_object_unref (fd_list);
+          g_strfreev (inherited_env);
+          return FALSE;
+        }
+    }
+
+  payload = g_byte_array_new ();
+  for (i = 0; i < n_fds; i++)
+    {
+      gint32 target = target_fds[i];
+
+      g_byte_array_append (payload, (const guint8 *) &target, sizeof target);
+    }
+  append_string (payload, program);
+  /* The server has its own working directory, which is not ours. */
+  if (working_directory == NULL)
+    working_directory = current_dir = g_get_current_dir ();
+  append_string (payload, working_directory);
+
+  req.magic = G_SPAWN_SERVER_MAGIC;
+  req.n_fds = n_fds;
+  req.n_argv = 0;
+  req.n_envp = 0;
+  for (i = 0; argv[i] != NULL; i++, req.n_argv++)
+    append_string (payload, argv[i]);
+  for (i = 0; envp[i] != NULL; i++, req.n_envp++)
+    append_string (payload, envp[i]);
+  req.payload_len = payload->len;
+
+  g_strfreev (inherited_env);
+
+  if (req.payload_len > G_SPAWN_SERVER_MAX_PAYLOAD)
+    {
+      g_byte_array_unref (payload);
+      g_object_unref (fd_list);
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           "Arguments too long for the spawn server");
+      return FALSE;
+    }
+
+  g_mutex_lock (&server_lock);
+
+  ok = server_ensure_locked ();
+  if (ok)
+    {
+      ok = server_send_locked (&req, payload, fd_list, &local_error) &&
+           server_receive_locked (&reply, &local_error);
+      if (!ok)
+        {
+          /* Start a fresh server next time. */
+          g_debug ("Lost connection to spawn server: %s", local_error->message);
+          g_clear_error (&local_error);
+          server_stop_locked ();
+        }
+    }
+
+  g_mutex_unlock (&server_lock);
+
+  g_byte_array_unref (payload);
+  g_object_unref (fd_list);
+
+  if (!ok || reply.stage == G_SPAWN_SERVER_STAGE_BAD_REQUEST)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           "Spawn server not available");
+      return FALSE;
+    }
+
+  if (reply.stage == G_SPAWN_SERVER_STAGE_OK)
+    {
+      *child_pid = reply.pid;
+      return TRUE;
+    }
+
+  /* A child that failed before exec() is still ours to reap. */
+  if (reply.pid > 0)
+    {
+      while (waitpid (reply.pid, NULL, 0) < 0 && errno == EINTR)
+        ;
+    }
+
+  switch (reply.stage)
+    {
+    case G_SPAWN_SERVER_STAGE_CHDIR:
+      g_set_error (error, G_SPAWN_ERROR, G_SPAWN_ERROR_CHDIR,
+                   _("Failed to change to directory “%s” (%s)"),
+                   working_directory, g_strerror (reply.errnum));
+      break;
+
+    case G_SPAWN_SERVER_STAGE_EXEC:
+      g_set_error (error, G_SPAWN_ERROR,
+                   _g_spawn_exec_err_to_g_error (reply.errnum),
+                   _("Failed to execute child process “%s” (%s)"),
+                   argv[0], g_strerror (reply.errnum));
+      break;
+
+    case G_SPAWN_SERVER_STAGE_DUP:
+      g_set_error (error, G_SPAWN_ERROR, G_SPAWN_ERROR_FAILED,
+                   _("Failed to duplicate file descriptor for child process (%s)"),
+                   g_strerror (reply.errnum));
+      break;
+
+    case G_SPAWN_SERVER_STAGE_FORK:
+    default:
+      g_set_error (error, G_SPAWN_ERROR, G_SPAWN_ERROR_FORK,
+                   _("Failed to fork child process (%s)"),
+                   g_strerror (reply.errnum));
+      break;
+    }
+
+  return FALSE;
+#else
+  /* Without CLONE_PARENT the children would not be ours to reap. */
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       "Spawn server not supported on this platform");
+  return FALSE;
+#endif
+}
@@ -89,6 +89,9 @@
 #include "gmemoryinputstream.h"
 #include "glibintl.h"
 #include "glib-private.h"
+#ifdef G_OS_UNIX
+#include "gspawnserver-private.h"
+#endif
 
 #include <string.h>
 #ifdef G_OS_UNIX
@@ -236,6 +239,153 @@ unix_open_file (const char  *filename,
 
   return my_fd;
 }
+
+/* Starts the child through the launcher’s spawn server, mirroring what
+ * g_spawn_async_with_pipes_and_fds() would do with the same arguments.
+ * Returns %FALSE if the server cannot be used, in which case the caller
+ * should spawn the child itself; otherwise @success and @error are set. */
+static gboolean
+spawn_via_server (GSubprocess  *self,
+                  GSpawnFlags   spawn_flags,
+                  gint          stdin_fd,
+                  gint          stdout_fd,
+                  gint          stderr_fd,
+                  gint        **pipe_ptrs,
+                  gboolean     *success,
+                  GError      **error)
+{
+  GSubprocessLauncher *launcher = self->launcher;
+  gint pipes[3][2] = { { -1, -1 }, { -1, -1 }, { -1, -1 } };
+  gint child_fds[3];
+  gint devnull = -1;
+  GArray *source_fds = NULL, *target_fds = NULL;
+  gchar *program = NULL;
+  GError *local_error = NULL;
+  gboolean handled = TRUE;
+  gint i;
+
+  *success = FALSE;
+
+  /* The server does no PATH lookup of its own. */
+  if (spawn_flags & (G_SPAWN_SEARCH_PATH | G_SPAWN_SEARCH_PATH_FROM_ENVP))
+    {
+      const gchar *search_path = NULL;
+
+      if (spawn_flags & G_SPAWN_SEARCH_PATH_FROM_ENVP)
+        search_path = g_environ_getenv (launcher->envp, "PATH");
+      if (search_path == NULL)
+        search_path = g_getenv ("PATH");
+
+      program = g_find_program_for_path (self->argv[0], search_path, launcher->cwd);
+      if (program == NULL)
+        {
+          g_set_error (error, G_SPAWN_ERROR, G_SPAWN_ERROR_NOENT,
+                       _("Failed to execute child process “%s” (%s)"),
+                       self->argv[0], g_strerror (ENOENT));
+          return TRUE;
+        }
+    }
+
+  for (i = 0; i < 3; i++)
+    if (pipe_ptrs[i] != NULL && !g_unix_open_pipe (pipes[i], O_CLOEXEC, error))
+      goto out;
+
+  if ((spawn_flags & (G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL)) ||
+      (pipe_ptrs[0] == NULL && stdin_fd == -1 && !(spawn_flags & G_SPAWN_CHILD_INHERITS_STDIN)))
+    {
+      devnull = unix_open_file ("/dev/null", O_RDWR, error);
+      if (devnull == -1)
+        goto out;
+    }
+
+  if (pipe_ptrs[0] != NULL)
+    child_fds[0] = pipes[0][0];
+  else if (stdin_fd != -1)
+    child_fds[0] = stdin_fd;
+  else if (spawn_flags & G_SPAWN_CHILD_INHERITS_STDIN)
+    child_fds[0] = 0;
+  else
+    child_fds[0] = devnull;
+
+  if (pipe_ptrs[1] != NULL)
+    child_fds[1] = pipes[1][1];
+  else if (spawn_flags & G_SPAWN_STDOUT_TO_DEV_NULL)
+    child_fds[1] = devnull;
+  else if (stdout_fd != -1)
+    child_fds[1] = stdout_fd;
+  else
+    child_fds[1] = 1;
+
+  if (pipe_ptrs[2] != NULL)
+    child_fds[2] = pipes[2][1];
+  else if (spawn_flags & G_SPAWN_STDERR_TO_DEV_NULL)
+    child_fds[2] = devnull;
+  else if (self->flags & G_SUBPROCESS_FLAGS_STDERR_MERGE)
+    child_fds[2] = child_fds[1];
+  else if (stderr_fd != -1)
+    child_fds[2] = stderr_fd;
+  else
+    child_fds[2] = 2;
+
+  source_fds = g_array_new (FALSE, FALSE, sizeof (gint));
+  target_fds = g_array_new (FALSE, FALSE, sizeof (gint));
+  for (i = 0; i < 3; i++)
+    {
+      g_array_append_val (source_fds, child_fds[i]);
+      g_array_append_val (target_fds, i);
+    }
+  g_array_append_vals (source_fds, launcher->source_fds->data, launcher->source_fds->len);
+  g_array_append_vals (target_fds, launcher->target_fds->data, launcher->target_fds->len);
+
+  *success = _g_spawn_server_spawn (launcher->cwd,
+                                    program ? program : self->argv[0],
+                                    (const gchar * const *) self->argv,
+                                    (const gchar * const *) launcher->envp,
+                                    (const gint *) source_fds->data,
+                                    (const gint *) target_fds->data,
+                                    source_fds->len,
+                                    &self->pid,
+                                    &local_error);
+
+  if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+    {
+      g_clear_error (&local_error);
+      handled = FALSE;
+    }
+  else if (local_error != NULL)
+    g_propagate_error (error, local_error);
+
+out:
+  /* Hand the parent’s ends of the pipes out, and close everything else. */
+  for (i = 0; i < 3; i++)
+    {
+      gint parent_end = (i == 0) ? 1 : 0;
+
+      if (pipes[i][0] == -1)
+        continue;
+
+      if (*success)
+        {
+          *pipe_ptrs[i] = pipes[i][parent_end];
+          pipes[i][parent_end] = -1;
+        }
+
+      if (pipes[i][0] != -1)
+        close (pipes[i][0]);
+      if (pipes[i][1] != -1)
+        close (pipes[i][1]);
+    }
+
+  if (devnull != -1)
+    close (devnull);
+  if (source_fds != NULL)
+    g_array_unref (source_fds);
+  if (target_fds != NULL)
+    g_array_unref (target_fds);
+  g_free (program);
+
+  return handled;
+}
 #endif
 
 static void
@@ -304,6 +454,7 @@ initable_init (GInitable     *initable,
   gint stdin_fd = -1, stdout_fd = -1, stderr_fd = -1;
 #endif
   GSpawnFlags spawn_flags = 0;
+  gboolean spawned_via_server = FALSE;
   gboolean success = FALSE;
   gint i;
 
@@ -393,25 +544,38 @@ initable_init (GInitable     *initable,
   spawn_flags |= G_SPAWN_DO_NOT_REAP_CHILD;
   spawn_flags |= G_SPAWN_CLOEXEC_PIPES;
 
-  success = g_spawn_async_with_pipes_and_fds (self->launcher ? self->launcher->cwd : NULL,
-                                              (const gchar * const *) self->argv,
-                                              (const gchar * const *) (self->launcher ? self->launcher->envp : NULL),
-                                              spawn_flags,
 #ifdef G_OS_UNIX
-                                              self->launcher ? self->launcher->child_setup_func : NULL,
-                                              self->launcher ? self->launcher->child_setup_user_data : NULL,
-                                              stdin_fd, stdout_fd, stderr_fd,
-                                              self->launcher ? (const gint *) self->launcher->source_fds->data : NULL,
-                                              self->launcher ? (const gint *) self->launcher->target_fds->data : NULL,
-                                              self->launcher ? self->launcher->source_fds->len : 0,
+  /* The spawn server cannot run child setup functions, and only passes on
+   * the file descriptors it is given. */
+  if (self->launcher != NULL &&
+      self->launcher->use_spawn_server &&
+      self->launcher->child_setup_func == NULL &&
+      !(self->flags & G_SUBPROCESS_FLAGS_INHERIT_FDS))
+    spawned_via_server = spawn_via_server (self, spawn_flags,
+                                           stdin_fd, stdout_fd, stderr_fd,
+                                           pipe_ptrs, &success, error);
+#endif
+
+  if (!spawned_via_server)
+    success = g_spawn_async_with_pipes_and_fds (self->launcher ? self->launcher->cwd : NULL,
+                                                (const gchar * const *) self->argv,
+                                                (const gchar * const *) (self->launcher ? self->launcher->envp : NULL),
+                                                spawn_flags,
+#ifdef G_OS_UNIX
+                                                self->launcher ? self->launcher->child_setup_func : NULL,
+                                                self->launcher ? self->launcher->child_setup_user_data : NULL,
+                                                stdin_fd, stdout_fd, stderr_fd,
+                                                self->launcher ? (const gint *) self->launcher->source_fds->data : NULL,
+                                                self->launcher ? (const gint *) self->launcher->target_fds->data : NULL,
+                                                self->launcher ? self->launcher->source_fds->len : 0,
 #else
-                                              NULL, NULL,
-                                              -1, -1, -1,
-                                              NULL, NULL, 0,
+                                                NULL, NULL,
+                                                -1, -1, -1,
+                                                NULL, NULL, 0,
 #endif
-                                              &self->pid,
-                                              pipe_ptrs[0], pipe_ptrs[1], pipe_ptrs[2],
-                                              error);
+                                                &self->pid,
+                                                pipe_ptrs[0], pipe_ptrs[1], pipe_ptrs[2],
+                                                error);
   g_assert (success == (self->pid != 0));
 
   {
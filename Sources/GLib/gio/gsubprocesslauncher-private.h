@@ -50,6 +50,8 @@ struct _GSubprocessLauncher
   GSpawnChildSetupFunc child_setup_func;
   gpointer child_setup_user_data;
   GDestroyNotify child_setup_destroy_notify;
+
+  gboolean use_spawn_server;
 #endif
 };
 
@@ -715,6 +715,43 @@ g_subprocess_launcher_set_child_setup (GSubprocessLauncher  *self,
   self->child_setup_user_data = user_data;
   self->child_setup_destroy_notify = destroy_notify;
 }
+
+/**
+ * g_subprocess_launcher_set_use_spawn_server:
+ * @self: a #GSubprocessLauncher
+ * @use_spawn_server: whether to launch through the spawn server
+ *
+ * Sets whether processes are launched through a spawn server.
+ *
+ * The spawn server is a small helper process that is started the first
+ * time it is needed and then shared by all launchers in the process. It
+ * starts children on behalf of the application, so launching does not
+ * need to duplicate the application’s address space. This makes launching
+ * many short-lived processes from a large application considerably
+ * cheaper.
+ *
+ * The children are still direct children of the application, and behave
+ * exactly as usual with respect to g_subprocess_wait() and
+ * g_subprocess_send_signal(). However, process state other than the
+ * environment, working directory and file descriptors (such as resource
+ * limits or the signal mask) is inherited from the spawn server, which
+ * captured it when it was started.
+ *
+ * The spawn server is only available on Linux. It is not used if a child
+ * setup function is set or if %G_SUBPROCESS_FLAGS_INHERIT_FDS is given; in
+ * those cases, and whenever the server cannot be started, processes are
+ * launched directly as if this had not been set.
+ *
+ * Since: 2.80
+ */
+void
+g_subprocess_launcher_set_use_spawn_server (GSubprocessLauncher *self,
+                                            gboolean             use_spawn_server)
+{
+  g_return_if_fail (G_IS_SUBPROCESS_LAUNCHER (self));
+
+  self->use_spawn_server = !!use_spawn_server;
+}
 #endif
 
 /**
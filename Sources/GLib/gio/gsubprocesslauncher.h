@@ -114,6 +114,10 @@ void                    g_subprocess_launcher_set_child_setup           (GSubpro
                                                                          GSpawnChildSetupFunc   child_setup,
                                                                          gpointer               user_data,
                                                                          GDestroyNotify         destroy_notify);
+
+GIO_AVAILABLE_IN_2_80
+void                    g_subprocess_launcher_set_use_spawn_server      (GSubprocessLauncher   *self,
+                                                                         gboolean               use_spawn_server);
 #endif
 
 G_END_DECLS
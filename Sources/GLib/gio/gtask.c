@@ -571,6 +571,7 @@ struct _GTask {
 
   GMainContext *context;
   gint64 creation_time;
+  gint64 queue_time;  /* when pushed to its thread pool */
   gint priority;
   GCancellable *cancellable;
 
@@ -601,6 +602,7 @@ struct _GTask {
   guint synchronous : 1;
   guint blocking_other_task : 1;
   guint name_is_static : 1;
+  guint thread_pool : 1;  /* GTaskThreadPool */
 
   GError *error;
   union {
@@ -631,33 +633,62 @@ G_DEFINE_TYPE_WITH_CODE (GTask, g_task, G_TYPE_OBJECT,
                                                 g_task_async_result_iface_init);
                          g_task_thread_pool_init ();)
 
-static GThreadPool *task_pool;
+typedef struct
+{
+  GThreadPool *pool;
+  GSource *manager;
+  gint base_size;
+  gint64 wait_time_base;
+  gboolean grow_on_latency;
+  gint running;
+  gint max_threads;
+  gint64 avg_wait;  /* moving average of the queueing latency */
+
+  /* Statistics, see g_task_get_thread_pool_stats() */
+  guint queued;
+  guint64 n_completed;
+  guint64 total_wait;
+
+  guint max_counter;
+  guint running_counter;
+  guint queued_counter;
+  guint wait_counter;
+} GTaskPool;
+
+/* Indexed by GTaskThreadPool; all protected by task_pool_mutex */
+static GTaskPool task_pools[2];
 static GMutex task_pool_mutex;
 static GPrivate task_private = G_PRIVATE_INIT (NULL);
-static GSource *task_pool_manager;
-static guint64 task_wait_time;
-static gint tasks_running;
-
-static guint task_pool_max_counter;
-static guint tasks_running_counter;
-
-/* When the task pool fills up and blocks, and the program keeps
- * queueing more tasks, we will slowly add more threads to the pool
- * (in case the existing tasks are trying to queue subtasks of their
- * own) until tasks start completing again. These "overflow" threads
- * will only run one task apiece, and then exit, so the pool will
- * eventually get back down to its base size.
- *
- * The base and multiplier below gives us 10 extra threads after about
- * a second of blocking, 30 after 5 seconds, 100 after a minute, and
- * 200 after 20 minutes.
- *
- * We specify maximum pool size of 330 to increase the waiting time up
- * to around 30 minutes.
+
+/* Once every thread of a task pool is busy, we add more threads to the
+ * pool based on how long tasks are kept waiting in its queue. Each pool
+ * has a target latency, which starts out at the base wait time and grows
+ * in proportion to the number of running threads, so that a steady
+ * backlog settles at a bounded number of threads instead of growing
+ * without limit. These "overflow" threads will only run one task apiece,
+ * and then exit, so the pool will eventually get back down to its base
+ * size.
+ *
+ * A thread is added when either:
+ *  - no task has started for the target latency while tasks are queued;
+ *    the running tasks may be blocked on subtasks of their own, or
+ *  - for the I/O pool, the moving average of the time tasks spent queued
+ *    exceeds the target latency; tasks there mostly wait for system
+ *    calls, so more of them in flight means more throughput.
+ *
+ * While everything is blocked, the I/O pool gets 10 extra threads after
+ * about 1.5 seconds, 30 after 8 seconds, 100 after a minute, and 200
+ * after 4 minutes. The target stops growing at 330 threads, from where
+ * one thread is added every 3.3 seconds.
+ *
+ * The CPU pool starts out with one thread per processor and has ten times
+ * the base wait time. Its tasks keep a processor busy, so queueing latency
+ * alone never adds threads to it: that would not make computations finish
+ * sooner. Only tasks which wait on each other get more threads there.
  */
 #define G_TASK_POOL_SIZE 10
 #define G_TASK_WAIT_TIME_BASE 100000
-#define G_TASK_WAIT_TIME_MULTIPLIER 1.03
+#define G_TASK_CPU_WAIT_TIME_BASE 1000000
 #define G_TASK_WAIT_TIME_MAX_POOL_SIZE 330
 
 static void
@@ -1313,6 +1344,106 @@ g_task_get_return_on_cancel (GTask *task)
   return task->return_on_cancel ? TRUE : FALSE;
 }
 
+/**
+ * g_task_set_thread_pool:
+ * @task: the #GTask
+ * @pool: the #GTaskThreadPool to run @task in
+ *
+ * Sets which thread pool g_task_run_in_thread() and
+ * g_task_run_in_thread_sync() will run @task in. The default,
+ * %G_TASK_THREAD_POOL_IO, suits tasks which mostly wait for blocking
+ * system calls. Tasks which mostly keep a processor busy should use
+ * %G_TASK_THREAD_POOL_CPU instead, so that they neither hold up I/O tasks
+ * nor cause more threads to be started than there are processors to run
+ * them.
+ *
+ * This must be called before the task is run in a thread.
+ *
+ * Since: 2.80
+ */
+void
+g_task_set_thread_pool (GTask           *task,
+                        GTaskThreadPool  pool)
+{
+  g_return_if_fail (G_IS_TASK (task));
+  g_return_if_fail (!G_TASK_IS_THREADED (task));
+  g_return_if_fail (pool == G_TASK_THREAD_POOL_IO || pool == G_TASK_THREAD_POOL_CPU);
+
+  task->thread_pool = pool;
+}
+
+/**
+ * g_task_get_thread_pool:
+ * @task: the #GTask
+ *
+ * Gets the thread pool @task runs in. See g_task_set_thread_pool().
+ *
+ * Returns: the #GTaskThreadPool of @task
+ *
+ * Since: 2.80
+ */
+GTaskThreadPool
+g_task_get_thread_pool (GTask *task)
+{
+  g_return_val_if_fail (G_IS_TASK (task), G_TASK_THREAD_POOL_IO);
+
+  return (GTaskThreadPool) task->thread_pool;
+}
+
+/**
+ * g_task_get_thread_pool_stats:
+ * @pool: a #GTaskThreadPool
+ * @n_running: (out) (optional): return location for the number of tasks
+ *   currently running in @pool
+ * @max_threads: (out) (optional): return location for the number of
+ *   threads @pool may currently use
+ * @n_queued: (out) (optional): return location for the number of tasks
+ *   waiting for a thread in @pool
+ * @n_completed: (out) (optional): return location for the number of tasks
+ *   which have finished running in @pool
+ * @total_wait_usec: (out) (optional): return location for the total time,
+ *   in microseconds, that tasks started so far spent waiting for a thread
+ *
+ * Gets statistics about one of the thread pools used by
+ * g_task_run_in_thread(). Dividing the change in @total_wait_usec by the
+ * number of tasks started over the same interval gives the average queueing
+ * latency.
+ *
+ * The same values are also available as `GIO` counters to profilers using
+ * the g_trace API.
+ *
+ * Since: 2.80
+ */
+void
+g_task_get_thread_pool_stats (GTaskThreadPool  pool,
+                              guint           *n_running,
+                              guint           *max_threads,
+                              guint           *n_queued,
+                              guint64         *n_completed,
+                              guint64         *total_wait_usec)
+{
+  GTaskPool *tp;
+
+  g_return_if_fail (pool == G_TASK_THREAD_POOL_IO || pool == G_TASK_THREAD_POOL_CPU);
+
+  /* The pools are created along with the type */
+  g_type_ensure (G_TYPE_TASK);
+  tp = &task_pools[pool];
+
+  g_mutex_lock (&task_pool_mutex);
+  if (n_running != NULL)
+    *n_running = tp->running;
+  if (max_threads != NULL)
+    *max_threads = tp->max_threads;
+  if (n_queued != NULL)
+    *n_queued = tp->queued;
+  if (n_completed != NULL)
+    *n_completed = tp->n_completed;
+  if (total_wait_usec != NULL)
+    *total_wait_usec = tp->total_wait;
+  g_mutex_unlock (&task_pool_mutex);
+}
+
 /**
  * g_task_get_source_tag:
  * @task: a #GTask
@@ -1513,60 +1644,95 @@ g_task_thread_complete (GTask *task)
     g_task_return (task, G_TASK_RETURN_FROM_THREAD);
 }
 
+/* Call with task_pool_mutex held */
+static gint64
+task_pool_target_latency (GTaskPool *tp)
+{
+  gint n = CLAMP (tp->running, tp->base_size, G_TASK_WAIT_TIME_MAX_POOL_SIZE);
+
+  return tp->wait_time_base * n / tp->base_size;
+}
+
+/* Call with task_pool_mutex held */
+static void
+task_pool_grow (GTaskPool *tp)
+{
+  tp->max_threads = tp->running + 1;
+  g_thread_pool_set_max_threads (tp->pool, tp->max_threads, NULL);
+  g_trace_set_int64_counter (tp->max_counter, tp->max_threads);
+}
+
 static gboolean
 task_pool_manager_timeout (gpointer user_data)
 {
+  GTaskPool *tp = user_data;
+
   g_mutex_lock (&task_pool_mutex);
-  g_thread_pool_set_max_threads (task_pool, tasks_running + 1, NULL);
-  g_trace_set_int64_counter (task_pool_max_counter, tasks_running + 1);
-  g_source_set_ready_time (task_pool_manager, -1);
+  /* No task has started for the target latency */
+  if (tp->queued > 0)
+    {
+      task_pool_grow (tp);
+      g_source_set_ready_time (tp->manager, g_get_monotonic_time () +
+                               task_pool_target_latency (tp));
+    }
+  else
+    g_source_set_ready_time (tp->manager, -1);
   g_mutex_unlock (&task_pool_mutex);
 
   return TRUE;
 }
 
 static void
-g_task_thread_setup (void)
+g_task_thread_setup (GTaskPool *tp,
+                     GTask     *task)
 {
+  gint64 now, wait, target;
+
   g_private_set (&task_private, GUINT_TO_POINTER (TRUE));
+  now = g_get_monotonic_time ();
+  wait = MAX (now - task->queue_time, 0);
+
   g_mutex_lock (&task_pool_mutex);
-  tasks_running++;
+  tp->running++;
+  tp->queued--;
+  tp->total_wait += wait;
+  tp->avg_wait += (wait - tp->avg_wait) / 8;
 
-  g_trace_set_int64_counter (tasks_running_counter, tasks_running);
+  g_trace_set_int64_counter (tp->running_counter, tp->running);
+  g_trace_set_int64_counter (tp->queued_counter, tp->queued);
+  g_trace_set_int64_counter (tp->wait_counter, wait);
 
-  if (tasks_running == G_TASK_POOL_SIZE)
-    task_wait_time = G_TASK_WAIT_TIME_BASE;
-  else if (tasks_running > G_TASK_POOL_SIZE && tasks_running < G_TASK_WAIT_TIME_MAX_POOL_SIZE)
-    task_wait_time *= G_TASK_WAIT_TIME_MULTIPLIER;
+  if (tp->running >= tp->max_threads)
+    {
+      target = task_pool_target_latency (tp);
 
-  if (tasks_running >= G_TASK_POOL_SIZE)
-    g_source_set_ready_time (task_pool_manager, g_get_monotonic_time () + task_wait_time);
+      if (tp->grow_on_latency && tp->queued > 0 && tp->avg_wait >= target)
+        task_pool_grow (tp);
+
+      g_source_set_ready_time (tp->manager, now + target);
+    }
 
   g_mutex_unlock (&task_pool_mutex);
 }
 
 static void
-g_task_thread_cleanup (void)
+g_task_thread_cleanup (GTaskPool *tp)
 {
-  gint tasks_pending;
-
   g_mutex_lock (&task_pool_mutex);
-  tasks_pending = g_thread_pool_unprocessed (task_pool);
 
-  if (tasks_running > G_TASK_POOL_SIZE)
+  if (tp->running > tp->base_size)
     {
-      g_thread_pool_set_max_threads (task_pool, tasks_running - 1, NULL);
-      g_trace_set_int64_counter (task_pool_max_counter, tasks_running - 1);
+      tp->max_threads = tp->running - 1;
+      g_thread_pool_set_max_threads (tp->pool, tp->max_threads, NULL);
+      g_trace_set_int64_counter (tp->max_counter, tp->max_threads);
     }
-  else if (tasks_running + tasks_pending < G_TASK_POOL_SIZE)
-    g_source_set_ready_time (task_pool_manager, -1);
+  else if (tp->queued == 0)
+    g_source_set_ready_time (tp->manager, -1);
 
-  if (tasks_running > G_TASK_POOL_SIZE && tasks_running < G_TASK_WAIT_TIME_MAX_POOL_SIZE)
-    task_wait_time /= G_TASK_WAIT_TIME_MULTIPLIER;
+  tp->running--;
+  tp->n_completed++;
 
-  tasks_running--;
-
-  g_trace_set_int64_counter (tasks_running_counter, tasks_running);
+  g_trace_set_int64_counter (tp->running_counter, tp->running);
 
   g_mutex_unlock (&task_pool_mutex);
   g_private_set (&task_private, GUINT_TO_POINTER (FALSE));
@@ -1577,15 +1743,36 @@ g_task_thread_pool_thread (gpointer thread_data,
                            gpointer pool_data)
 {
   GTask *task = thread_data;
+  GTaskPool *tp = pool_data;
 
-  g_task_thread_setup ();
+  g_task_thread_setup (tp, task);
 
   task->task_func (task, task->source_object, task->task_data,
                    task->cancellable);
   g_task_thread_complete (task);
   g_object_unref (task);
 
-  g_task_thread_cleanup ();
+  g_task_thread_cleanup (tp);
+}
+
+static void
+g_task_thread_pool_push (GTask *task)
+{
+  GTaskPool *tp = &task_pools[task->thread_pool];
+
+  task->queue_time = g_get_monotonic_time ();
+
+  g_mutex_lock (&task_pool_mutex);
+  tp->queued++;
+  g_trace_set_int64_counter (tp->queued_counter, tp->queued);
+  /* Start watching for a stall if this task has to wait for a thread */
+  if (tp->running >= tp->max_threads &&
+      g_source_get_ready_time (tp->manager) == -1)
+    g_source_set_ready_time (tp->manager, task->queue_time +
+                             task_pool_target_latency (tp));
+  g_mutex_unlock (&task_pool_mutex);
+
+  g_thread_pool_push (tp->pool, g_object_ref (task), NULL);
 }
 
 static void
@@ -1597,7 +1784,7 @@ task_thread_cancelled (GCancellable *cancellable,
   /* Move this task to the front of the queue - no need for
    * a complete resorting of the queue.
    */
-  g_thread_pool_move_to_front (task_pool, task);
+  g_thread_pool_move_to_front (task_pools[task->thread_pool].pool, task);
 
   g_mutex_lock (&task->lock);
   task->thread_cancelled = TRUE;
@@ -1644,7 +1831,7 @@ g_task_start_task_thread (GTask           *task,
         {
           task->thread_cancelled = task->thread_complete = TRUE;
           TRACE (GIO_TASK_AFTER_RUN_IN_THREAD (task, task->thread_cancelled));
-          g_thread_pool_push (task_pool, g_object_ref (task), NULL);
+          g_task_thread_pool_push (task);
           return;
         }
 
@@ -1665,7 +1852,7 @@ g_task_start_task_thread (GTask           *task,
 
   if (g_private_get (&task_private))
     task->blocking_other_task = TRUE;
-  g_thread_pool_push (task_pool, g_object_ref (task), NULL);
+  g_task_thread_pool_push (task);
 }
 
 /**
@@ -1693,6 +1880,9 @@ g_task_start_task_thread (GTask           *task,
  * separate worker thread or thread pool explicitly, rather than using
  * g_task_run_in_thread().
  *
+ * CPU-bound tasks should be moved out of the default pool with
+ * g_task_set_thread_pool().
+ *
  * Since: 2.36
  */
 void
@@ -2408,19 +2598,37 @@ GSourceFuncs trivial_source_funcs = {
 static void
 g_task_thread_pool_init (void)
 {
-  task_pool = g_thread_pool_new (g_task_thread_pool_thread, NULL,
-                                 G_TASK_POOL_SIZE, FALSE, NULL);
-  g_assert (task_pool != NULL);
+  static const gchar * const manager_names[] = {
+    "GTask thread pool manager",
+    "GTask CPU thread pool manager",
+  };
+  gsize i;
 
-  g_thread_pool_set_sort_function (task_pool, g_task_compare_priority, NULL);
+  task_pools[G_TASK_THREAD_POOL_IO].base_size = G_TASK_POOL_SIZE;
+  task_pools[G_TASK_THREAD_POOL_IO].wait_time_base = G_TASK_WAIT_TIME_BASE;
+  task_pools[G_TASK_THREAD_POOL_IO].grow_on_latency = TRUE;
+  task_pools[G_TASK_THREAD_POOL_CPU].base_size = g_get_num_processors ();
+  task_pools[G_TASK_THREAD_POOL_CPU].wait_time_base = G_TASK_CPU_WAIT_TIME_BASE;
 
-  task_pool_manager = g_source_new (&trivial_source_funcs, sizeof (GSource));
-  g_source_set_static_name (task_pool_manager, "GTask thread pool manager");
-  g_source_set_callback (task_pool_manager, task_pool_manager_timeout, NULL, NULL);
-  g_source_set_ready_time (task_pool_manager, -1);
-  g_source_attach (task_pool_manager,
-                   GLIB_PRIVATE_CALL (g_get_worker_context ()));
-  g_source_unref (task_pool_manager);
+  for (i = 0; i < G_N_ELEMENTS (task_pools); i++)
+    {
+      GTaskPool *tp = &task_pools[i];
+
+      tp->max_threads = tp->base_size;
+      tp->pool = g_thread_pool_new (g_task_thread_pool_thread, tp,
+                                    tp->base_size, FALSE, NULL);
+      g_assert (tp->pool != NULL);
+
+      g_thread_pool_set_sort_function (tp->pool, g_task_compare_priority, NULL);
+
+      tp->manager = g_source_new (&trivial_source_funcs, sizeof (GSource));
+      g_source_set_static_name (tp->manager, manager_names[i]);
+      g_source_set_callback (tp->manager, task_pool_manager_timeout, tp, NULL);
+      g_source_set_ready_time (tp->manager, -1);
+      g_source_attach (tp->manager,
+                       GLIB_PRIVATE_CALL (g_get_worker_context ()));
+      g_source_unref (tp->manager);
+    }
 }
 
 static void
@@ -2469,14 +2677,25 @@ g_task_class_init (GTaskClass *klass)
     g_param_spec_boolean ("completed", NULL, NULL,
                           FALSE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
-  if (G_UNLIKELY (task_pool_max_counter == 0))
+  if (G_UNLIKELY (task_pools[G_TASK_THREAD_POOL_IO].max_counter == 0))
     {
-      /* We use two counters to track characteristics of the GTask thread pool.
+      GTaskPool *io = &task_pools[G_TASK_THREAD_POOL_IO];
+      GTaskPool *cpu = &task_pools[G_TASK_THREAD_POOL_CPU];
+
+      /* We use four counters to track characteristics of each GTask thread pool.
        * task pool max size - the value of g_thread_pool_set_max_threads()
        * tasks running - the number of running threads
+       * tasks queued - the number of tasks waiting for a thread
+       * task queue wait - how long the last task to start waited for a thread
        */
-      task_pool_max_counter = g_trace_define_int64_counter ("GIO", "task pool max size", "Maximum number of threads allowed in the GTask thread pool; see g_thread_pool_set_max_threads()");
-      tasks_running_counter = g_trace_define_int64_counter ("GIO", "tasks running", "Number of currently running tasks in the GTask thread pool");
+      io->max_counter = g_trace_define_int64_counter ("GIO", "task pool max size", "Maximum number of threads allowed in the GTask thread pool; see g_thread_pool_set_max_threads()");
+      io->running_counter = g_trace_define_int64_counter ("GIO", "tasks running", "Number of currently running tasks in the GTask thread pool");
+      io->queued_counter = g_trace_define_int64_counter ("GIO", "tasks queued", "Number of tasks waiting for a thread in the GTask thread pool");
+      io->wait_counter = g_trace_define_int64_counter ("GIO", "task queue wait", "Time in microseconds the last task started in the GTask thread pool spent waiting for a thread");
+      cpu->max_counter = g_trace_define_int64_counter ("GIO", "CPU task pool max size", "Maximum number of threads allowed in the GTask CPU thread pool; see g_thread_pool_set_max_threads()");
+      cpu->running_counter = g_trace_define_int64_counter ("GIO", "CPU tasks running", "Number of currently running tasks in the GTask CPU thread pool");
+      cpu->queued_counter = g_trace_define_int64_counter ("GIO", "CPU tasks queued", "Number of tasks waiting for a thread in the GTask CPU thread pool");
+      cpu->wait_counter = g_trace_define_int64_counter ("GIO", "CPU task queue wait", "Time in microseconds the last task started in the GTask CPU thread pool spent waiting for a thread");
     }
 }
 
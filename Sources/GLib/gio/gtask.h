@@ -143,6 +143,19 @@ gboolean      g_task_set_return_on_cancel (GTask           *task,
 GIO_AVAILABLE_IN_2_36
 gboolean      g_task_get_return_on_cancel (GTask           *task);
 
+GIO_AVAILABLE_IN_2_80
+void            g_task_set_thread_pool       (GTask           *task,
+                                              GTaskThreadPool  pool);
+GIO_AVAILABLE_IN_2_80
+GTaskThreadPool g_task_get_thread_pool       (GTask           *task);
+GIO_AVAILABLE_IN_2_80
+void            g_task_get_thread_pool_stats (GTaskThreadPool  pool,
+                                              guint           *n_running,
+                                              guint           *max_threads,
+                                              guint           *n_queued,
+                                              guint64         *n_completed,
+                                              guint64         *total_wait_usec);
+
 GIO_AVAILABLE_IN_2_36
 void          g_task_attach_source        (GTask           *task,
                                            GSource         *source,
@@ -29,12 +29,14 @@
 
 #define USE_INOTIFY 1
 #include "inotify-helper.h"
+#include "inotify-tree.h"
 
 struct _GInotifyFileMonitor
 {
   GLocalFileMonitor parent_instance;
 
   inotify_sub *sub;
+  InotifyTree *tree;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GInotifyFileMonitor, g_inotify_file_monitor, G_TYPE_LOCAL_FILE_MONITOR,
@@ -65,6 +67,19 @@ g_inotify_file_monitor_start (GLocalFileMonitor  *local_monitor,
   _ih_sub_add (inotify_monitor->sub);
 }
 
+static gboolean
+g_inotify_file_monitor_start_recursive (GLocalFileMonitor   *local_monitor,
+                                        const gchar         *dirname,
+                                        GFileMonitorSource  *source,
+                                        GError             **error)
+{
+  GInotifyFileMonitor *inotify_monitor = G_INOTIFY_FILE_MONITOR (local_monitor);
+
+  inotify_monitor->tree = _it_tree_new (dirname, source, error);
+
+  return inotify_monitor->tree != NULL;
+}
+
 static gboolean
 g_inotify_file_monitor_cancel (GFileMonitor *monitor)
 {
@@ -77,6 +92,8 @@ g_inotify_file_monitor_cancel (GFileMonitor *monitor)
       inotify_monitor->sub = NULL;
     }
 
+  g_clear_pointer (&inotify_monitor->tree, _it_tree_free);
+
   return TRUE;
 }
 
@@ -89,6 +106,7 @@ g_inotify_file_monitor_finalize (GObject *object)
 
   /* must surely have been cancelled already */
   g_assert (!inotify_monitor->sub);
+  g_assert (!inotify_monitor->tree);
 
   G_OBJECT_CLASS (g_inotify_file_monitor_parent_class)->finalize (object);
 }
@@ -108,6 +126,7 @@ g_inotify_file_monitor_class_init (GInotifyFileMonitorClass* klass)
   local_file_monitor_class->is_supported = g_inotify_file_monitor_is_supported;
   local_file_monitor_class->start = g_inotify_file_monitor_start;
   local_file_monitor_class->mount_notify = TRUE;
+  local_file_monitor_class->start_recursive = g_inotify_file_monitor_start_recursive;
   file_monitor_class->cancel = g_inotify_file_monitor_cancel;
 
   gobject_class->finalize = g_inotify_file_monitor_finalize;
@@ -40,6 +40,12 @@
 /* From inotify(7) */
 #define MAX_EVENT_SIZE       (sizeof(struct inotify_event) + NAME_MAX + 1)
 
+/* Initial size of the buffer that events are read into.  This is large
+ * enough to drain the default kernel queue (16384 events without names)
+ * in a few reads when a burst of activity happens.
+ */
+#define READ_BUFFER_SIZE     (64 * 1024)
+
 /* Amount of time to sleep on receipt of uninteresting events */
 #define BOREDOM_SLEEP_TIME   (100 * G_TIME_SPAN_MILLISECOND)
 
@@ -57,23 +63,44 @@
  */
 G_LOCK_EXTERN (inotify_lock);
 
-static ik_event_t *
-ik_event_new (struct inotify_event *kevent,
-              gint64                now)
+/* Fills in @event from @kevent.  The name is not copied: it points
+ * into the read buffer.
+ */
+static void
+ik_event_init (ik_event_t           *event,
+               struct inotify_event *kevent,
+               gint64                now)
 {
-  ik_event_t *event = g_new0 (ik_event_t, 1);
+  memset (event, 0, sizeof (ik_event_t));
 
   event->wd = kevent->wd;
   event->mask = kevent->mask;
   event->cookie = kevent->cookie;
   event->len = kevent->len;
   event->timestamp = now;
-  if (event->len)
-    event->name = g_strdup (kevent->name);
-  else
-    event->name = NULL;
+  event->name = event->len && kevent->name[0] ? kevent->name : NULL;
+}
+
+/* Copies @event, and its name, in a single allocation, so that it can
+ * outlive the read buffer.
+ */
+static ik_event_t *
+ik_event_copy (const ik_event_t *event)
+{
+  gsize name_len;
+  ik_event_t *copy;
+
+  name_len = event->name ? strlen (event->name) + 1 : 0;
+  copy = g_malloc (sizeof (ik_event_t) + name_len);
+  memcpy (copy, event, sizeof (ik_event_t));
+
+  if (event->name)
+    {
+      copy->name = (char *) (copy + 1);
+      memcpy (copy->name, event->name, name_len);
+    }
 
-  return event;
+  return copy;
 }
 
 void
@@ -85,7 +112,6 @@ _ik_event_free (ik_event_t *event)
       _ik_event_free (event->pair);
     }
 
-  g_free (event->name);
   g_free (event);
 }
 
@@ -99,6 +125,9 @@ typedef struct
 
   GHashTable *unmatched_moves;
   gboolean    is_bored;
+
+  gchar      *buffer;
+  gsize       buffer_size;
 } InotifyKernelSource;
 
 static InotifyKernelSource *inotify_source;
@@ -165,22 +194,18 @@ again:
   return result;
 }
 
-static gchar *
-ik_source_read_all_the_events (InotifyKernelSource *iks,
-                               gchar               *buffer,
-                               gsize                buffer_len,
-                               gsize               *length_out)
+static gsize
+ik_source_read_all_the_events (InotifyKernelSource *iks)
 {
   gsize n_read;
 
-  n_read = ik_source_read_some_events (iks, buffer, buffer_len);
+  n_read = ik_source_read_some_events (iks, iks->buffer, iks->buffer_size);
 
   /* Check if we might have gotten another event if we had passed in a
    * bigger buffer...
    */
-  if (n_read + MAX_EVENT_SIZE > buffer_len)
+  if (n_read + MAX_EVENT_SIZE > iks->buffer_size)
     {
-      gchar *new_buffer;
       guint n_readable;
       gint result;
       int errsv;
@@ -193,14 +218,13 @@ ik_source_read_all_the_events (InotifyKernelSource *iks,
 
       if (n_readable != 0)
         {
-          /* there is in fact more data.  allocate a new buffer, copy
-           * the existing data, and then append the remaining.
+          /* there is in fact more data.  grow the buffer, keeping the
+           * existing data, and then append the remaining.  The buffer
+           * stays at its new size, for the next burst of events.
            */
-          new_buffer = g_malloc (n_read + n_readable);
-          memcpy (new_buffer, buffer, n_read);
-          n_read += ik_source_read_some_events (iks, new_buffer + n_read, n_readable);
-
-          buffer = new_buffer;
+          iks->buffer_size = MAX (iks->buffer_size * 2, n_read + n_readable);
+          iks->buffer = g_realloc (iks->buffer, iks->buffer_size);
+          n_read += ik_source_read_some_events (iks, iks->buffer + n_read, iks->buffer_size - n_read);
 
           /* There may be new events in the buffer that were added after
            * the FIONREAD was performed, but we can't risk getting into
@@ -209,9 +233,22 @@ ik_source_read_all_the_events (InotifyKernelSource *iks,
         }
     }
 
-  *length_out = n_read;
+  return n_read;
+}
+
+static gboolean
+ik_source_deliver (ik_event_t *event,
+                   gboolean  (*user_callback) (ik_event_t *event))
+{
+  gboolean interesting;
+
+  G_LOCK (inotify_lock);
+
+  interesting = (* user_callback) (event);
+
+  G_UNLOCK (inotify_lock);
 
-  return buffer;
+  return interesting;
 }
 
 static gboolean
@@ -228,9 +265,7 @@ ik_source_dispatch (GSource     *source,
 
   if (iks->is_bored || g_source_query_unix_fd (source, iks->fd_tag))
     {
-      gchar stack_buffer[4096];
       gsize buffer_len;
-      gchar *buffer;
       gsize offset;
 
       /* We want to read all of the available events.
@@ -239,29 +274,35 @@ ik_source_dispatch (GSource     *source,
        * get caught in a loop of read() with another process
        * continuously adding events each time we drain them.
        *
-       * In the normal case we will have only a few events in the queue,
-       * so start out by reading into a small stack-allocated buffer.
-       * Even though we're on a fresh stack frame, there is no need to
-       * pointlessly blow up with the size of the worker thread stack
-       * with a huge buffer here.
-       *
+       * We read into a buffer that is kept for the lifetime of the
+       * source, and which is large enough to hold a burst of events.
        * If the result is large enough to cause us to suspect that
-       * another event may be pending then we allocate a buffer on the
-       * heap that can hold all of the events and read (once!) into that
-       * buffer.
+       * another event may be pending then we grow the buffer so that it
+       * can hold all of the events and read (once!) into the rest of it.
        */
-      buffer = ik_source_read_all_the_events (iks, stack_buffer, sizeof stack_buffer, &buffer_len);
+      buffer_len = ik_source_read_all_the_events (iks);
 
       offset = 0;
 
       while (offset < buffer_len)
         {
-          struct inotify_event *kevent = (struct inotify_event *) (buffer + offset);
-          ik_event_t *event;
+          struct inotify_event *kevent = (struct inotify_event *) (iks->buffer + offset);
+          ik_event_t parsed, *event;
+
+          ik_event_init (&parsed, kevent, now);
 
-          event = ik_event_new (kevent, now);
+          offset += sizeof (struct inotify_event) + parsed.len;
+
+          /* Most events can be delivered straight from the buffer, as
+           * long as nothing is waiting ahead of them for its move pair.
+           */
+          if (iks->queue.length == 0 && !(parsed.mask & IN_MOVE))
+            {
+              interesting |= ik_source_deliver (&parsed, user_callback);
+              continue;
+            }
 
-          offset += sizeof (struct inotify_event) + event->len;
+          event = ik_event_copy (&parsed);
 
           if (event->mask & IN_MOVED_TO)
             {
@@ -307,26 +348,20 @@ ik_source_dispatch (GSource     *source,
           g_assert (iks->is_bored);
           interesting = TRUE;
         }
-
-      if (buffer != stack_buffer)
-        g_free (buffer);
     }
 
   while (ik_source_can_dispatch_now (iks, now))
     {
       ik_event_t *event;
 
-      /* callback will free the event */
       event = g_queue_pop_head (&iks->queue);
 
       if (event->mask & IN_MOVED_FROM && !event->pair)
         g_hash_table_remove (iks->unmatched_moves, GUINT_TO_POINTER (event->cookie));
 
-      G_LOCK (inotify_lock);
-
-      interesting |= (* user_callback) (event);
+      interesting |= ik_source_deliver (event, user_callback);
 
-      G_UNLOCK (inotify_lock);
+      _ik_event_free (event);
     }
 
   /* The queue gets blocked iff we have unmatched moves */
@@ -385,6 +420,8 @@ ik_source_new (gboolean (* callback) (ik_event_t *event))
   g_source_set_static_name (source, "inotify kernel source");
 
   iks->unmatched_moves = g_hash_table_new (NULL, NULL);
+  iks->buffer_size = READ_BUFFER_SIZE;
+  iks->buffer = g_malloc (iks->buffer_size);
   iks->fd = inotify_init1 (IN_CLOEXEC | IN_NONBLOCK);
 
   if (iks->fd < 0)
@@ -536,10 +536,7 @@ ip_event_callback (ik_event_t *event)
   /* We can ignore the IGNORED events. Likewise, if the event queue overflowed,
    * there is not much we can do to recover. */
   if (event->mask & (IN_IGNORED | IN_Q_OVERFLOW))
-    {
-      _ik_event_free (event);
-      return TRUE;
-    }
+    return TRUE;
 
   dir_list = g_hash_table_lookup (wd_dir_hash, GINT_TO_POINTER (event->wd));
   file_list = g_hash_table_lookup (wd_file_hash, GINT_TO_POINTER (event->wd));
@@ -570,8 +567,6 @@ ip_event_callback (ik_event_t *event)
       /* Unmap all directories attached to this wd */
       ip_unmap_wd (event->wd);
     }
-  
-  _ik_event_free (event);
 
   return interesting;
 }
@@ -0,0 +1,790 @@
+/*
+   Copyright © 2023 GNOME Foundation Inc.
+
+   SPDX-License-Identifier: LGPL-2.1-or-later
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Recursive monitoring of a directory tree.
+ *
+ * Where the kernel lets us, this is done with a single fanotify mark on
+ * the filesystem containing the tree, reporting the parent directory
+ * handle and entry name of each change; events outside the tree are
+ * dropped after resolving the handle.  Filesystem marks need
+ * CAP_SYS_ADMIN, so for ordinary processes we fall back to one inotify
+ * watch per directory on a private inotify instance.  The initial walk
+ * for that is spread over a small thread pool, since on large trees it
+ * is dominated by the latency of opendir() and inotify_add_watch().
+ *
+ * Either way, children are reported to the GFileMonitorSource as paths
+ * relative to the monitored directory.
+ */
+
+#include "config.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#if defined (HAVE_SYS_FANOTIFY_H)
+#include <sys/fanotify.h>
+#endif
+
+#include <glib/glib.h>
+#include <glib/glib-unix.h>
+
+#include "inotify-tree.h"
+#include "gio/gioerror.h"
+#include "glibintl.h"
+#include "glib-private.h"
+
+#if defined (HAVE_SYS_FANOTIFY_H) && defined (FAN_REPORT_DFID_NAME)
+#define USE_FANOTIFY 1
+#endif
+
+#define READ_BUFFER_SIZE         65536
+#define MAX_READS_PER_DISPATCH   16
+#define MAX_HANDLE_CACHE_SIZE    65536
+#define MAX_WALK_THREADS         8
+
+#define IT_WATCH_MASK (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | \
+                       IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE | \
+                       IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | \
+                       IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK)
+
+struct _InotifyTree
+{
+  GSource             source;
+
+  GFileMonitorSource *fms;
+  gchar              *root;
+  gsize               root_len;
+
+  gint                fd;
+  gpointer            fd_tag;
+  gboolean            is_fanotify;
+
+  guint8             *buffer;
+
+  /* inotify: wd → path relative to root ("" for the root itself) */
+  GMutex              lock;
+  GHashTable         *wd_paths;
+
+  /* fanotify: file handle → absolute path ("" if not resolvable) */
+  gint                mount_fd;
+  GHashTable         *handle_paths;
+
+  /* initial parallel walk */
+  GThreadPool        *walk_pool;
+  gint                walk_pending;
+  GCond               walk_cond;
+};
+
+static void
+it_tree_report (InotifyTree       *tree,
+                GFileMonitorEvent  event,
+                const gchar       *child,
+                const gchar       *rename_to)
+{
+  g_file_monitor_source_handle_event (tree->fms, event, child, rename_to, NULL, g_get_monotonic_time ());
+}
+
+/* inotify {{{1 */
+
+static gchar *
+it_tree_join (const gchar *dir,
+              const gchar *name)
+{
+  if (dir[0] == '\0')
+    return g_strdup (name);
+
+  return g_strconcat (dir, "/", name, NULL);
+}
+
+static gint
+it_tree_add_watch (InotifyTree *tree,
+                   const gchar *relpath)
+{
+  gchar *path;
+  gint wd;
+
+  path = relpath[0] ? g_build_filename (tree->root, relpath, NULL) : g_strdup (tree->root);
+  wd = inotify_add_watch (tree->fd, path, IT_WATCH_MASK);
+  g_free (path);
+
+  if (wd >= 0)
+    {
+      g_mutex_lock (&tree->lock);
+      g_hash_table_replace (tree->wd_paths, GINT_TO_POINTER (wd), g_strdup (relpath));
+      g_mutex_unlock (&tree->lock);
+    }
+
+  return wd;
+}
+
+/* Watches @relpath and scans it for subdirectories.  These are handed to
+ * the walk pool if there is one, or walked directly otherwise.  Every
+ * entry found is appended to @found, if given.
+ */
+static void
+it_tree_walk (InotifyTree *tree,
+              const gchar *relpath,
+              GPtrArray   *found)
+{
+  struct dirent *entry;
+  gchar *path;
+  DIR *dir;
+  int dfd;
+
+  /* Watch before reading, so nothing created meanwhile is missed */
+  if (it_tree_add_watch (tree, relpath) < 0)
+    return;
+
+  path = relpath[0] ? g_build_filename (tree->root, relpath, NULL) : g_strdup (tree->root);
+  dir = opendir (path);
+  g_free (path);
+
+  if (dir == NULL)
+    return;
+
+  dfd = dirfd (dir);
+
+  while ((entry = readdir (dir)) != NULL)
+    {
+      gboolean is_dir;
+      gchar *child;
+
+      if (g_str_equal (entry->d_name, ".") || g_str_equal (entry->d_name, ".."))
+        continue;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+      if (entry->d_type != DT_UNKNOWN)
+        is_dir = entry->d_type == DT_DIR;
+      else
+#endif
+        {
+          struct stat buf;
+
+          is_dir = fstatat (dfd, entry->d_name, &buf, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR (buf.st_mode);
+        }
+
+      if (found == NULL && !is_dir)
+        continue;
+
+      child = it_tree_join (relpath, entry->d_name);
+
+      if (found)
+        g_ptr_array_add (found, g_strdup (child));
+
+      if (!is_dir)
+        g_free (child);
+      else if (tree->walk_pool)
+        {
+          g_atomic_int_inc (&tree->walk_pending);
+          g_thread_pool_push (tree->walk_pool, child, NULL);
+        }
+      else
+        {
+          it_tree_walk (tree, child, found);
+          g_free (child);
+        }
+    }
+
+  closedir (dir);
+}
+
+static void
+it_tree_walk_func (gpointer data,
+                   gpointer user_data)
+{
+  InotifyTree *tree = user_data;
+  gchar *relpath = data;
+
+  it_tree_walk (tree, relpath, NULL);
+  g_free (relpath);
+
+  if (g_atomic_int_dec_and_test (&tree->walk_pending))
+    {
+      g_mutex_lock (&tree->lock);
+      g_cond_signal (&tree->walk_cond);
+      g_mutex_unlock (&tree->lock);
+    }
+}
+
+static void
+it_tree_walk_parallel (InotifyTree *tree)
+{
+  gint n_threads;
+
+  n_threads = CLAMP (g_get_num_processors (), 1, MAX_WALK_THREADS);
+  tree->walk_pool = g_thread_pool_new (it_tree_walk_func, tree, n_threads, FALSE, NULL);
+
+  g_atomic_int_set (&tree->walk_pending, 1);
+  g_thread_pool_push (tree->walk_pool, g_strdup (""), NULL);
+
+  g_mutex_lock (&tree->lock);
+  while (g_atomic_int_get (&tree->walk_pending) > 0)
+    g_cond_wait (&tree->walk_cond, &tree->lock);
+  g_mutex_unlock (&tree->lock);
+
+  g_thread_pool_free (tree->walk_pool, FALSE, TRUE);
+  tree->walk_pool = NULL;
+}
+
+static gboolean
+it_path_has_prefix (const gchar *path,
+                    const gchar *prefix,
+                    gsize        prefix_len)
+{
+  return strncmp (path, prefix, prefix_len) == 0 && (path[prefix_len] == '\0' || path[prefix_len] == '/');
+}
+
+/* Stops watching @relpath and everything below it */
+static void
+it_tree_unwatch (InotifyTree *tree,
+                 const gchar *relpath)
+{
+  gsize len = strlen (relpath);
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_hash_table_iter_init (&iter, tree->wd_paths);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    if (it_path_has_prefix (value, relpath, len))
+      {
+        inotify_rm_watch (tree->fd, GPOINTER_TO_INT (key));
+        g_hash_table_iter_remove (&iter);
+      }
+}
+
+/* Rewrites the paths of @from and everything below it to live under @to */
+static void
+it_tree_rename (InotifyTree *tree,
+                const gchar *from,
+                const gchar *to)
+{
+  gsize len = strlen (from);
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, tree->wd_paths);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    if (it_path_has_prefix (value, from, len))
+      {
+        gchar *path = g_strconcat (to, (gchar *) value + len, NULL);
+        g_hash_table_iter_replace (&iter, path);
+      }
+}
+
+static void
+it_tree_add_subtree (InotifyTree       *tree,
+                     const gchar       *relpath,
+                     gboolean           report)
+{
+  GPtrArray *found = NULL;
+
+  if (report)
+    found = g_ptr_array_new_with_free_func (g_free);
+
+  it_tree_walk (tree, relpath, found);
+
+  if (found)
+    {
+      guint i;
+
+      for (i = 0; i < found->len; i++)
+        it_tree_report (tree, G_FILE_MONITOR_EVENT_CREATED, found->pdata[i], NULL);
+
+      g_ptr_array_unref (found);
+    }
+}
+
+static void
+it_tree_handle_inotify_event (InotifyTree                *tree,
+                              const struct inotify_event *event,
+                              const struct inotify_event *pair)
+{
+  gboolean is_dir = (event->mask & IN_ISDIR) != 0;
+  const gchar *dir;
+  gchar *child;
+
+  if (event->mask & IN_Q_OVERFLOW)
+    {
+      g_warning ("Recursive monitor for %s overflowed; events were lost", tree->root);
+      return;
+    }
+
+  dir = g_hash_table_lookup (tree->wd_paths, GINT_TO_POINTER (event->wd));
+  if (dir == NULL)
+    return;
+
+  if (event->mask & IN_IGNORED)
+    {
+      g_hash_table_remove (tree->wd_paths, GINT_TO_POINTER (event->wd));
+      return;
+    }
+
+  /* Changes to subdirectories themselves are reported by their parent */
+  if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+    {
+      if (dir[0] == '\0')
+        it_tree_report (tree, G_FILE_MONITOR_EVENT_DELETED, NULL, NULL);
+      return;
+    }
+
+  if (event->len == 0)
+    return;
+
+  child = it_tree_join (dir, event->name);
+
+  if (event->mask & IN_MOVED_FROM)
+    {
+      if (pair != NULL)
+        {
+          const gchar *pair_dir = g_hash_table_lookup (tree->wd_paths, GINT_TO_POINTER (pair->wd));
+          gchar *rename_to = it_tree_join (pair_dir, pair->name);
+
+          if (is_dir)
+            it_tree_rename (tree, child, rename_to);
+
+          it_tree_report (tree, G_FILE_MONITOR_EVENT_RENAMED, child, rename_to);
+          g_free (rename_to);
+        }
+      else
+        {
+          if (is_dir)
+            it_tree_unwatch (tree, child);
+
+          it_tree_report (tree, G_FILE_MONITOR_EVENT_MOVED_OUT, child, NULL);
+        }
+    }
+  else if (event->mask & IN_MOVED_TO)
+    {
+      it_tree_report (tree, G_FILE_MONITOR_EVENT_MOVED_IN, child, NULL);
+
+      if (is_dir)
+        it_tree_add_subtree (tree, child, FALSE);
+    }
+  else if (event->mask & IN_CREATE)
+    {
+      it_tree_report (tree, G_FILE_MONITOR_EVENT_CREATED, child, NULL);
+
+      if (is_dir)
+        it_tree_add_subtree (tree, child, TRUE);
+      else
+        it_tree_report (tree, G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT, child, NULL);
+    }
+  else if (event->mask & IN_DELETE)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_DELETED, child, NULL);
+  else if (event->mask & IN_MODIFY)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_CHANGED, child, NULL);
+  else if (event->mask & IN_ATTRIB)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED, child, NULL);
+  else if (event->mask & IN_CLOSE_WRITE)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT, child, NULL);
+
+  g_free (child);
+}
+
+static void
+it_tree_dispatch_inotify (InotifyTree *tree,
+                          gssize       len)
+{
+  GHashTable *moves_to = NULL;
+  GHashTable *paired = NULL;
+  gssize offset;
+
+  /* Pair up the two halves of moves that happened within the tree.  The
+   * kernel queues them back-to-back, so they nearly always arrive in the
+   * same read.
+   */
+  for (offset = 0; offset < len; )
+    {
+      const struct inotify_event *event = (const struct inotify_event *) (tree->buffer + offset);
+
+      if ((event->mask & IN_MOVED_TO) && event->cookie != 0)
+        {
+          if (moves_to == NULL)
+            {
+              moves_to = g_hash_table_new (NULL, NULL);
+              paired = g_hash_table_new (NULL, NULL);
+            }
+
+          g_hash_table_insert (moves_to, GUINT_TO_POINTER (event->cookie), (gpointer) event);
+        }
+
+      offset += sizeof (struct inotify_event) + event->len;
+    }
+
+  for (offset = 0; offset < len; )
+    {
+      const struct inotify_event *event = (const struct inotify_event *) (tree->buffer + offset);
+      const struct inotify_event *pair = NULL;
+
+      offset += sizeof (struct inotify_event) + event->len;
+
+      if (moves_to && (event->mask & IN_MOVED_FROM))
+        {
+          pair = g_hash_table_lookup (moves_to, GUINT_TO_POINTER (event->cookie));
+
+          if (pair && g_hash_table_contains (tree->wd_paths, GINT_TO_POINTER (pair->wd)))
+            g_hash_table_add (paired, (gpointer) pair);
+          else
+            pair = NULL;
+        }
+      else if (paired && g_hash_table_contains (paired, event))
+        continue; /* already reported with its MOVED_FROM */
+
+      it_tree_handle_inotify_event (tree, event, pair);
+    }
+
+  if (moves_to)
+    {
+      g_hash_table_unref (moves_to);
+      g_hash_table_unref (paired);
+    }
+}
+
+/* fanotify {{{1 */
+
+#ifdef USE_FANOTIFY
+
+static const gchar *
+it_tree_resolve_handle (InotifyTree       *tree,
+                        struct file_handle *handle)
+{
+  gsize handle_size = sizeof (struct file_handle) + handle->handle_bytes;
+  GBytes *key;
+  gchar *path;
+  int fd;
+
+  key = g_bytes_new_static (handle, handle_size);
+  path = g_hash_table_lookup (tree->handle_paths, key);
+  g_bytes_unref (key);
+
+  if (path)
+    return path;
+
+  fd = open_by_handle_at (tree->mount_fd, handle, O_PATH | O_CLOEXEC);
+  if (fd >= 0)
+    {
+      gchar *proc_path = g_strdup_printf ("/proc/self/fd/%d", fd);
+      path = g_file_read_link (proc_path, NULL);
+      g_free (proc_path);
+      close (fd);
+    }
+
+  /* Deleted directories get " (deleted)" appended; nothing to report */
+  if (path == NULL || g_str_has_suffix (path, " (deleted)"))
+    {
+      g_free (path);
+      path = g_strdup ("");
+    }
+
+  if (g_hash_table_size (tree->handle_paths) >= MAX_HANDLE_CACHE_SIZE)
+    g_hash_table_remove_all (tree->handle_paths);
+
+  g_hash_table_insert (tree->handle_paths, g_bytes_new (handle, handle_size), path);
+
+  return path;
+}
+
+static void
+it_tree_handle_fanotify_event (InotifyTree        *tree,
+                               guint64             mask,
+                               struct file_handle *handle,
+                               const gchar        *name)
+{
+  const gchar *dir;
+  const gchar *child;
+  gchar *full;
+
+  dir = it_tree_resolve_handle (tree, handle);
+  if (dir[0] == '\0')
+    full = NULL;
+  else if (name[0] == '\0' || g_str_equal (name, "."))
+    full = g_strdup (dir);
+  else
+    full = g_build_filename (dir, name, NULL);
+
+  /* Directories moved or deleted invalidate the cached paths below them.
+   * This has to happen for events outside the tree too, since a directory
+   * whose path was cached outside may just have been moved into it.
+   */
+  if ((mask & FAN_ONDIR) && (mask & (FAN_MOVED_FROM | FAN_MOVED_TO | FAN_DELETE)))
+    g_hash_table_remove_all (tree->handle_paths);
+
+  if (full == NULL)
+    return;
+
+  if (g_str_equal (full, tree->root))
+    child = NULL;
+  else if (it_path_has_prefix (full, tree->root, tree->root_len) ||
+           (tree->root_len == 1 && full[0] == '/'))
+    child = full + tree->root_len + (tree->root_len > 1);
+  else
+    {
+      g_free (full);
+      return;
+    }
+
+  if (child == NULL)
+    {
+      if (mask & (FAN_DELETE | FAN_MOVED_FROM))
+        it_tree_report (tree, G_FILE_MONITOR_EVENT_DELETED, NULL, NULL);
+      g_free (full);
+      return;
+    }
+
+  if (mask & FAN_CREATE)
+    {
+      it_tree_report (tree, G_FILE_MONITOR_EVENT_CREATED, child, NULL);
+      if (!(mask & FAN_ONDIR))
+        it_tree_report (tree, G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT, child, NULL);
+    }
+  if (mask & FAN_MOVED_TO)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_MOVED_IN, child, NULL);
+  if (mask & FAN_MODIFY)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_CHANGED, child, NULL);
+  if (mask & FAN_ATTRIB)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED, child, NULL);
+  if (mask & FAN_CLOSE_WRITE)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT, child, NULL);
+  if (mask & FAN_MOVED_FROM)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_MOVED_OUT, child, NULL);
+  if (mask & FAN_DELETE)
+    it_tree_report (tree, G_FILE_MONITOR_EVENT_DELETED, child, NULL);
+
+  g_free (full);
+}
+
+static void
+it_tree_dispatch_fanotify (InotifyTree *tree,
+                           gssize       len)
+{
+  struct fanotify_event_metadata *metadata = (struct fanotify_event_metadata *) tree->buffer;
+
+  for (; FAN_EVENT_OK (metadata, len); metadata = FAN_EVENT_NEXT (metadata, len))
+    {
+      guint8 *info = (guint8 *) metadata + metadata->metadata_len;
+      guint8 *end = (guint8 *) metadata + metadata->event_len;
+
+      if (metadata->vers != FANOTIFY_METADATA_VERSION)
+        break;
+
+      if (metadata->mask & FAN_Q_OVERFLOW)
+        {
+          g_warning ("Recursive monitor for %s overflowed; events were lost", tree->root);
+          continue;
+        }
+
+      while (info + sizeof (struct fanotify_event_info_header) <= end)
+        {
+          struct fanotify_event_info_fid *fid = (struct fanotify_event_info_fid *) info;
+
+          if (fid->hdr.len == 0)
+            break;
+
+          if (fid->hdr.info_type == FAN_EVENT_INFO_TYPE_DFID_NAME)
+            {
+              struct file_handle *handle = (struct file_handle *) fid->handle;
+              const gchar *name = (const gchar *) handle->f_handle + handle->handle_bytes;
+
+              it_tree_handle_fanotify_event (tree, metadata->mask, handle, name);
+            }
+
+          info += fid->hdr.len;
+        }
+    }
+}
+
+static gboolean
+it_tree_try_fanotify (InotifyTree *tree)
+{
+  struct {
+    struct file_handle handle;
+    guint8 f_handle[MAX_HANDLE_SZ];
+  } probe;
+  int mount_id;
+  int fd;
+
+  tree->fd = fanotify_init (FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME,
+                            O_RDONLY | O_CLOEXEC | O_LARGEFILE);
+  if (tree->fd < 0)
+    return FALSE;
+
+  if (fanotify_mark (tree->fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                     FAN_CREATE | FAN_DELETE | FAN_MODIFY | FAN_ATTRIB |
+                     FAN_MOVED_FROM | FAN_MOVED_TO | FAN_CLOSE_WRITE | FAN_ONDIR,
+                     AT_FDCWD, tree->root) < 0)
+    goto fail;
+
+  /* Handles are only useful if we are allowed to open them again */
+  tree->mount_fd = open (tree->root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (tree->mount_fd < 0)
+    goto fail;
+
+  probe.handle.handle_bytes = MAX_HANDLE_SZ;
+  if (name_to_handle_at (AT_FDCWD, tree->root, &probe.handle, &mount_id, 0) < 0)
+    goto fail;
+
+  fd = open_by_handle_at (tree->mount_fd, &probe.handle, O_PATH | O_CLOEXEC);
+  if (fd < 0)
+    goto fail;
+  close (fd);
+
+  tree->handle_paths = g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+                                              (GDestroyNotify) g_bytes_unref, g_free);
+  tree->is_fanotify = TRUE;
+
+  return TRUE;
+
+fail:
+  close (tree->fd);
+  tree->fd = -1;
+
+  return FALSE;
+}
+
+#endif /* USE_FANOTIFY */
+
+/* GSource {{{1 */
+
+static gboolean
+it_tree_dispatch (GSource     *source,
+                  GSourceFunc  func,
+                  gpointer     user_data)
+{
+  InotifyTree *tree = (InotifyTree *) source;
+  gssize len;
+  guint n_reads = 0;
+
+  if (!(g_source_query_unix_fd (source, tree->fd_tag) & G_IO_IN))
+    return TRUE;
+
+  /* Don't hold the worker context for too long when the tree is busy;
+   * whatever is left in the fd is read on the next dispatch
+   */
+  while (n_reads++ < MAX_READS_PER_DISPATCH &&
+         (len = read (tree->fd, tree->buffer, READ_BUFFER_SIZE)) > 0)
+    {
+#ifdef USE_FANOTIFY
+      if (tree->is_fanotify)
+        it_tree_dispatch_fanotify (tree, len);
+      else
+#endif
+        it_tree_dispatch_inotify (tree, len);
+    }
+
+  return TRUE;
+}
+
+static void
+it_tree_finalize (GSource *source)
+{
+  InotifyTree *tree = (InotifyTree *) source;
+
+  if (tree->fd >= 0)
+    close (tree->fd);
+  if (tree->mount_fd >= 0)
+    close (tree->mount_fd);
+
+  g_clear_pointer (&tree->wd_paths, g_hash_table_unref);
+  g_clear_pointer (&tree->handle_paths, g_hash_table_unref);
+  g_free (tree->buffer);
+  g_free (tree->root);
+  g_mutex_clear (&tree->lock);
+  g_cond_clear (&tree->walk_cond);
+
+  g_source_unref ((GSource *) tree->fms);
+}
+
+InotifyTree *
+_it_tree_new (const gchar         *dirname,
+              GFileMonitorSource  *fms,
+              GError             **error)
+{
+  static GSourceFuncs source_funcs = {
+    NULL, NULL,
+    it_tree_dispatch,
+    it_tree_finalize,
+    NULL, NULL
+  };
+  InotifyTree *tree;
+  GSource *source;
+
+  source = g_source_new (&source_funcs, sizeof (InotifyTree));
+  tree = (InotifyTree *) source;
+
+  g_source_set_static_name (source, "inotify tree source");
+
+  tree->fms = (GFileMonitorSource *) g_source_ref ((GSource *) fms);
+  tree->root = g_strdup (dirname);
+  tree->root_len = strlen (dirname);
+  tree->fd = -1;
+  tree->mount_fd = -1;
+  tree->buffer = g_malloc (READ_BUFFER_SIZE);
+  g_mutex_init (&tree->lock);
+  g_cond_init (&tree->walk_cond);
+
+#ifdef USE_FANOTIFY
+  if (g_getenv ("GIO_RECURSIVE_MONITOR_NO_FANOTIFY") == NULL)
+    it_tree_try_fanotify (tree);
+#endif
+
+  if (!tree->is_fanotify)
+    {
+      if (tree->mount_fd >= 0)
+        {
+          close (tree->mount_fd);
+          tree->mount_fd = -1;
+        }
+
+      tree->fd = inotify_init1 (IN_CLOEXEC | IN_NONBLOCK);
+      tree->wd_paths = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+      if (tree->fd < 0)
+        {
+          int errsv = errno;
+
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                       _("Unable to create an inotify instance to monitor “%s”: %s"),
+                       dirname, g_strerror (errsv));
+          g_source_unref (source);
+
+          return NULL;
+        }
+
+      it_tree_walk_parallel (tree);
+    }
+
+  tree->fd_tag = g_source_add_unix_fd (source, tree->fd, G_IO_IN);
+
+  g_source_attach (source, GLIB_PRIVATE_CALL (g_get_worker_context) ());
+
+  return tree;
+}
+
+void
+_it_tree_free (InotifyTree *tree)
+{
+  g_source_destroy ((GSource *) tree);
+  g_source_unref ((GSource *) tree);
+}
+
+/* vim:set foldmethod=marker: */
@@ -0,0 +1,32 @@
+/*
+   Copyright © 2023 GNOME Foundation Inc.
+
+   SPDX-License-Identifier: LGPL-2.1-or-later
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public
+   License as published by the Free Software Foundation; either
+   version 2.1 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __INOTIFY_TREE_H
+#define __INOTIFY_TREE_H
+
+#include <gio/glocalfilemonitor.h>
+
+typedef struct _InotifyTree InotifyTree;
+
+InotifyTree *_it_tree_new  (const gchar         *dirname,
+                            GFileMonitorSource  *source,
+                            GError             **error);
+void         _it_tree_free (InotifyTree         *tree);
+
+#endif
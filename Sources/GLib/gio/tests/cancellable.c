@@ -790,6 +790,89 @@ test_cancellable_cancel_reset_connect_races (void)
   g_object_unref (cancellable);
 }
 
+static void
+on_perf_cancelled (GCancellable *cancellable,
+                   gpointer      data)
+{
+  guint *n_cancelled = data;
+
+  (*n_cancelled)++;
+}
+
+typedef struct
+{
+  guint iterations;
+  guint n_cancelled;
+} PerfThreadData;
+
+static gpointer
+cancellable_perf_thread (gpointer user_data)
+{
+  PerfThreadData *data = user_data;
+  guint i;
+
+  for (i = 0; i < data->iterations; i++)
+    {
+      GCancellable *cancellable = g_cancellable_new ();
+      gulong id;
+
+      id = g_cancellable_connect (cancellable, G_CALLBACK (on_perf_cancelled),
+                                  &data->n_cancelled, NULL);
+      g_assert_false (g_cancellable_is_cancelled (cancellable));
+
+      /* Let half of them run to completion, and cancel the others */
+      if (i % 2 == 0)
+        g_cancellable_cancel (cancellable);
+      g_assert_true (g_cancellable_is_cancelled (cancellable) == (i % 2 == 0));
+
+      g_cancellable_disconnect (cancellable, id);
+      g_cancellable_reset (cancellable);
+      g_object_unref (cancellable);
+    }
+
+  return NULL;
+}
+
+static void
+test_cancellable_threaded_performance (void)
+{
+  guint n_threads = MAX (2, g_get_num_processors ());
+  guint iterations = g_test_perf () ? 200000 : 1000;
+  PerfThreadData *data;
+  GThread **threads;
+  gdouble elapsed;
+  guint i;
+
+  g_test_summary ("Measures connect/cancel/disconnect throughput of "
+                  "independent cancellables used on several threads");
+
+  data = g_new0 (PerfThreadData, n_threads);
+  threads = g_new0 (GThread *, n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_threads; i++)
+    {
+      data[i].iterations = iterations;
+      threads[i] = g_thread_new ("cancellable-perf", cancellable_perf_thread, &data[i]);
+    }
+
+  for (i = 0; i < n_threads; i++)
+    g_thread_join (threads[i]);
+
+  elapsed = g_test_timer_elapsed ();
+
+  for (i = 0; i < n_threads; i++)
+    g_assert_cmpuint (data[i].n_cancelled, ==, (iterations + 1) / 2);
+
+  g_test_maximized_result (n_threads * iterations / elapsed,
+                           "%u threads: %.0f cancellables/s",
+                           n_threads, n_threads * iterations / elapsed);
+
+  g_free (threads);
+  g_free (data);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -805,6 +888,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/cancellable/cancel-reset-races", test_cancellable_cancel_reset_races);
   g_test_add_func ("/cancellable/cancel-reset-connect-races", test_cancellable_cancel_reset_connect_races);
   g_test_add_func ("/cancellable-source/threaded-dispose", test_cancellable_source_threaded_dispose);
+  g_test_add_func ("/cancellable/perf/threaded", test_cancellable_threaded_performance);
 
   return g_test_run ();
 }
@@ -732,6 +732,7 @@ typedef struct {
   const gchar *path;
   GZlibCompressorFormat format;
   gint level;
+  guint n_threads;  /* 0 to use the default */
 } CompressorTest;
 
 static void
@@ -760,7 +761,14 @@ test_roundtrip (gconstpointer data)
     DATA_LENGTH * sizeof (guint32), NULL);
 
   ostream1 = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
-  compressor = G_CONVERTER (g_zlib_compressor_new (test->format, test->level));
+  if (test->n_threads > 0)
+    compressor = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                               "format", test->format,
+                               "level", test->level,
+                               "n-threads", test->n_threads,
+                               NULL);
+  else
+    compressor = G_CONVERTER (g_zlib_compressor_new (test->format, test->level));
   info = g_file_info_new ();
   g_file_info_set_name (info, "foo");
   g_object_set (compressor, "file-info", info, NULL);
@@ -808,6 +816,169 @@ test_roundtrip (gconstpointer data)
   g_free (data0);
 }
 
+/* Compressible, log-like data */
+static GBytes *
+make_text (gsize size)
+{
+  GString *text = g_string_sized_new (size + 128);
+  guint i = 0;
+
+  while (text->len < size)
+    {
+      g_string_append_printf (text, "%u INFO worker-%u: processed item %u in %u ms\n",
+                              i, i % 7, i * 13, (i * 31) % 1000);
+      i++;
+    }
+
+  g_string_truncate (text, size);
+  return g_string_free_to_bytes (text);
+}
+
+static GBytes *
+decompress (GZlibCompressorFormat  format,
+            GBytes                *compressed)
+{
+  GConverter *decompressor;
+  GInputStream *istream, *cistream;
+  GOutputStream *ostream;
+  GBytes *result;
+  GError *error = NULL;
+
+  istream = g_memory_input_stream_new_from_bytes (compressed);
+  decompressor = G_CONVERTER (g_zlib_decompressor_new (format));
+  cistream = g_converter_input_stream_new (istream, decompressor);
+  ostream = g_memory_output_stream_new_resizable ();
+
+  g_output_stream_splice (ostream, cistream, G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, NULL, &error);
+  g_assert_no_error (error);
+
+  result = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream));
+
+  g_object_unref (ostream);
+  g_object_unref (cistream);
+  g_object_unref (decompressor);
+  g_object_unref (istream);
+
+  return result;
+}
+
+static void
+test_compressor_parallel_flush (void)
+{
+  GConverter *compressor;
+  GOutputStream *ostream, *costream;
+  GBytes *text, *compressed, *decompressed;
+  gsize size, offset;
+  GError *error = NULL;
+
+  g_test_summary ("Test that flushing a parallel GZlibCompressor emits everything "
+                  "written so far, and that the result round-trips");
+
+  text = make_text (1000000);
+  ostream = g_memory_output_stream_new_resizable ();
+  compressor = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                             "format", G_ZLIB_COMPRESSOR_FORMAT_GZIP,
+                             "n-threads", 4,
+                             NULL);
+  costream = g_converter_output_stream_new (ostream, compressor);
+
+  /* Odd write sizes, so that blocks and flushes do not line up */
+  for (offset = 0; offset < g_bytes_get_size (text); offset += size)
+    {
+      gsize before;
+
+      size = MIN (77777, g_bytes_get_size (text) - offset);
+      g_output_stream_write_all (costream,
+                                 (const guint8 *) g_bytes_get_data (text, NULL) + offset,
+                                 size, NULL, NULL, &error);
+      g_assert_no_error (error);
+
+      before = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream));
+      g_output_stream_flush (costream, NULL, &error);
+      g_assert_no_error (error);
+
+      /* Each write leaves a partial block, which the flush must emit */
+      g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream)), >, before);
+    }
+
+  g_output_stream_close (costream, NULL, &error);
+  g_assert_no_error (error);
+
+  compressed = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream));
+  decompressed = decompress (G_ZLIB_COMPRESSOR_FORMAT_GZIP, compressed);
+  g_assert_true (g_bytes_equal (decompressed, text));
+
+  g_bytes_unref (decompressed);
+  g_bytes_unref (compressed);
+  g_object_unref (costream);
+  g_object_unref (compressor);
+  g_object_unref (ostream);
+  g_bytes_unref (text);
+}
+
+static gsize
+compress_timed (GBytes  *text,
+                guint    n_threads,
+                gdouble *elapsed)
+{
+  GConverter *compressor;
+  GInputStream *istream;
+  GOutputStream *ostream, *costream;
+  GError *error = NULL;
+  gsize compressed_size;
+
+  istream = g_memory_input_stream_new_from_bytes (text);
+  ostream = g_memory_output_stream_new_resizable ();
+  compressor = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                             "format", G_ZLIB_COMPRESSOR_FORMAT_GZIP,
+                             "n-threads", n_threads,
+                             NULL);
+  costream = g_converter_output_stream_new (ostream, compressor);
+
+  g_test_timer_start ();
+  g_output_stream_splice (costream, istream, G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, NULL, &error);
+  *elapsed = g_test_timer_elapsed ();
+  g_assert_no_error (error);
+
+  compressed_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream));
+
+  g_object_unref (costream);
+  g_object_unref (compressor);
+  g_object_unref (ostream);
+  g_object_unref (istream);
+
+  return compressed_size;
+}
+
+static void
+test_compressor_parallel_performance (void)
+{
+  GBytes *text;
+  gdouble elapsed, mib;
+  gsize size;
+  guint n_threads;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  text = make_text (256 * 1024 * 1024);
+  mib = g_bytes_get_size (text) / (1024.0 * 1024.0);
+
+  for (n_threads = 1; n_threads <= g_get_num_processors (); n_threads *= 2)
+    {
+      size = compress_timed (text, n_threads, &elapsed);
+      g_test_maximized_result (mib / elapsed,
+                               "%u thread(s): %.1f MiB/s, %.2f%% of input",
+                               n_threads, mib / elapsed,
+                               100.0 * size / g_bytes_get_size (text));
+    }
+
+  g_bytes_unref (text);
+}
+
 typedef struct {
   const gchar *path;
   const gchar *charset_in;
@@ -1194,17 +1365,21 @@ main (int   argc,
       char *argv[])
 {
   CompressorTest compressor_tests[] = {
-    { "/converter-output-stream/roundtrip/zlib-0", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 0 },
-    { "/converter-output-stream/roundtrip/zlib-9", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9 },
-    { "/converter-output-stream/roundtrip/gzip-0", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 0 },
-    { "/converter-output-stream/roundtrip/gzip-9", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 9 },
-    { "/converter-output-stream/roundtrip/raw-0", G_ZLIB_COMPRESSOR_FORMAT_RAW, 0 },
-    { "/converter-output-stream/roundtrip/raw-9", G_ZLIB_COMPRESSOR_FORMAT_RAW, 9 },
+    { "/converter-output-stream/roundtrip/zlib-0", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 0, 0 },
+    { "/converter-output-stream/roundtrip/zlib-9", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9, 0 },
+    { "/converter-output-stream/roundtrip/gzip-0", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 0, 0 },
+    { "/converter-output-stream/roundtrip/gzip-9", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 9, 0 },
+    { "/converter-output-stream/roundtrip/raw-0", G_ZLIB_COMPRESSOR_FORMAT_RAW, 0, 0 },
+    { "/converter-output-stream/roundtrip/raw-9", G_ZLIB_COMPRESSOR_FORMAT_RAW, 9, 0 },
+    { "/converter-output-stream/roundtrip/parallel/zlib-6", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 6, 4 },
+    { "/converter-output-stream/roundtrip/parallel/gzip-0", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 0, 4 },
+    { "/converter-output-stream/roundtrip/parallel/gzip-9", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 9, 3 },
+    { "/converter-output-stream/roundtrip/parallel/raw-1", G_ZLIB_COMPRESSOR_FORMAT_RAW, 1, 2 },
   };
   CompressorTest truncation_tests[] = {
-    { "/converter-input-stream/truncation/zlib", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 0 },
-    { "/converter-input-stream/truncation/gzip", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 0 },
-    { "/converter-input-stream/truncation/raw", G_ZLIB_COMPRESSOR_FORMAT_RAW, 0 },
+    { "/converter-input-stream/truncation/zlib", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 0, 0 },
+    { "/converter-input-stream/truncation/gzip", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 0, 0 },
+    { "/converter-input-stream/truncation/raw", G_ZLIB_COMPRESSOR_FORMAT_RAW, 0, 0 },
   };
   CharsetTest charset_tests[] = {
     { "/converter-input-stream/charset/utf8->latin1", "UTF-8", "\303\205rr Sant\303\251", "ISO-8859-1", "\305rr Sant\351", 0 },
@@ -1229,6 +1404,9 @@ main (int   argc,
   for (i = 0; i < G_N_ELEMENTS (charset_tests); i++)
     g_test_add_data_func (charset_tests[i].path, &charset_tests[i], test_charset);
 
+  g_test_add_func ("/converter-output-stream/compressor/parallel-flush", test_compressor_parallel_flush);
+  g_test_add_func ("/converter-output-stream/perf/compressor", test_compressor_parallel_performance);
+
   g_test_add_func ("/converter-stream/pollable", test_converter_pollable);
   g_test_add_func ("/converter-stream/leftover", test_converter_leftover);
 
@@ -488,6 +488,194 @@ test_read_int (void)
 }
 
 
+static void
+test_read_line_bytes (void)
+{
+  const char *data = "first\r\nsecond\rthird\n\nthe fifth line is longer than the buffer\r\nlast";
+  const char *expected[] = { "first", "second", "third", "", "the fifth line is longer than the buffer", "last" };
+  GInputStream *base_stream;
+  GDataInputStream *stream;
+  GPtrArray *lines;
+  GBytes *line;
+  GError *error = NULL;
+  gsize i;
+
+  g_test_summary ("Test that lines returned by g_data_input_stream_read_line_bytes() "
+                  "stay intact while the buffer is compacted and resized");
+
+  base_stream = g_memory_input_stream_new_from_data (data, -1, NULL);
+  stream = g_data_input_stream_new (base_stream);
+  g_data_input_stream_set_newline_type (stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+  g_buffered_input_stream_set_buffer_size (G_BUFFERED_INPUT_STREAM (stream), 8);
+
+  lines = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+  while ((line = g_data_input_stream_read_line_bytes (stream, NULL, &error)) != NULL)
+    g_ptr_array_add (lines, line);
+  g_assert_no_error (error);
+
+  g_assert_cmpuint (lines->len, ==, G_N_ELEMENTS (expected));
+  for (i = 0; i < lines->len; i++)
+    {
+      gsize size;
+      const char *str = g_bytes_get_data (lines->pdata[i], &size);
+
+      g_assert_cmpmem (str, size, expected[i], strlen (expected[i]));
+    }
+
+  g_ptr_array_unref (lines);
+  g_object_unref (stream);
+  g_object_unref (base_stream);
+}
+
+typedef struct
+{
+  GMainLoop *loop;
+  GPtrArray *lines;
+  guint max_lines;
+  guint n_batches;
+  guint largest_batch;
+} ReadLinesData;
+
+static void
+read_lines_cb (GObject      *object,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+  GDataInputStream *stream = G_DATA_INPUT_STREAM (object);
+  ReadLinesData *data = user_data;
+  GPtrArray *batch;
+  GError *error = NULL;
+  guint i;
+
+  batch = g_data_input_stream_read_lines_finish (stream, result, &error);
+  g_assert_no_error (error);
+
+  if (batch == NULL)
+    {
+      g_main_loop_quit (data->loop);
+      return;
+    }
+
+  g_assert_cmpuint (batch->len, >, 0);
+  g_assert_cmpuint (batch->len, <=, data->max_lines);
+  data->n_batches++;
+  data->largest_batch = MAX (data->largest_batch, batch->len);
+
+  for (i = 0; i < batch->len; i++)
+    g_ptr_array_add (data->lines, g_bytes_ref (batch->pdata[i]));
+  g_ptr_array_unref (batch);
+
+  g_data_input_stream_read_lines_async (stream, data->max_lines, G_PRIORITY_DEFAULT,
+                                        NULL, read_lines_cb, data);
+}
+
+static void
+test_read_lines_async (void)
+{
+  GInputStream *base_stream;
+  GDataInputStream *stream;
+  ReadLinesData data = { NULL, NULL, 7, 0, 0 };
+  guint i;
+
+  g_test_summary ("Test that g_data_input_stream_read_lines_async() returns "
+                  "batches of buffered lines, and a final unterminated line");
+
+  base_stream = g_memory_input_stream_new ();
+  for (i = 0; i < MAX_LINES; i++)
+    g_memory_input_stream_add_data (G_MEMORY_INPUT_STREAM (base_stream),
+                                    g_strdup_printf ("line %u\r\n", i), -1, g_free);
+  g_memory_input_stream_add_data (G_MEMORY_INPUT_STREAM (base_stream), "tail", -1, NULL);
+
+  stream = g_data_input_stream_new (base_stream);
+  g_data_input_stream_set_newline_type (stream, G_DATA_STREAM_NEWLINE_TYPE_CR_LF);
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.lines = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+
+  g_data_input_stream_read_lines_async (stream, data.max_lines, G_PRIORITY_DEFAULT,
+                                        NULL, read_lines_cb, &data);
+  g_main_loop_run (data.loop);
+
+  g_assert_cmpuint (data.lines->len, ==, MAX_LINES + 1);
+  g_assert_cmpuint (data.largest_batch, ==, data.max_lines);
+  g_assert_cmpuint (data.n_batches, <, data.lines->len);
+
+  for (i = 0; i < data.lines->len; i++)
+    {
+      char *expected = (i < MAX_LINES) ? g_strdup_printf ("line %u", i) : g_strdup ("tail");
+      gsize size;
+      const char *line = g_bytes_get_data (data.lines->pdata[i], &size);
+
+      g_assert_cmpmem (line, size, expected, strlen (expected));
+      g_free (expected);
+    }
+
+  g_ptr_array_unref (data.lines);
+  g_main_loop_unref (data.loop);
+  g_object_unref (stream);
+  g_object_unref (base_stream);
+}
+
+static void
+test_read_line_performance (void)
+{
+  const gsize n_lines = 1000000;
+  GInputStream *base_stream;
+  GDataInputStream *stream;
+  GString *text;
+  GBytes *bytes;
+  gdouble elapsed;
+  gsize i, n_read;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  text = g_string_new (NULL);
+  for (i = 0; i < n_lines; i++)
+    g_string_append_printf (text, "%" G_GSIZE_FORMAT " INFO some-service[%u]: "
+                            "request handled in %u ms\n", i, (guint) (i % 4096), (guint) (i % 97));
+  bytes = g_string_free_to_bytes (text);
+
+  base_stream = g_memory_input_stream_new_from_bytes (bytes);
+  stream = g_data_input_stream_new (base_stream);
+
+  g_test_timer_start ();
+  for (n_read = 0; ; n_read++)
+    {
+      char *line = g_data_input_stream_read_line (stream, NULL, NULL, NULL);
+      if (line == NULL)
+        break;
+      g_free (line);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_assert_cmpuint (n_read, ==, n_lines);
+  g_test_maximized_result (n_lines / elapsed, "read_line: %.0f lines/s", n_lines / elapsed);
+
+  g_object_unref (stream);
+  g_object_unref (base_stream);
+  base_stream = g_memory_input_stream_new_from_bytes (bytes);
+  stream = g_data_input_stream_new (base_stream);
+
+  g_test_timer_start ();
+  for (n_read = 0; ; n_read++)
+    {
+      GBytes *line = g_data_input_stream_read_line_bytes (stream, NULL, NULL);
+      if (line == NULL)
+        break;
+      g_bytes_unref (line);
+    }
+  elapsed = g_test_timer_elapsed ();
+  g_assert_cmpuint (n_read, ==, n_lines);
+  g_test_maximized_result (n_lines / elapsed, "read_line_bytes: %.0f lines/s", n_lines / elapsed);
+
+  g_object_unref (stream);
+  g_object_unref (base_stream);
+  g_bytes_unref (bytes);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -501,9 +689,12 @@ main (int   argc,
   g_test_add_func ("/data-input-stream/read-lines-CR", test_read_lines_CR);
   g_test_add_func ("/data-input-stream/read-lines-CR-LF", test_read_lines_CR_LF);
   g_test_add_func ("/data-input-stream/read-lines-any", test_read_lines_any);
+  g_test_add_func ("/data-input-stream/read-line-bytes", test_read_line_bytes);
+  g_test_add_func ("/data-input-stream/read-lines-async", test_read_lines_async);
   g_test_add_func ("/data-input-stream/read-until", test_read_until);
   g_test_add_func ("/data-input-stream/read-upto", test_read_upto);
   g_test_add_func ("/data-input-stream/read-int", test_read_int);
+  g_test_add_func ("/data-input-stream/perf/read-line", test_read_line_performance);
 
   return g_test_run();
 }
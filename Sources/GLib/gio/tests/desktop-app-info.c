@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <utime.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -963,6 +964,145 @@ test_implements (void)
   assert_implementations ("org.gnome.Shell.SearchProvider2", "", FALSE, FALSE);
 }
 
+static gchar *
+run_search_in (const gchar *data_dir,
+               const gchar *search_string,
+               gboolean     no_index)
+{
+  gchar *argv[] = { NULL, "search", (gchar *) search_string, NULL };
+  gchar **envp;
+  gchar *out;
+  gint status;
+
+  argv[0] = g_test_build_filename (G_TEST_BUILT, "apps", NULL);
+
+  envp = g_get_environ ();
+  envp = g_environ_setenv (envp, "XDG_DATA_DIRS", data_dir, TRUE);
+  envp = g_environ_setenv (envp, "XDG_DATA_HOME", "/does-not-exist", TRUE);
+  envp = g_environ_setenv (envp, "LC_ALL", "C", TRUE);
+  envp = g_environ_unsetenv (envp, "LANGUAGE");
+  envp = g_environ_unsetenv (envp, "XDG_CURRENT_DESKTOP");
+  if (no_index)
+    envp = g_environ_setenv (envp, "GIO_DESKTOP_APP_INFO_NO_INDEX", "1", TRUE);
+  else
+    envp = g_environ_unsetenv (envp, "GIO_DESKTOP_APP_INFO_NO_INDEX");
+
+  g_assert_true (g_spawn_sync (NULL, argv, envp, 0, NULL, NULL, &out, NULL, &status, NULL));
+  g_assert_cmpint (status, ==, 0);
+  g_strchomp (out);
+
+  g_strfreev (envp);
+  g_free (argv[0]);
+
+  return out;
+}
+
+static void
+write_desktop_file (const gchar *applications_dir,
+                    const gchar *desktop_id,
+                    const gchar *name,
+                    time_t       dir_mtime)
+{
+  struct utimbuf times = { dir_mtime, dir_mtime };
+  gchar *filename, *contents;
+  GError *error = NULL;
+
+  filename = g_build_filename (applications_dir, desktop_id, NULL);
+  contents = g_strdup_printf ("[Desktop Entry]\n"
+                              "Type=Application\n"
+                              "Name=%s\n"
+                              "Exec=%s\n", name, name);
+  g_file_set_contents (filename, contents, -1, &error);
+  g_assert_no_error (error);
+
+  /* Pretend that the directory was last changed long ago, otherwise
+   * it is considered too recent to be indexed */
+  g_assert_no_errno (g_utime (applications_dir, &times));
+
+  g_free (contents);
+  g_free (filename);
+}
+
+static guint
+count_indexes (void)
+{
+  gchar *index_dir;
+  GDir *dir;
+  guint n = 0;
+
+  index_dir = g_build_filename (g_get_user_cache_dir (), "glib-2.0", "desktop-app-info", NULL);
+  dir = g_dir_open (index_dir, 0, NULL);
+
+  while (dir && g_dir_read_name (dir))
+    n++;
+
+  g_clear_pointer (&dir, g_dir_close);
+  g_free (index_dir);
+
+  return n;
+}
+
+static void
+test_search_index (void)
+{
+  gchar *data_dir, *applications_dir, *filename, *result;
+  GError *error = NULL;
+
+  data_dir = g_dir_make_tmp ("desktop-app-info-index-XXXXXX", &error);
+  g_assert_no_error (error);
+  applications_dir = g_build_filename (data_dir, "applications", NULL);
+  g_assert_no_errno (g_mkdir (applications_dir, 0700));
+
+  write_desktop_file (applications_dir, "frobnicator.desktop", "frobnicator", 1000000000);
+  g_assert_cmpuint (count_indexes (), ==, 0);
+
+  /* The first search reads the desktop files and writes the index */
+  result = run_search_in (data_dir, "frob", FALSE);
+  g_assert_cmpstr (result, ==, "frobnicator.desktop");
+  g_free (result);
+  g_assert_cmpuint (count_indexes (), ==, 1);
+
+  /* Changing a desktop file in place goes unnoticed by the index, which
+   * shows that later searches use it */
+  write_desktop_file (applications_dir, "frobnicator.desktop", "twiddler", 1000000000);
+
+  result = run_search_in (data_dir, "frob", FALSE);
+  g_assert_cmpstr (result, ==, "frobnicator.desktop");
+  g_free (result);
+
+  result = run_search_in (data_dir, "twiddler", FALSE);
+  g_assert_cmpstr (result, ==, "");
+  g_free (result);
+
+  result = run_search_in (data_dir, "twiddler", TRUE);
+  g_assert_cmpstr (result, ==, "frobnicator.desktop");
+  g_free (result);
+
+  /* Adding a desktop file changes the directory, and the index is
+   * replaced */
+  write_desktop_file (applications_dir, "twiddler.desktop", "twiddler", 1000000001);
+
+  result = run_search_in (data_dir, "twiddler", FALSE);
+  assert_strings_equivalent ("frobnicator.desktop twiddler.desktop", result);
+  g_free (result);
+  g_assert_cmpuint (count_indexes (), ==, 1);
+
+  result = run_search_in (data_dir, "twiddler", FALSE);
+  assert_strings_equivalent ("frobnicator.desktop twiddler.desktop", result);
+  g_free (result);
+
+  filename = g_build_filename (applications_dir, "frobnicator.desktop", NULL);
+  g_assert_no_errno (g_remove (filename));
+  g_free (filename);
+  filename = g_build_filename (applications_dir, "twiddler.desktop", NULL);
+  g_assert_no_errno (g_remove (filename));
+  g_free (filename);
+  g_assert_no_errno (g_rmdir (applications_dir));
+  g_assert_no_errno (g_rmdir (data_dir));
+  g_free (applications_dir);
+  g_free (data_dir);
+}
+
 static void
 assert_shown (const gchar *desktop_id,
               gboolean     expected,
@@ -1889,6 +2029,7 @@ main (int   argc,
   g_test_add_func ("/desktop-app-info/extra-getters", test_extra_getters);
   g_test_add_func ("/desktop-app-info/actions", test_actions);
   g_test_add_func ("/desktop-app-info/search", test_search);
+  g_test_add_func ("/desktop-app-info/search/index", test_search_index);
   g_test_add_func ("/desktop-app-info/implements", test_implements);
   g_test_add_func ("/desktop-app-info/show-in", test_show_in);
   g_test_add_func ("/desktop-app-info/app-path", test_app_path);
@@ -2811,6 +2811,133 @@ test_load_bytes_async (void)
   g_main_loop_unref (data.main_loop);
 }
 
+static void
+store_result_cb (GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GAsyncResult **result_out = user_data;
+
+  g_assert_null (*result_out);
+  *result_out = g_object_ref (result);
+  g_main_context_wakeup (NULL);
+}
+
+/* Native read_async()/write_async() on local files: the data must round-trip
+ * and the file position must advance like with the synchronous calls. */
+static void
+test_read_write_async (void)
+{
+  GFile *file;
+  GFileIOStream *iostream = NULL;
+  GOutputStream *ostream;
+  GInputStream *istream;
+  GCancellable *cancellable;
+  GAsyncResult *result = NULL;
+  GError *error = NULL;
+  guint8 *data, *contents;
+  gsize total = 256 * 1024, pos;
+  gssize n;
+  gsize i;
+
+  data = g_malloc (total);
+  for (i = 0; i < total; i++)
+    data[i] = (guint8) (i * 7);
+  contents = g_malloc0 (total);
+
+  file = g_file_new_tmp ("g_file_read_write_async_XXXXXX", &iostream, NULL);
+  g_assert_nonnull (file);
+  ostream = g_io_stream_get_output_stream (G_IO_STREAM (iostream));
+
+  for (pos = 0; pos < total; pos += n)
+    {
+      g_output_stream_write_async (ostream, data + pos, MIN (4096, total - pos),
+                                   G_PRIORITY_DEFAULT, NULL, store_result_cb, &result);
+      while (result == NULL)
+        g_main_context_iteration (NULL, TRUE);
+      n = g_output_stream_write_finish (ostream, result, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (n, >, 0);
+      g_clear_object (&result);
+    }
+
+  g_io_stream_close (G_IO_STREAM (iostream), NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (iostream);
+
+  istream = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  g_assert_no_error (error);
+
+  for (pos = 0; pos < total; pos += n)
+    {
+      g_input_stream_read_async (istream, contents + pos, 1000,
+                                 G_PRIORITY_DEFAULT, NULL, store_result_cb, &result);
+      while (result == NULL)
+        g_main_context_iteration (NULL, TRUE);
+      n = g_input_stream_read_finish (istream, result, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (n, >, 0);
+      g_clear_object (&result);
+    }
+  g_assert_cmpmem (contents, total, data, total);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (istream)), ==, total);
+
+  /* End of file */
+  g_input_stream_read_async (istream, contents, 1000,
+                             G_PRIORITY_DEFAULT, NULL, store_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  n = g_input_stream_read_finish (istream, result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 0);
+  g_clear_object (&result);
+
+  /* Skipping seeks, and stops at the end of the file */
+  g_seekable_seek (G_SEEKABLE (istream), 1000, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_input_stream_skip_async (istream, 5000, G_PRIORITY_DEFAULT, NULL,
+                             store_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  n = g_input_stream_skip_finish (istream, result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, 5000);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (istream)), ==, 6000);
+  g_clear_object (&result);
+
+  g_input_stream_skip_async (istream, total, G_PRIORITY_DEFAULT, NULL,
+                             store_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  n = g_input_stream_skip_finish (istream, result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n, ==, total - 6000);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (istream)), ==, total);
+  g_clear_object (&result);
+
+  /* Cancelled before it starts */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  g_seekable_seek (G_SEEKABLE (istream), 0, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_input_stream_read_async (istream, contents, 1000,
+                             G_PRIORITY_DEFAULT, cancellable, store_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  n = g_input_stream_read_finish (istream, result, &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_cmpint (n, ==, -1);
+  g_clear_error (&error);
+  g_clear_object (&result);
+  g_object_unref (cancellable);
+
+  g_object_unref (istream);
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (contents);
+  g_free (data);
+}
+
 static void
 test_writev_helper (GOutputVector *vectors,
                     gsize          n_vectors,
@@ -4032,6 +4159,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/file/measure-async", test_measure_async);
   g_test_add_func ("/file/load-bytes", test_load_bytes);
   g_test_add_func ("/file/load-bytes-async", test_load_bytes_async);
+  g_test_add_func ("/file/read-write-async", test_read_write_async);
   g_test_add_func ("/file/writev", test_writev);
   g_test_add_func ("/file/writev/no-bytes-written", test_writev_no_bytes_written);
   g_test_add_func ("/file/writev/no-vectors", test_writev_no_vectors);
@@ -2786,6 +2786,99 @@ test_schema_list_keys (void)
   g_settings_schema_unref (schema);
 }
 
+static void
+test_schema_shared (void)
+{
+  GSettingsSchemaSource *src = g_settings_schema_source_get_default ();
+  GSettingsSchema *schema1, *schema2, *schema3;
+  GSettingsSchemaKey *key;
+  GSettings *settings1, *settings2;
+  gchar **keys1, **keys2;
+
+  g_test_summary ("Test that lookups of the same schema share one GSettingsSchema "
+                  "and its parsed key information");
+
+  schema1 = g_settings_schema_source_lookup (src, "org.gtk.test", TRUE);
+  schema2 = g_settings_schema_source_lookup (src, "org.gtk.test", TRUE);
+  g_assert_nonnull (schema1);
+  g_assert_true (schema1 == schema2);
+
+  settings1 = g_settings_new ("org.gtk.test");
+  settings2 = g_settings_new ("org.gtk.test");
+  g_object_get (settings1, "settings-schema", &schema3, NULL);
+  g_assert_true (schema3 == schema1);
+  g_settings_schema_unref (schema3);
+  g_object_get (settings2, "settings-schema", &schema3, NULL);
+  g_assert_true (schema3 == schema1);
+  g_settings_schema_unref (schema3);
+
+  keys1 = g_settings_schema_list_keys (schema1);
+  keys2 = g_settings_schema_list_keys (schema2);
+  g_assert_true (keys1 != keys2);
+  g_assert_cmpstrv (keys1, keys2);
+  g_strfreev (keys1);
+  g_strfreev (keys2);
+
+  key = g_settings_schema_get_key (schema1, "greeting");
+  g_assert_cmpstr (g_settings_schema_key_get_name (key), ==, "greeting");
+  g_settings_schema_key_unref (key);
+
+  g_object_unref (settings1);
+  g_object_unref (settings2);
+  g_settings_schema_unref (schema1);
+  g_settings_schema_unref (schema2);
+
+  /* Once all references are gone, the schema is built again */
+  schema1 = g_settings_schema_source_lookup (src, "org.gtk.test", TRUE);
+  g_assert_nonnull (schema1);
+  g_assert_true (g_settings_schema_has_key (schema1, "greeting"));
+  g_settings_schema_unref (schema1);
+}
+
+static void
+test_bind_many (void)
+{
+  TestObject *obj;
+  GSettings *settings;
+  gboolean b;
+  gint i;
+  gchar *str;
+
+  g_test_summary ("Test binding several keys at once with g_settings_bind_many()");
+
+  settings = g_settings_new ("org.gtk.test.binding");
+  obj = test_object_new ();
+
+  g_settings_set_boolean (settings, "bool", TRUE);
+  g_settings_set_int (settings, "int", 12345);
+  g_settings_set_string (settings, "string", "bound");
+
+  g_settings_bind_many (settings, obj, G_SETTINGS_BIND_DEFAULT,
+                        "bool", "bool",
+                        "int", "int",
+                        "string", "string",
+                        NULL);
+
+  g_object_get (obj, "bool", &b, "int", &i, "string", &str, NULL);
+  g_assert_true (b);
+  g_assert_cmpint (i, ==, 12345);
+  g_assert_cmpstr (str, ==, "bound");
+  g_free (str);
+
+  g_object_set (obj, "int", 54321, "string", "changed", NULL);
+  g_assert_cmpint (g_settings_get_int (settings, "int"), ==, 54321);
+  str = g_settings_get_string (settings, "string");
+  g_assert_cmpstr (str, ==, "changed");
+  g_free (str);
+
+  g_settings_set_boolean (settings, "bool", FALSE);
+  g_object_get (obj, "bool", &b, NULL);
+  g_assert_false (b);
+
+  g_object_unref (obj);
+  g_object_unref (settings);
+}
+
 static void
 test_actions (void)
 {
@@ -3240,6 +3333,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/gsettings/no-change-binding", test_no_change_binding);
   g_test_add_func ("/gsettings/unbinding", test_unbind);
   g_test_add_func ("/gsettings/writable-binding", test_bind_writable);
+  g_test_add_func ("/gsettings/bind-many", test_bind_many);
 
   if (!backend_set)
     {
@@ -3279,6 +3373,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/gsettings/get-range", test_get_range);
   g_test_add_func ("/gsettings/schema-source", test_schema_source);
   g_test_add_func ("/gsettings/schema-list-keys", test_schema_list_keys);
+  g_test_add_func ("/gsettings/schema-shared", test_schema_shared);
   g_test_add_func ("/gsettings/actions", test_actions);
   g_test_add_func ("/gsettings/null-backend", test_null_backend);
   g_test_add_func ("/gsettings/memory-backend", test_memory_backend);
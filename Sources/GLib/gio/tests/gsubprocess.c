@@ -4,6 +4,7 @@
 #ifdef G_OS_UNIX
 #include <sys/wait.h>
 #include <glib/glib-unix.h>
+#include <glib/gstdio.h>
 #include <gio/gunixinputstream.h>
 #include <gio/gunixoutputstream.h>
 #include <gio/gfiledescriptorbased.h>
@@ -2105,6 +2106,296 @@ test_exit_status_trapped (void)
 #endif
 }
 
+static GSubprocessLauncher *
+spawn_server_launcher_new (GSubprocessFlags flags)
+{
+  GSubprocessLauncher *launcher;
+
+  launcher = g_subprocess_launcher_new (flags);
+  g_subprocess_launcher_set_use_spawn_server (launcher, TRUE);
+
+  return launcher;
+}
+
+static void
+test_spawn_server_echo (void)
+{
+  GSubprocessLauncher *launcher;
+  GSubprocess *proc;
+  GPtrArray *args;
+  GError *error = NULL;
+  gchar *out;
+
+  g_test_summary ("Test pipes and exit status of processes launched through the spawn server");
+
+  launcher = spawn_server_launcher_new (G_SUBPROCESS_FLAGS_STDOUT_PIPE |
+                                        G_SUBPROCESS_FLAGS_STDERR_MERGE);
+
+  args = get_test_subprocess_args ("echo-stdout-and-stderr", "merge", "this", NULL);
+  proc = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) args->pdata, &error);
+  g_ptr_array_free (args, TRUE);
+  g_assert_no_error (error);
+
+  g_subprocess_communicate_utf8 (proc, NULL, NULL, &out, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (out, ==, "merge\nmerge\nthis\nthis\n");
+  g_free (out);
+
+  g_subprocess_wait_check (proc, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (proc);
+
+  args = get_test_subprocess_args ("exit1", NULL);
+  proc = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) args->pdata, &error);
+  g_ptr_array_free (args, TRUE);
+  g_assert_no_error (error);
+
+  g_subprocess_wait (proc, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (g_subprocess_get_if_exited (proc));
+  g_assert_cmpint (g_subprocess_get_exit_status (proc), ==, 1);
+  g_object_unref (proc);
+
+  g_object_unref (launcher);
+}
+
+static void
+test_spawn_server_env_cwd (void)
+{
+  GSubprocessLauncher *launcher;
+  GSubprocess *proc;
+  GPtrArray *args;
+  GError *error = NULL;
+  const gchar *tmpdir = g_get_tmp_dir ();
+  gchar *out, *tmpdir_basename, *out_basename;
+
+  g_test_summary ("Test that the spawn server uses the launcher’s environment and working directory");
+
+  launcher = spawn_server_launcher_new (G_SUBPROCESS_FLAGS_STDOUT_PIPE);
+  g_subprocess_launcher_setenv (launcher, "E", "F", TRUE);
+  g_subprocess_launcher_set_cwd (launcher, tmpdir);
+
+  args = get_test_subprocess_args ("printenv", "E", NULL);
+  proc = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) args->pdata, &error);
+  g_ptr_array_free (args, TRUE);
+  g_assert_no_error (error);
+
+  g_subprocess_communicate_utf8 (proc, NULL, NULL, &out, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (out, ==, "E=F\n");
+  g_free (out);
+  g_object_unref (proc);
+
+  args = get_test_subprocess_args ("cwd", NULL);
+  proc = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) args->pdata, &error);
+  g_ptr_array_free (args, TRUE);
+  g_assert_no_error (error);
+
+  g_subprocess_communicate_utf8 (proc, NULL, NULL, &out, NULL, &error);
+  g_assert_no_error (error);
+  tmpdir_basename = g_path_get_basename (tmpdir);
+  out_basename = g_path_get_basename (g_strstrip (out));
+  g_assert_cmpstr (out_basename, ==, tmpdir_basename);
+  g_free (tmpdir_basename);
+  g_free (out_basename);
+  g_free (out);
+  g_object_unref (proc);
+
+  g_object_unref (launcher);
+}
+
+static void
+test_spawn_server_pass_fd (void)
+{
+  GSubprocessLauncher *launcher;
+  GSubprocess *proc;
+  GPtrArray *args;
+  GError *error = NULL;
+  GInputStream *child_input;
+  GDataInputStream *child_datainput;
+  int pipefds[2];
+  char *fd_str, *buf;
+
+  g_test_summary ("Test passing a file descriptor to a new number through the spawn server");
+
+  g_unix_open_pipe (pipefds, O_CLOEXEC, &error);
+  g_assert_no_error (error);
+
+  fd_str = g_strdup_printf ("%d", pipefds[1] + 1);
+  args = get_test_subprocess_args ("write-to-fds", fd_str, NULL);
+  launcher = spawn_server_launcher_new (G_SUBPROCESS_FLAGS_NONE);
+  g_subprocess_launcher_take_fd (launcher, pipefds[1], pipefds[1] + 1);
+  proc = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) args->pdata, &error);
+  g_ptr_array_free (args, TRUE);
+  g_assert_no_error (error);
+  g_free (fd_str);
+
+  /* Drop our copy of the write end so that the read sees EOF. */
+  g_subprocess_launcher_close (launcher);
+
+  child_input = g_unix_input_stream_new (pipefds[0], TRUE);
+  child_datainput = g_data_input_stream_new (child_input);
+  buf = g_data_input_stream_read_line_utf8 (child_datainput, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "hello world");
+  g_free (buf);
+  g_object_unref (child_datainput);
+  g_object_unref (child_input);
+
+  g_subprocess_wait_check (proc, NULL, &error);
+  g_assert_no_error (error);
+
+  g_object_unref (proc);
+  g_object_unref (launcher);
+}
+
+static void
+test_spawn_server_noent (void)
+{
+  GSubprocessLauncher *launcher;
+  GSubprocess *proc;
+  GError *error = NULL;
+  const gchar *argv[] = { "/nonexistent/gsubprocess-testprog", NULL };
+
+  g_test_summary ("Test that exec() failures in the spawn server are reported");
+
+  launcher = spawn_server_launcher_new (G_SUBPROCESS_FLAGS_NONE);
+  proc = g_subprocess_launcher_spawnv (launcher, argv, &error);
+  g_assert_error (error, G_SPAWN_ERROR, G_SPAWN_ERROR_NOENT);
+  g_assert_null (proc);
+  g_clear_error (&error);
+
+  g_object_unref (launcher);
+}
+
+static void
+test_spawn_server_script (void)
+{
+  GSubprocessLauncher *launcher;
+  GSubprocess *proc;
+  GError *error = NULL;
+  gchar *tmpdir, *script, *old_cwd, *out;
+  gchar **lines, *tmpdir_basename, *out_basename;
+  const gchar *argv[] = { NULL, "arg", NULL };
+
+  g_test_summary ("Test that the spawn server runs scripts without a #! line "
+                  "with /bin/sh, in the caller’s working directory");
+
+  tmpdir = g_dir_make_tmp ("gsubprocess-spawn-server-XXXXXX", &error);
+  g_assert_no_error (error);
+  script = g_build_filename (tmpdir, "script", NULL);
+  g_file_set_contents (script, "echo \"$1\"\npwd\n", -1, &error);
+  g_assert_no_error (error);
+  g_assert_no_errno (g_chmod (script, 0755));
+  argv[0] = script;
+
+  /* The server process was started elsewhere, so the child must still
+   * pick up our working directory when the launcher has none set. */
+  old_cwd = g_get_current_dir ();
+  g_assert_no_errno (g_chdir (tmpdir));
+
+  launcher = spawn_server_launcher_new (G_SUBPROCESS_FLAGS_STDOUT_PIPE);
+  proc = g_subprocess_launcher_spawnv (launcher, argv, &error);
+  g_assert_no_error (error);
+
+  g_assert_no_errno (g_chdir (old_cwd));
+
+  g_subprocess_communicate_utf8 (proc, NULL, NULL, &out, NULL, &error);
+  g_assert_no_error (error);
+  g_subprocess_wait_check (proc, NULL, &error);
+  g_assert_no_error (error);
+
+  lines = g_strsplit (out, "\n", -1);
+  g_assert_cmpuint (g_strv_length (lines), ==, 3);
+  g_assert_cmpstr (lines[0], ==, "arg");
+  tmpdir_basename = g_path_get_basename (tmpdir);
+  out_basename = g_path_get_basename (lines[1]);
+  g_assert_cmpstr (out_basename, ==, tmpdir_basename);
+  g_free (tmpdir_basename);
+  g_free (out_basename);
+  g_strfreev (lines);
+  g_free (out);
+
+  g_object_unref (proc);
+  g_object_unref (launcher);
+  g_unlink (script);
+  g_rmdir (tmpdir);
+  g_free (old_cwd);
+  g_free (script);
+  g_free (tmpdir);
+}
+
+static gdouble
+spawn_server_perf_run (gboolean use_spawn_server,
+                       guint    n_launches)
+{
+  GSubprocessLauncher *launcher;
+  GPtrArray *args;
+  GError *error = NULL;
+  gdouble elapsed;
+  guint i;
+
+  /* A working directory forces gspawn off its posix_spawn() fast path, as
+   * is typical for an IDE running compilers in a project directory. */
+  launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE);
+  g_subprocess_launcher_set_cwd (launcher, g_get_tmp_dir ());
+  g_subprocess_launcher_set_use_spawn_server (launcher, use_spawn_server);
+  args = get_test_subprocess_args ("noop", NULL);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_launches; i++)
+    {
+      GSubprocess *proc;
+
+      proc = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) args->pdata, &error);
+      g_assert_no_error (error);
+      g_subprocess_wait_check (proc, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (proc);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+
+  g_ptr_array_free (args, TRUE);
+  g_object_unref (launcher);
+
+  return elapsed;
+}
+
+static void
+test_spawn_server_perf (void)
+{
+  gsize heap_size = g_test_perf () ? 1024 * 1024 * 1024 : 16 * 1024 * 1024;
+  guint n_launches = g_test_perf () ? 500 : 5;
+  guint8 *heap;
+  gdouble direct, server;
+  gsize i;
+
+  g_test_summary ("Compare launch throughput with and without the spawn server "
+                  "from a process with a large address space");
+
+  /* Touch every page, so that fork() has real page tables to copy. */
+  heap = g_malloc (heap_size);
+  for (i = 0; i < heap_size; i += 4096)
+    heap[i] = (guint8) i;
+
+  /* Start the server outside of the timed loop. */
+  spawn_server_perf_run (TRUE, 1);
+
+  direct = spawn_server_perf_run (FALSE, n_launches);
+  server = spawn_server_perf_run (TRUE, n_launches);
+
+  g_test_minimized_result (direct * 1e6 / n_launches,
+                           "direct launch: %.1f µs per process", direct * 1e6 / n_launches);
+  g_test_minimized_result (server * 1e6 / n_launches,
+                           "spawn server launch: %.1f µs per process", server * 1e6 / n_launches);
+  g_test_maximized_result (n_launches / server,
+                           "spawn server throughput: %.0f processes/s", n_launches / server);
+
+  g_free (heap);
+}
+
 #endif  /* G_OS_UNIX */
 
 static void
@@ -2250,6 +2541,12 @@ main (int argc, char **argv)
   g_test_add_func ("/gsubprocess/fd-conflation/inherit-fds", test_fd_conflation_inherit_fds);
   g_test_add_func ("/gsubprocess/fd-conflation/child-err-report-fd", test_fd_conflation_child_err_report_fd);
   g_test_add_func ("/gsubprocess/exit-status/trapped", test_exit_status_trapped);
+  g_test_add_func ("/gsubprocess/spawn-server/echo", test_spawn_server_echo);
+  g_test_add_func ("/gsubprocess/spawn-server/env-cwd", test_spawn_server_env_cwd);
+  g_test_add_func ("/gsubprocess/spawn-server/pass-fd", test_spawn_server_pass_fd);
+  g_test_add_func ("/gsubprocess/spawn-server/noent", test_spawn_server_noent);
+  g_test_add_func ("/gsubprocess/spawn-server/script", test_spawn_server_script);
+  g_test_add_func ("/gsubprocess/spawn-server/perf", test_spawn_server_perf);
 #endif
   g_test_add_func ("/gsubprocess/launcher-environment", test_launcher_environment);
 
@@ -1251,6 +1251,109 @@ test_happy_eyeballs_both_error_delays_3 (HappyEyeballsFixture *fixture,
   g_error_free (ipv6_error);
 }
 
+static void
+resolver_cache_lookup_cb (GObject      *source_object,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GList **addrs_out = user_data;
+  GError *error = NULL;
+
+  *addrs_out = g_resolver_lookup_by_name_with_flags_finish (G_RESOLVER (source_object),
+                                                            result, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (*addrs_out);
+}
+
+static void
+assert_first_address (GList       *addrs,
+                      const gchar *expected)
+{
+  gchar *str;
+
+  g_assert_nonnull (addrs);
+  str = g_inet_address_to_string (addrs->data);
+  g_assert_cmpstr (str, ==, expected);
+  g_free (str);
+}
+
+static void
+test_resolver_cache (void)
+{
+  MockResolver *mock_resolver;
+  GResolver *resolver;
+  GList *results = NULL, *addrs = NULL;
+  guint64 n_hits = 0, n_misses = 0;
+  GError *error = NULL;
+
+  g_test_summary ("Test that GResolver:cache-ttl caches successful name lookups");
+
+  mock_resolver = mock_resolver_new ();
+  resolver = G_RESOLVER (mock_resolver);
+
+  results = g_list_append (NULL, g_inet_address_new_from_string ("192.0.2.1"));
+  mock_resolver_set_ipv4_results (mock_resolver, results);
+  g_list_free_full (results, g_object_unref);
+
+  /* Caching is off by default */
+  g_assert_cmpuint (g_resolver_get_cache_ttl (resolver), ==, 0);
+  g_resolver_set_cache_ttl (resolver, 60);
+
+  addrs = g_resolver_lookup_by_name (resolver, "example.com", NULL, &error);
+  g_assert_no_error (error);
+  assert_first_address (addrs, "192.0.2.1");
+  g_resolver_free_addresses (addrs);
+
+  /* Change what the resolver would return; the cached result should win */
+  results = g_list_append (NULL, g_inet_address_new_from_string ("192.0.2.2"));
+  mock_resolver_set_ipv4_results (mock_resolver, results);
+  g_list_free_full (results, g_object_unref);
+
+  addrs = g_resolver_lookup_by_name (resolver, "example.com", NULL, &error);
+  g_assert_no_error (error);
+  assert_first_address (addrs, "192.0.2.1");
+  g_resolver_free_addresses (addrs);
+
+  g_resolver_get_cache_stats (resolver, &n_hits, &n_misses);
+  g_assert_cmpuint (n_hits, ==, 1);
+  g_assert_cmpuint (n_misses, ==, 1);
+
+  /* Entries are keyed by flags as well as by name, and async lookups
+   * share the cache */
+  g_resolver_lookup_by_name_with_flags_async (resolver, "example.com",
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, resolver_cache_lookup_cb, &addrs);
+  while (addrs == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  assert_first_address (addrs, "192.0.2.2");
+  g_clear_pointer (&addrs, g_resolver_free_addresses);
+
+  g_resolver_lookup_by_name_with_flags_async (resolver, "example.com",
+                                              G_RESOLVER_NAME_LOOKUP_FLAGS_IPV4_ONLY,
+                                              NULL, resolver_cache_lookup_cb, &addrs);
+  while (addrs == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  assert_first_address (addrs, "192.0.2.2");
+  g_clear_pointer (&addrs, g_resolver_free_addresses);
+
+  g_resolver_get_cache_stats (resolver, &n_hits, &n_misses);
+  g_assert_cmpuint (n_hits, ==, 2);
+  g_assert_cmpuint (n_misses, ==, 2);
+
+  /* Disabling the cache flushes it */
+  g_resolver_set_cache_ttl (resolver, 0);
+  addrs = g_resolver_lookup_by_name (resolver, "example.com", NULL, &error);
+  g_assert_no_error (error);
+  assert_first_address (addrs, "192.0.2.2");
+  g_resolver_free_addresses (addrs);
+
+  g_resolver_get_cache_stats (resolver, &n_hits, &n_misses);
+  g_assert_cmpuint (n_hits, ==, 2);
+  g_assert_cmpuint (n_misses, ==, 2);
+
+  g_object_unref (mock_resolver);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1297,6 +1400,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/network-address/localhost/async", test_localhost_async);
   g_test_add_func ("/network-address/localhost/sync", test_localhost_sync);
   g_test_add_func ("/network-address/to-string", test_to_string);
+  g_test_add_func ("/network-address/resolver-cache", test_resolver_cache);
 
   g_test_add ("/network-address/happy-eyeballs/basic", HappyEyeballsFixture, NULL,
               happy_eyeballs_setup, test_happy_eyeballs_basic, happy_eyeballs_teardown);
@@ -20,6 +20,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gio/gio.h>
 #include <glib/gstdio.h>
 
@@ -167,6 +169,70 @@ test_streams (GPollableInputStream *in,
   g_assert_cmpint (success, ==, TRUE);
 }
 
+static void
+test_streams_readv (GPollableInputStream *in,
+                    GOutputStream        *out)
+{
+  const gchar data[] = "headerpayload";
+  gchar header[6], payload[16];
+  GInputVector vectors[3];
+  GPollableReturn res;
+  GError *error = NULL;
+  gsize bytes_read = 42;
+  gsize total = 0;
+
+  vectors[0].buffer = header;
+  vectors[0].size = sizeof (header);
+  vectors[1].buffer = NULL;
+  vectors[1].size = 0;
+  vectors[2].buffer = payload;
+  vectors[2].size = sizeof (payload);
+
+  res = g_pollable_input_stream_readv_nonblocking (in, vectors, G_N_ELEMENTS (vectors),
+                                                   &bytes_read, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (res, ==, G_POLLABLE_RETURN_WOULD_BLOCK);
+  g_assert_cmpuint (bytes_read, ==, 0);
+
+  g_output_stream_write_all (out, data, strlen (data), NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  /* The data may take a moment to arrive, and a short read is allowed */
+  while (total < strlen (data))
+    {
+      res = g_pollable_input_stream_readv_nonblocking (in, vectors, G_N_ELEMENTS (vectors),
+                                                       &bytes_read, NULL, &error);
+      g_assert_no_error (error);
+
+      if (res == G_POLLABLE_RETURN_WOULD_BLOCK)
+        {
+          g_usleep (1000);
+          continue;
+        }
+
+      g_assert_cmpint (res, ==, G_POLLABLE_RETURN_OK);
+      g_assert_cmpuint (bytes_read, >, 0);
+
+      /* On a short read, continue filling where the last call stopped */
+      total += bytes_read;
+      if (total >= sizeof (header))
+        {
+          vectors[0].size = 0;
+          vectors[2].buffer = payload + (total - sizeof (header));
+          vectors[2].size = sizeof (payload) - (total - sizeof (header));
+        }
+      else
+        {
+          vectors[0].buffer = header + total;
+          vectors[0].size = sizeof (header) - total;
+        }
+    }
+
+  g_assert_cmpuint (total, ==, strlen (data));
+  g_assert_cmpmem (header, sizeof (header), "header", 6);
+  g_assert_cmpmem (payload, 7, "payload", 7);
+}
+
 #ifdef G_OS_UNIX
 
 #define g_assert_not_pollable(fd) \
@@ -201,6 +267,7 @@ test_pollable_unix_pipe (void)
   out = g_unix_output_stream_new (pipefds[1], TRUE);
 
   test_streams (in, out);
+  test_streams_readv (in, out);
 
   g_object_unref (in);
   g_object_unref (out);
@@ -377,6 +444,7 @@ test_pollable_socket (void)
   out = g_io_stream_get_output_stream (G_IO_STREAM (server_conn));
 
   test_streams (in, out);
+  test_streams_readv (in, out);
 
   g_object_unref (client_conn);
   g_object_unref (server_conn);
@@ -99,6 +99,196 @@ test_start_stop (void)
   g_object_unref (service);
 }
 
+static gboolean
+incoming_count_cb (GSocketService    *service,
+                   GSocketConnection *connection,
+                   GObject           *source_object,
+                   gpointer           user_data)
+{
+  guint *n_incoming = user_data;
+
+  (*n_incoming)++;
+
+  return FALSE;
+}
+
+/* Test that a backlog of several pending connections is fully delivered
+ * when the service starts, including those picked up by the batched
+ * non-blocking accepts that follow the first asynchronous one.
+ */
+static void
+test_accept_backlog (void)
+{
+  GInetAddress *iaddr;
+  GSocketAddress *saddr, *listening_addr;
+  GSocketService *service;
+  GSocketClient *client;
+  GSocketConnection *clients[8];
+  GError *error = NULL;
+  guint n_incoming = 0;
+  gsize i;
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  saddr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+
+  service = g_object_new (G_TYPE_SOCKET_SERVICE, "active", FALSE, NULL);
+  g_signal_connect (service, "incoming", G_CALLBACK (incoming_count_cb), &n_incoming);
+
+  g_socket_listener_add_address (G_SOCKET_LISTENER (service),
+                                 saddr,
+                                 G_SOCKET_TYPE_STREAM,
+                                 G_SOCKET_PROTOCOL_TCP,
+                                 NULL,
+                                 &listening_addr,
+                                 &error);
+  g_assert_no_error (error);
+  g_object_unref (saddr);
+
+  /* The kernel completes these handshakes and queues them in the listen
+   * backlog while the service is still inactive */
+  client = g_socket_client_new ();
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    {
+      clients[i] = g_socket_client_connect (client, G_SOCKET_CONNECTABLE (listening_addr),
+                                            NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  g_socket_service_start (service);
+
+  while (n_incoming < G_N_ELEMENTS (clients))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (n_incoming, ==, G_N_ELEMENTS (clients));
+
+  g_socket_service_stop (service);
+
+  for (i = 0; i < G_N_ELEMENTS (clients); i++)
+    g_object_unref (clients[i]);
+  g_object_unref (client);
+  g_object_unref (listening_addr);
+  g_object_unref (service);
+}
+
+static gboolean
+incoming_keep_cb (GSocketService    *service,
+                  GSocketConnection *connection,
+                  GObject           *source_object,
+                  gpointer           user_data)
+{
+  GPtrArray *server_connections = user_data;
+
+  g_ptr_array_add (server_connections, g_object_ref (connection));
+
+  return TRUE;
+}
+
+static void
+pool_connect_cb (GObject      *client,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GSocketConnection **conn = user_data;
+  GError *error = NULL;
+
+  *conn = g_socket_client_connect_finish (G_SOCKET_CLIENT (client), result, &error);
+  g_assert_no_error (error);
+}
+
+/* Test that a GSocketClient with pooling enabled hands released connections
+ * back out, and drops them once the peer has closed them.
+ */
+static void
+test_client_pool (void)
+{
+  GInetAddress *iaddr;
+  GSocketAddress *saddr, *listening_addr;
+  GSocketService *service;
+  GSocketClient *client;
+  GSocketConnection *conn, *first, *async_conn = NULL;
+  GPtrArray *server_connections;
+  guint64 n_reused, n_created;
+  GError *error = NULL;
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  saddr = g_inet_socket_address_new (iaddr, 0);
+  g_object_unref (iaddr);
+
+  server_connections = g_ptr_array_new_with_free_func (g_object_unref);
+  service = g_socket_service_new ();
+  g_signal_connect (service, "incoming", G_CALLBACK (incoming_keep_cb), server_connections);
+  g_socket_listener_add_address (G_SOCKET_LISTENER (service),
+                                 saddr,
+                                 G_SOCKET_TYPE_STREAM,
+                                 G_SOCKET_PROTOCOL_TCP,
+                                 NULL,
+                                 &listening_addr,
+                                 &error);
+  g_assert_no_error (error);
+  g_object_unref (saddr);
+
+  client = g_socket_client_new ();
+  g_assert_cmpuint (g_socket_client_get_pool_max_idle (client), ==, 0);
+  g_socket_client_set_pool_max_idle (client, 2);
+
+  conn = g_socket_client_connect (client, G_SOCKET_CONNECTABLE (listening_addr), NULL, &error);
+  g_assert_no_error (error);
+  first = conn;
+  g_socket_client_release_connection (client, conn);
+  g_object_unref (conn);
+
+  /* Reused, without a new connection being made */
+  conn = g_socket_client_connect (client, G_SOCKET_CONNECTABLE (listening_addr), NULL, &error);
+  g_assert_no_error (error);
+  g_assert_true (conn == first);
+
+  g_socket_client_get_pool_stats (client, &n_reused, &n_created);
+  g_assert_cmpuint (n_reused, ==, 1);
+  g_assert_cmpuint (n_created, ==, 1);
+
+  /* Once the server closes its end, the connection must not be pooled */
+  while (server_connections->len < 1)
+    g_main_context_iteration (NULL, TRUE);
+  g_io_stream_close (server_connections->pdata[0], NULL, &error);
+  g_assert_no_error (error);
+  g_socket_condition_timed_wait (g_socket_connection_get_socket (conn),
+                                 G_IO_IN, G_USEC_PER_SEC, NULL, &error);
+  g_assert_no_error (error);
+
+  g_socket_client_release_connection (client, conn);
+  g_object_unref (conn);
+
+  conn = g_socket_client_connect (client, G_SOCKET_CONNECTABLE (listening_addr), NULL, &error);
+  g_assert_no_error (error);
+
+  g_socket_client_get_pool_stats (client, &n_reused, &n_created);
+  g_assert_cmpuint (n_reused, ==, 1);
+  g_assert_cmpuint (n_created, ==, 2);
+
+  /* Asynchronous connects share the pool */
+  first = conn;
+  g_socket_client_release_connection (client, conn);
+  g_object_unref (conn);
+
+  g_socket_client_connect_async (client, G_SOCKET_CONNECTABLE (listening_addr),
+                                 NULL, pool_connect_cb, &async_conn);
+  while (async_conn == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_true (async_conn == first);
+
+  g_socket_client_get_pool_stats (client, &n_reused, &n_created);
+  g_assert_cmpuint (n_reused, ==, 2);
+  g_assert_cmpuint (n_created, ==, 2);
+
+  g_object_unref (async_conn);
+  g_socket_service_stop (service);
+  g_object_unref (client);
+  g_object_unref (listening_addr);
+  g_object_unref (service);
+  g_ptr_array_unref (server_connections);
+}
+
 GMutex mutex_712570;
 GCond cond_712570;
 gboolean finalized;  /* (atomic) */
@@ -560,6 +750,8 @@ main (int   argc,
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func ("/socket-service/start-stop", test_start_stop);
+  g_test_add_func ("/socket-service/accept-backlog", test_accept_backlog);
+  g_test_add_func ("/socket-service/client-pool", test_client_pool);
   g_test_add_func ("/socket-service/threaded/712570", test_threaded_712570);
   g_test_add_func ("/socket-service/read_write_async", test_read_write_async);
   g_test_add_func ("/socket-service/read_writev_async", test_read_writev_async);
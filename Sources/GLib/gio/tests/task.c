@@ -1172,6 +1172,57 @@ test_run_in_thread (void)
   g_mutex_unlock (&run_in_thread_mutex);
 }
 
+/* test_thread_pool: tasks can be moved to the CPU pool, whose
+ * statistics then account for them.
+ */
+static void
+thread_pool_thread (GTask        *task,
+                    gpointer      source_object,
+                    gpointer      task_data,
+                    GCancellable *cancellable)
+{
+  guint n_running = 0;
+
+  g_task_get_thread_pool_stats (G_TASK_THREAD_POOL_CPU, &n_running,
+                                NULL, NULL, NULL, NULL);
+  g_assert_cmpuint (n_running, >=, 1);
+
+  g_task_return_int (task, 42);
+}
+
+static void
+test_thread_pool (void)
+{
+  GTask *task;
+  GError *error = NULL;
+  guint max_threads = 0;
+  guint64 n_completed_before = 0, n_completed = 0;
+
+  g_task_get_thread_pool_stats (G_TASK_THREAD_POOL_CPU, NULL, &max_threads,
+                                NULL, &n_completed_before, NULL);
+  g_assert_cmpuint (max_threads, ==, g_get_num_processors ());
+
+  task = g_task_new (NULL, NULL, NULL, NULL);
+  g_assert_cmpint (g_task_get_thread_pool (task), ==, G_TASK_THREAD_POOL_IO);
+  g_task_set_thread_pool (task, G_TASK_THREAD_POOL_CPU);
+  g_assert_cmpint (g_task_get_thread_pool (task), ==, G_TASK_THREAD_POOL_CPU);
+
+  g_task_run_in_thread_sync (task, thread_pool_thread);
+  g_assert_cmpint (g_task_propagate_int (task, &error), ==, 42);
+  g_assert_no_error (error);
+  g_object_unref (task);
+
+  /* The counters are updated once the thread is done with the task, which
+   * may be after g_task_run_in_thread_sync() returned. */
+  while (n_completed != n_completed_before + 1)
+    {
+      g_task_get_thread_pool_stats (G_TASK_THREAD_POOL_CPU, NULL, NULL,
+                                    NULL, &n_completed, NULL);
+      g_assert_cmpuint (n_completed, <=, n_completed_before + 1);
+      g_usleep (1000);
+    }
+}
+
 /* test_run_in_thread_sync */
 
 static void
@@ -2599,6 +2650,7 @@ main (int argc, char **argv)
   g_test_add_func ("/gtask/run-in-thread-priority", test_run_in_thread_priority);
   g_test_add_func ("/gtask/run-in-thread-nested", test_run_in_thread_nested);
   g_test_add_func ("/gtask/run-in-thread-overflow", test_run_in_thread_overflow);
+  g_test_add_func ("/gtask/thread-pool", test_thread_pool);
   g_test_add_func ("/gtask/return-on-cancel", test_return_on_cancel);
   g_test_add_func ("/gtask/return-on-cancel-sync", test_return_on_cancel_sync);
   g_test_add_func ("/gtask/return-on-cancel-atomic", test_return_on_cancel_atomic);
@@ -3,6 +3,11 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#endif
 
 static gboolean
 skip_win32 (void)
@@ -1036,6 +1041,462 @@ test_file_hard_links (Fixture       *fixture,
   g_object_unref (data.output_stream);
 }
 
+typedef struct
+{
+  GMainLoop *loop;
+  GHashTable *changes; /* basename -> GFileMonitorChangeFlags */
+  guint n_batches;
+  guint n_changed;
+} BatchData;
+
+static void
+monitor_changed_batch (GFileMonitor *monitor,
+                       GHashTable   *changes,
+                       gpointer      user_data)
+{
+  BatchData *data = user_data;
+  GHashTableIter iter;
+  gpointer file, value;
+
+  data->n_batches++;
+
+  g_hash_table_iter_init (&iter, changes);
+  while (g_hash_table_iter_next (&iter, &file, &value))
+    {
+      gchar *basename = g_file_get_basename (file);
+      guint old = GPOINTER_TO_UINT (g_hash_table_lookup (data->changes, basename));
+
+      g_hash_table_insert (data->changes, basename, GUINT_TO_POINTER (old | GPOINTER_TO_UINT (value)));
+    }
+}
+
+static void
+monitor_changed_count (GFileMonitor      *monitor,
+                       GFile             *file,
+                       GFile             *other_file,
+                       GFileMonitorEvent  event_type,
+                       gpointer           user_data)
+{
+  BatchData *data = user_data;
+
+  data->n_changed++;
+}
+
+static guint
+get_batch_changes (BatchData   *data,
+                   const gchar *basename)
+{
+  return GPOINTER_TO_UINT (g_hash_table_lookup (data->changes, basename));
+}
+
+static void
+test_dir_batch (Fixture       *fixture,
+                gconstpointer  user_data)
+{
+  GFile *dir, *file, *file2;
+  GFileMonitor *monitor;
+  GError *error = NULL;
+  BatchData data = { 0, };
+  gint batch_latency;
+  guint i;
+
+  g_test_summary ("Test that changes are coalesced per file and emitted in batches "
+                  "when GFileMonitor:batch-latency is set.");
+
+  if (skip_win32 ())
+    return;
+
+  dir = g_file_get_child (fixture->tmp_dir, "dir_batch_test");
+  g_file_make_directory (dir, NULL, &error);
+  g_assert_no_error (error);
+
+  monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+  g_assert_no_error (error);
+
+  g_file_monitor_set_batch_latency (monitor, 200);
+  g_object_get (monitor, "batch-latency", &batch_latency, NULL);
+  if (batch_latency == 0)
+    {
+      g_test_skip_printf ("%s does not support batching", G_OBJECT_TYPE_NAME (monitor));
+      g_object_unref (monitor);
+      g_file_delete (dir, NULL, NULL);
+      g_object_unref (dir);
+      return;
+    }
+  g_assert_cmpint (batch_latency, ==, 200);
+
+  data.loop = g_main_loop_new (NULL, TRUE);
+  data.changes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_signal_connect (monitor, "changed-batch", G_CALLBACK (monitor_changed_batch), &data);
+  g_signal_connect (monitor, "changed", G_CALLBACK (monitor_changed_count), &data);
+
+  for (i = 0; i < 100; i++)
+    {
+      gchar *name = g_strdup_printf ("file_%u", i);
+
+      file = g_file_get_child (dir, name);
+      g_file_replace_contents (file, "contents", 8, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (file);
+      g_free (name);
+    }
+
+  file = g_file_get_child (dir, "file_0");
+  file2 = g_file_get_child (dir, "renamed");
+  g_file_move (file, file2, G_FILE_COPY_NONE, NULL, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+  g_object_unref (file2);
+
+  file = g_file_get_child (dir, "file_1");
+  g_file_delete (file, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+
+  g_timeout_add_once (1500, (GSourceOnceFunc) g_main_loop_quit, data.loop);
+  g_main_loop_run (data.loop);
+
+  g_assert_cmpuint (data.n_changed, ==, 0);
+  g_assert_cmpuint (data.n_batches, >, 0);
+  g_assert_cmpuint (data.n_batches, <, 10);
+  g_assert_cmpuint (g_hash_table_size (data.changes), ==, 101);
+
+  for (i = 2; i < 100; i++)
+    {
+      gchar *name = g_strdup_printf ("file_%u", i);
+
+      g_assert_cmpuint (get_batch_changes (&data, name) & G_FILE_MONITOR_CHANGE_CREATED, !=, 0);
+      g_assert_cmpuint (get_batch_changes (&data, name) & G_FILE_MONITOR_CHANGE_DELETED, ==, 0);
+      g_free (name);
+    }
+
+  g_assert_cmpuint (get_batch_changes (&data, "file_0") & G_FILE_MONITOR_CHANGE_DELETED, !=, 0);
+  g_assert_cmpuint (get_batch_changes (&data, "file_1") & G_FILE_MONITOR_CHANGE_DELETED, !=, 0);
+  g_assert_cmpuint (get_batch_changes (&data, "renamed"), ==, G_FILE_MONITOR_CHANGE_CREATED);
+
+  g_object_unref (monitor);
+
+  for (i = 2; i < 100; i++)
+    {
+      gchar *name = g_strdup_printf ("file_%u", i);
+
+      file = g_file_get_child (dir, name);
+      g_file_delete (file, NULL, NULL);
+      g_object_unref (file);
+      g_free (name);
+    }
+  file = g_file_get_child (dir, "renamed");
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_file_delete (dir, NULL, &error);
+  g_assert_no_error (error);
+
+  g_hash_table_unref (data.changes);
+  g_main_loop_unref (data.loop);
+  g_object_unref (dir);
+}
+
+static void
+delete_tree (GFile *file)
+{
+  GFileEnumerator *enumerator;
+
+  enumerator = g_file_enumerate_children (file, G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS, NULL, NULL);
+  if (enumerator)
+    {
+      GFile *child;
+
+      while (g_file_enumerator_iterate (enumerator, NULL, &child, NULL, NULL) && child)
+        delete_tree (child);
+
+      g_object_unref (enumerator);
+    }
+
+  g_file_delete (file, NULL, NULL);
+}
+
+typedef struct
+{
+  GFile *dir;
+  GMainLoop *loop;
+  GHashTable *events;  /* relative path → GFileMonitorEvent bitmask */
+} RecursiveData;
+
+static void
+monitor_changed_recursive (GFileMonitor      *monitor,
+                           GFile             *file,
+                           GFile             *other_file,
+                           GFileMonitorEvent  event_type,
+                           gpointer           user_data)
+{
+  RecursiveData *data = user_data;
+  gchar *path;
+  guint events;
+
+  path = g_file_get_relative_path (data->dir, file);
+  if (path == NULL)
+    return;
+
+  events = GPOINTER_TO_UINT (g_hash_table_lookup (data->events, path));
+  g_hash_table_insert (data->events, path, GUINT_TO_POINTER (events | (1u << event_type)));
+}
+
+static gboolean
+recursive_saw (RecursiveData     *data,
+               const gchar       *path,
+               GFileMonitorEvent  event_type)
+{
+  return (GPOINTER_TO_UINT (g_hash_table_lookup (data->events, path)) & (1u << event_type)) != 0;
+}
+
+static void
+test_dir_recursive (Fixture       *fixture,
+                    gconstpointer  user_data)
+{
+  RecursiveData data = { 0, };
+  GFileMonitor *monitor;
+  GError *error = NULL;
+  GFile *sub, *file;
+
+  g_test_summary ("Test that G_FILE_MONITOR_WATCH_RECURSIVE reports changes "
+                  "anywhere below the monitored directory.");
+
+  data.dir = g_file_get_child (fixture->tmp_dir, "dir_recursive_test");
+  g_file_make_directory (data.dir, NULL, &error);
+  g_assert_no_error (error);
+
+  sub = g_file_resolve_relative_path (data.dir, "a/b");
+  g_file_make_directory_with_parents (sub, NULL, &error);
+  g_assert_no_error (error);
+
+  monitor = g_file_monitor_directory (data.dir, G_FILE_MONITOR_WATCH_RECURSIVE, NULL, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+    {
+      g_test_skip (error->message);
+      g_clear_error (&error);
+      delete_tree (data.dir);
+      g_object_unref (sub);
+      g_object_unref (data.dir);
+      return;
+    }
+  g_assert_no_error (error);
+
+  data.loop = g_main_loop_new (NULL, TRUE);
+  data.events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_file_monitor_set_rate_limit (monitor, 200);
+  g_signal_connect (monitor, "changed", G_CALLBACK (monitor_changed_recursive), &data);
+
+  /* A file in an existing subdirectory */
+  file = g_file_get_child (sub, "file");
+  g_file_replace_contents (file, "contents", 8, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+
+  /* A file in a subdirectory created after the monitor */
+  file = g_file_resolve_relative_path (data.dir, "a/c/d");
+  g_file_make_directory_with_parents (file, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+
+  g_timeout_add_once (500, (GSourceOnceFunc) g_main_loop_quit, data.loop);
+  g_main_loop_run (data.loop);
+
+  file = g_file_resolve_relative_path (data.dir, "a/c/d/file");
+  g_file_replace_contents (file, "contents", 8, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_file_delete (file, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+
+  g_timeout_add_once (1000, (GSourceOnceFunc) g_main_loop_quit, data.loop);
+  g_main_loop_run (data.loop);
+
+  g_assert_true (recursive_saw (&data, "a/b/file", G_FILE_MONITOR_EVENT_CREATED));
+  g_assert_true (recursive_saw (&data, "a/c", G_FILE_MONITOR_EVENT_CREATED));
+  g_assert_true (recursive_saw (&data, "a/c/d/file", G_FILE_MONITOR_EVENT_CREATED));
+  g_assert_true (recursive_saw (&data, "a/c/d/file", G_FILE_MONITOR_EVENT_DELETED));
+
+  g_object_unref (monitor);
+  delete_tree (data.dir);
+
+  g_hash_table_unref (data.events);
+  g_main_loop_unref (data.loop);
+  g_object_unref (sub);
+  g_object_unref (data.dir);
+}
+
+static void
+test_dir_recursive_move_in (Fixture       *fixture,
+                            gconstpointer  user_data)
+{
+  RecursiveData data = { 0, };
+  GFileMonitor *monitor;
+  GError *error = NULL;
+  GFile *outside, *sub, *file;
+
+  g_test_summary ("Test that G_FILE_MONITOR_WATCH_RECURSIVE reports changes "
+                  "in a directory tree moved in from outside the monitored "
+                  "directory, after changes were made to it outside.");
+
+  data.dir = g_file_get_child (fixture->tmp_dir, "dir_recursive_move_in_test");
+  g_file_make_directory (data.dir, NULL, &error);
+  g_assert_no_error (error);
+
+  outside = g_file_get_child (fixture->tmp_dir, "dir_recursive_move_in_outside");
+  sub = g_file_resolve_relative_path (outside, "x/y");
+  g_file_make_directory_with_parents (sub, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (sub);
+
+  monitor = g_file_monitor_directory (data.dir, G_FILE_MONITOR_WATCH_RECURSIVE, NULL, &error);
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+    {
+      g_test_skip (error->message);
+      g_clear_error (&error);
+      delete_tree (data.dir);
+      delete_tree (outside);
+      g_object_unref (outside);
+      g_object_unref (data.dir);
+      return;
+    }
+  g_assert_no_error (error);
+
+  data.loop = g_main_loop_new (NULL, TRUE);
+  data.events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_file_monitor_set_rate_limit (monitor, 200);
+  g_signal_connect (monitor, "changed", G_CALLBACK (monitor_changed_recursive), &data);
+
+  /* Changes outside the tree are not reported, but the monitor may still
+   * see them and remember where their directories are */
+  file = g_file_resolve_relative_path (outside, "x/y/before");
+  g_file_replace_contents (file, "contents", 8, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+
+  g_timeout_add_once (200, (GSourceOnceFunc) g_main_loop_quit, data.loop);
+  g_main_loop_run (data.loop);
+
+  sub = g_file_get_child (outside, "x");
+  file = g_file_get_child (data.dir, "x");
+  g_file_move (sub, file, G_FILE_COPY_NO_FALLBACK_FOR_MOVE, NULL, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+  g_object_unref (sub);
+
+  g_timeout_add_once (500, (GSourceOnceFunc) g_main_loop_quit, data.loop);
+  g_main_loop_run (data.loop);
+
+  file = g_file_resolve_relative_path (data.dir, "x/y/after");
+  g_file_replace_contents (file, "contents", 8, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (file);
+
+  g_timeout_add_once (1000, (GSourceOnceFunc) g_main_loop_quit, data.loop);
+  g_main_loop_run (data.loop);
+
+  g_assert_false (recursive_saw (&data, "x/y/before", G_FILE_MONITOR_EVENT_CREATED));
+  g_assert_true (recursive_saw (&data, "x/y/after", G_FILE_MONITOR_EVENT_CREATED));
+
+  g_object_unref (monitor);
+  delete_tree (data.dir);
+  delete_tree (outside);
+
+  g_hash_table_unref (data.events);
+  g_main_loop_unref (data.loop);
+  g_object_unref (outside);
+  g_object_unref (data.dir);
+}
+
+static gsize
+get_resident_size (void)
+{
+#ifdef __linux__
+  gchar *contents = NULL;
+  gsize resident = 0;
+
+  if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+    {
+      gchar **fields = g_strsplit (contents, " ", 3);
+
+      if (g_strv_length (fields) >= 2)
+        resident = g_ascii_strtoull (fields[1], NULL, 10) * sysconf (_SC_PAGESIZE);
+
+      g_strfreev (fields);
+      g_free (contents);
+    }
+
+  return resident;
+#else
+  return 0;
+#endif
+}
+
+static void
+test_dir_recursive_performance (Fixture       *fixture,
+                                gconstpointer  user_data)
+{
+  const guint n_top = 10, n_mid = 100, n_leaf = 100;
+  GFileMonitor *monitor;
+  GError *error = NULL;
+  gsize rss_before, rss_after;
+  gdouble elapsed;
+  gchar *root;
+  GFile *dir;
+  guint i, j, k;
+
+  g_test_summary ("Measure the time and memory needed to start recursively "
+                  "monitoring a tree of 100,000 directories.");
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  dir = g_file_get_child (fixture->tmp_dir, "dir_recursive_perf");
+  root = g_file_get_path (dir);
+
+  for (i = 0; i < n_top; i++)
+    for (j = 0; j < n_mid; j++)
+      for (k = 0; k < n_leaf; k++)
+        {
+          gchar *path = g_strdup_printf ("%s/%u/%u/%u", root, i, j, k);
+          g_assert_no_errno (g_mkdir_with_parents (path, 0700));
+          g_free (path);
+        }
+
+  rss_before = get_resident_size ();
+  g_test_timer_start ();
+
+  monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_WATCH_RECURSIVE, NULL, &error);
+
+  elapsed = g_test_timer_elapsed ();
+  rss_after = get_resident_size ();
+
+  if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+    {
+      g_test_skip (error->message);
+      g_clear_error (&error);
+    }
+  else
+    {
+      g_assert_no_error (error);
+
+      g_test_minimized_result (elapsed, "Started monitoring %u directories in %.3f seconds",
+                               n_top * n_mid * n_leaf, elapsed);
+      if (rss_before && rss_after)
+        g_test_message ("Resident memory grew by %" G_GSIZE_FORMAT " KiB",
+                        (rss_after - MIN (rss_before, rss_after)) / 1024);
+
+      g_object_unref (monitor);
+    }
+
+  delete_tree (dir);
+  g_object_unref (dir);
+  g_free (root);
+}
+
 static void
 test_finalize_in_callback (Fixture       *fixture,
                            gconstpointer  user_data)
@@ -1128,6 +1589,10 @@ main (int argc, char *argv[])
   g_test_add ("/monitor/dir-not-existent", Fixture, NULL, setup, test_dir_non_existent, teardown);
   g_test_add ("/monitor/cross-dir-moves", Fixture, NULL, setup, test_cross_dir_moves, teardown);
   g_test_add ("/monitor/file/hard-links", Fixture, NULL, setup, test_file_hard_links, teardown);
+  g_test_add ("/monitor/dir-batch", Fixture, NULL, setup, test_dir_batch, teardown);
+  g_test_add ("/monitor/dir-recursive", Fixture, NULL, setup, test_dir_recursive, teardown);
+  g_test_add ("/monitor/recursive/move-in", Fixture, NULL, setup, test_dir_recursive_move_in, teardown);
+  g_test_add ("/monitor/recursive/performance", Fixture, NULL, setup, test_dir_recursive_performance, teardown);
   g_test_add ("/monitor/finalize-in-callback", Fixture, NULL, setup, test_finalize_in_callback, teardown);
   g_test_add ("/monitor/root", Fixture, NULL, setup, test_root, teardown);
 
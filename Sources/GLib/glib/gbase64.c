@@ -29,11 +29,295 @@
 
 #include "gbase64.h"
 #include "gtestutils.h"
+#include "gthread.h"
 #include "glibintl.h"
 
 static const char base64_alphabet[] =
         "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+/*
+ * Vectorized encoding and decoding
+ *
+ * The kernels below handle the bulk of the data, in blocks of several
+ * groups (3 bytes when encoding, 4 characters when decoding); everything
+ * else (the saved state, line breaks, padding, whitespace and invalid
+ * characters) is left to the generic code.
+ *
+ * On x86 they use SSSE3, and are only used if the CPU supports it;
+ * on AArch64 they use NEON, which is always available.
+ */
+
+#if (defined (__x86_64__) || defined (__i386__)) && \
+    (G_GNUC_CHECK_VERSION (5, 0) || defined (__clang__))
+#define HAVE_BASE64_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+
+/* Encoding reads 16 bytes for each block of 12 */
+#define BASE64_ENCODE_BLOCK 12
+#define BASE64_ENCODE_OVERREAD 4
+#define BASE64_DECODE_BLOCK 16
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+#define HAVE_BASE64_NEON 1
+#include <arm_neon.h>
+
+#define BASE64_ENCODE_BLOCK 48
+#define BASE64_ENCODE_OVERREAD 0
+#define BASE64_DECODE_BLOCK 64
+#endif
+
+#if defined (HAVE_BASE64_X86) || defined (HAVE_BASE64_NEON)
+#define HAVE_BASE64_SIMD 1
+
+/* Encodes @n_blocks blocks of BASE64_ENCODE_BLOCK bytes */
+typedef void (* Base64EncodeBlocksFunc) (const guchar *in,
+                                         gsize         n_blocks,
+                                         gchar        *out);
+
+/* Decodes at most @n_blocks blocks of BASE64_DECODE_BLOCK characters,
+ * stopping before the first one containing a character that is not
+ * in the alphabet (this includes padding and whitespace), and returns
+ * the number of decoded blocks
+ */
+typedef gsize (* Base64DecodeBlocksFunc) (const guchar *in,
+                                          gsize         n_blocks,
+                                          guchar       *out);
+#endif
+
+#ifdef HAVE_BASE64_X86
+__attribute__ ((target ("ssse3")))
+static void
+base64_encode_blocks_ssse3 (const guchar *in,
+                            gsize         n_blocks,
+                            gchar        *out)
+{
+  /* Places the 3 bytes of each group in a 32-bit lane as b1 b0 b2 b1 */
+  const __m128i spread = _mm_setr_epi8 (1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+
+  while (n_blocks--)
+    {
+      __m128i v, a, b, indices, ascii;
+
+      v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) in), spread);
+
+      /* Move each sextet to its own byte */
+      a = _mm_mulhi_epu16 (_mm_and_si128 (v, _mm_set1_epi32 (0x0fc0fc00)),
+                           _mm_set1_epi32 (0x04000040));
+      b = _mm_mullo_epi16 (_mm_and_si128 (v, _mm_set1_epi32 (0x003f03f0)),
+                           _mm_set1_epi32 (0x01000010));
+      indices = _mm_or_si128 (a, b);
+
+      /* Map 0…63 to the alphabet: 'A' + n, then shifted for each range */
+      ascii = _mm_add_epi8 (indices, _mm_set1_epi8 ('A'));
+      ascii = _mm_add_epi8 (ascii, _mm_and_si128 (_mm_cmpgt_epi8 (indices, _mm_set1_epi8 (25)),
+                                                  _mm_set1_epi8 ('a' - 'A' - 26)));
+      ascii = _mm_add_epi8 (ascii, _mm_and_si128 (_mm_cmpgt_epi8 (indices, _mm_set1_epi8 (51)),
+                                                  _mm_set1_epi8 ('0' - 'a' - 26)));
+      ascii = _mm_add_epi8 (ascii, _mm_and_si128 (_mm_cmpgt_epi8 (indices, _mm_set1_epi8 (61)),
+                                                  _mm_set1_epi8 ('+' - '0' - 10)));
+      ascii = _mm_add_epi8 (ascii, _mm_and_si128 (_mm_cmpeq_epi8 (indices, _mm_set1_epi8 (63)),
+                                                  _mm_set1_epi8 ('/' - '+' - 1)));
+
+      _mm_storeu_si128 ((__m128i *) out, ascii);
+
+      in += BASE64_ENCODE_BLOCK;
+      out += 16;
+    }
+}
+
+__attribute__ ((target ("ssse3")))
+static inline __m128i
+base64_range_mask (__m128i v,
+                   char    first,
+                   char    last)
+{
+  return _mm_and_si128 (_mm_cmpgt_epi8 (v, _mm_set1_epi8 (first - 1)),
+                        _mm_cmpgt_epi8 (_mm_set1_epi8 (last + 1), v));
+}
+
+__attribute__ ((target ("ssse3")))
+static gsize
+base64_decode_blocks_ssse3 (const guchar *in,
+                            gsize         n_blocks,
+                            guchar       *out)
+{
+  /* Gathers the 3 bytes of each group, most significant first */
+  const __m128i gather = _mm_setr_epi8 (2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  gsize i;
+
+  for (i = 0; i < n_blocks; i++)
+    {
+      __m128i v, upper, lower, digit, plus, slash, shift, bytes;
+      guint32 tail;
+
+      v = _mm_loadu_si128 ((const __m128i *) in);
+
+      /* Bytes >= 0x80 are negative, and don't match any range */
+      upper = base64_range_mask (v, 'A', 'Z');
+      lower = base64_range_mask (v, 'a', 'z');
+      digit = base64_range_mask (v, '0', '9');
+      plus = _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('+'));
+      slash = _mm_cmpeq_epi8 (v, _mm_set1_epi8 ('/'));
+
+      if (_mm_movemask_epi8 (_mm_or_si128 (_mm_or_si128 (upper, lower),
+                                           _mm_or_si128 (digit, _mm_or_si128 (plus, slash)))) != 0xffff)
+        break;
+
+      shift = _mm_or_si128 (_mm_and_si128 (upper, _mm_set1_epi8 (-'A')),
+                            _mm_and_si128 (lower, _mm_set1_epi8 (26 - 'a')));
+      shift = _mm_or_si128 (shift, _mm_and_si128 (digit, _mm_set1_epi8 (52 - '0')));
+      shift = _mm_or_si128 (shift, _mm_and_si128 (plus, _mm_set1_epi8 (62 - '+')));
+      shift = _mm_or_si128 (shift, _mm_and_si128 (slash, _mm_set1_epi8 (63 - '/')));
+      v = _mm_add_epi8 (v, shift);
+
+      /* Merge the sextets into 24-bit groups, and pack them */
+      v = _mm_maddubs_epi16 (v, _mm_set1_epi32 (0x01400140));
+      v = _mm_madd_epi16 (v, _mm_set1_epi32 (0x00011000));
+      bytes = _mm_shuffle_epi8 (v, gather);
+
+      _mm_storel_epi64 ((__m128i *) out, bytes);
+      tail = _mm_cvtsi128_si32 (_mm_srli_si128 (bytes, 8));
+      memcpy (out + 8, &tail, sizeof (tail));
+
+      in += BASE64_DECODE_BLOCK;
+      out += 12;
+    }
+
+  return i;
+}
+
+static gboolean
+base64_ssse3_supported (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  return __get_cpuid (1, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 9)) != 0;
+}
+#endif /* HAVE_BASE64_X86 */
+
+#ifdef HAVE_BASE64_NEON
+static void
+base64_encode_blocks_neon (const guchar *in,
+                           gsize         n_blocks,
+                           gchar        *out)
+{
+  uint8x16x4_t alphabet;
+
+  alphabet.val[0] = vld1q_u8 ((const guint8 *) base64_alphabet);
+  alphabet.val[1] = vld1q_u8 ((const guint8 *) base64_alphabet + 16);
+  alphabet.val[2] = vld1q_u8 ((const guint8 *) base64_alphabet + 32);
+  alphabet.val[3] = vld1q_u8 ((const guint8 *) base64_alphabet + 48);
+
+  while (n_blocks--)
+    {
+      uint8x16x3_t v = vld3q_u8 (in);
+      uint8x16x4_t indices;
+
+      indices.val[0] = vshrq_n_u8 (v.val[0], 2);
+      indices.val[1] = vandq_u8 (vorrq_u8 (vshrq_n_u8 (v.val[1], 4), vshlq_n_u8 (v.val[0], 4)),
+                                 vdupq_n_u8 (0x3f));
+      indices.val[2] = vandq_u8 (vorrq_u8 (vshrq_n_u8 (v.val[2], 6), vshlq_n_u8 (v.val[1], 2)),
+                                 vdupq_n_u8 (0x3f));
+      indices.val[3] = vandq_u8 (v.val[2], vdupq_n_u8 (0x3f));
+
+      indices.val[0] = vqtbl4q_u8 (alphabet, indices.val[0]);
+      indices.val[1] = vqtbl4q_u8 (alphabet, indices.val[1]);
+      indices.val[2] = vqtbl4q_u8 (alphabet, indices.val[2]);
+      indices.val[3] = vqtbl4q_u8 (alphabet, indices.val[3]);
+
+      vst4q_u8 ((guint8 *) out, indices);
+
+      in += BASE64_ENCODE_BLOCK;
+      out += 64;
+    }
+}
+
+static inline uint8x16_t
+base64_decode_neon (uint8x16_t  v,
+                    uint8x16_t *valid)
+{
+  uint8x16_t upper, lower, digit, plus, slash, shift;
+
+  upper = vcleq_u8 (vsubq_u8 (v, vdupq_n_u8 ('A')), vdupq_n_u8 ('Z' - 'A'));
+  lower = vcleq_u8 (vsubq_u8 (v, vdupq_n_u8 ('a')), vdupq_n_u8 ('z' - 'a'));
+  digit = vcleq_u8 (vsubq_u8 (v, vdupq_n_u8 ('0')), vdupq_n_u8 ('9' - '0'));
+  plus = vceqq_u8 (v, vdupq_n_u8 ('+'));
+  slash = vceqq_u8 (v, vdupq_n_u8 ('/'));
+
+  *valid = vandq_u8 (*valid, vorrq_u8 (vorrq_u8 (upper, lower),
+                                       vorrq_u8 (digit, vorrq_u8 (plus, slash))));
+
+  shift = vorrq_u8 (vandq_u8 (upper, vdupq_n_u8 ((guint8) -'A')),
+                    vandq_u8 (lower, vdupq_n_u8 ((guint8) (26 - 'a'))));
+  shift = vorrq_u8 (shift, vandq_u8 (digit, vdupq_n_u8 ((guint8) (52 - '0'))));
+  shift = vorrq_u8 (shift, vandq_u8 (plus, vdupq_n_u8 ((guint8) (62 - '+'))));
+  shift = vorrq_u8 (shift, vandq_u8 (slash, vdupq_n_u8 ((guint8) (63 - '/'))));
+
+  return vaddq_u8 (v, shift);
+}
+
+static gsize
+base64_decode_blocks_neon (const guchar *in,
+                           gsize         n_blocks,
+                           guchar       *out)
+{
+  gsize i;
+
+  for (i = 0; i < n_blocks; i++)
+    {
+      uint8x16x4_t v = vld4q_u8 (in);
+      uint8x16x3_t bytes;
+      uint8x16_t valid = vdupq_n_u8 (0xff);
+
+      v.val[0] = base64_decode_neon (v.val[0], &valid);
+      v.val[1] = base64_decode_neon (v.val[1], &valid);
+      v.val[2] = base64_decode_neon (v.val[2], &valid);
+      v.val[3] = base64_decode_neon (v.val[3], &valid);
+
+      if (vminvq_u8 (valid) == 0)
+        break;
+
+      bytes.val[0] = vorrq_u8 (vshlq_n_u8 (v.val[0], 2), vshrq_n_u8 (v.val[1], 4));
+      bytes.val[1] = vorrq_u8 (vshlq_n_u8 (v.val[1], 4), vshrq_n_u8 (v.val[2], 2));
+      bytes.val[2] = vorrq_u8 (vshlq_n_u8 (v.val[2], 6), v.val[3]);
+
+      vst3q_u8 (out, bytes);
+
+      in += BASE64_DECODE_BLOCK;
+      out += 48;
+    }
+
+  return i;
+}
+#endif /* HAVE_BASE64_NEON */
+
+#ifdef HAVE_BASE64_SIMD
+static Base64EncodeBlocksFunc base64_encode_blocks;
+static Base64DecodeBlocksFunc base64_decode_blocks;
+
+static void
+base64_init_blocks (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+#if defined (HAVE_BASE64_X86)
+      if (base64_ssse3_supported ())
+        {
+          base64_encode_blocks = base64_encode_blocks_ssse3;
+          base64_decode_blocks = base64_decode_blocks_ssse3;
+        }
+#elif defined (HAVE_BASE64_NEON)
+      base64_encode_blocks = base64_encode_blocks_neon;
+      base64_decode_blocks = base64_decode_blocks_neon;
+#endif
+
+      g_once_init_leave (&initialized, 1);
+    }
+}
+#endif /* HAVE_BASE64_SIMD */
+
 /**
  * g_base64_encode_step:
  * @in: (array length=len) (element-type guint8): the binary data to encode
@@ -86,6 +370,10 @@ g_base64_encode_step (const guchar *in,
   if (len == 0)
     return 0;
 
+#ifdef HAVE_BASE64_SIMD
+  base64_init_blocks ();
+#endif
+
   inptr = in;
   outptr = out;
 
@@ -114,6 +402,36 @@ g_base64_encode_step (const guchar *in,
        */
       while (inptr < inend)
         {
+#ifdef HAVE_BASE64_SIMD
+          /* Encode whole blocks at once, up to the next line break */
+          if (base64_encode_blocks != NULL &&
+              (gsize) (inend + 2 - inptr) >= BASE64_ENCODE_BLOCK + BASE64_ENCODE_OVERREAD)
+            {
+              gsize n_blocks, n_groups;
+
+              n_blocks = (inend + 2 - inptr - BASE64_ENCODE_OVERREAD) / BASE64_ENCODE_BLOCK;
+              if (break_lines)
+                n_blocks = MIN (n_blocks, (gsize) (19 - already) / (BASE64_ENCODE_BLOCK / 3));
+
+              if (n_blocks > 0)
+                {
+                  base64_encode_blocks (inptr, n_blocks, outptr);
+
+                  n_groups = n_blocks * (BASE64_ENCODE_BLOCK / 3);
+                  inptr += n_groups * 3;
+                  outptr += n_groups * 4;
+
+                  if (break_lines && (already += n_groups) >= 19)
+                    {
+                      *outptr++ = '\n';
+                      already = 0;
+                    }
+
+                  continue;
+                }
+            }
+#endif
+
           c1 = *inptr++;
         skip1:
           c2 = *inptr++;
@@ -321,6 +639,10 @@ g_base64_decode_step (const gchar  *in,
   if (len == 0)
     return 0;
 
+#ifdef HAVE_BASE64_SIMD
+  base64_init_blocks ();
+#endif
+
   inend = (const guchar *)in+len;
   outptr = out;
 
@@ -341,6 +663,25 @@ g_base64_decode_step (const gchar  *in,
   inptr = (const guchar *)in;
   while (inptr < inend)
     {
+#ifdef HAVE_BASE64_SIMD
+      /* Decode whole blocks at once, when at the start of a group */
+      if (i == 0 && base64_decode_blocks != NULL &&
+          (gsize) (inend - inptr) >= BASE64_DECODE_BLOCK)
+        {
+          gsize n_blocks;
+
+          n_blocks = base64_decode_blocks (inptr, (inend - inptr) / BASE64_DECODE_BLOCK, outptr);
+          if (n_blocks > 0)
+            {
+              inptr += n_blocks * BASE64_DECODE_BLOCK;
+              outptr += n_blocks * (BASE64_DECODE_BLOCK / 4 * 3);
+              last[1] = inptr[-2];
+              last[0] = inptr[-1];
+              continue;
+            }
+        }
+#endif
+
       c = *inptr++;
       rank = mime_base64_rank [c];
       if (rank != 0xff)
@@ -24,10 +24,12 @@
 
 #include "gchecksum.h"
 
+#include "genviron.h"
 #include "gslice.h"
 #include "gmem.h"
 #include "gstrfuncs.h"
 #include "gtestutils.h"
+#include "gthread.h"
 #include "gtypes.h"
 #include "glibintl.h"
 
@@ -134,6 +136,19 @@ struct _GChecksum
   } sum;
 };
 
+/* SHA-1 and SHA-256 process their input through one of these, picked
+ * at runtime depending on what the CPU supports; @data points to
+ * @n_blocks blocks of 64 bytes, in the byte order of the message
+ */
+typedef void (* ShaTransformBlocksFunc) (guint32      *buf,
+                                         const guint8 *data,
+                                         gsize         n_blocks);
+
+static ShaTransformBlocksFunc sha1_transform_blocks;
+static ShaTransformBlocksFunc sha256_transform_blocks;
+
+static void checksum_init_transforms (void);
+
 /* we need different byte swapping functions because MD5 expects buffers
  * to be little-endian, while SHA1 and SHA256 expect them in big-endian
  * form.
@@ -510,6 +525,8 @@ effort (for example the reengineering of a great many Capstone chips).
 static void
 sha1_sum_init (Sha1sum *sha1)
 {
+  checksum_init_transforms ();
+
   /* initialize constants */
   sha1->buf[0] = 0x67452301L;
   sha1->buf[1] = 0xEFCDAB89L;
@@ -678,6 +695,24 @@ sha1_transform (guint32  buf[5],
   buf[4] += E;
 }
 
+static void
+sha1_transform_blocks_c (guint32      *buf,
+                         const guint8 *data,
+                         gsize         n_blocks)
+{
+  guint32 in[16];
+
+  while (n_blocks--)
+    {
+      memcpy (in, data, SHA1_DATASIZE);
+
+      sha_byte_reverse (in, SHA1_DATASIZE);
+      sha1_transform (buf, in);
+
+      data += SHA1_DATASIZE;
+    }
+}
+
 #undef K1
 #undef K2
 #undef K3
@@ -721,23 +756,19 @@ sha1_sum_update (Sha1sum      *sha1,
 
       memcpy (p, buffer, dataCount);
 
-      sha_byte_reverse (sha1->data, SHA1_DATASIZE);
-      sha1_transform (sha1->buf, sha1->data);
+      sha1_transform_blocks (sha1->buf, (guchar *) sha1->data, 1);
 
       buffer += dataCount;
       count -= dataCount;
     }
 
   /* Process data in SHA1_DATASIZE chunks */
-  while (count >= SHA1_DATASIZE)
+  if (count >= SHA1_DATASIZE)
     {
-      memcpy (sha1->data, buffer, SHA1_DATASIZE);
-
-      sha_byte_reverse (sha1->data, SHA1_DATASIZE);
-      sha1_transform (sha1->buf, sha1->data);
+      sha1_transform_blocks (sha1->buf, buffer, count / SHA1_DATASIZE);
 
-      buffer += SHA1_DATASIZE;
-      count -= SHA1_DATASIZE;
+      buffer += count & ~(gsize) (SHA1_DATASIZE - 1);
+      count &= SHA1_DATASIZE - 1;
     }
 
   /* Handle any remaining bytes of data. */
@@ -769,8 +800,7 @@ sha1_sum_close (Sha1sum *sha1)
       /* Two lots of padding:  Pad the first block to 64 bytes */
       memset (data_p, 0, count);
 
-      sha_byte_reverse (sha1->data, SHA1_DATASIZE);
-      sha1_transform (sha1->buf, sha1->data);
+      sha1_transform_blocks (sha1->buf, (guchar *) sha1->data, 1);
 
       /* Now fill the next block with 56 bytes */
       memset (sha1->data, 0, SHA1_DATASIZE - 8);
@@ -782,11 +812,10 @@ sha1_sum_close (Sha1sum *sha1)
     }
 
   /* Append length in bits and transform */
-  sha1->data[14] = sha1->bits[1];
-  sha1->data[15] = sha1->bits[0];
+  sha1->data[14] = GUINT32_TO_BE (sha1->bits[1]);
+  sha1->data[15] = GUINT32_TO_BE (sha1->bits[0]);
 
-  sha_byte_reverse (sha1->data, SHA1_DATASIZE - 8);
-  sha1_transform (sha1->buf, sha1->data);
+  sha1_transform_blocks (sha1->buf, (guchar *) sha1->data, 1);
   sha_byte_reverse (sha1->buf, SHA1_DIGEST_LEN);
 
   memcpy (sha1->digest, sha1->buf, SHA1_DIGEST_LEN);
@@ -825,6 +854,8 @@ sha1_sum_digest (Sha1sum *sha1,
 static void
 sha256_sum_init (Sha256sum *sha256)
 {
+  checksum_init_transforms ();
+
   sha256->buf[0] = 0x6a09e667;
   sha256->buf[1] = 0xbb67ae85;
   sha256->buf[2] = 0x3c6ef372;
@@ -987,6 +1018,365 @@ sha256_transform (guint32      buf[8],
   buf[7] += H;
 }
 
+static void
+sha256_transform_blocks_c (guint32      *buf,
+                           const guint8 *data,
+                           gsize         n_blocks)
+{
+  while (n_blocks--)
+    {
+      sha256_transform (buf, data);
+      data += SHA256_DATASIZE;
+    }
+}
+
+/*
+ * Hardware accelerated SHA-1 and SHA-256
+ *
+ * On x86, using the SHA extensions (SHA-NI); on AArch64, using the
+ * ARMv8 cryptography extensions. The kernels are compiled with the
+ * target attribute, so that they don't need any special compiler flags,
+ * and are only used if the CPU advertises support for the instructions.
+ */
+
+#if (defined (__x86_64__) || defined (__i386__)) && \
+    (G_GNUC_CHECK_VERSION (5, 0) || defined (__clang__))
+#define HAVE_SHA_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined (__aarch64__) && \
+    (defined (__ARM_FEATURE_CRYPTO) || defined (__ARM_FEATURE_SHA2))
+/* The extensions are always available */
+#define HAVE_SHA_ARM 1
+#define SHA_ARM_TARGET
+#include <arm_neon.h>
+#elif defined (__aarch64__) && defined (__linux__) && defined (HAVE_GETAUXVAL) && \
+      G_GNUC_CHECK_VERSION (6, 0) && !defined (__clang__)
+#define HAVE_SHA_ARM 1
+#define SHA_ARM_TARGET __attribute__ ((target ("+crypto")))
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#endif
+
+#if defined (HAVE_SHA_X86) || defined (HAVE_SHA_ARM)
+static const guint32 sha256_k[64] __attribute__ ((aligned (16))) =
+{
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+  0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+  0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+  0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+  0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+  0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+  0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+  0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+  0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+#endif
+
+#ifdef HAVE_SHA_X86
+/* 4 rounds of SHA-1; @e_next receives the value of the state used
+ * to compute the E term of the next 4 rounds
+ */
+#define SHA1_X86_ROUNDS(e_in, e_next, msg, f) G_STMT_START {     \
+    e_in = _mm_sha1nexte_epu32 (e_in, msg);                     \
+    e_next = abcd;                                              \
+    abcd = _mm_sha1rnds4_epu32 (abcd, e_in, f); } G_STMT_END
+
+/* The message schedule for the 4 words following w0..w3 */
+#define SHA1_X86_SCHEDULE(w0, w1, w2, w3) \
+    (w0 = _mm_sha1msg2_epu32 (_mm_xor_si128 (_mm_sha1msg1_epu32 (w0, w1), w2), w3))
+
+__attribute__ ((target ("sha,sse4.1")))
+static void
+sha1_transform_blocks_x86 (guint32      *buf,
+                           const guint8 *data,
+                           gsize         n_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x (0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd, abcd_save, e0, e0_save, e1;
+  __m128i w0, w1, w2, w3;
+
+  abcd = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) buf), 0x1B);
+  e0 = _mm_set_epi32 (buf[4], 0, 0, 0);
+
+  while (n_blocks--)
+    {
+      abcd_save = abcd;
+      e0_save = e0;
+
+      w0 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 0)), byte_swap);
+      w1 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 16)), byte_swap);
+      w2 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 32)), byte_swap);
+      w3 = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + 48)), byte_swap);
+
+      /* Rounds 0-19 */
+      e0 = _mm_add_epi32 (e0, w0);
+      e1 = abcd;
+      abcd = _mm_sha1rnds4_epu32 (abcd, e0, 0);
+      SHA1_X86_ROUNDS (e1, e0, w1, 0);
+      SHA1_X86_ROUNDS (e0, e1, w2, 0);
+      SHA1_X86_ROUNDS (e1, e0, w3, 0);
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w0, w1, w2, w3), 0);
+
+      /* Rounds 20-39 */
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w1, w2, w3, w0), 1);
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w2, w3, w0, w1), 1);
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w3, w0, w1, w2), 1);
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w0, w1, w2, w3), 1);
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w1, w2, w3, w0), 1);
+
+      /* Rounds 40-59 */
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w2, w3, w0, w1), 2);
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w3, w0, w1, w2), 2);
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w0, w1, w2, w3), 2);
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w1, w2, w3, w0), 2);
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w2, w3, w0, w1), 2);
+
+      /* Rounds 60-79 */
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w3, w0, w1, w2), 3);
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w0, w1, w2, w3), 3);
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w1, w2, w3, w0), 3);
+      SHA1_X86_ROUNDS (e0, e1, SHA1_X86_SCHEDULE (w2, w3, w0, w1), 3);
+      SHA1_X86_ROUNDS (e1, e0, SHA1_X86_SCHEDULE (w3, w0, w1, w2), 3);
+
+      e0 = _mm_sha1nexte_epu32 (e0, e0_save);
+      abcd = _mm_add_epi32 (abcd, abcd_save);
+
+      data += SHA1_DATASIZE;
+    }
+
+  _mm_storeu_si128 ((__m128i *) buf, _mm_shuffle_epi32 (abcd, 0x1B));
+  buf[4] = _mm_extract_epi32 (e0, 3);
+}
+
+#undef SHA1_X86_ROUNDS
+#undef SHA1_X86_SCHEDULE
+
+__attribute__ ((target ("sha,sse4.1")))
+static void
+sha256_transform_blocks_x86 (guint32      *buf,
+                             const guint8 *data,
+                             gsize         n_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x (0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i state0, state1, abef_save, cdgh_save, tmp;
+  __m128i w[4];
+  int i;
+
+  /* The instructions work on ABEF and CDGH */
+  tmp = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) &buf[0]), 0xB1);
+  state1 = _mm_shuffle_epi32 (_mm_loadu_si128 ((const __m128i *) &buf[4]), 0x1B);
+  state0 = _mm_alignr_epi8 (tmp, state1, 8);
+  state1 = _mm_blend_epi16 (state1, tmp, 0xF0);
+
+  while (n_blocks--)
+    {
+      abef_save = state0;
+      cdgh_save = state1;
+
+      for (i = 0; i < 16; i++)
+        {
+          __m128i msg;
+
+          if (i < 4)
+            w[i] = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i *) (data + i * 16)), byte_swap);
+          else
+            w[i & 3] = _mm_sha256msg2_epu32 (_mm_add_epi32 (_mm_sha256msg1_epu32 (w[i & 3], w[(i + 1) & 3]),
+                                                            _mm_alignr_epi8 (w[(i + 3) & 3], w[(i + 2) & 3], 4)),
+                                             w[(i + 3) & 3]);
+
+          msg = _mm_add_epi32 (w[i & 3], _mm_load_si128 ((const __m128i *) &sha256_k[i * 4]));
+          state1 = _mm_sha256rnds2_epu32 (state1, state0, msg);
+          state0 = _mm_sha256rnds2_epu32 (state0, state1, _mm_shuffle_epi32 (msg, 0x0E));
+        }
+
+      state0 = _mm_add_epi32 (state0, abef_save);
+      state1 = _mm_add_epi32 (state1, cdgh_save);
+
+      data += SHA256_DATASIZE;
+    }
+
+  tmp = _mm_shuffle_epi32 (state0, 0x1B);
+  state1 = _mm_shuffle_epi32 (state1, 0xB1);
+  _mm_storeu_si128 ((__m128i *) &buf[0], _mm_blend_epi16 (tmp, state1, 0xF0));
+  _mm_storeu_si128 ((__m128i *) &buf[4], _mm_alignr_epi8 (state1, tmp, 8));
+}
+
+static gboolean
+sha_x86_supported (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  /* SSSE3 and SSE4.1 */
+  if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx) ||
+      (ecx & ((1 << 9) | (1 << 19))) != ((1 << 9) | (1 << 19)))
+    return FALSE;
+
+  if (__get_cpuid_max (0, NULL) < 7)
+    return FALSE;
+
+  /* SHA */
+  __cpuid_count (7, 0, eax, ebx, ecx, edx);
+
+  return (ebx & (1 << 29)) != 0;
+}
+#endif /* HAVE_SHA_X86 */
+
+#ifdef HAVE_SHA_ARM
+SHA_ARM_TARGET
+static void
+sha1_transform_blocks_arm (guint32      *buf,
+                           const guint8 *data,
+                           gsize         n_blocks)
+{
+  static const guint32 k[4] = { 0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6 };
+  uint32x4_t abcd, abcd_save, wk;
+  uint32x4_t w[4];
+  guint32 e, e_save, e_next;
+  int i;
+
+  abcd = vld1q_u32 (buf);
+  e = buf[4];
+
+  while (n_blocks--)
+    {
+      abcd_save = abcd;
+      e_save = e;
+
+      for (i = 0; i < 4; i++)
+        w[i] = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + i * 16)));
+
+      for (i = 0; i < 20; i++)
+        {
+          wk = vaddq_u32 (w[i & 3], vdupq_n_u32 (k[i / 5]));
+
+          if (i < 16)
+            w[i & 3] = vsha1su1q_u32 (vsha1su0q_u32 (w[i & 3], w[(i + 1) & 3], w[(i + 2) & 3]),
+                                      w[(i + 3) & 3]);
+
+          e_next = vsha1h_u32 (vgetq_lane_u32 (abcd, 0));
+          if (i < 5)
+            abcd = vsha1cq_u32 (abcd, e, wk);
+          else if (i < 10 || i >= 15)
+            abcd = vsha1pq_u32 (abcd, e, wk);
+          else
+            abcd = vsha1mq_u32 (abcd, e, wk);
+          e = e_next;
+        }
+
+      abcd = vaddq_u32 (abcd, abcd_save);
+      e += e_save;
+
+      data += SHA1_DATASIZE;
+    }
+
+  vst1q_u32 (buf, abcd);
+  buf[4] = e;
+}
+
+SHA_ARM_TARGET
+static void
+sha256_transform_blocks_arm (guint32      *buf,
+                             const guint8 *data,
+                             gsize         n_blocks)
+{
+  uint32x4_t state0, state1, abcd_save, efgh_save, wk, tmp;
+  uint32x4_t w[4];
+  int i;
+
+  state0 = vld1q_u32 (&buf[0]);
+  state1 = vld1q_u32 (&buf[4]);
+
+  while (n_blocks--)
+    {
+      abcd_save = state0;
+      efgh_save = state1;
+
+      for (i = 0; i < 4; i++)
+        w[i] = vreinterpretq_u32_u8 (vrev32q_u8 (vld1q_u8 (data + i * 16)));
+
+      for (i = 0; i < 16; i++)
+        {
+          wk = vaddq_u32 (w[i & 3], vld1q_u32 (&sha256_k[i * 4]));
+
+          if (i < 12)
+            w[i & 3] = vsha256su1q_u32 (vsha256su0q_u32 (w[i & 3], w[(i + 1) & 3]),
+                                        w[(i + 2) & 3], w[(i + 3) & 3]);
+
+          tmp = state0;
+          state0 = vsha256hq_u32 (state0, state1, wk);
+          state1 = vsha256h2q_u32 (state1, tmp, wk);
+        }
+
+      state0 = vaddq_u32 (state0, abcd_save);
+      state1 = vaddq_u32 (state1, efgh_save);
+
+      data += SHA256_DATASIZE;
+    }
+
+  vst1q_u32 (&buf[0], state0);
+  vst1q_u32 (&buf[4], state1);
+}
+
+static gboolean
+sha_arm_supported (void)
+{
+#if defined (__ARM_FEATURE_CRYPTO) || defined (__ARM_FEATURE_SHA2)
+  return TRUE;
+#elif defined (HWCAP_SHA1) && defined (HWCAP_SHA2)
+  unsigned long hwcap = getauxval (AT_HWCAP);
+
+  return (hwcap & (HWCAP_SHA1 | HWCAP_SHA2)) == (HWCAP_SHA1 | HWCAP_SHA2);
+#else
+  return FALSE;
+#endif
+}
+#endif /* HAVE_SHA_ARM */
+
+/* Picks the SHA-1 and SHA-256 implementations, the first time a
+ * checksum using them is initialized. Setting G_CHECKSUM_NO_HWACCEL
+ * in the environment forces the portable implementations.
+ */
+static void
+checksum_init_transforms (void)
+{
+  static gsize initialized = 0;
+
+  if (g_once_init_enter (&initialized))
+    {
+      sha1_transform_blocks = sha1_transform_blocks_c;
+      sha256_transform_blocks = sha256_transform_blocks_c;
+
+      if (g_getenv ("G_CHECKSUM_NO_HWACCEL") == NULL)
+        {
+#if defined (HAVE_SHA_X86)
+          if (sha_x86_supported ())
+            {
+              sha1_transform_blocks = sha1_transform_blocks_x86;
+              sha256_transform_blocks = sha256_transform_blocks_x86;
+            }
+#elif defined (HAVE_SHA_ARM)
+          if (sha_arm_supported ())
+            {
+              sha1_transform_blocks = sha1_transform_blocks_arm;
+              sha256_transform_blocks = sha256_transform_blocks_arm;
+            }
+#endif
+        }
+
+      g_once_init_leave (&initialized, 1);
+    }
+}
+
 static void
 sha256_sum_update (Sha256sum    *sha256,
                    const guchar *buffer,
@@ -1011,19 +1401,19 @@ sha256_sum_update (Sha256sum    *sha256,
     {
       memcpy ((sha256->data + left), input, fill);
 
-      sha256_transform (sha256->buf, sha256->data);
+      sha256_transform_blocks (sha256->buf, sha256->data, 1);
       length -= fill;
       input += fill;
 
       left = 0;
     }
 
-  while (length >= SHA256_DATASIZE)
+  if (length >= SHA256_DATASIZE)
     {
-      sha256_transform (sha256->buf, input);
+      sha256_transform_blocks (sha256->buf, input, length / SHA256_DATASIZE);
 
-      length -= 64;
-      input += 64;
+      input += length & ~(gsize) (SHA256_DATASIZE - 1);
+      length &= SHA256_DATASIZE - 1;
     }
 
   if (length)
@@ -1865,3 +2255,80 @@ g_compute_checksum_for_bytes (GChecksumType  checksum_type,
   byte_data = g_bytes_get_data (data, &length);
   return g_compute_checksum_for_data (checksum_type, byte_data, length);
 }
+
+/**
+ * g_checksum_digest_many:
+ * @checksum_type: a #GChecksumType
+ * @data: (array length=n_data): the binary blobs to compute the digests of
+ * @lengths: (array length=n_data): the lengths of the blobs in @data
+ * @n_data: the number of blobs in @data
+ * @digests: (out caller-allocates) (array): return location for the digests
+ *
+ * Computes the digests of @n_data independent binary blobs, and places
+ * them one after the other in @digests, which must be at least
+ * @n_data times g_checksum_type_get_length() bytes long.
+ *
+ * This gives the same results as computing the digest of each blob
+ * with a new #GChecksum, but is faster when hashing many small blobs,
+ * as no memory is allocated and the hexadecimal strings are not built.
+ *
+ * Since: 2.80
+ */
+void
+g_checksum_digest_many (GChecksumType         checksum_type,
+                        const guint8 * const *data,
+                        const gsize          *lengths,
+                        gsize                 n_data,
+                        guint8               *digests)
+{
+  GChecksum checksum = { 0, };
+  gsize digest_len;
+  gsize i;
+
+  g_return_if_fail (IS_VALID_TYPE (checksum_type));
+  g_return_if_fail (n_data == 0 || (data != NULL && lengths != NULL && digests != NULL));
+
+  checksum.type = checksum_type;
+  digest_len = g_checksum_type_get_length (checksum_type);
+
+  for (i = 0; i < n_data; i++)
+    {
+      g_return_if_fail (lengths[i] == 0 || data[i] != NULL);
+
+      g_checksum_reset (&checksum);
+
+      switch (checksum_type)
+        {
+        case G_CHECKSUM_MD5:
+          md5_sum_update (&(checksum.sum.md5), data[i], lengths[i]);
+          md5_sum_close (&(checksum.sum.md5));
+          md5_sum_digest (&(checksum.sum.md5), digests);
+          break;
+        case G_CHECKSUM_SHA1:
+          sha1_sum_update (&(checksum.sum.sha1), data[i], lengths[i]);
+          sha1_sum_close (&(checksum.sum.sha1));
+          sha1_sum_digest (&(checksum.sum.sha1), digests);
+          break;
+        case G_CHECKSUM_SHA256:
+          sha256_sum_update (&(checksum.sum.sha256), data[i], lengths[i]);
+          sha256_sum_close (&(checksum.sum.sha256));
+          sha256_sum_digest (&(checksum.sum.sha256), digests);
+          break;
+        case G_CHECKSUM_SHA384:
+          sha512_sum_update (&(checksum.sum.sha512), data[i], lengths[i]);
+          sha512_sum_close (&(checksum.sum.sha512));
+          sha384_sum_digest (&(checksum.sum.sha512), digests);
+          break;
+        case G_CHECKSUM_SHA512:
+          sha512_sum_update (&(checksum.sum.sha512), data[i], lengths[i]);
+          sha512_sum_close (&(checksum.sum.sha512));
+          sha512_sum_digest (&(checksum.sum.sha512), digests);
+          break;
+        default:
+          g_assert_not_reached ();
+          break;
+        }
+
+      digests += digest_len;
+    }
+}
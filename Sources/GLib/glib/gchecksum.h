@@ -91,6 +91,13 @@ GLIB_AVAILABLE_IN_2_34
 gchar                *g_compute_checksum_for_bytes  (GChecksumType    checksum_type,
                                                      GBytes          *data);
 
+GLIB_AVAILABLE_IN_2_80
+void                  g_checksum_digest_many        (GChecksumType         checksum_type,
+                                                     const guint8 * const *data,
+                                                     const gsize          *lengths,
+                                                     gsize                 n_data,
+                                                     guint8               *digests);
+
 G_END_DECLS
 
 #endif /* __G_CHECKSUM_H__ */
@@ -57,6 +57,8 @@
 #define O_CLOEXEC 0
 #endif
 
+#include "garray.h"
+#include "gbytes.h"
 #include "gconvert.h"
 #include "gdataset.h"
 #include "gerror.h"
@@ -64,6 +66,7 @@
 #include "ghash.h"
 #include "glibintl.h"
 #include "glist.h"
+#include "gmappedfile.h"
 #include "gslist.h"
 #include "gmem.h"
 #include "gmessages.h"
@@ -242,6 +245,13 @@
  *   (possibly modified) contents of the key file back to a file;
  *   otherwise only the translations for the current language will be
  *   written back.
+ * @G_KEY_FILE_READ_ONLY: Use this flag if you only plan to look up values
+ *   in the key file. Rather than copying every group, key and value into
+ *   separate allocations, the file is mapped (or read into a single buffer)
+ *   and only the offsets of groups and keys are indexed. Modifying the key
+ *   file is still possible, but the first modification parses the whole
+ *   file as if the flag had not been given. Ignored if
+ *   %G_KEY_FILE_KEEP_COMMENTS is set. Since: 2.80
  *
  * Flags which influence the parsing.
  */
@@ -493,6 +503,7 @@
  */
 
 typedef struct _GKeyFileGroup GKeyFileGroup;
+typedef struct _GKeyFileIndex GKeyFileIndex;
 
 struct _GKeyFile
 {
@@ -511,6 +522,10 @@ struct _GKeyFile
   gboolean checked_locales;  /* TRUE if @locales has been initialised */
   gchar **locales;  /* (nullable) */
 
+  /* Only set for %G_KEY_FILE_READ_ONLY, in which case @groups is empty
+   * until the key file is modified; see g_key_file_materialize() */
+  GKeyFileIndex *index;  /* (nullable) (owned) */
+
   gint ref_count;  /* (atomic) */
 };
 
@@ -534,6 +549,48 @@ struct _GKeyFileKeyValuePair
   gchar *value;
 };
 
+/* With %G_KEY_FILE_READ_ONLY, the loaded data is kept as it is and only
+ * the offsets of its groups and keys are recorded, in file order. The
+ * entries of a group are contiguous. Lookups go through open-addressed
+ * tables holding the position of a group or entry plus one, so that 0
+ * marks an empty slot.
+ */
+typedef struct
+{
+  guint32 name;
+  guint32 name_len;
+  guint32 first_entry;
+  guint32 n_entries;
+} GKeyFileIndexGroup;
+
+typedef struct
+{
+  guint32 key;
+  guint32 key_len;
+  guint32 value;
+  guint32 value_len;
+} GKeyFileIndexEntry;
+
+struct _GKeyFileIndex
+{
+  GBytes *bytes;
+  const gchar *data;
+
+  GKeyFileIndexGroup *groups;
+  guint32 n_groups;
+  GKeyFileIndexEntry *entries;
+  guint32 n_entries;
+
+  guint32 *group_slots;
+  guint32 group_mask;
+  guint32 *entry_slots;
+  guint32 entry_mask;
+};
+
+/* Files smaller than this are read into a single buffer rather than
+ * mapped, since every mapping costs at least a page and a VMA */
+#define KEY_FILE_MAP_THRESHOLD 4096
+
 static gint                  find_file_in_data_dirs            (const gchar            *file,
 								const gchar           **data_dirs,
 								gchar                 **output_file,
@@ -623,6 +680,11 @@ static void                  g_key_file_parse_data             (GKeyFile
 								GError                **error);
 static void                  g_key_file_flush_parse_buffer     (GKeyFile               *key_file,
 								GError                **error);
+static void                  g_key_file_index_free             (GKeyFileIndex          *index);
+static gboolean              g_key_file_parse_bytes            (GKeyFile               *key_file,
+                                                                GBytes                 *bytes,
+                                                                GError                **error);
+static void                  g_key_file_materialize            (GKeyFile               *key_file);
 
 G_DEFINE_QUARK (g-key-file-error-quark, g_key_file_error)
 
@@ -636,6 +698,7 @@ g_key_file_init (GKeyFile *key_file)
   key_file->parse_buffer = NULL;
   key_file->list_separator = ';';
   key_file->flags = 0;
+  key_file->index = NULL;
 }
 
 static void
@@ -656,6 +719,12 @@ g_key_file_clear (GKeyFile *key_file)
       key_file->parse_buffer = NULL;
     }
 
+  if (key_file->index)
+    {
+      g_key_file_index_free (key_file->index);
+      key_file->index = NULL;
+    }
+
   tmp = key_file->groups;
   while (tmp != NULL)
     {
@@ -800,6 +869,78 @@ find_file_in_data_dirs (const gchar   *file,
   return fd;
 }
 
+static gboolean
+g_key_file_flags_use_index (GKeyFileFlags flags)
+{
+  return (flags & G_KEY_FILE_READ_ONLY) && !(flags & G_KEY_FILE_KEEP_COMMENTS);
+}
+
+/* Reads the whole of @fd for indexing. Large files are mapped, small
+ * ones are read into a single allocation. */
+static GBytes *
+g_key_file_read_fd (gint               fd,
+                    const struct stat *stat_buf,
+                    GError           **error)
+{
+  gchar *buf;
+  gsize len, alloc;
+
+  if (stat_buf->st_size >= KEY_FILE_MAP_THRESHOLD)
+    {
+      GMappedFile *mapped;
+      GBytes *bytes;
+
+      mapped = g_mapped_file_new_from_fd (fd, FALSE, error);
+      if (mapped == NULL)
+        return NULL;
+
+      bytes = g_mapped_file_get_bytes (mapped);
+      g_mapped_file_unref (mapped);
+
+      return bytes;
+    }
+
+  /* One spare byte, so that hitting the end of the file does not need
+   * another allocation. The file may still grow while being read. */
+  alloc = stat_buf->st_size + 1;
+  buf = g_malloc (alloc);
+  len = 0;
+
+  while (TRUE)
+    {
+      gssize bytes_read;
+      int errsv;
+
+      if (len == alloc)
+        {
+          alloc *= 2;
+          buf = g_realloc (buf, alloc);
+        }
+
+      bytes_read = read (fd, buf + len, alloc - len);
+      errsv = errno;
+
+      if (bytes_read == 0)  /* End of File */
+        break;
+
+      if (bytes_read < 0)
+        {
+          if (errsv == EINTR || errsv == EAGAIN)
+            continue;
+
+          g_set_error_literal (error, G_FILE_ERROR,
+                               g_file_error_from_errno (errsv),
+                               g_strerror (errsv));
+          g_free (buf);
+          return NULL;
+        }
+
+      len += bytes_read;
+    }
+
+  return g_bytes_new_take (buf, len);
+}
+
 static gboolean
 g_key_file_load_from_fd (GKeyFile       *key_file,
 			 gint            fd,
@@ -835,6 +976,21 @@ g_key_file_load_from_fd (GKeyFile       *key_file,
   key_file->list_separator = list_separator;
   key_file->flags = flags;
 
+  if (g_key_file_flags_use_index (flags))
+    {
+      GBytes *bytes;
+      gboolean retval;
+
+      bytes = g_key_file_read_fd (fd, &stat_buf, error);
+      if (bytes == NULL)
+        return FALSE;
+
+      retval = g_key_file_parse_bytes (key_file, bytes, error);
+      g_bytes_unref (bytes);
+
+      return retval;
+    }
+
   do
     {
       int errsv;
@@ -972,6 +1128,19 @@ g_key_file_load_from_data (GKeyFile       *key_file,
   key_file->list_separator = list_separator;
   key_file->flags = flags;
 
+  if (g_key_file_flags_use_index (flags))
+    {
+      GBytes *bytes;
+      gboolean retval;
+
+      /* A single copy, which the index points into */
+      bytes = g_bytes_new (data, length);
+      retval = g_key_file_parse_bytes (key_file, bytes, error);
+      g_bytes_unref (bytes);
+
+      return retval;
+    }
+
   g_key_file_parse_data (key_file, data, length, &key_file_error);
   
   if (key_file_error)
@@ -1017,6 +1186,20 @@ g_key_file_load_from_bytes (GKeyFile       *key_file,
   g_return_val_if_fail (key_file != NULL, FALSE);
   g_return_val_if_fail (bytes != NULL, FALSE);
 
+  if (g_key_file_flags_use_index (flags))
+    {
+      gchar list_separator;
+
+      /* Index @bytes directly rather than copying it */
+      list_separator = key_file->list_separator;
+      g_key_file_clear (key_file);
+      g_key_file_init (key_file);
+      key_file->list_separator = list_separator;
+      key_file->flags = flags;
+
+      return g_key_file_parse_bytes (key_file, bytes, error);
+    }
+
   data = g_bytes_get_data (bytes, &size);
   return g_key_file_load_from_data (key_file, (const gchar *) data, size, flags, error);
 }
@@ -1565,6 +1748,371 @@ g_key_file_flush_parse_buffer (GKeyFile  *key_file,
     }
 }
 
+static guint32
+g_key_file_index_hash (const gchar *str,
+                       gsize        len,
+                       guint32      seed)
+{
+  guint32 h = 5381 ^ seed;
+  gsize i;
+
+  for (i = 0; i < len; i++)
+    h = (h << 5) + h + (guchar) str[i];
+
+  return h;
+}
+
+static guint32
+g_key_file_index_entry_seed (const GKeyFileIndex      *index,
+                             const GKeyFileIndexGroup *group)
+{
+  return (guint32) (group - index->groups) * 0x9E3779B1u;
+}
+
+static guint32 *
+g_key_file_index_new_slots (guint32  n_items,
+                            guint32 *mask_out)
+{
+  guint32 n_slots = 8;
+
+  /* Keep the load factor at or below one half */
+  while (n_slots < n_items * 2)
+    n_slots *= 2;
+
+  *mask_out = n_slots - 1;
+
+  return g_new0 (guint32, n_slots);
+}
+
+static void
+g_key_file_index_free (GKeyFileIndex *index)
+{
+  g_bytes_unref (index->bytes);
+  g_free (index->groups);
+  g_free (index->entries);
+  g_free (index->group_slots);
+  g_free (index->entry_slots);
+  g_free_sized (index, sizeof (GKeyFileIndex));
+}
+
+/* Fills in the lookup tables, failing if a group or a key within a group
+ * appears twice. The regular parser merges those, so such files are left
+ * to it.
+ */
+static gboolean
+g_key_file_index_build_slots (GKeyFileIndex *index)
+{
+  guint32 i, j;
+
+  index->group_slots = g_key_file_index_new_slots (index->n_groups, &index->group_mask);
+  index->entry_slots = g_key_file_index_new_slots (index->n_entries, &index->entry_mask);
+
+  for (i = 0; i < index->n_groups; i++)
+    {
+      const GKeyFileIndexGroup *group = &index->groups[i];
+      const gchar *name = index->data + group->name;
+      guint32 slot;
+
+      slot = g_key_file_index_hash (name, group->name_len, 0) & index->group_mask;
+      while (index->group_slots[slot] != 0)
+        {
+          const GKeyFileIndexGroup *other = &index->groups[index->group_slots[slot] - 1];
+
+          if (other->name_len == group->name_len &&
+              memcmp (index->data + other->name, name, group->name_len) == 0)
+            return FALSE;
+
+          slot = (slot + 1) & index->group_mask;
+        }
+      index->group_slots[slot] = i + 1;
+
+      for (j = group->first_entry; j < group->first_entry + group->n_entries; j++)
+        {
+          const GKeyFileIndexEntry *entry = &index->entries[j];
+          const gchar *key = index->data + entry->key;
+
+          slot = g_key_file_index_hash (key, entry->key_len,
+                                        g_key_file_index_entry_seed (index, group)) & index->entry_mask;
+          while (index->entry_slots[slot] != 0)
+            {
+              guint32 other_pos = index->entry_slots[slot] - 1;
+              const GKeyFileIndexEntry *other = &index->entries[other_pos];
+
+              if (other_pos >= group->first_entry &&
+                  other->key_len == entry->key_len &&
+                  memcmp (index->data + other->key, key, entry->key_len) == 0)
+                return FALSE;
+
+              slot = (slot + 1) & index->entry_mask;
+            }
+          index->entry_slots[slot] = j + 1;
+        }
+    }
+
+  return TRUE;
+}
+
+/* Indexes the groups and keys of @bytes without copying any of them.
+ * This follows g_key_file_parse_data() and g_key_file_parse_line() line
+ * by line, but gives up on anything unusual (invalid lines, duplicates,
+ * embedded nul bytes, a bad encoding, ...) so that the regular parser can
+ * handle it, and report errors, exactly as it always has.
+ */
+static GKeyFileIndex *
+g_key_file_index_new (GKeyFile *key_file,
+                      GBytes   *bytes)
+{
+  GKeyFileIndex *index;
+  GArray *groups, *entries;
+  const gchar *data, *line, *end;
+  gsize length;
+
+  data = g_bytes_get_data (bytes, &length);
+
+  if (length > G_MAXUINT32 || (length > 0 && memchr (data, '\0', length) != NULL))
+    return NULL;
+
+  groups = g_array_new (FALSE, FALSE, sizeof (GKeyFileIndexGroup));
+  entries = g_array_new (FALSE, FALSE, sizeof (GKeyFileIndexEntry));
+
+  end = data + length;
+  for (line = data; line < end; )
+    {
+      const gchar *line_end, *next_line, *p;
+
+      line_end = memchr (line, '\n', end - line);
+      if (line_end != NULL)
+        {
+          next_line = line_end + 1;
+          if (line_end > line && line_end[-1] == '\r')
+            line_end--;
+        }
+      else
+        next_line = line_end = end;
+
+      p = line;
+      while (p < line_end && g_ascii_isspace (*p))
+        p++;
+
+      if (p == line_end || *p == '#')
+        {
+          /* Comment */
+        }
+      else if (*p == '[')
+        {
+          GKeyFileIndexGroup group;
+          const gchar *name_end, *q;
+
+          name_end = memchr (p, ']', line_end - p);
+          if (name_end == NULL || name_end == p + 1)
+            goto fail;
+
+          for (q = name_end + 1; q < line_end && (*q == ' ' || *q == '\t'); q++)
+            ;
+          if (q != line_end)
+            goto fail;
+
+          /* As in g_key_file_is_group_name() */
+          for (q = p + 1; q < name_end; q++)
+            if (*q == '[' || g_ascii_iscntrl (*q))
+              goto fail;
+
+          group.name = p + 1 - data;
+          group.name_len = name_end - (p + 1);
+          group.first_entry = entries->len;
+          group.n_entries = 0;
+          g_array_append_val (groups, group);
+        }
+      else
+        {
+          GKeyFileIndexEntry entry;
+          const gchar *key_end, *value, *locale;
+          gsize key_len, locale_len;
+
+          key_end = memchr (p, '=', line_end - p);
+          if (key_end == NULL || key_end == p || groups->len == 0)
+            goto fail;
+
+          value = key_end + 1;
+
+          /* Chomp trailing whitespace from the key; @p is not whitespace */
+          do
+            key_end--;
+          while (g_ascii_isspace (*key_end));
+          key_len = key_end + 1 - p;
+
+          if (!g_key_file_is_key_name (p, key_len))
+            goto fail;
+
+          while (value < line_end && g_ascii_isspace (*value))
+            value++;
+
+          if (groups->len == 1 &&
+              key_len == strlen ("Encoding") && memcmp (p, "Encoding", key_len) == 0 &&
+              (line_end - value != strlen ("UTF-8") ||
+               g_ascii_strncasecmp (value, "UTF-8", line_end - value) != 0))
+            goto fail;
+
+          /* As in key_get_locale() */
+          for (locale = key_end; locale >= p && *locale != '['; locale--)
+            ;
+          locale_len = locale >= p ? (gsize) (key_end + 1 - locale) : 0;
+
+          if (locale_len > 2 &&
+              !g_key_file_locale_is_interesting (key_file, locale + 1, locale_len - 2))
+            {
+              line = next_line;
+              continue;
+            }
+
+          entry.key = p - data;
+          entry.key_len = key_len;
+          entry.value = value - data;
+          entry.value_len = line_end - value;
+          g_array_append_val (entries, entry);
+
+          g_array_index (groups, GKeyFileIndexGroup, groups->len - 1).n_entries++;
+        }
+
+      line = next_line;
+    }
+
+  index = g_new0 (GKeyFileIndex, 1);
+  index->bytes = g_bytes_ref (bytes);
+  index->data = data;
+  index->n_groups = groups->len;
+  index->groups = (GKeyFileIndexGroup *) g_array_free (groups, FALSE);
+  index->n_entries = entries->len;
+  index->entries = (GKeyFileIndexEntry *) g_array_free (entries, FALSE);
+
+  if (!g_key_file_index_build_slots (index))
+    {
+      g_key_file_index_free (index);
+      return NULL;
+    }
+
+  return index;
+
+fail:
+  g_array_free (groups, TRUE);
+  g_array_free (entries, TRUE);
+
+  return NULL;
+}
+
+static const GKeyFileIndexGroup *
+g_key_file_index_lookup_group (const GKeyFileIndex *index,
+                               const gchar         *group_name)
+{
+  gsize name_len = strlen (group_name);
+  guint32 slot;
+
+  slot = g_key_file_index_hash (group_name, name_len, 0) & index->group_mask;
+  while (index->group_slots[slot] != 0)
+    {
+      const GKeyFileIndexGroup *group = &index->groups[index->group_slots[slot] - 1];
+
+      if (group->name_len == name_len &&
+          memcmp (index->data + group->name, group_name, name_len) == 0)
+        return group;
+
+      slot = (slot + 1) & index->group_mask;
+    }
+
+  return NULL;
+}
+
+static const GKeyFileIndexEntry *
+g_key_file_index_lookup_entry (const GKeyFileIndex      *index,
+                               const GKeyFileIndexGroup *group,
+                               const gchar              *key)
+{
+  gsize key_len = strlen (key);
+  guint32 slot;
+
+  slot = g_key_file_index_hash (key, key_len,
+                                g_key_file_index_entry_seed (index, group)) & index->entry_mask;
+  while (index->entry_slots[slot] != 0)
+    {
+      guint32 pos = index->entry_slots[slot] - 1;
+      const GKeyFileIndexEntry *entry = &index->entries[pos];
+
+      if (pos >= group->first_entry &&
+          pos < group->first_entry + group->n_entries &&
+          entry->key_len == key_len &&
+          memcmp (index->data + entry->key, key, key_len) == 0)
+        return entry;
+
+      slot = (slot + 1) & index->entry_mask;
+    }
+
+  return NULL;
+}
+
+/* Parses @bytes, which is what the key file was loaded from, into
+ * @key_file. With %G_KEY_FILE_READ_ONLY this only builds an index, if
+ * possible.
+ */
+static gboolean
+g_key_file_parse_bytes (GKeyFile  *key_file,
+                        GBytes    *bytes,
+                        GError   **error)
+{
+  GError *key_file_error = NULL;
+  const gchar *data;
+  gsize length;
+
+  if (g_key_file_flags_use_index (key_file->flags))
+    {
+      key_file->index = g_key_file_index_new (key_file, bytes);
+      if (key_file->index != NULL)
+        return TRUE;
+    }
+
+  data = g_bytes_get_data (bytes, &length);
+  g_key_file_parse_data (key_file, data, length, &key_file_error);
+
+  if (!key_file_error)
+    g_key_file_flush_parse_buffer (key_file, &key_file_error);
+
+  if (key_file_error)
+    {
+      g_propagate_error (error, key_file_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Turns an indexed key file into a regular one, before it is modified
+ * or anything the index does not cover is looked at.
+ */
+static void
+g_key_file_materialize (GKeyFile *key_file)
+{
+  GKeyFileIndex *index = key_file->index;
+  GError *local_error = NULL;
+  const gchar *data;
+  gsize length;
+
+  if (index == NULL)
+    return;
+
+  key_file->index = NULL;
+
+  data = g_bytes_get_data (index->bytes, &length);
+  g_key_file_parse_data (key_file, data, length, &local_error);
+
+  if (!local_error)
+    g_key_file_flush_parse_buffer (key_file, &local_error);
+
+  /* The data was indexed, so it must parse */
+  g_warn_if_fail (local_error == NULL);
+  g_clear_error (&local_error);
+
+  g_key_file_index_free (index);
+}
+
 /**
  * g_key_file_to_data:
  * @key_file: a #GKeyFile
@@ -1592,6 +2140,8 @@ g_key_file_to_data (GKeyFile  *key_file,
 
   g_return_val_if_fail (key_file != NULL, NULL);
 
+  g_key_file_materialize (key_file);
+
   data_string = g_string_new (NULL);
 
   for (group_node = g_list_last (key_file->groups);
@@ -1657,6 +2207,37 @@ g_key_file_get_keys (GKeyFile     *key_file,
   
   g_return_val_if_fail (key_file != NULL, NULL);
   g_return_val_if_fail (group_name != NULL, NULL);
+
+  if (key_file->index)
+    {
+      const GKeyFileIndex *index = key_file->index;
+      const GKeyFileIndexGroup *igroup;
+
+      igroup = g_key_file_index_lookup_group (index, group_name);
+
+      if (!igroup)
+        {
+          g_set_error (error, G_KEY_FILE_ERROR,
+                       G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+                       _("Key file does not have group “%s”"),
+                       group_name);
+          return NULL;
+        }
+
+      keys = g_new (gchar *, igroup->n_entries + 1);
+      for (i = 0; i < igroup->n_entries; i++)
+        {
+          const GKeyFileIndexEntry *entry = &index->entries[igroup->first_entry + i];
+
+          keys[i] = g_strndup (index->data + entry->key, entry->key_len);
+        }
+      keys[i] = NULL;
+
+      if (length)
+        *length = igroup->n_entries;
+
+      return keys;
+    }
   
   group = g_key_file_lookup_group (key_file, group_name);
   
@@ -1719,6 +2300,16 @@ g_key_file_get_start_group (GKeyFile *key_file)
 {
   g_return_val_if_fail (key_file != NULL, NULL);
 
+  if (key_file->index)
+    {
+      const GKeyFileIndex *index = key_file->index;
+
+      if (index->n_groups > 0)
+        return g_strndup (index->data + index->groups[0].name, index->groups[0].name_len);
+
+      return NULL;
+    }
+
   if (key_file->start_group)
     return g_strdup (key_file->start_group->name);
 
@@ -1748,6 +2339,21 @@ g_key_file_get_groups (GKeyFile *key_file,
 
   g_return_val_if_fail (key_file != NULL, NULL);
 
+  if (key_file->index)
+    {
+      const GKeyFileIndex *index = key_file->index;
+
+      groups = g_new (gchar *, index->n_groups + 1);
+      for (i = 0; i < index->n_groups; i++)
+        groups[i] = g_strndup (index->data + index->groups[i].name, index->groups[i].name_len);
+      groups[i] = NULL;
+
+      if (length)
+        *length = index->n_groups;
+
+      return groups;
+    }
+
   num_groups = g_list_length (key_file->groups);
 
   g_return_val_if_fail (num_groups > 0, NULL);
@@ -1830,6 +2436,33 @@ g_key_file_get_value (GKeyFile     *key_file,
   g_return_val_if_fail (key_file != NULL, NULL);
   g_return_val_if_fail (group_name != NULL, NULL);
   g_return_val_if_fail (key != NULL, NULL);
+
+  if (key_file->index)
+    {
+      const GKeyFileIndex *index = key_file->index;
+      const GKeyFileIndexGroup *igroup;
+      const GKeyFileIndexEntry *entry;
+
+      igroup = g_key_file_index_lookup_group (index, group_name);
+
+      if (!igroup)
+        {
+          g_set_error (error, G_KEY_FILE_ERROR,
+                       G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+                       _("Key file does not have group “%s”"),
+                       group_name);
+          return NULL;
+        }
+
+      entry = g_key_file_index_lookup_entry (index, igroup, key);
+
+      if (entry)
+        value = g_strndup (index->data + entry->value, entry->value_len);
+      else
+        set_not_found_key_error (group_name, key, error);
+
+      return value;
+    }
   
   group = g_key_file_lookup_group (key_file, group_name);
 
@@ -1882,6 +2515,8 @@ g_key_file_set_value (GKeyFile    *key_file,
   g_return_if_fail (key != NULL && g_key_file_is_key_name (key, strlen (key)));
   g_return_if_fail (value != NULL);
 
+  g_key_file_materialize (key_file);
+
   group = g_key_file_lookup_group (key_file, group_name);
 
   if (!group)
@@ -3453,6 +4088,8 @@ g_key_file_set_comment (GKeyFile     *key_file,
 {
   g_return_val_if_fail (key_file != NULL, FALSE);
 
+  g_key_file_materialize (key_file);
+
   if (group_name != NULL && key != NULL) 
     {
       if (!g_key_file_set_key_comment (key_file, group_name, key, comment, error))
@@ -3678,6 +4315,8 @@ g_key_file_get_comment (GKeyFile     *key_file,
 {
   g_return_val_if_fail (key_file != NULL, NULL);
 
+  g_key_file_materialize (key_file);
+
   if (group_name != NULL && key != NULL)
     return g_key_file_get_key_comment (key_file, group_name, key, error);
   else if (group_name != NULL)
@@ -3711,6 +4350,8 @@ g_key_file_remove_comment (GKeyFile     *key_file,
 {
   g_return_val_if_fail (key_file != NULL, FALSE);
 
+  g_key_file_materialize (key_file);
+
   if (group_name != NULL && key != NULL)
     return g_key_file_set_key_comment (key_file, group_name, key, NULL, error);
   else if (group_name != NULL)
@@ -3737,6 +4378,9 @@ g_key_file_has_group (GKeyFile    *key_file,
   g_return_val_if_fail (key_file != NULL, FALSE);
   g_return_val_if_fail (group_name != NULL, FALSE);
 
+  if (key_file->index)
+    return g_key_file_index_lookup_group (key_file->index, group_name) != NULL;
+
   return g_key_file_lookup_group (key_file, group_name) != NULL;
 }
 
@@ -3757,6 +4401,27 @@ g_key_file_has_key_full (GKeyFile     *key_file,
   g_return_val_if_fail (group_name != NULL, FALSE);
   g_return_val_if_fail (key != NULL, FALSE);
 
+  if (key_file->index)
+    {
+      const GKeyFileIndexGroup *igroup;
+
+      igroup = g_key_file_index_lookup_group (key_file->index, group_name);
+
+      if (!igroup)
+        {
+          g_set_error (error, G_KEY_FILE_ERROR,
+                       G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+                       _("Key file does not have group “%s”"),
+                       group_name);
+
+          return FALSE;
+        }
+
+      if (has_key)
+        *has_key = g_key_file_index_lookup_entry (key_file->index, igroup, key) != NULL;
+      return TRUE;
+    }
+
   group = g_key_file_lookup_group (key_file, group_name);
 
   if (!group)
@@ -4006,6 +4671,8 @@ g_key_file_remove_group (GKeyFile     *key_file,
   g_return_val_if_fail (key_file != NULL, FALSE);
   g_return_val_if_fail (group_name != NULL, FALSE);
 
+  g_key_file_materialize (key_file);
+
   group_node = g_key_file_lookup_group_node (key_file, group_name);
 
   if (!group_node)
@@ -4079,6 +4746,8 @@ g_key_file_remove_key (GKeyFile     *key_file,
   g_return_val_if_fail (group_name != NULL, FALSE);
   g_return_val_if_fail (key != NULL, FALSE);
 
+  g_key_file_materialize (key_file);
+
   pair = NULL;
 
   group = g_key_file_lookup_group (key_file, group_name);
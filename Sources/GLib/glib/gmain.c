@@ -54,6 +54,9 @@
 #ifdef HAVE_EVENTFD
 #include <sys/eventfd.h>
 #endif
+#ifdef HAVE_EPOLL_CREATE
+#include <sys/epoll.h>
+#endif
 #endif
 
 #include <signal.h>
@@ -134,13 +137,18 @@ typedef struct _GTimeoutSource GTimeoutSource;
 typedef struct _GChildWatchSource GChildWatchSource;
 typedef struct _GUnixSignalWatchSource GUnixSignalWatchSource;
 typedef struct _GPollRec GPollRec;
+#ifdef HAVE_EPOLL_CREATE
+typedef struct _GEpollRec GEpollRec;
+#endif
 typedef struct _GSourceCallback GSourceCallback;
 
 typedef enum
 {
   G_SOURCE_READY = 1 << G_HOOK_FLAG_USER_SHIFT,
   G_SOURCE_CAN_RECURSE = 1 << (G_HOOK_FLAG_USER_SHIFT + 1),
-  G_SOURCE_BLOCKED = 1 << (G_HOOK_FLAG_USER_SHIFT + 2)
+  G_SOURCE_BLOCKED = 1 << (G_HOOK_FLAG_USER_SHIFT + 2),
+  G_SOURCE_PASSIVE = 1 << (G_HOOK_FLAG_USER_SHIFT + 3),
+  G_SOURCE_FIRED = 1 << (G_HOOK_FLAG_USER_SHIFT + 4)
 } GSourceFlags;
 
 typedef struct _GSourceList GSourceList;
@@ -149,6 +157,9 @@ struct _GSourceList
 {
   GList link;
   GSource *head, *tail;
+  /* Sources which are only ever ready because of their unix fds; only
+   * used by epoll contexts, see source_is_passive() */
+  GSource *passive_head, *passive_tail;
   gint priority;
 };
 
@@ -211,6 +222,20 @@ struct _GMainContext
 
   gint64   time;
   gboolean time_is_fresh;
+
+#ifdef HAVE_EPOLL_CREATE
+  /* Only used with G_MAIN_CONTEXT_FLAGS_EPOLL; epoll_fd is -1 otherwise */
+  gint epoll_fd;
+  GHashTable *epoll_records;        /* (element-type gint GEpollRec) */
+  GPtrArray *epoll_fired;           /* records whose revents were set */
+  GPtrArray *epoll_legacy;          /* records with a plain GPollFD */
+  GPtrArray *epoll_unpollable;      /* records epoll_ctl() refused */
+  GPtrArray *epoll_ready;           /* passive sources found ready by check */
+  struct epoll_event *epoll_events;
+  gint n_epoll_events;
+  gboolean epoll_revents_stale;     /* revents were set by a plain poll() */
+  gboolean poll_records_unsorted;
+#endif
 };
 
 struct _GSourceCallback
@@ -268,7 +293,30 @@ struct _GPollRec
   GPollRec *prev;
   GPollRec *next;
   gint priority;
+  /* TRUE if fd->events is only ever changed via g_source_modify_unix_fd() */
+  gboolean unix_fd;
+#ifdef HAVE_EPOLL_CREATE
+  GEpollRec *epoll_rec;
+  GSource *source;      /* owner of a unix fd, if any */
+#endif
+};
+
+#ifdef HAVE_EPOLL_CREATE
+/* All the poll records for one file descriptor, which epoll only lets us
+ * register once.
+ */
+struct _GEpollRec
+{
+  gint fd;
+  guint32 events;       /* as last registered with the kernel */
+  GSList *pollrecs;     /* (element-type GPollRec) */
+  guint n_legacy;       /* pollrecs with unix_fd unset */
+  gint error;           /* errno from epoll_ctl(), if unpollable */
+  guint registered : 1;
+  guint unpollable : 1;
+  guint fired : 1;
 };
+#endif
 
 struct _GSourcePrivate
 {
@@ -291,6 +339,8 @@ typedef struct _GSourceIter
 {
   GMainContext *context;
   gboolean may_modify;
+  gboolean active_only;  /* skip passive sources */
+  gboolean in_passive;
   GList *current_list;
   GSource *source;
 } GSourceIter;
@@ -319,7 +369,8 @@ static void g_child_source_remove_internal      (GSource      *child_source,
 static gboolean g_main_context_acquire_unlocked (GMainContext *context);
 static void g_main_context_release_unlocked     (GMainContext *context);
 static gboolean g_main_context_prepare_unlocked (GMainContext *context,
-                                                 gint         *priority);
+                                                 gint         *priority,
+                                                 gboolean      epoll);
 static gint g_main_context_query_unlocked       (GMainContext *context,
                                                  gint          max_priority,
                                                  gint         *timeout,
@@ -328,7 +379,8 @@ static gint g_main_context_query_unlocked       (GMainContext *context,
 static gboolean g_main_context_check_unlocked   (GMainContext *context,
                                                  gint          max_priority,
                                                  GPollFD      *fds,
-                                                 gint          n_fds);
+                                                 gint          n_fds,
+                                                 gboolean      epoll);
 static void g_main_context_dispatch_unlocked    (GMainContext *context);
 static void g_main_context_poll_unlocked        (GMainContext *context,
                                                  int           timeout,
@@ -338,6 +390,10 @@ static void g_main_context_poll_unlocked        (GMainContext *context,
 static void g_main_context_add_poll_unlocked    (GMainContext *context,
 						 gint          priority,
 						 GPollFD      *fd);
+static void g_main_context_add_unix_fd_unlocked (GMainContext *context,
+						 gint          priority,
+						 GPollFD      *fd,
+						 GSource      *source);
 static void g_main_context_remove_poll_unlocked (GMainContext *context,
 						 GPollFD      *fd);
 
@@ -482,6 +538,295 @@ poll_rec_list_free (GMainContext *context,
   g_slice_free_chain (GPollRec, list, next);
 }
 
+#ifdef HAVE_EPOLL_CREATE
+static void
+epoll_rec_free (gpointer data)
+{
+  GEpollRec *rec = data;
+
+  g_slist_free (rec->pollrecs);
+  g_free (rec);
+}
+
+static void
+g_main_context_epoll_init (GMainContext *context)
+{
+  context->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+  if (context->epoll_fd < 0)
+    {
+      /* Not fatal: the context silently falls back to poll() */
+      g_debug ("epoll_create1() failed: %s", g_strerror (errno));
+      return;
+    }
+
+  context->epoll_records = g_hash_table_new_full (g_int_hash, g_int_equal,
+                                                  NULL, epoll_rec_free);
+  context->epoll_fired = g_ptr_array_new ();
+  context->epoll_legacy = g_ptr_array_new ();
+  context->epoll_unpollable = g_ptr_array_new ();
+  context->epoll_ready = g_ptr_array_new ();
+  context->n_epoll_events = 64;
+  context->epoll_events = g_new (struct epoll_event, context->n_epoll_events);
+}
+
+static void
+g_main_context_epoll_clear (GMainContext *context)
+{
+  if (context->epoll_fd < 0)
+    return;
+
+  g_hash_table_destroy (context->epoll_records);
+  g_ptr_array_free (context->epoll_fired, TRUE);
+  g_ptr_array_free (context->epoll_legacy, TRUE);
+  g_ptr_array_free (context->epoll_unpollable, TRUE);
+  g_ptr_array_free (context->epoll_ready, TRUE);
+  g_free (context->epoll_events);
+  close (context->epoll_fd);
+  context->epoll_fd = -1;
+}
+
+/* HOLDS: context's lock
+ *
+ * Brings the kernel's interest list in line with the union of the events
+ * of all poll records for @rec's fd. This is a no-op unless they changed.
+ */
+static void
+g_main_context_epoll_update (GMainContext *context,
+                             GEpollRec    *rec)
+{
+  struct epoll_event ev;
+  guint32 events = 0;
+  GSList *l;
+  int op, ret;
+
+  for (l = rec->pollrecs; l != NULL; l = l->next)
+    events |= ((GPollRec *) l->data)->fd->events;
+  events &= EPOLLIN | EPOLLPRI | EPOLLOUT;
+
+  if (rec->registered && rec->events == events)
+    return;
+
+  rec->events = events;
+
+  if (rec->unpollable)
+    return;
+
+  memset (&ev, 0, sizeof (ev));
+  ev.events = events;
+  ev.data.fd = rec->fd;
+
+  op = rec->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+  ret = epoll_ctl (context->epoll_fd, op, rec->fd, &ev);
+
+  /* The fd was closed, which drops it from the interest list, and then
+   * reused before its poll records were removed. */
+  if (ret < 0 && op == EPOLL_CTL_MOD && errno == ENOENT)
+    ret = epoll_ctl (context->epoll_fd, EPOLL_CTL_ADD, rec->fd, &ev);
+
+  rec->registered = TRUE;
+
+  if (ret < 0)
+    {
+      /* epoll refuses regular files and directories (EPERM), which poll()
+       * always reports as readable and writable, and poll() reports
+       * G_IO_NVAL for fds which are not open (EBADF). Emulate both. */
+      rec->error = errno;
+      rec->unpollable = TRUE;
+      g_ptr_array_add (context->epoll_unpollable, rec);
+    }
+}
+
+/* HOLDS: context's lock */
+static void
+g_main_context_epoll_add (GMainContext *context,
+                          GPollRec     *pollrec)
+{
+  GEpollRec *rec;
+  gint fd = pollrec->fd->fd;
+
+  /* poll() ignores negative fds, so there is nothing to register */
+  if (fd < 0)
+    return;
+
+  rec = g_hash_table_lookup (context->epoll_records, &fd);
+  if (rec == NULL)
+    {
+      rec = g_new0 (GEpollRec, 1);
+      rec->fd = fd;
+      g_hash_table_insert (context->epoll_records, &rec->fd, rec);
+    }
+
+  rec->pollrecs = g_slist_prepend (rec->pollrecs, pollrec);
+  pollrec->epoll_rec = rec;
+
+  if (!pollrec->unix_fd && rec->n_legacy++ == 0)
+    g_ptr_array_add (context->epoll_legacy, rec);
+
+  g_main_context_epoll_update (context, rec);
+}
+
+/* HOLDS: context's lock */
+static void
+g_main_context_epoll_remove (GMainContext *context,
+                             GPollRec     *pollrec)
+{
+  GEpollRec *rec = pollrec->epoll_rec;
+
+  if (rec == NULL)
+    return;
+
+  pollrec->epoll_rec = NULL;
+  rec->pollrecs = g_slist_remove (rec->pollrecs, pollrec);
+
+  if (!pollrec->unix_fd && --rec->n_legacy == 0)
+    g_ptr_array_remove_fast (context->epoll_legacy, rec);
+
+  if (rec->pollrecs != NULL)
+    {
+      g_main_context_epoll_update (context, rec);
+      return;
+    }
+
+  if (rec->unpollable)
+    g_ptr_array_remove_fast (context->epoll_unpollable, rec);
+  else if (rec->registered)
+    epoll_ctl (context->epoll_fd, EPOLL_CTL_DEL, rec->fd, NULL);
+
+  if (rec->fired)
+    g_ptr_array_remove_fast (context->epoll_fired, rec);
+
+  g_hash_table_remove (context->epoll_records, &rec->fd);
+}
+
+/* HOLDS: context's lock */
+static void
+g_main_context_epoll_fire (GMainContext *context,
+                           GEpollRec    *rec,
+                           gushort       revents,
+                           gint          max_priority)
+{
+  GSList *l;
+
+  for (l = rec->pollrecs; l != NULL; l = l->next)
+    {
+      GPollRec *pollrec = l->data;
+
+      if (pollrec->priority <= max_priority)
+        pollrec->fd->revents =
+          revents & (pollrec->fd->events | G_IO_ERR | G_IO_HUP | G_IO_NVAL);
+    }
+
+  if (!rec->fired)
+    {
+      rec->fired = TRUE;
+      g_ptr_array_add (context->epoll_fired, rec);
+    }
+}
+
+/* HOLDS: context's lock
+ *
+ * The epoll counterpart of g_main_context_query_unlocked(),
+ * g_main_context_poll_unlocked() and the revents bookkeeping at the start
+ * of g_main_context_check_unlocked(). Only the records of fds which are
+ * actually ready are touched.
+ */
+static void
+g_main_context_epoll_unlocked (GMainContext *context,
+                               gint          timeout,
+                               gint          max_priority)
+{
+  struct epoll_event *events;
+  gint n_events, errsv;
+  guint i;
+
+  /* Forget the results of the previous iteration. */
+  if (context->epoll_revents_stale)
+    {
+      GPollRec *pollrec;
+
+      for (pollrec = context->poll_records; pollrec; pollrec = pollrec->next)
+        pollrec->fd->revents = 0;
+      context->epoll_revents_stale = FALSE;
+    }
+
+  for (i = 0; i < context->epoll_fired->len; i++)
+    {
+      GEpollRec *rec = context->epoll_fired->pdata[i];
+      GSList *l;
+
+      for (l = rec->pollrecs; l != NULL; l = l->next)
+        ((GPollRec *) l->data)->fd->revents = 0;
+      rec->fired = FALSE;
+    }
+  g_ptr_array_set_size (context->epoll_fired, 0);
+
+  /* Plain GPollFDs added with g_source_add_poll() may have had their
+   * events changed in place, so look at them again. */
+  for (i = 0; i < context->epoll_legacy->len; i++)
+    g_main_context_epoll_update (context, context->epoll_legacy->pdata[i]);
+
+  context->poll_changed = FALSE;
+
+  if (context->epoll_unpollable->len > 0)
+    timeout = 0;
+
+  /* Only the owner of the context gets here, so the events buffer can be
+   * used without the lock. */
+  events = context->epoll_events;
+
+  UNLOCK_CONTEXT (context);
+  n_events = epoll_wait (context->epoll_fd, events, context->n_epoll_events, timeout);
+  errsv = errno;
+  LOCK_CONTEXT (context);
+
+  if (n_events < 0)
+    {
+      if (errsv != EINTR)
+        g_warning ("epoll_wait(2) failed due to: %s.", g_strerror (errsv));
+      n_events = 0;
+    }
+
+  for (i = 0; i < (guint) n_events; i++)
+    {
+      GEpollRec *rec;
+      gint fd = events[i].data.fd;
+
+      /* The fd may have been removed while we were waiting. */
+      rec = g_hash_table_lookup (context->epoll_records, &fd);
+      if (rec == NULL || rec->unpollable)
+        continue;
+
+      if (fd == context->wake_up_rec.fd)
+        {
+          TRACE (GLIB_MAIN_CONTEXT_WAKEUP_ACKNOWLEDGE (context));
+          g_wakeup_acknowledge (context->wakeup);
+        }
+
+      g_main_context_epoll_fire (context, rec,
+                                 events[i].events & (EPOLLIN | EPOLLPRI | EPOLLOUT | EPOLLERR | EPOLLHUP),
+                                 max_priority);
+    }
+
+  for (i = 0; i < context->epoll_unpollable->len; i++)
+    {
+      GEpollRec *rec = context->epoll_unpollable->pdata[i];
+
+      g_main_context_epoll_fire (context, rec,
+                                 (rec->error == EPERM) ? (rec->events & (G_IO_IN | G_IO_OUT)) : G_IO_NVAL,
+                                 max_priority);
+    }
+
+  /* A full buffer means there may have been more ready fds than we could
+   * fetch; they will be reported next time, but make room for them. */
+  if (n_events == context->n_epoll_events && n_events < G_MAXINT / 2)
+    {
+      context->n_epoll_events *= 2;
+      g_free (context->epoll_events);
+      context->epoll_events = g_new (struct epoll_event, context->n_epoll_events);
+    }
+}
+#endif /* HAVE_EPOLL_CREATE */
+
 /**
  * g_main_context_unref:
  * @context: (not nullable): a #GMainContext
@@ -560,6 +905,10 @@ g_main_context_unref (GMainContext *context)
 
   poll_rec_list_free (context, context->poll_records);
 
+#ifdef HAVE_EPOLL_CREATE
+  g_main_context_epoll_clear (context);
+#endif
+
   g_wakeup_free (context->wakeup);
   g_cond_clear (&context->cond);
 
@@ -654,10 +1003,16 @@ g_main_context_new_with_flags (GMainContextFlags flags)
   context->pending_dispatches = g_ptr_array_new ();
   
   context->time_is_fresh = FALSE;
+
+#ifdef HAVE_EPOLL_CREATE
+  context->epoll_fd = -1;
+  if (flags & G_MAIN_CONTEXT_FLAGS_EPOLL)
+    g_main_context_epoll_init (context);
+#endif
   
   context->wakeup = g_wakeup_new ();
   g_wakeup_get_pollfd (context->wakeup, &context->wake_up_rec);
-  g_main_context_add_poll_unlocked (context, 0, &context->wake_up_rec);
+  g_main_context_add_unix_fd_unlocked (context, 0, &context->wake_up_rec, NULL);
 
   G_LOCK (main_context_list);
   main_context_list = g_slist_append (main_context_list, context);
@@ -980,6 +1335,8 @@ g_source_iter_init (GSourceIter  *iter,
   iter->current_list = NULL;
   iter->source = NULL;
   iter->may_modify = may_modify;
+  iter->active_only = FALSE;
+  iter->in_passive = FALSE;
 }
 
 /* Holds context's lock */
@@ -993,19 +1350,30 @@ g_source_iter_next (GSourceIter *iter, GSource **source)
   else
     next_source = NULL;
 
-  if (!next_source)
+  /* Each list holds its active sources and then its passive ones. */
+  while (!next_source)
     {
+      GSourceList *source_list;
+
+      if (iter->current_list && !iter->in_passive && !iter->active_only)
+        {
+          iter->in_passive = TRUE;
+          source_list = iter->current_list->data;
+          next_source = source_list->passive_head;
+          continue;
+        }
+
       if (iter->current_list)
 	iter->current_list = iter->current_list->next;
       else
 	iter->current_list = iter->context->source_lists.head;
 
-      if (iter->current_list)
-	{
-	  GSourceList *source_list = iter->current_list->data;
+      if (!iter->current_list)
+        break;
 
-	  next_source = source_list->head;
-	}
+      iter->in_passive = FALSE;
+      source_list = iter->current_list->data;
+      next_source = source_list->head;
     }
 
   /* Note: unreffing iter->source could potentially cause its
@@ -1084,20 +1452,52 @@ find_source_list_for_priority (GMainContext *context,
   return source_list;
 }
 
+/* Holds context's lock
+ *
+ * A passive source can only become ready because one of its unix fds
+ * polled as ready. On epoll contexts such sources are kept apart from
+ * the others, so that prepare and check only visit them when their fds
+ * actually fired.
+ */
+static gboolean
+source_is_passive (GSource      *source,
+                   GMainContext *context)
+{
+#ifdef HAVE_EPOLL_CREATE
+  return context->epoll_fd >= 0 &&
+         source->source_funcs->prepare == NULL &&
+         source->source_funcs->check == NULL &&
+         source->priv->ready_time == -1 &&
+         source->priv->parent_source == NULL &&
+         source->priv->child_sources == NULL;
+#else
+  return FALSE;
+#endif
+}
+
 /* Holds context's lock
  */
 static void
-source_add_to_context (GSource      *source,
-		       GMainContext *context)
+source_list_link (GSourceList *source_list,
+                  GSource     *source)
 {
-  GSourceList *source_list;
+  GSource **head, **tail;
   GSource *prev, *next;
 
-  source_list = find_source_list_for_priority (context, source->priority, TRUE);
+  if (source->flags & G_SOURCE_PASSIVE)
+    {
+      head = &source_list->passive_head;
+      tail = &source_list->passive_tail;
+    }
+  else
+    {
+      head = &source_list->head;
+      tail = &source_list->tail;
+    }
 
   if (source->priv->parent_source)
     {
-      g_assert (source_list->head != NULL);
+      g_assert (*head != NULL);
 
       /* Put the source immediately before its parent */
       prev = source->priv->parent_source->prev;
@@ -1105,7 +1505,7 @@ source_add_to_context (GSource      *source,
     }
   else
     {
-      prev = source_list->tail;
+      prev = *tail;
       next = NULL;
     }
 
@@ -1113,46 +1513,107 @@ source_add_to_context (GSource      *source,
   if (next)
     next->prev = source;
   else
-    source_list->tail = source;
+    *tail = source;
   
   source->prev = prev;
   if (prev)
     prev->next = source;
   else
-    source_list->head = source;
+    *head = source;
 }
 
 /* Holds context's lock
  */
 static void
-source_remove_from_context (GSource      *source,
-			    GMainContext *context)
+source_list_unlink (GSourceList *source_list,
+                    GSource     *source)
 {
-  GSourceList *source_list;
-
-  source_list = find_source_list_for_priority (context, source->priority, FALSE);
-  g_return_if_fail (source_list != NULL);
-
   if (source->prev)
     source->prev->next = source->next;
+  else if (source->flags & G_SOURCE_PASSIVE)
+    source_list->passive_head = source->next;
   else
     source_list->head = source->next;
 
   if (source->next)
     source->next->prev = source->prev;
+  else if (source->flags & G_SOURCE_PASSIVE)
+    source_list->passive_tail = source->prev;
   else
     source_list->tail = source->prev;
 
   source->prev = NULL;
   source->next = NULL;
+}
 
-  if (source_list->head == NULL)
+/* Holds context's lock
+ */
+static void
+source_add_to_context (GSource      *source,
+		       GMainContext *context)
+{
+  GSourceList *source_list;
+
+  source_list = find_source_list_for_priority (context, source->priority, TRUE);
+
+  if (source_is_passive (source, context))
+    source->flags |= G_SOURCE_PASSIVE;
+  else
+    source->flags &= ~G_SOURCE_PASSIVE;
+
+  source_list_link (source_list, source);
+}
+
+/* Holds context's lock
+ */
+static void
+source_remove_from_context (GSource      *source,
+			    GMainContext *context)
+{
+  GSourceList *source_list;
+
+  source_list = find_source_list_for_priority (context, source->priority, FALSE);
+  g_return_if_fail (source_list != NULL);
+
+  source_list_unlink (source_list, source);
+
+  if (source_list->head == NULL && source_list->passive_head == NULL)
     {
       g_queue_unlink (&context->source_lists, &source_list->link);
       g_slice_free (GSourceList, source_list);
     }
 }
 
+/* Holds context's lock
+ *
+ * Moves @source to the other half of its list if it stopped or started
+ * being passive.
+ */
+static void
+source_update_passive (GSource      *source,
+                       GMainContext *context)
+{
+  GSourceList *source_list;
+  gboolean passive;
+
+  if (context == NULL)
+    return;
+
+  passive = source_is_passive (source, context);
+  if (passive == ((source->flags & G_SOURCE_PASSIVE) != 0))
+    return;
+
+  source_list = find_source_list_for_priority (context, source->priority, FALSE);
+  g_return_if_fail (source_list != NULL);
+
+  source_list_unlink (source_list, source);
+  if (passive)
+    source->flags |= G_SOURCE_PASSIVE;
+  else
+    source->flags &= ~G_SOURCE_PASSIVE;
+  source_list_link (source_list, source);
+}
+
 static guint
 g_source_attach_unlocked (GSource      *source,
                           GMainContext *context,
@@ -1186,7 +1647,7 @@ g_source_attach_unlocked (GSource      *source,
         }
 
       for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
-        g_main_context_add_poll_unlocked (context, source->priority, tmp_list->data);
+        g_main_context_add_unix_fd_unlocked (context, source->priority, tmp_list->data, source);
     }
 
   tmp_list = source->priv->child_sources;
@@ -1540,6 +2001,7 @@ g_source_add_child_source (GSource *source,
   source->priv->child_sources = g_slist_prepend (source->priv->child_sources,
 						 g_source_ref (child_source));
   child_source->priv->parent_source = source;
+  source_update_passive (source, context);
   g_source_set_priority_unlocked (child_source, NULL, source->priority);
   if (SOURCE_BLOCKED (source))
     block_source (child_source);
@@ -1563,6 +2025,9 @@ g_child_source_remove_internal (GSource *child_source,
 
   g_source_destroy_internal (child_source, context, TRUE);
   g_source_unref_internal (child_source, context, TRUE);
+
+  if (parent_source->context == context)
+    source_update_passive (parent_source, context);
 }
 
 /**
@@ -1813,7 +2278,7 @@ g_source_set_priority_unlocked (GSource      *source,
           for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
             {
               g_main_context_remove_poll_unlocked (context, tmp_list->data);
-              g_main_context_add_poll_unlocked (context, priority, tmp_list->data);
+              g_main_context_add_unix_fd_unlocked (context, priority, tmp_list->data, source);
             }
 	}
     }
@@ -1938,6 +2403,8 @@ g_source_set_ready_time (GSource *source,
 
   if (context)
     {
+      source_update_passive (source, context);
+
       /* Quite likely that we need to change the timeout on the poll */
       if (!SOURCE_BLOCKED (source))
         g_wakeup_signal (context->wakeup);
@@ -2647,7 +3114,7 @@ g_source_add_unix_fd (GSource      *source,
   if (context)
     {
       if (!SOURCE_BLOCKED (source))
-        g_main_context_add_poll_unlocked (context, source->priority, poll_fd);
+        g_main_context_add_unix_fd_unlocked (context, source->priority, poll_fd, source);
       UNLOCK_CONTEXT (context);
     }
 
@@ -2689,6 +3156,25 @@ g_source_modify_unix_fd (GSource      *source,
   context = source->context;
   poll_fd = tag;
 
+#ifdef HAVE_EPOLL_CREATE
+  /* epoll_ctl() takes effect even on a running epoll_wait(), so there is
+   * no need to wake the context up. */
+  if (context && context->epoll_fd >= 0)
+    {
+      LOCK_CONTEXT (context);
+      poll_fd->events = new_events;
+      if (poll_fd->fd >= 0)
+        {
+          GEpollRec *rec = g_hash_table_lookup (context->epoll_records, &poll_fd->fd);
+
+          if (rec != NULL)
+            g_main_context_epoll_update (context, rec);
+        }
+      UNLOCK_CONTEXT (context);
+      return;
+    }
+#endif
+
   poll_fd->events = new_events;
 
   if (context)
@@ -3268,7 +3754,7 @@ unblock_source (GSource *source)
     }
 
   for (tmp_list = source->priv->fds; tmp_list; tmp_list = tmp_list->next)
-    g_main_context_add_poll_unlocked (source->context, source->priority, tmp_list->data);
+    g_main_context_add_unix_fd_unlocked (source->context, source->priority, tmp_list->data, source);
 
   if (source->priv && source->priv->child_sources)
     {
@@ -3626,16 +4112,21 @@ g_main_context_prepare (GMainContext *context,
   
   LOCK_CONTEXT (context);
 
-  ready = g_main_context_prepare_unlocked (context, priority);
+  ready = g_main_context_prepare_unlocked (context, priority, FALSE);
 
   UNLOCK_CONTEXT (context);
   
   return ready;
 }
 
+/* If @epoll is %TRUE, the caller polls with
+ * g_main_context_epoll_unlocked(), and passive sources are left to
+ * g_main_context_check_unlocked() entirely.
+ */
 static gboolean
 g_main_context_prepare_unlocked (GMainContext *context,
-                                 gint         *priority)
+                                 gint         *priority,
+                                 gboolean      epoll)
 {
   guint i;
   gint n_ready = 0;
@@ -3669,8 +4160,16 @@ g_main_context_prepare_unlocked (GMainContext *context,
 
   for (i = 0; i < context->pending_dispatches->len; i++)
     {
-      if (context->pending_dispatches->pdata[i])
-        g_source_unref_internal ((GSource *)context->pending_dispatches->pdata[i], context, TRUE);
+      source = context->pending_dispatches->pdata[i];
+
+      if (source)
+        {
+          /* Passive sources are not visited below; the level-triggered
+           * epoll will report their fds again if they are still ready. */
+          if (epoll && (source->flags & G_SOURCE_PASSIVE))
+            source->flags &= ~G_SOURCE_READY;
+          g_source_unref_internal (source, context, TRUE);
+        }
     }
   g_ptr_array_set_size (context->pending_dispatches, 0);
   
@@ -3679,6 +4178,7 @@ g_main_context_prepare_unlocked (GMainContext *context,
   context->timeout = -1;
   
   g_source_iter_init (&iter, context, TRUE);
+  iter.active_only = epoll;
   while (g_source_iter_next (&iter, &source))
     {
       gint source_timeout = -1;
@@ -3825,6 +4325,78 @@ g_main_context_query (GMainContext *context,
   return n_poll;
 }
 
+#ifdef HAVE_EPOLL_CREATE
+static GPollRec *
+poll_rec_list_merge (GPollRec *a,
+                     GPollRec *b)
+{
+  GPollRec head, *tail = &head;
+
+  /* Take from @a on ties, so that the sort is stable */
+  while (a && b)
+    {
+      if (b->fd->fd < a->fd->fd)
+        {
+          tail->next = b;
+          b = b->next;
+        }
+      else
+        {
+          tail->next = a;
+          a = a->next;
+        }
+      tail = tail->next;
+    }
+  tail->next = a ? a : b;
+
+  return head.next;
+}
+
+static GPollRec *
+poll_rec_list_sort (GPollRec *list)
+{
+  GPollRec *slow, *fast, *second;
+
+  if (list == NULL || list->next == NULL)
+    return list;
+
+  slow = list;
+  for (fast = list->next; fast && fast->next; fast = fast->next->next)
+    slow = slow->next;
+
+  second = slow->next;
+  slow->next = NULL;
+
+  return poll_rec_list_merge (poll_rec_list_sort (list),
+                              poll_rec_list_sort (second));
+}
+#endif
+
+/* HOLDS: context's lock
+ *
+ * Epoll contexts only keep their poll records in fd order when
+ * the GPollFD array code needs it.
+ */
+static void
+poll_records_ensure_sorted (GMainContext *context)
+{
+#ifdef HAVE_EPOLL_CREATE
+  GPollRec *pollrec, *prevrec = NULL;
+
+  if (!context->poll_records_unsorted)
+    return;
+
+  context->poll_records = poll_rec_list_sort (context->poll_records);
+  for (pollrec = context->poll_records; pollrec; pollrec = pollrec->next)
+    {
+      pollrec->prev = prevrec;
+      prevrec = pollrec;
+    }
+
+  context->poll_records_unsorted = FALSE;
+#endif
+}
+
 static gint
 g_main_context_query_unlocked (GMainContext *context,
                                gint          max_priority,
@@ -3838,6 +4410,8 @@ g_main_context_query_unlocked (GMainContext *context,
   
   TRACE (GLIB_MAIN_CONTEXT_BEFORE_QUERY (context, max_priority));
 
+  poll_records_ensure_sorted (context);
+
   /* fds is filled sequentially from poll_records. Since poll_records
    * are incrementally sorted by file descriptor identifier, fds will
    * also be incrementally sorted.
@@ -3927,24 +4501,71 @@ g_main_context_check (GMainContext *context,
    
   LOCK_CONTEXT (context);
 
-  ready = g_main_context_check_unlocked (context, max_priority, fds, n_fds);
+  ready = g_main_context_check_unlocked (context, max_priority, fds, n_fds, FALSE);
 
   UNLOCK_CONTEXT (context);
 
   return ready;
 }
 
+#ifdef HAVE_EPOLL_CREATE
+/* HOLDS: context's lock
+ *
+ * Collects the passive sources whose unix fds fired in the last
+ * g_main_context_epoll_unlocked() into context->epoll_ready, and returns
+ * the highest priority among them, or G_MAXINT if there are none.
+ */
+static gint
+g_main_context_epoll_collect (GMainContext *context)
+{
+  gint priority = G_MAXINT;
+  guint i;
+
+  for (i = 0; i < context->epoll_fired->len; i++)
+    {
+      GEpollRec *rec = context->epoll_fired->pdata[i];
+      GSList *l;
+
+      for (l = rec->pollrecs; l != NULL; l = l->next)
+        {
+          GPollRec *pollrec = l->data;
+          GSource *source = pollrec->source;
+
+          if (source == NULL || pollrec->fd->revents == 0 ||
+              !(source->flags & G_SOURCE_PASSIVE) ||
+              (source->flags & G_SOURCE_FIRED) ||
+              SOURCE_DESTROYED (source) || SOURCE_BLOCKED (source))
+            continue;
+
+          source->flags |= G_SOURCE_FIRED;
+          g_ptr_array_add (context->epoll_ready, g_source_ref (source));
+          priority = MIN (priority, source->priority);
+        }
+    }
+
+  return priority;
+}
+#endif
+
+/* If @epoll is %TRUE, @fds is unused: revents were already set by
+ * g_main_context_epoll_unlocked(). Only active sources are walked then;
+ * the passive ones are found through the fds which fired.
+ */
 static gboolean
 g_main_context_check_unlocked (GMainContext *context,
                                gint          max_priority,
                                GPollFD      *fds,
-                               gint          n_fds)
+                               gint          n_fds,
+                               gboolean      epoll)
 {
   GSource *source;
   GSourceIter iter;
   GPollRec *pollrec;
   gint n_ready = 0;
   gint i;
+#ifdef HAVE_EPOLL_CREATE
+  gint passive_priority = G_MAXINT;
+#endif
 
   if (context == NULL)
     context = g_main_context_default ();
@@ -3981,6 +4602,23 @@ g_main_context_check_unlocked (GMainContext *context,
       return FALSE;
     }
 
+#ifdef HAVE_EPOLL_CREATE
+  if (epoll)
+    {
+      passive_priority = g_main_context_epoll_collect (context);
+
+      /* Don't let lower priority active sources in ahead of them */
+      if (passive_priority < max_priority)
+        max_priority = passive_priority;
+    }
+  else if (context->epoll_fd >= 0)
+    {
+      /* Revents below are set on all records, not just the fired ones */
+      context->epoll_revents_stale = TRUE;
+      poll_records_ensure_sorted (context);
+    }
+#endif
+
   /* The linear iteration below relies on the assumption that both
    * poll records and the fds array are incrementally sorted by file
    * descriptor identifier.
@@ -4012,12 +4650,20 @@ g_main_context_check_unlocked (GMainContext *context,
     }
 
   g_source_iter_init (&iter, context, TRUE);
+#ifdef HAVE_EPOLL_CREATE
+  iter.active_only = epoll;
+#endif
   while (g_source_iter_next (&iter, &source))
     {
       if (SOURCE_DESTROYED (source) || SOURCE_BLOCKED (source))
 	continue;
+#ifdef HAVE_EPOLL_CREATE
+      if ((n_ready > 0 || passive_priority < G_MAXINT) && (source->priority > max_priority))
+	break;
+#else
       if ((n_ready > 0) && (source->priority > max_priority))
 	break;
+#endif
 
       if (!(source->flags & G_SOURCE_READY))
 	{
@@ -4111,6 +4757,30 @@ g_main_context_check_unlocked (GMainContext *context,
     }
   g_source_iter_clear (&iter);
 
+#ifdef HAVE_EPOLL_CREATE
+  /* Passive sources of the chosen priority are dispatched after the
+   * active ones; those of lower priority wait for the next iteration,
+   * when epoll reports their fds again. */
+  for (i = 0; epoll && i < (gint) context->epoll_ready->len; i++)
+    {
+      source = context->epoll_ready->pdata[i];
+      source->flags &= ~G_SOURCE_FIRED;
+
+      if (source->priority == max_priority &&
+          (source->flags & G_SOURCE_PASSIVE) &&
+          !SOURCE_DESTROYED (source) && !SOURCE_BLOCKED (source))
+        {
+          source->flags |= G_SOURCE_READY;
+          g_ptr_array_add (context->pending_dispatches, g_source_ref (source));
+          n_ready++;
+        }
+
+      g_source_unref_internal (source, context, TRUE);
+    }
+  if (epoll)
+    g_ptr_array_set_size (context->epoll_ready, 0);
+#endif
+
   TRACE (GLIB_MAIN_CONTEXT_AFTER_CHECK (context, n_ready));
 
   return n_ready > 0;
@@ -4186,32 +4856,52 @@ g_main_context_iterate_unlocked (GMainContext *context,
 	return FALSE;
     }
   
-  if (!context->cached_poll_array)
+#ifdef HAVE_EPOLL_CREATE
+  /* A custom poll function has to be handed the full GPollFD array. */
+  if (context->epoll_fd >= 0 && context->poll_func == g_poll)
     {
-      context->cached_poll_array_size = context->n_poll_records;
-      context->cached_poll_array = g_new (GPollFD, context->n_poll_records);
-    }
+      g_main_context_prepare_unlocked (context, &max_priority, TRUE);
 
-  allocated_nfds = context->cached_poll_array_size;
-  fds = context->cached_poll_array;
-  
-  g_main_context_prepare_unlocked (context, &max_priority);
-  
-  while ((nfds = g_main_context_query_unlocked (
-            context, max_priority, &timeout, fds,
-            allocated_nfds)) > allocated_nfds)
-    {
-      g_free (fds);
-      context->cached_poll_array_size = allocated_nfds = nfds;
-      context->cached_poll_array = fds = g_new (GPollFD, nfds);
+      timeout = context->timeout;
+      if (timeout != 0)
+        context->time_is_fresh = FALSE;
+      if (!block)
+        timeout = 0;
+
+      g_main_context_epoll_unlocked (context, timeout, max_priority);
+
+      some_ready = g_main_context_check_unlocked (context, max_priority, NULL, 0, TRUE);
     }
+  else
+#endif
+    {
+      if (!context->cached_poll_array)
+        {
+          context->cached_poll_array_size = context->n_poll_records;
+          context->cached_poll_array = g_new (GPollFD, context->n_poll_records);
+        }
 
-  if (!block)
-    timeout = 0;
-  
-  g_main_context_poll_unlocked (context, timeout, max_priority, fds, nfds);
-  
-  some_ready = g_main_context_check_unlocked (context, max_priority, fds, nfds);
+      allocated_nfds = context->cached_poll_array_size;
+      fds = context->cached_poll_array;
+
+      g_main_context_prepare_unlocked (context, &max_priority, FALSE);
+
+      while ((nfds = g_main_context_query_unlocked (
+                context, max_priority, &timeout, fds,
+                allocated_nfds)) > allocated_nfds)
+        {
+          g_free (fds);
+          context->cached_poll_array_size = allocated_nfds = nfds;
+          context->cached_poll_array = fds = g_new (GPollFD, nfds);
+        }
+
+      if (!block)
+        timeout = 0;
+
+      g_main_context_poll_unlocked (context, timeout, max_priority, fds, nfds);
+
+      some_ready = g_main_context_check_unlocked (context, max_priority, fds, nfds, FALSE);
+    }
   
   if (dispatch)
     g_main_context_dispatch_unlocked (context);
@@ -4608,9 +5298,11 @@ g_main_context_add_poll (GMainContext *context,
 
 /* HOLDS: main_loop_lock */
 static void 
-g_main_context_add_poll_unlocked (GMainContext *context,
-				  gint          priority,
-				  GPollFD      *fd)
+g_main_context_add_poll_internal (GMainContext *context,
+                                  gint          priority,
+                                  GPollFD      *fd,
+                                  gboolean      unix_fd,
+                                  GSource      *source)
 {
   GPollRec *prevrec, *nextrec;
   GPollRec *newrec = g_slice_new (GPollRec);
@@ -4619,10 +5311,25 @@ g_main_context_add_poll_unlocked (GMainContext *context,
   fd->revents = 0;
   newrec->fd = fd;
   newrec->priority = priority;
+  newrec->unix_fd = unix_fd;
+#ifdef HAVE_EPOLL_CREATE
+  newrec->source = source;
+  newrec->epoll_rec = NULL;
+  if (context->epoll_fd >= 0)
+    g_main_context_epoll_add (context, newrec);
+#endif
 
-  /* Poll records are incrementally sorted by file descriptor identifier. */
   prevrec = NULL;
   nextrec = context->poll_records;
+
+#ifdef HAVE_EPOLL_CREATE
+  /* Only the GPollFD array path needs the records sorted, so epoll
+   * contexts sort them lazily in poll_records_ensure_sorted(). */
+  if (context->epoll_fd >= 0)
+    context->poll_records_unsorted = TRUE;
+  else
+#endif
+  /* Poll records are incrementally sorted by file descriptor identifier. */
   while (nextrec)
     {
       if (nextrec->fd->fd > fd->fd)
@@ -4651,6 +5358,29 @@ g_main_context_add_poll_unlocked (GMainContext *context,
     g_wakeup_signal (context->wakeup);
 }
 
+/* HOLDS: main_loop_lock */
+static void
+g_main_context_add_poll_unlocked (GMainContext *context,
+                                  gint          priority,
+                                  GPollFD      *fd)
+{
+  g_main_context_add_poll_internal (context, priority, fd, FALSE, NULL);
+}
+
+/* HOLDS: main_loop_lock
+ *
+ * Like g_main_context_add_poll_unlocked(), for GPollFDs whose events are
+ * only changed through g_source_modify_unix_fd() (or never).
+ */
+static void
+g_main_context_add_unix_fd_unlocked (GMainContext *context,
+                                     gint          priority,
+                                     GPollFD      *fd,
+                                     GSource      *source)
+{
+  g_main_context_add_poll_internal (context, priority, fd, TRUE, source);
+}
+
 /**
  * g_main_context_remove_poll:
  * @context: (nullable): a #GMainContext (if %NULL, the global-default
@@ -4684,6 +5414,25 @@ g_main_context_remove_poll_unlocked (GMainContext *context,
   prevrec = NULL;
   pollrec = context->poll_records;
 
+#ifdef HAVE_EPOLL_CREATE
+  /* Find the record through its fd rather than walking the whole list */
+  if (context->epoll_fd >= 0 && fd->fd >= 0)
+    {
+      GEpollRec *rec = g_hash_table_lookup (context->epoll_records, &fd->fd);
+      GSList *l;
+
+      for (l = rec ? rec->pollrecs : NULL; l != NULL; l = l->next)
+        {
+          if (((GPollRec *) l->data)->fd == fd)
+            {
+              pollrec = l->data;
+              prevrec = pollrec->prev;
+              break;
+            }
+        }
+    }
+#endif
+
   while (pollrec)
     {
       nextrec = pollrec->next;
@@ -4697,6 +5446,11 @@ g_main_context_remove_poll_unlocked (GMainContext *context,
 	  if (nextrec != NULL)
 	    nextrec->prev = prevrec;
 
+#ifdef HAVE_EPOLL_CREATE
+	  if (context->epoll_fd >= 0)
+	    g_main_context_epoll_remove (context, pollrec);
+#endif
+
 	  g_slice_free (GPollRec, pollrec);
 
 	  context->n_poll_records--;
@@ -47,6 +47,18 @@ typedef enum /*< flags >*/
  * free the thread to process other jobs. That's useful if you're using
  * `g_main_context_{prepare,query,check,dispatch}` to integrate GMainContext in
  * other event loops.
+ * @G_MAIN_CONTEXT_FLAGS_EPOLL: Keep file descriptors registered with an
+ * epoll(7) instance across iterations instead of building a #GPollFD array
+ * and calling poll() every time. Sources that only watch file descriptors
+ * added with g_source_add_unix_fd(), with no prepare or check function and
+ * no ready time, are then only visited when one of their descriptors is
+ * ready, so their cost per iteration does not grow with their number.
+ * Other sources are still prepared and checked every iteration.
+ * Only has an effect on Linux, and only while the default poll function is
+ * in use; contexts with a custom #GPollFunc fall back to the normal
+ * behaviour. As with epoll itself, sources should be removed before their
+ * file descriptors are closed: a closed descriptor is not reported as
+ * %G_IO_NVAL. Since: 2.80
  *
  * Flags to pass to g_main_context_new_with_flags() which affect the behaviour
  * of a #GMainContext.
@@ -57,7 +69,8 @@ GLIB_AVAILABLE_TYPE_IN_2_72
 typedef enum /*< flags >*/
 {
   G_MAIN_CONTEXT_FLAGS_NONE = 0,
-  G_MAIN_CONTEXT_FLAGS_OWNERLESS_POLLING = 1
+  G_MAIN_CONTEXT_FLAGS_OWNERLESS_POLLING = 1,
+  G_MAIN_CONTEXT_FLAGS_EPOLL GLIB_AVAILABLE_ENUMERATOR_IN_2_80 = 2
 } GMainContextFlags;
 
 
@@ -229,9 +229,7 @@ struct _GMatchInfo
   PCRE2_SIZE n_workspace;       /* number of workspace elements */
   const gchar *string;          /* string passed to the match function */
   gssize string_len;            /* length of string, in bytes */
-  pcre2_match_context *match_context;
-  pcre2_match_data *match_data;
-  pcre2_jit_stack *jit_stack;
+  pcre2_match_data *match_data; /* borrowed from the thread cache, see match_data_acquire() */
 };
 
 typedef enum
@@ -241,6 +239,27 @@ typedef enum
   JIT_STATUS_DISABLED
 } JITStatus;
 
+/* The JIT only supports PCRE2_ANCHORED and PCRE2_ENDANCHORED when they are
+ * given at compile time, so matches using them get their own variant of the
+ * compiled pattern, indexed by a combination of these flags. */
+#define JIT_VARIANT_ANCHORED    (1 << 0)
+#define JIT_VARIANT_ENDANCHORED (1 << 1)
+#define N_JIT_VARIANTS          4
+
+typedef struct
+{
+  pcre2_code *code;             /* compiled form of the pattern for this variant */
+  uint32_t jit_options;         /* options which were enabled for jit compiler (atomic) */
+  JITStatus jit_status;         /* indicates the status of jit compiler for this variant (atomic) */
+  /* The jit_status here does _not_ correspond to whether we used the JIT in the last invocation,
+   * which may be affected by match_options or a JIT_STACK_LIMIT error, but whether it was ever
+   * enabled for the current regex AND current set of jit_options.
+   * JIT_STATUS_DEFAULT means enablement was never tried,
+   * JIT_STATUS_ENABLED means it was tried and successful (even if we're not currently using it),
+   * and JIT_STATUS_DISABLED means it was tried and failed (so we shouldn't try again).
+   */
+} RegexJIT;
+
 struct _GRegex
 {
   gint ref_count;               /* the ref count for the immutable part (atomic) */
@@ -250,17 +269,32 @@ struct _GRegex
   GRegexCompileFlags orig_compile_opts; /* options used at compile time on the pattern, gregex values */
   uint32_t match_opts;          /* pcre2 options used at match time on the regex */
   GRegexMatchFlags orig_match_opts; /* options used as default match options, gregex values */
-  uint32_t jit_options;         /* options which were enabled for jit compiler */
-  JITStatus jit_status;         /* indicates the status of jit compiler for this compiled regex */
-  /* The jit_status here does _not_ correspond to whether we used the JIT in the last invocation,
-   * which may be affected by match_options or a JIT_STACK_LIMIT error, but whether it was ever
-   * enabled for the current regex AND current set of jit_options.
-   * JIT_STATUS_DEFAULT means enablement was never tried,
-   * JIT_STATUS_ENABLED means it was tried and successful (even if we're not currently using it),
-   * and JIT_STATUS_DISABLED means it was tried and failed (so we shouldn't try again).
-   */
+  GMutex jit_lock;              /* serialises JIT compilation */
+  RegexJIT jit[N_JIT_VARIANTS]; /* jit[0].code is pcre_re, the others are compiled on demand */
+  gint jit_stack_size;          /* JIT stack size needed by matches of this regex so far (atomic) */
+  gsize n_jit_matches;          /* number of matches run by the JIT (atomic) */
+  gsize n_interpreted_matches;  /* number of matches run by the interpreter (atomic) */
 };
 
+/* Start with a 512KiB JIT stack, and grow it for regexes which need more */
+#define JIT_STACK_MIN_SIZE     (1 << 15)
+#define JIT_STACK_DEFAULT_SIZE (1 << 19)
+#define JIT_STACK_MAX_SIZE     (1 << 23)
+
+#define MATCH_DATA_POOL_SIZE 4
+
+/* Matching resources kept per thread and shared by all regexes, so that
+ * matches don't each create a match context, JIT stack and match data.
+ * A JIT stack must never be used by two threads at once. */
+typedef struct
+{
+  pcre2_match_context *match_context;
+  pcre2_jit_stack *jit_stack;   /* assigned to match_context */
+  gint jit_stack_size;          /* maximum size of jit_stack */
+  pcre2_match_data *match_data[MATCH_DATA_POOL_SIZE];
+  guint n_match_data;
+} RegexThreadCache;
+
 /* TRUE if ret is an error code, FALSE otherwise. */
 #define IS_PCRE2_ERROR(ret) ((ret) < PCRE2_ERROR_NOMATCH && (ret) != PCRE2_ERROR_PARTIAL)
 
@@ -804,6 +838,97 @@ translate_compile_error (gint *errcode, const gchar **errmsg)
   g_assert (*errcode != -1);
 }
 
+static pcre2_code * regex_compile (const gchar  *pattern,
+                                   uint32_t      compile_options,
+                                   uint32_t      newline_options,
+                                   uint32_t      bsr_options,
+                                   GError      **error);
+
+/* Per-thread matching resources */
+
+static void
+regex_thread_cache_free (gpointer data)
+{
+  RegexThreadCache *cache = data;
+  guint i;
+
+  for (i = 0; i < cache->n_match_data; i++)
+    pcre2_match_data_free (cache->match_data[i]);
+  if (cache->jit_stack != NULL)
+    pcre2_jit_stack_free (cache->jit_stack);
+  pcre2_match_context_free (cache->match_context);
+  g_free (cache);
+}
+
+static GPrivate regex_thread_cache_private = G_PRIVATE_INIT (regex_thread_cache_free);
+
+static RegexThreadCache *
+regex_thread_cache_get (void)
+{
+  RegexThreadCache *cache = g_private_get (&regex_thread_cache_private);
+
+  if (G_UNLIKELY (cache == NULL))
+    {
+      cache = g_new0 (RegexThreadCache, 1);
+      cache->match_context = pcre2_match_context_create (NULL);
+      g_private_set (&regex_thread_cache_private, cache);
+    }
+
+  return cache;
+}
+
+/* Returns the thread's match context, with a JIT stack of at least
+ * @jit_stack_size bytes assigned to it. */
+static pcre2_match_context *
+regex_thread_cache_get_context (RegexThreadCache *cache,
+                                gint              jit_stack_size)
+{
+  if (cache->jit_stack_size < jit_stack_size)
+    {
+      if (cache->jit_stack != NULL)
+        pcre2_jit_stack_free (cache->jit_stack);
+
+      /* If this fails the JIT falls back to 32KiB of the machine stack */
+      cache->jit_stack = pcre2_jit_stack_create (JIT_STACK_MIN_SIZE, jit_stack_size, NULL);
+      cache->jit_stack_size = (cache->jit_stack != NULL) ? jit_stack_size : 0;
+      pcre2_jit_stack_assign (cache->match_context, NULL, cache->jit_stack);
+    }
+
+  return cache->match_context;
+}
+
+/* Takes match data with room for at least @n_pairs offset pairs from the
+ * thread's pool, or creates it. */
+static pcre2_match_data *
+match_data_acquire (RegexThreadCache *cache,
+                    uint32_t          n_pairs)
+{
+  guint i;
+
+  for (i = cache->n_match_data; i > 0; i--)
+    {
+      pcre2_match_data *match_data = cache->match_data[i - 1];
+
+      if (pcre2_get_ovector_count (match_data) >= n_pairs)
+        {
+          cache->match_data[i - 1] = cache->match_data[--cache->n_match_data];
+          return match_data;
+        }
+    }
+
+  return pcre2_match_data_create (n_pairs, NULL);
+}
+
+static void
+match_data_release (RegexThreadCache *cache,
+                    pcre2_match_data *match_data)
+{
+  if (cache->n_match_data < MATCH_DATA_POOL_SIZE)
+    cache->match_data[cache->n_match_data++] = match_data;
+  else
+    pcre2_match_data_free (match_data);
+}
+
 /* GMatchInfo */
 
 static GMatchInfo *
@@ -832,8 +957,6 @@ match_info_new (const GRegex     *regex,
   pcre2_pattern_info (regex->pcre_re, PCRE2_INFO_CAPTURECOUNT,
                       &match_info->n_subpatterns);
 
-  match_info->match_context = pcre2_match_context_create (NULL);
-
   if (is_dfa)
     {
       /* These values should be enough for most cases, if they are not
@@ -848,9 +971,8 @@ match_info_new (const GRegex     *regex,
   match_info->offsets[0] = -1;
   match_info->offsets[1] = -1;
 
-  match_info->match_data = pcre2_match_data_create_from_pattern (
-      match_info->regex->pcre_re,
-      NULL);
+  match_info->match_data = match_data_acquire (regex_thread_cache_get (),
+                                               match_info->n_subpatterns + 1);
 
   return match_info;
 }
@@ -900,49 +1022,96 @@ recalc_match_offsets (GMatchInfo *match_info,
   return TRUE;
 }
 
-static JITStatus
-enable_jit_with_match_options (GMatchInfo  *match_info,
-                               uint32_t  match_options)
+/* Returns the code to run @regex with using the JIT for @match_options,
+ * compiling it first if needed, or %NULL if the interpreter must be used. */
+static pcre2_code *
+regex_get_jit_code (GRegex   *regex,
+                    uint32_t  match_options)
 {
+  RegexJIT *jit;
+  pcre2_code *code = NULL;
+  uint32_t needed_jit_options;
+  guint variant = 0;
   gint retval;
-  uint32_t old_jit_options, new_jit_options;
-
-  if (!(match_info->regex->orig_compile_opts & G_REGEX_OPTIMIZE))
-    return JIT_STATUS_DISABLED;
 
-  if (match_info->regex->jit_status == JIT_STATUS_DISABLED)
-    return JIT_STATUS_DISABLED;
+  if (!(regex->orig_compile_opts & G_REGEX_OPTIMIZE))
+    return NULL;
 
-  if (match_options & G_REGEX_PCRE2_JIT_UNSUPPORTED_OPTIONS)
-    return JIT_STATUS_DISABLED;
+  if (match_options & PCRE2_ANCHORED)
+    variant |= JIT_VARIANT_ANCHORED;
+  if (match_options & PCRE2_ENDANCHORED)
+    variant |= JIT_VARIANT_ENDANCHORED;
+  jit = &regex->jit[variant];
 
-  old_jit_options = match_info->regex->jit_options;
-  new_jit_options = old_jit_options | PCRE2_JIT_COMPLETE;
+  needed_jit_options = PCRE2_JIT_COMPLETE;
   if (match_options & PCRE2_PARTIAL_HARD)
-    new_jit_options |= PCRE2_JIT_PARTIAL_HARD;
+    needed_jit_options |= PCRE2_JIT_PARTIAL_HARD;
   if (match_options & PCRE2_PARTIAL_SOFT)
-    new_jit_options |= PCRE2_JIT_PARTIAL_SOFT;
+    needed_jit_options |= PCRE2_JIT_PARTIAL_SOFT;
 
-  /* no new options enabled */
-  if (new_jit_options == old_jit_options)
+  /* Fast path, without taking the lock */
+  switch (g_atomic_int_get (&jit->jit_status))
     {
-      g_assert (match_info->regex->jit_status != JIT_STATUS_DEFAULT);
-      return match_info->regex->jit_status;
+    case JIT_STATUS_DISABLED:
+      return NULL;
+    case JIT_STATUS_ENABLED:
+      if ((g_atomic_int_get (&jit->jit_options) & needed_jit_options) == needed_jit_options)
+        return jit->code;
+      break;
+    case JIT_STATUS_DEFAULT:
+    default:
+      break;
     }
 
-  retval = pcre2_jit_compile (match_info->regex->pcre_re, new_jit_options);
-  if (retval == 0)
+  g_mutex_lock (&regex->jit_lock);
+
+  if (jit->jit_status == JIT_STATUS_DISABLED)
+    goto out;
+
+  if (jit->jit_status == JIT_STATUS_ENABLED &&
+      (jit->jit_options & needed_jit_options) == needed_jit_options)
     {
-      match_info->regex->jit_status = JIT_STATUS_ENABLED;
+      code = jit->code;
+      goto out;
+    }
+
+  if (jit->code == NULL)
+    {
+      uint32_t compile_options = regex->compile_opts;
+      uint32_t newline_options, bsr_options;
+
+      if (variant & JIT_VARIANT_ANCHORED)
+        compile_options |= PCRE2_ANCHORED;
+      if (variant & JIT_VARIANT_ENDANCHORED)
+        compile_options |= PCRE2_ENDANCHORED;
+
+      newline_options = get_pcre2_newline_match_options (regex->orig_match_opts);
+      if (!newline_options)
+        newline_options = get_pcre2_newline_compile_options (regex->orig_compile_opts);
+
+      bsr_options = get_pcre2_bsr_match_options (regex->orig_match_opts);
+      if (!bsr_options)
+        bsr_options = get_pcre2_bsr_compile_options (regex->orig_compile_opts);
 
-      match_info->regex->jit_options = new_jit_options;
-      /* Set min stack size for JIT to 32KiB and max to 512KiB */
-      match_info->jit_stack = pcre2_jit_stack_create (1 << 15, 1 << 19, NULL);
-      pcre2_jit_stack_assign (match_info->match_context, NULL, match_info->jit_stack);
+      jit->code = regex_compile (regex->pattern, compile_options,
+                                 newline_options, bsr_options, NULL);
+      if (jit->code == NULL)
+        {
+          g_atomic_int_set (&jit->jit_status, JIT_STATUS_DISABLED);
+          goto out;
+        }
+    }
+
+  retval = pcre2_jit_compile (jit->code, jit->jit_options | needed_jit_options);
+  if (retval == 0)
+    {
+      g_atomic_int_set (&jit->jit_options, jit->jit_options | needed_jit_options);
+      g_atomic_int_set (&jit->jit_status, JIT_STATUS_ENABLED);
+      code = jit->code;
     }
   else
     {
-      match_info->regex->jit_status = JIT_STATUS_DISABLED;
+      g_atomic_int_set (&jit->jit_status, JIT_STATUS_DISABLED);
 
       switch (retval)
         {
@@ -965,9 +1134,68 @@ enable_jit_with_match_options (GMatchInfo  *match_info,
         }
     }
 
-  return match_info->regex->jit_status;
+out:
+  g_mutex_unlock (&regex->jit_lock);
+
+  return code;
+}
+
+/* Runs a single match of @regex on @string, using the JIT where possible.
+ * If the JIT runs out of stack, the stack for @regex is grown and the match
+ * retried, up to JIT_STACK_MAX_SIZE, before falling back to the interpreter.
+ * Returns the pcre2 match result. */
+static int
+regex_match_once (GRegex           *regex,
+                  const gchar      *string,
+                  gssize            string_len,
+                  gint              start_position,
+                  uint32_t          match_options,
+                  pcre2_match_data *match_data,
+                  RegexThreadCache *cache,
+                  gboolean         *used_jit)
+{
+  pcre2_code *jit_code;
+  int retval;
+
+  jit_code = regex_get_jit_code (regex, match_options);
+  while (jit_code != NULL)
+    {
+      gint jit_stack_size = g_atomic_int_get (&regex->jit_stack_size);
+
+      retval = pcre2_jit_match (jit_code,
+                                (PCRE2_SPTR8) string,
+                                string_len,
+                                start_position,
+                                match_options & ~G_REGEX_PCRE2_JIT_UNSUPPORTED_OPTIONS,
+                                match_data,
+                                regex_thread_cache_get_context (cache, jit_stack_size));
+      if (retval != PCRE2_ERROR_JIT_STACKLIMIT)
+        {
+          *used_jit = TRUE;
+          return retval;
+        }
+
+      if (jit_stack_size >= JIT_STACK_MAX_SIZE)
+        {
+          g_debug ("PCRE2 JIT stack limit reached, falling back to "
+                   "non-optimized matching.");
+          break;
+        }
+
+      g_atomic_int_compare_and_exchange (&regex->jit_stack_size,
+                                         jit_stack_size, jit_stack_size * 2);
+    }
 
-  g_assert_not_reached ();
+  /* PCRE2_NO_JIT, as pcre2_match() would otherwise use the JIT code of
+   * pcre_re by itself when the options allow it */
+  *used_jit = FALSE;
+  return pcre2_match (regex->pcre_re,
+                      (PCRE2_SPTR8) string,
+                      string_len,
+                      start_position,
+                      match_options | PCRE2_NO_JIT,
+                      match_data,
+                      cache->match_context);
 }
 
 /**
@@ -1041,12 +1269,8 @@ g_match_info_unref (GMatchInfo *match_info)
   if (g_atomic_int_dec_and_test (&match_info->ref_count))
     {
       g_regex_unref (match_info->regex);
-      if (match_info->match_context)
-        pcre2_match_context_free (match_info->match_context);
-      if (match_info->jit_stack)
-        pcre2_jit_stack_free (match_info->jit_stack);
       if (match_info->match_data)
-        pcre2_match_data_free (match_info->match_data);
+        match_data_release (regex_thread_cache_get (), match_info->match_data);
       g_free (match_info->offsets);
       g_free (match_info->workspace);
       g_free (match_info);
@@ -1091,10 +1315,10 @@ gboolean
 g_match_info_next (GMatchInfo  *match_info,
                    GError     **error)
 {
-  JITStatus jit_status;
   gint prev_match_start;
   gint prev_match_end;
   uint32_t opts;
+  gboolean used_jit;
 
   g_return_val_if_fail (match_info != NULL, FALSE);
   g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
@@ -1113,37 +1337,16 @@ g_match_info_next (GMatchInfo  *match_info,
 
   opts = match_info->regex->match_opts | match_info->match_opts;
 
-  jit_status = enable_jit_with_match_options (match_info, opts);
-  if (jit_status == JIT_STATUS_ENABLED)
-    {
-      match_info->matches = pcre2_jit_match (match_info->regex->pcre_re,
-                                             (PCRE2_SPTR8) match_info->string,
-                                             match_info->string_len,
-                                             match_info->pos,
-                                             opts,
-                                             match_info->match_data,
-                                             match_info->match_context);
-      /* if the JIT stack limit was reached, fall back to non-JIT matching in
-       * the next conditional statement */
-      if (match_info->matches == PCRE2_ERROR_JIT_STACKLIMIT)
-        {
-          g_debug ("PCRE2 JIT stack limit reached, falling back to "
-                   "non-optimized matching.");
-          opts |= PCRE2_NO_JIT;
-          jit_status = JIT_STATUS_DISABLED;
-        }
-    }
-
-  if (jit_status != JIT_STATUS_ENABLED)
-    {
-      match_info->matches = pcre2_match (match_info->regex->pcre_re,
-                                         (PCRE2_SPTR8) match_info->string,
-                                         match_info->string_len,
-                                         match_info->pos,
-                                         opts,
-                                         match_info->match_data,
-                                         match_info->match_context);
-    }
+  match_info->matches = regex_match_once (match_info->regex,
+                                          match_info->string,
+                                          match_info->string_len,
+                                          match_info->pos,
+                                          opts,
+                                          match_info->match_data,
+                                          regex_thread_cache_get (),
+                                          &used_jit);
+  g_atomic_pointer_add (used_jit ? &match_info->regex->n_jit_matches
+                                 : &match_info->regex->n_interpreted_matches, 1);
 
   if (IS_PCRE2_ERROR (match_info->matches))
     {
@@ -1691,19 +1894,19 @@ g_regex_unref (GRegex *regex)
 
   if (g_atomic_int_dec_and_test (&regex->ref_count))
     {
+      guint i;
+
       g_free (regex->pattern);
       if (regex->pcre_re != NULL)
         pcre2_code_free (regex->pcre_re);
+      for (i = 1; i < N_JIT_VARIANTS; i++)
+        if (regex->jit[i].code != NULL)
+          pcre2_code_free (regex->jit[i].code);
+      g_mutex_clear (&regex->jit_lock);
       g_free (regex);
     }
 }
 
-static pcre2_code * regex_compile (const gchar  *pattern,
-                                   uint32_t      compile_options,
-                                   uint32_t      newline_options,
-                                   uint32_t      bsr_options,
-                                   GError      **error);
-
 static uint32_t get_pcre2_inline_compile_options (pcre2_code *re,
                                                   uint32_t    compile_options);
 
@@ -1796,6 +1999,9 @@ G_GNUC_END_IGNORE_DEPRECATIONS
   regex->orig_compile_opts = compile_options;
   regex->match_opts = pcre_match_options;
   regex->orig_match_opts = match_options;
+  g_mutex_init (&regex->jit_lock);
+  regex->jit[0].code = re;
+  regex->jit_stack_size = JIT_STACK_DEFAULT_SIZE;
 
   return regex;
 }
@@ -2445,7 +2651,7 @@ g_regex_match_all_full (const GRegex      *regex,
                                        info->pos,
                                        (regex->match_opts | info->match_opts),
                                        info->match_data,
-                                       info->match_context,
+                                       regex_thread_cache_get ()->match_context,
                                        info->workspace, info->n_workspace);
       if (info->matches == PCRE2_ERROR_DFA_WSSIZE)
         {
@@ -2485,6 +2691,8 @@ g_regex_match_all_full (const GRegex      *regex,
 
   pcre2_code_free (pcre_re);
 
+  g_atomic_pointer_add (&((GRegex *) regex)->n_interpreted_matches, 1);
+
   /* don’t assert that (info->matches <= info->n_subpatterns + 1) as that only
    * holds true for a single match, rather than matching all */
 
@@ -2500,6 +2708,145 @@ g_regex_match_all_full (const GRegex      *regex,
   return retval;
 }
 
+/**
+ * g_regex_match_many:
+ * @regex: a #GRegex structure from g_regex_new()
+ * @strings: (array length=n_strings): the strings to scan for matches
+ * @lengths: (array length=n_strings) (nullable): the length of each string
+ *     in @strings, in bytes, or -1 if it is nul-terminated; or %NULL if
+ *     all of @strings are nul-terminated
+ * @n_strings: the number of strings in @strings
+ * @match_options: match options
+ * @matches: (array length=n_strings) (out caller-allocates) (optional):
+ *     return location for whether each string matched
+ * @n_matches: (out) (optional): return location for the number of strings
+ *     which matched
+ * @error: location to store the error occurring, or %NULL to ignore errors
+ *
+ * Scans each of @strings for a match of @regex, as g_regex_match_full()
+ * would with a @start_position of 0, but without creating a #GMatchInfo
+ * for each of them. This is meant for filtering large numbers of strings,
+ * such as the lines of a log, when only whether they match is needed.
+ *
+ * Matching stops at the first error, in which case the contents of
+ * @matches after the string which failed are undefined.
+ *
+ * Returns: %TRUE if all the strings were scanned, %FALSE if an error
+ *     occurred
+ *
+ * Since: 2.80
+ */
+gboolean
+g_regex_match_many (const GRegex        *regex,
+                    const gchar * const *strings,
+                    const gssize        *lengths,
+                    gsize                n_strings,
+                    GRegexMatchFlags     match_options,
+                    gboolean            *matches,
+                    gsize               *n_matches,
+                    GError             **error)
+{
+  RegexThreadCache *cache;
+  pcre2_match_data *match_data;
+  uint32_t opts;
+  gsize i, n_matched = 0, n_jit = 0, n_interpreted = 0;
+  gboolean retval = TRUE;
+
+  g_return_val_if_fail (regex != NULL, FALSE);
+  g_return_val_if_fail (strings != NULL || n_strings == 0, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+  g_return_val_if_fail ((match_options & ~G_REGEX_MATCH_MASK) == 0, FALSE);
+
+  opts = regex->match_opts |
+         get_pcre2_match_options (match_options, regex->orig_compile_opts);
+
+  /* Only whether there is a match is needed, so room for the offsets of
+   * the whole match is enough; pcre2 returns 0 rather than failing when
+   * the captures don't fit. */
+  cache = regex_thread_cache_get ();
+  match_data = match_data_acquire (cache, 1);
+
+  for (i = 0; i < n_strings; i++)
+    {
+      gssize string_len;
+      gboolean used_jit;
+      int rc;
+
+      if (lengths != NULL && lengths[i] >= 0)
+        string_len = lengths[i];
+      else
+        string_len = strlen (strings[i]);
+
+      rc = regex_match_once ((GRegex *) regex, strings[i], string_len, 0,
+                             opts, match_data, cache, &used_jit);
+      if (used_jit)
+        n_jit++;
+      else
+        n_interpreted++;
+
+      if (IS_PCRE2_ERROR (rc))
+        {
+          gchar *error_msg = get_match_error_message (rc);
+
+          g_set_error (error, G_REGEX_ERROR, G_REGEX_ERROR_MATCH,
+                       _("Error while matching regular expression %s: %s"),
+                       regex->pattern, error_msg);
+          g_clear_pointer (&error_msg, g_free);
+          retval = FALSE;
+          break;
+        }
+
+      if (matches != NULL)
+        matches[i] = (rc >= 0);
+      if (rc >= 0)
+        n_matched++;
+    }
+
+  match_data_release (cache, match_data);
+
+  /* Counted once per batch to keep threads sharing @regex from
+   * contending on the counters */
+  g_atomic_pointer_add (&((GRegex *) regex)->n_jit_matches, n_jit);
+  g_atomic_pointer_add (&((GRegex *) regex)->n_interpreted_matches, n_interpreted);
+
+  if (n_matches != NULL)
+    *n_matches = n_matched;
+
+  return retval;
+}
+
+/**
+ * g_regex_get_match_stats:
+ * @regex: a #GRegex structure
+ * @n_jit_matches: (out) (optional): return location for the number of
+ *     matches run by the JIT compiled code
+ * @n_interpreted_matches: (out) (optional): return location for the number
+ *     of matches run by the interpreter
+ *
+ * Retrieves how many of the matches done with @regex so far used the JIT
+ * compiled form of the pattern, and how many fell back to the slower
+ * interpreter. Each call to g_regex_match_full() or g_match_info_next(),
+ * each string passed to g_regex_match_many(), and each call to
+ * g_regex_match_all_full() (which never uses the JIT) count as one match.
+ *
+ * The JIT is only used if @regex was created with %G_REGEX_OPTIMIZE and
+ * the PCRE library supports it on this platform.
+ *
+ * Since: 2.80
+ */
+void
+g_regex_get_match_stats (const GRegex *regex,
+                         guint64      *n_jit_matches,
+                         guint64      *n_interpreted_matches)
+{
+  g_return_if_fail (regex != NULL);
+
+  if (n_jit_matches != NULL)
+    *n_jit_matches = (gsize) g_atomic_pointer_get (&((GRegex *) regex)->n_jit_matches);
+  if (n_interpreted_matches != NULL)
+    *n_interpreted_matches = (gsize) g_atomic_pointer_get (&((GRegex *) regex)->n_interpreted_matches);
+}
+
 /**
  * g_regex_get_string_number:
  * @regex: #GRegex structure
@@ -479,6 +479,10 @@ GLIB_AVAILABLE_IN_ALL
 GRegexCompileFlags g_regex_get_compile_flags    (const GRegex        *regex);
 GLIB_AVAILABLE_IN_ALL
 GRegexMatchFlags   g_regex_get_match_flags      (const GRegex        *regex);
+GLIB_AVAILABLE_IN_2_80
+void               g_regex_get_match_stats      (const GRegex        *regex,
+                                                 guint64             *n_jit_matches,
+                                                 guint64             *n_interpreted_matches);
 
 /* Matching. */
 GLIB_AVAILABLE_IN_ALL
@@ -512,6 +516,15 @@ gboolean	  g_regex_match_all_full	(const GRegex        *regex,
 						 GRegexMatchFlags     match_options,
 						 GMatchInfo         **match_info,
 						 GError             **error);
+GLIB_AVAILABLE_IN_2_80
+gboolean	  g_regex_match_many		(const GRegex        *regex,
+						 const gchar * const *strings,
+						 const gssize        *lengths,
+						 gsize                n_strings,
+						 GRegexMatchFlags     match_options,
+						 gboolean            *matches,
+						 gsize               *n_matches,
+						 GError             **error);
 
 /* String splitting. */
 GLIB_AVAILABLE_IN_ALL
@@ -55,6 +55,7 @@
 
 #include "gprintf.h"
 #include "gprintfint.h"
+#include "gstrkernelsprivate.h"
 #include "glibintl.h"
 
 /**
@@ -1549,16 +1550,17 @@ gchar*
 g_ascii_strdown (const gchar *str,
                  gssize       len)
 {
-  gchar *result, *s;
+  gchar *result;
 
   g_return_val_if_fail (str != NULL, NULL);
 
   if (len < 0)
     len = (gssize) strlen (str);
 
+  /* g_strndup() pads with nul bytes, so converting all @len bytes
+   * leaves anything after an embedded nul untouched */
   result = g_strndup (str, (gsize) len);
-  for (s = result; *s; s++)
-    *s = g_ascii_tolower (*s);
+  _g_str_ascii_down (result, result, (gsize) len);
 
   return result;
 }
@@ -1579,16 +1581,17 @@ gchar*
 g_ascii_strup (const gchar *str,
                gssize       len)
 {
-  gchar *result, *s;
+  gchar *result;
 
   g_return_val_if_fail (str != NULL, NULL);
 
   if (len < 0)
     len = (gssize) strlen (str);
 
+  /* g_strndup() pads with nul bytes, so converting all @len bytes
+   * leaves anything after an embedded nul untouched */
   result = g_strndup (str, (gsize) len);
-  for (s = result; *s; s++)
-    *s = g_ascii_toupper (*s);
+  _g_str_ascii_up (result, result, (gsize) len);
 
   return result;
 }
@@ -1607,13 +1610,9 @@ g_ascii_strup (const gchar *str,
 gboolean
 g_str_is_ascii (const gchar *str)
 {
-  gsize i;
-
-  for (i = 0; str[i]; i++)
-    if (str[i] & 0x80)
-      return FALSE;
+  gsize len = strlen (str);
 
-  return TRUE;
+  return _g_str_find_non_ascii (str, len) == len;
 }
 
 /**
@@ -2348,6 +2347,17 @@ g_strchomp (gchar *string)
   return string;
 }
 
+static inline const gchar *
+strsplit_find (const gchar *haystack,
+               const gchar *delimiter,
+               gsize        delimiter_len)
+{
+  if (delimiter_len == 1)
+    return strchr (haystack, delimiter[0]);
+
+  return strstr (haystack, delimiter);
+}
+
 /**
  * g_strsplit:
  * @string: a string to split
@@ -2380,46 +2390,43 @@ g_strsplit (const gchar *string,
             const gchar *delimiter,
             gint         max_tokens)
 {
-  char *s;
-  const gchar *remainder;
-  GPtrArray *string_list;
+  gchar **str_array;
+  const gchar *remainder, *s;
+  gsize delimiter_len, n_tokens, i;
 
   g_return_val_if_fail (string != NULL, NULL);
   g_return_val_if_fail (delimiter != NULL, NULL);
   g_return_val_if_fail (delimiter[0] != '\0', NULL);
 
+  if (*string == '\0')
+    return g_new0 (gchar *, 1);
+
   if (max_tokens < 1)
-    {
-      max_tokens = G_MAXINT;
-      string_list = g_ptr_array_new ();
-    }
-  else
-    {
-      string_list = g_ptr_array_new_full (max_tokens + 1, NULL);
-    }
+    max_tokens = G_MAXINT;
 
-  remainder = string;
-  s = strstr (remainder, delimiter);
-  if (s)
-    {
-      gsize delimiter_len = strlen (delimiter);
+  delimiter_len = strlen (delimiter);
 
-      while (--max_tokens && s)
-        {
-          gsize len;
+  /* Count the pieces first, so that the vector is allocated exactly
+   * once at its final size rather than grown as tokens are found */
+  n_tokens = 1;
+  for (s = strsplit_find (string, delimiter, delimiter_len);
+       s != NULL && n_tokens < (gsize) max_tokens;
+       s = strsplit_find (s + delimiter_len, delimiter, delimiter_len))
+    n_tokens++;
 
-          len = s - remainder;
-          g_ptr_array_add (string_list, g_strndup (remainder, len));
-          remainder = s + delimiter_len;
-          s = strstr (remainder, delimiter);
-        }
-    }
-  if (*string)
-    g_ptr_array_add (string_list, g_strdup (remainder));
+  str_array = g_new (gchar *, n_tokens + 1);
 
-  g_ptr_array_add (string_list, NULL);
+  remainder = string;
+  for (i = 0; i + 1 < n_tokens; i++)
+    {
+      s = strsplit_find (remainder, delimiter, delimiter_len);
+      str_array[i] = g_strndup (remainder, (gsize) (s - remainder));
+      remainder = s + delimiter_len;
+    }
+  str_array[i++] = g_strdup (remainder);
+  str_array[i] = NULL;
 
-  return (char **) g_ptr_array_free (string_list, FALSE);
+  return str_array;
 }
 
 /**
@@ -39,6 +39,7 @@
 #include "gstring.h"
 #include "guriprivate.h"
 #include "gprintf.h"
+#include "gstrkernelsprivate.h"
 #include "gutilsprivate.h"
 
 
@@ -1023,9 +1024,11 @@ g_string_replace (GString     *string,
                   const gchar *replace,
                   guint        limit)
 {
-  gsize f_len, r_len, pos;
-  gchar *cur, *next;
-  guint n = 0;
+  gsize f_len, r_len, search_len, grow, new_len, allocated_len;
+  const gchar *cur, *next;
+  gchar *new_str, *dest;
+  gboolean aliased;
+  guint n, i;
 
   g_return_val_if_fail (string != NULL, 0);
   g_return_val_if_fail (find != NULL, 0);
@@ -1033,28 +1036,98 @@ g_string_replace (GString     *string,
 
   f_len = strlen (find);
   r_len = strlen (replace);
-  cur = string->str;
 
-  while ((next = strstr (cur, find)) != NULL)
+  /* Like strstr(), only search up to the first nul */
+  search_len = strlen (string->str);
+
+  aliased = (find >= string->str && find < string->str + string->allocated_len) ||
+            (replace >= string->str && replace < string->str + string->allocated_len);
+
+  /* Replacements which don't change the length are done in place */
+  if (f_len == r_len && f_len > 0 && !aliased)
     {
-      pos = next - string->str;
-      g_string_erase (string, pos, f_len);
-      g_string_insert (string, pos, replace);
-      cur = string->str + pos + r_len;
-      n++;
-      /* Only match the empty string once at any given position, to
-       * avoid infinite loops */
-      if (f_len == 0)
+      n = 0;
+      cur = string->str;
+
+      while ((next = strstr (cur, find)) != NULL)
+        {
+          memcpy ((gchar *) next, replace, r_len);
+          cur = next + f_len;
+          if (++n == limit)
+            break;
+        }
+
+      return n;
+    }
+
+  /* Otherwise count the matches first, then build the result in a single
+   * new buffer rather than moving the tail of the string for each one.
+   * The empty string matches once at each position, including the end. */
+  if (f_len == 0)
+    {
+      n = (search_len < G_MAXUINT) ? (guint) search_len + 1 : G_MAXUINT;
+      if (limit > 0 && n > limit)
+        n = limit;
+    }
+  else
+    {
+      n = 0;
+      cur = string->str;
+
+      while ((next = strstr (cur, find)) != NULL)
         {
-          if (cur[0] == '\0')
+          cur = next + f_len;
+          if (++n == limit)
             break;
-          else
-            cur++;
         }
-      if (n == limit)
-        break;
+
+      if (n == 0)
+        return 0;
     }
 
+  if (r_len > f_len)
+    {
+      if (!g_size_checked_mul (&grow, n, r_len - f_len) ||
+          (G_MAXSIZE - string->len - 1) < grow)
+        g_error ("replacing %u occurrences in string would overflow", n);
+
+      new_len = string->len + grow;
+    }
+  else
+    new_len = string->len - (gsize) n * (f_len - r_len);
+
+  allocated_len = g_nearest_pow (new_len + 1);
+  if (allocated_len == 0)
+    allocated_len = new_len + 1;
+
+  new_str = g_malloc (allocated_len);
+  dest = new_str;
+  cur = string->str;
+
+  for (i = 0; i < n; i++)
+    {
+      next = (f_len > 0) ? strstr (cur, find) : cur;
+
+      memcpy (dest, cur, next - cur);
+      dest += next - cur;
+      memcpy (dest, replace, r_len);
+      dest += r_len;
+      cur = next + f_len;
+
+      /* Only match the empty string once at any given position, to
+       * avoid infinite loops */
+      if (f_len == 0 && cur < string->str + search_len)
+        *dest++ = *cur++;
+    }
+
+  memcpy (dest, cur, string->str + string->len - cur);
+  new_str[new_len] = '\0';
+
+  g_free (string->str);
+  string->str = new_str;
+  string->len = new_len;
+  string->allocated_len = allocated_len;
+
   return n;
 }
 
@@ -1071,20 +1144,9 @@ g_string_replace (GString     *string,
 GString *
 g_string_ascii_down (GString *string)
 {
-  gchar *s;
-  gint n;
-
   g_return_val_if_fail (string != NULL, NULL);
 
-  n = string->len;
-  s = string->str;
-
-  while (n)
-    {
-      *s = g_ascii_tolower (*s);
-      s++;
-      n--;
-    }
+  _g_str_ascii_down (string->str, string->str, string->len);
 
   return string;
 }
@@ -1102,20 +1164,9 @@ g_string_ascii_down (GString *string)
 GString *
 g_string_ascii_up (GString *string)
 {
-  gchar *s;
-  gint n;
-
   g_return_val_if_fail (string != NULL, NULL);
 
-  n = string->len;
-  s = string->str;
-
-  while (n)
-    {
-      *s = g_ascii_toupper (*s);
-      s++;
-      n--;
-    }
+  _g_str_ascii_up (string->str, string->str, string->len);
 
   return string;
 }
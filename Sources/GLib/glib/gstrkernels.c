@@ -0,0 +1,406 @@
+/* gstrkernels.c - vectorized string primitives
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The byte-classification loops behind g_str_is_ascii(), the
+ * g_ascii_str{down,up}() family and their GString equivalents.
+ *
+ * Every kernel works on an explicit length, never reading past it, and
+ * exists in a portable version working on a machine word at a time and
+ * in vector versions: SSE2 and AVX2 on x86 (picked at runtime from what
+ * the CPU supports) and NEON on AArch64.  Searching for bytes and
+ * substrings is left to memchr(), strchr() and strstr(), which the C
+ * library already vectorizes.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gstrkernelsprivate.h"
+#include "gstrfuncs.h"
+#include "gthread.h"
+
+#if (defined (__x86_64__) || defined (__i386__)) && \
+    (G_GNUC_CHECK_VERSION (5, 0) || defined (__clang__))
+#define HAVE_STR_KERNELS_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined (__aarch64__) && defined (__ARM_NEON)
+#define HAVE_STR_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef gsize (* FindNonAsciiFunc) (const gchar *str,
+                                    gsize        len);
+typedef void  (* CaseFunc)         (gchar       *dest,
+                                    const gchar *src,
+                                    gsize        len);
+
+typedef struct
+{
+  FindNonAsciiFunc find_non_ascii;
+  CaseFunc ascii_down;
+  CaseFunc ascii_up;
+} StrKernels;
+
+/* Portable versions {{{1 */
+
+#define ONES  G_GUINT64_CONSTANT (0x0101010101010101)
+#define HIGHS G_GUINT64_CONSTANT (0x8080808080808080)
+
+static gsize
+find_non_ascii_scalar (const gchar *str,
+                       gsize        len)
+{
+  gsize i = 0;
+
+  for (; i + 8 <= len; i += 8)
+    {
+      guint64 word;
+
+      memcpy (&word, str + i, sizeof word);
+      if (word & HIGHS)
+        break;
+    }
+
+  for (; i < len; i++)
+    if (str[i] & 0x80)
+      return i;
+
+  return len;
+}
+
+/* Sets the high bit of each byte of @word that is in [@lo, @hi], for
+ * words with no high bits set
+ */
+static inline guint64
+word_in_range (guint64 word,
+               guchar  lo,
+               guchar  hi)
+{
+  guint64 above_lo = word + ONES * (0x80 - lo);
+  guint64 above_hi = word + ONES * (0x7f - hi);
+
+  return (above_lo & ~above_hi) & HIGHS;
+}
+
+static void
+ascii_down_scalar (gchar       *dest,
+                   const gchar *src,
+                   gsize        len)
+{
+  gsize i = 0;
+
+  for (; i + 8 <= len; i += 8)
+    {
+      guint64 word;
+
+      memcpy (&word, src + i, sizeof word);
+      if (!(word & HIGHS))
+        word |= word_in_range (word, 'A', 'Z') >> 2;
+      else
+        {
+          gsize j;
+
+          for (j = 0; j < 8; j++)
+            dest[i + j] = g_ascii_tolower (src[i + j]);
+          continue;
+        }
+      memcpy (dest + i, &word, sizeof word);
+    }
+
+  for (; i < len; i++)
+    dest[i] = g_ascii_tolower (src[i]);
+}
+
+static void
+ascii_up_scalar (gchar       *dest,
+                 const gchar *src,
+                 gsize        len)
+{
+  gsize i = 0;
+
+  for (; i + 8 <= len; i += 8)
+    {
+      guint64 word;
+
+      memcpy (&word, src + i, sizeof word);
+      if (!(word & HIGHS))
+        word &= ~(word_in_range (word, 'a', 'z') >> 2);
+      else
+        {
+          gsize j;
+
+          for (j = 0; j < 8; j++)
+            dest[i + j] = g_ascii_toupper (src[i + j]);
+          continue;
+        }
+      memcpy (dest + i, &word, sizeof word);
+    }
+
+  for (; i < len; i++)
+    dest[i] = g_ascii_toupper (src[i]);
+}
+
+static const StrKernels str_kernels_scalar = {
+  find_non_ascii_scalar,
+  ascii_down_scalar,
+  ascii_up_scalar,
+};
+
+/* x86 {{{1 */
+
+#ifdef HAVE_STR_KERNELS_X86
+
+/* Bytes are compared as signed, so those with the high bit set are
+ * never in an ASCII range
+ */
+#define DEFINE_X86_KERNELS(isa, isa_name, vec, width, load, store, set1, movemask, \
+                           cmpgt, vand, vor, vandnot)                              \
+__attribute__ ((target (isa_name)))                                                \
+static gsize                                                                       \
+find_non_ascii_##isa (const gchar *str,                                            \
+                      gsize        len)                                            \
+{                                                                                  \
+  gsize i = 0;                                                                     \
+                                                                                   \
+  for (; i + width <= len; i += width)                                             \
+    {                                                                              \
+      guint mask = (guint) movemask (load ((const vec *) (str + i)));              \
+                                                                                   \
+      if (mask)                                                                    \
+        return i + (gsize) __builtin_ctz (mask);                                   \
+    }                                                                              \
+                                                                                   \
+  return i + find_non_ascii_scalar (str + i, len - i);                             \
+}                                                                                  \
+                                                                                   \
+__attribute__ ((target (isa_name)))                                                \
+static void                                                                        \
+ascii_down_##isa (gchar       *dest,                                               \
+                  const gchar *src,                                                \
+                  gsize        len)                                                \
+{                                                                                  \
+  gsize i = 0;                                                                     \
+                                                                                   \
+  for (; i + width <= len; i += width)                                             \
+    {                                                                              \
+      vec v = load ((const vec *) (src + i));                                      \
+      vec upper = vand (cmpgt (v, set1 ('A' - 1)), cmpgt (set1 ('Z' + 1), v));     \
+                                                                                   \
+      store ((vec *) (dest + i), vor (v, vand (upper, set1 (0x20))));              \
+    }                                                                              \
+                                                                                   \
+  ascii_down_scalar (dest + i, src + i, len - i);                                  \
+}                                                                                  \
+                                                                                   \
+__attribute__ ((target (isa_name)))                                                \
+static void                                                                        \
+ascii_up_##isa (gchar       *dest,                                                 \
+                const gchar *src,                                                  \
+                gsize        len)                                                  \
+{                                                                                  \
+  gsize i = 0;                                                                     \
+                                                                                   \
+  for (; i + width <= len; i += width)                                             \
+    {                                                                              \
+      vec v = load ((const vec *) (src + i));                                      \
+      vec lower = vand (cmpgt (v, set1 ('a' - 1)), cmpgt (set1 ('z' + 1), v));     \
+                                                                                   \
+      store ((vec *) (dest + i), vandnot (vand (lower, set1 (0x20)), v));          \
+    }                                                                              \
+                                                                                   \
+  ascii_up_scalar (dest + i, src + i, len - i);                                    \
+}                                                                                  \
+                                                                                   \
+static const StrKernels str_kernels_##isa = {                                      \
+  find_non_ascii_##isa,                                                            \
+  ascii_down_##isa,                                                                \
+  ascii_up_##isa,                                                                  \
+};
+
+DEFINE_X86_KERNELS (sse2, "sse2", __m128i, 16,
+                    _mm_loadu_si128, _mm_storeu_si128, _mm_set1_epi8, _mm_movemask_epi8,
+                    _mm_cmpgt_epi8, _mm_and_si128, _mm_or_si128, _mm_andnot_si128)
+DEFINE_X86_KERNELS (avx2, "avx2", __m256i, 32,
+                    _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi8, _mm256_movemask_epi8,
+                    _mm256_cmpgt_epi8, _mm256_and_si256, _mm256_or_si256, _mm256_andnot_si256)
+
+static const StrKernels *
+str_kernels_x86 (void)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx))
+    return &str_kernels_scalar;
+
+  /* AVX2 also needs the OS to save the YMM registers */
+  if ((ecx & bit_OSXSAVE) != 0)
+    {
+      unsigned int xcr0_lo, xcr0_hi;
+      unsigned int eax7, ebx7, ecx7, edx7;
+
+      __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+
+      if ((xcr0_lo & 0x6) == 0x6 &&
+          __get_cpuid_count (7, 0, &eax7, &ebx7, &ecx7, &edx7) &&
+          (ebx7 & bit_AVX2) != 0)
+        return &str_kernels_avx2;
+    }
+
+  if ((edx & bit_SSE2) != 0)
+    return &str_kernels_sse2;
+
+  return &str_kernels_scalar;
+}
+
+#endif /* HAVE_STR_KERNELS_X86 */
+
+/* NEON {{{1 */
+
+#ifdef HAVE_STR_KERNELS_NEON
+
+static gsize
+find_non_ascii_neon (const gchar *str,
+                     gsize        len)
+{
+  gsize i = 0;
+
+  for (; i + 16 <= len; i += 16)
+    if (vmaxvq_u8 (vld1q_u8 ((const guint8 *) str + i)) & 0x80)
+      break;
+
+  return i + find_non_ascii_scalar (str + i, len - i);
+}
+
+static void
+ascii_down_neon (gchar       *dest,
+                 const gchar *src,
+                 gsize        len)
+{
+  gsize i = 0;
+
+  for (; i + 16 <= len; i += 16)
+    {
+      uint8x16_t v = vld1q_u8 ((const guint8 *) src + i);
+      uint8x16_t upper = vcleq_u8 (vsubq_u8 (v, vdupq_n_u8 ('A')), vdupq_n_u8 ('Z' - 'A'));
+
+      vst1q_u8 ((guint8 *) dest + i, vorrq_u8 (v, vandq_u8 (upper, vdupq_n_u8 (0x20))));
+    }
+
+  ascii_down_scalar (dest + i, src + i, len - i);
+}
+
+static void
+ascii_up_neon (gchar       *dest,
+               const gchar *src,
+               gsize        len)
+{
+  gsize i = 0;
+
+  for (; i + 16 <= len; i += 16)
+    {
+      uint8x16_t v = vld1q_u8 ((const guint8 *) src + i);
+      uint8x16_t lower = vcleq_u8 (vsubq_u8 (v, vdupq_n_u8 ('a')), vdupq_n_u8 ('z' - 'a'));
+
+      vst1q_u8 ((guint8 *) dest + i, vbicq_u8 (v, vandq_u8 (lower, vdupq_n_u8 (0x20))));
+    }
+
+  ascii_up_scalar (dest + i, src + i, len - i);
+}
+
+static const StrKernels str_kernels_neon = {
+  find_non_ascii_neon,
+  ascii_down_neon,
+  ascii_up_neon,
+};
+
+#endif /* HAVE_STR_KERNELS_NEON */
+
+/* Dispatch {{{1 */
+
+static const StrKernels *
+str_kernels_get (void)
+{
+  static const StrKernels *kernels;
+
+  if (g_once_init_enter_pointer (&kernels))
+    {
+      const StrKernels *selected;
+
+#if defined (HAVE_STR_KERNELS_X86)
+      selected = str_kernels_x86 ();
+#elif defined (HAVE_STR_KERNELS_NEON)
+      selected = &str_kernels_neon;
+#else
+      selected = &str_kernels_scalar;
+#endif
+
+      g_once_init_leave_pointer (&kernels, selected);
+    }
+
+  return kernels;
+}
+
+/* Returns the index of the first byte of @str with the high bit set, or
+ * @len if there is none
+ */
+gsize
+_g_str_find_non_ascii (const gchar *str,
+                       gsize        len)
+{
+  /* Not worth a call through the table */
+  if (len < 16)
+    return find_non_ascii_scalar (str, len);
+
+  return str_kernels_get ()->find_non_ascii (str, len);
+}
+
+/* Stores g_ascii_tolower() of each byte of @src in @dest, which may be
+ * the same as @src
+ */
+void
+_g_str_ascii_down (gchar       *dest,
+                   const gchar *src,
+                   gsize        len)
+{
+  if (len < 16)
+    ascii_down_scalar (dest, src, len);
+  else
+    str_kernels_get ()->ascii_down (dest, src, len);
+}
+
+/* Stores g_ascii_toupper() of each byte of @src in @dest, which may be
+ * the same as @src
+ */
+void
+_g_str_ascii_up (gchar       *dest,
+                 const gchar *src,
+                 gsize        len)
+{
+  if (len < 16)
+    ascii_up_scalar (dest, src, len);
+  else
+    str_kernels_get ()->ascii_up (dest, src, len);
+}
+
+/* Epilogue {{{1 */
+/* vim: set foldmethod=marker: */
@@ -0,0 +1,39 @@
+/* gstrkernelsprivate.h - vectorized string primitives
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_STR_KERNELS_PRIVATE_H__
+#define __G_STR_KERNELS_PRIVATE_H__
+
+#include "gtypes.h"
+
+G_BEGIN_DECLS
+
+gsize _g_str_find_non_ascii (const gchar *str,
+                             gsize        len);
+void  _g_str_ascii_down     (gchar       *dest,
+                             const gchar *src,
+                             gsize        len);
+void  _g_str_ascii_up       (gchar       *dest,
+                             const gchar *src,
+                             gsize        len);
+
+G_END_DECLS
+
+#endif /* __G_STR_KERNELS_PRIVATE_H__ */
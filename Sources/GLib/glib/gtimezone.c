@@ -189,11 +189,21 @@ struct _GTimeZone
   gchar   *name;
   GArray  *t_info;         /* Array of TransitionInfo */
   GArray  *transitions;    /* Array of Transition */
+  guint    std_info;       /* TransitionInfo used before the first transition */
+  gint     last_interval;  /* hint for find_utc_interval(); accessed atomically */
   gint     ref_count;
 };
 
+/* Zones looked up by identifier stay in time_zones while anyone holds a
+ * ref.  The TZ_CACHE_SIZE most recently looked up ones also hold a ref
+ * from recent_zones, so that code repeatedly creating and dropping the
+ * same few zones does not re-read and re-parse the tzfile each time.
+ */
+#define TZ_CACHE_SIZE 16
+
 G_LOCK_DEFINE_STATIC (time_zones);
 static GHashTable/*<string?, GTimeZone>*/ *time_zones;
+static GQueue/*<GTimeZone>*/ recent_zones = G_QUEUE_INIT;
 G_LOCK_DEFINE_STATIC (tz_default);
 static GTimeZone *tz_default = NULL;
 G_LOCK_DEFINE_STATIC (tz_local);
@@ -1754,6 +1764,50 @@ g_time_zone_new (const gchar *identifier)
   return g_steal_pointer (&tz);
 }
 
+/* Moves @tz to the front of recent_zones, taking a ref on it if it was
+ * not already there.  Returns the zone that dropped off the end, whose
+ * ref must be released after unlocking time_zones.
+ */
+static GTimeZone *
+time_zone_cache_touch (GTimeZone *tz)
+{
+  GList *link;
+
+  if (recent_zones.head && recent_zones.head->data == tz)
+    return NULL;
+
+  link = g_queue_find (&recent_zones, tz);
+  if (link)
+    {
+      g_queue_unlink (&recent_zones, link);
+      g_queue_push_head_link (&recent_zones, link);
+      return NULL;
+    }
+
+  g_atomic_int_inc (&tz->ref_count);
+  g_queue_push_head (&recent_zones, tz);
+
+  if (recent_zones.length > TZ_CACHE_SIZE)
+    return g_queue_pop_tail (&recent_zones);
+
+  return NULL;
+}
+
+/* The tzfile documentation says to use the first standard-time
+ * TransitionInfo for times before the first transition.
+ */
+static guint
+find_std_info (GTimeZone *tz)
+{
+  guint index;
+
+  for (index = 0; index < tz->t_info->len; index++)
+    if (!g_array_index (tz->t_info, TransitionInfo, index).is_dst)
+      return index;
+
+  return 0;
+}
+
 /**
  * g_time_zone_new_identifier:
  * @identifier: (nullable): a timezone identifier
@@ -1845,8 +1899,15 @@ g_time_zone_new_identifier (const gchar *identifier)
       tz = g_hash_table_lookup (time_zones, identifier);
       if (tz)
         {
+          GTimeZone *evicted;
+
           g_atomic_int_inc (&tz->ref_count);
+          evicted = time_zone_cache_touch (tz);
           G_UNLOCK (time_zones);
+
+          if (evicted)
+            g_time_zone_unref (evicted);
+
           return tz;
         }
       else
@@ -1959,22 +2020,29 @@ g_time_zone_new_identifier (const gchar *identifier)
   g_assert (tz->name != NULL);
   g_assert (tz->t_info != NULL);
 
+  tz->std_info = find_std_info (tz);
+
+  g_atomic_int_inc (&tz->ref_count);
+
   if (identifier)
-    g_hash_table_insert (time_zones, tz->name, tz);
-  else if (tz->name)
+    {
+      GTimeZone *evicted;
+
+      g_hash_table_insert (time_zones, tz->name, tz);
+      evicted = time_zone_cache_touch (tz);
+      G_UNLOCK (time_zones);
+
+      if (evicted)
+        g_time_zone_unref (evicted);
+    }
+  else
     {
       /* Caching reference */
       g_atomic_int_inc (&tz->ref_count);
       tz_default = tz;
+      G_UNLOCK (tz_default);
     }
 
-  g_atomic_int_inc (&tz->ref_count);
-
-  if (identifier)
-    G_UNLOCK (time_zones);
-  else
-    G_UNLOCK (tz_default);
-
   return tz;
 }
 
@@ -2119,15 +2187,7 @@ interval_info (GTimeZone *tz,
   if (interval && tz->transitions && interval <= tz->transitions->len)
     index = (TRANSITION(interval - 1)).info_index;
   else
-    {
-      for (index = 0; index < tz->t_info->len; index++)
-        {
-          TransitionInfo *tzinfo = &(TRANSITION_INFO(index));
-          if (!tzinfo->is_dst)
-            return tzinfo;
-        }
-      index = 0;
-    }
+    index = tz->std_info;
 
   return &(TRANSITION_INFO(index));
 }
@@ -2209,6 +2269,48 @@ interval_valid (GTimeZone *tz,
   return interval <= tz->transitions->len;
 }
 
+/* Finds the interval containing the UTC @time_, ie: the first one whose
+ * end is not before it.  Callers tend to ask about nearby times over and
+ * over (formatting a run of log timestamps, say), so first try the
+ * interval found last time and the one after it, and only then
+ * binary-search the transitions.
+ */
+static guint
+find_utc_interval (GTimeZone *tz,
+                   gint64     time_)
+{
+  guint intervals = tz->transitions->len;
+  guint hint, lo, hi;
+
+  hint = (guint) g_atomic_int_get (&tz->last_interval);
+  if (hint <= intervals && time_ <= interval_end (tz, hint))
+    {
+      if (hint == 0 || time_ > interval_end (tz, hint - 1))
+        return hint;
+    }
+  else if (hint < intervals && time_ <= interval_end (tz, hint + 1))
+    {
+      g_atomic_int_set (&tz->last_interval, hint + 1);
+      return hint + 1;
+    }
+
+  lo = 0;
+  hi = intervals;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (time_ <= interval_end (tz, mid))
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+
+  g_atomic_int_set (&tz->last_interval, lo);
+
+  return lo;
+}
+
 /* g_time_zone_find_interval() {{{1 */
 
 /**
@@ -2251,11 +2353,8 @@ g_time_zone_adjust_time (GTimeZone *tz,
 
   intervals = tz->transitions->len;
 
-  /* find the interval containing *time UTC
-   * TODO: this could be binary searched (or better) */
-  for (i = 0; i <= intervals; i++)
-    if (*time_ <= interval_end (tz, i))
-      break;
+  /* find the interval containing *time UTC */
+  i = find_utc_interval (tz, *time_);
 
   g_assert (interval_start (tz, i) <= *time_ && *time_ <= interval_end (tz, i));
 
@@ -2347,9 +2446,7 @@ g_time_zone_find_interval (GTimeZone *tz,
   if (tz->transitions == NULL)
     return 0;
   intervals = tz->transitions->len;
-  for (i = 0; i <= intervals; i++)
-    if (time_ <= interval_end (tz, i))
-      break;
+  i = find_utc_interval (tz, time_);
 
   if (type == G_TIME_TYPE_UNIVERSAL)
     return i;
@@ -2484,5 +2581,100 @@ g_time_zone_get_identifier (GTimeZone *tz)
   return tz->name;
 }
 
+/* Batch conversion {{{1 */
+
+/* Converts a count of days since 1970-01-01 to a date in the proleptic
+ * Gregorian calendar, counting years from March so that the leap day
+ * comes last.  See https://howardhinnant.github.io/date_algorithms.html
+ */
+static inline void
+civil_from_days (gint64              days,
+                 GTimeZoneLocalTime *local)
+{
+  gint64 z = days + 719468;
+  gint64 era = (z >= 0 ? z : z - 146096) / 146097;
+  gint64 doe = z - era * 146097;                                       /* [0, 146096] */
+  gint64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  /* [0, 399] */
+  gint64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                /* [0, 365] */
+  gint64 mp = (5 * doy + 2) / 153;                                     /* [0, 11] */
+  gint64 year = yoe + era * 400 + (mp >= 10);
+  gboolean leap = (year % 4 == 0) && (year % 100 != 0 || year % 400 == 0);
+
+  local->year = (gint) year;
+  local->month = (gint) (mp < 10 ? mp + 3 : mp - 9);
+  local->day = (gint) (doy - (153 * mp + 2) / 5 + 1);
+  local->day_of_year = (gint) (mp >= 10 ? doy - 305 : doy + 60 + leap);
+}
+
+/**
+ * g_time_zone_to_local_times:
+ * @tz: a #GTimeZone
+ * @times: (array length=n_times): times, as seconds since January 1, 1970 UTC
+ * @n_times: the number of elements in @times
+ * @local_times: (array length=n_times) (out caller-allocates): return
+ *   location for the broken-down local times
+ *
+ * Converts each of @times to local time in @tz, breaking it down into
+ * its calendar fields.
+ *
+ * The results are the same as creating a #GDateTime for each time with
+ * g_date_time_new_from_unix_utc() and g_date_time_to_timezone(), and
+ * reading its fields, but without allocating anything.  Runs of times
+ * that fall in the same interval of @tz (as is usual for timestamps
+ * that are close together) are converted without searching the time
+ * zone's transitions again.
+ *
+ * Since: 2.80
+ */
+void
+g_time_zone_to_local_times (GTimeZone          *tz,
+                            const gint64       *times,
+                            gsize               n_times,
+                            GTimeZoneLocalTime *local_times)
+{
+  const TransitionInfo *info = NULL;
+  gint64 start = 0, end = -1;
+  guint interval = 0;
+  gsize i;
+
+  g_return_if_fail (tz != NULL);
+  g_return_if_fail (n_times == 0 || (times != NULL && local_times != NULL));
+
+  for (i = 0; i < n_times; i++)
+    {
+      GTimeZoneLocalTime *local = &local_times[i];
+      gint64 t = times[i];
+      gint64 days, secs;
+
+      if (info == NULL || t < start || t > end)
+        {
+          interval = tz->transitions ? find_utc_interval (tz, t) : 0;
+          info = interval_info (tz, interval);
+          start = interval_start (tz, interval);
+          end = tz->transitions ? interval_end (tz, interval) : G_MAXINT64;
+        }
+
+      t += info->gmt_offset;
+
+      days = t / 86400;
+      secs = t % 86400;
+      if (secs < 0)
+        {
+          secs += 86400;
+          days--;
+        }
+
+      civil_from_days (days, local);
+      local->hour = (gint) (secs / 3600);
+      local->minute = (gint) (secs / 60 % 60);
+      local->second = (gint) (secs % 60);
+      /* 1970-01-01 was a Thursday */
+      local->day_of_week = (gint) (((days % 7) + 10) % 7) + 1;
+      local->utc_offset = info->gmt_offset;
+      local->interval = (gint) interval;
+      local->is_dst = tz->transitions ? info->is_dst : FALSE;
+    }
+}
+
 /* Epilogue {{{1 */
 /* vim:set foldmethod=marker: */
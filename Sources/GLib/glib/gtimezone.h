@@ -93,6 +93,46 @@ gboolean                g_time_zone_is_dst                              (GTimeZo
 GLIB_AVAILABLE_IN_2_58
 const gchar *           g_time_zone_get_identifier                      (GTimeZone   *tz);
 
+/**
+ * GTimeZoneLocalTime:
+ * @year: the year, in the proleptic Gregorian calendar
+ * @month: the month of the year, from 1 to 12
+ * @day: the day of the month, from 1 to 31
+ * @hour: the hour of the day, from 0 to 23
+ * @minute: the minute of the hour, from 0 to 59
+ * @second: the second of the minute, from 0 to 59
+ * @day_of_week: the ISO 8601 day of the week, from 1 (Monday) to 7 (Sunday)
+ * @day_of_year: the day of the year, from 1 to 366
+ * @utc_offset: the offset to UTC in effect, in seconds
+ * @interval: the interval of the time zone the time falls in
+ * @is_dst: whether daylight savings time is in effect
+ *
+ * A time broken down into its calendar fields in a particular time zone,
+ * as filled in by g_time_zone_to_local_times().
+ *
+ * Since: 2.80
+ */
+typedef struct
+{
+  gint     year;
+  gint     month;
+  gint     day;
+  gint     hour;
+  gint     minute;
+  gint     second;
+  gint     day_of_week;
+  gint     day_of_year;
+  gint32   utc_offset;
+  gint     interval;
+  gboolean is_dst;
+} GTimeZoneLocalTime;
+
+GLIB_AVAILABLE_IN_2_80
+void                    g_time_zone_to_local_times                      (GTimeZone          *tz,
+                                                                         const gint64       *times,
+                                                                         gsize               n_times,
+                                                                         GTimeZoneLocalTime *local_times);
+
 G_END_DECLS
 
 #endif /* __G_TIME_ZONE_H__ */
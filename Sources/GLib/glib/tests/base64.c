@@ -486,6 +486,208 @@ test_base64_encode_decode_rfc4648 (void)
     }
 }
 
+/* A straightforward encoder, to check the output of the optimized one */
+static gchar *
+reference_encode (const guchar *data,
+                  gsize         len,
+                  gboolean      break_lines)
+{
+  static const char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  GString *out = g_string_new (NULL);
+  gsize i, groups = 0;
+
+  for (i = 0; i + 3 <= len; i += 3)
+    {
+      guint32 v = data[i] << 16 | data[i + 1] << 8 | data[i + 2];
+
+      g_string_append_c (out, alphabet[(v >> 18) & 0x3f]);
+      g_string_append_c (out, alphabet[(v >> 12) & 0x3f]);
+      g_string_append_c (out, alphabet[(v >> 6) & 0x3f]);
+      g_string_append_c (out, alphabet[v & 0x3f]);
+
+      if (break_lines && ++groups == 19)
+        {
+          g_string_append_c (out, '\n');
+          groups = 0;
+        }
+    }
+
+  if (len - i == 1)
+    {
+      g_string_append_c (out, alphabet[data[i] >> 2]);
+      g_string_append_c (out, alphabet[(data[i] & 0x3) << 4]);
+      g_string_append (out, "==");
+    }
+  else if (len - i == 2)
+    {
+      g_string_append_c (out, alphabet[data[i] >> 2]);
+      g_string_append_c (out, alphabet[(data[i] & 0x3) << 4 | data[i + 1] >> 4]);
+      g_string_append_c (out, alphabet[(data[i + 1] & 0xf) << 2]);
+      g_string_append_c (out, '=');
+    }
+
+  if (break_lines)
+    g_string_append_c (out, '\n');
+
+  return g_string_free (out, FALSE);
+}
+
+static guchar *
+make_random_data (gsize len)
+{
+  guchar *data = g_malloc (len + 1);
+  gsize i;
+
+  for (i = 0; i < len; i++)
+    data[i] = g_test_rand_int_range (0, 256);
+
+  return data;
+}
+
+static void
+test_base64_blocks (void)
+{
+  const gsize chunk_sizes[] = { 1, 5, 48, 1000 };
+  gsize len, c;
+
+  g_test_summary ("Check encoding and decoding of buffers large enough to use "
+                  "the vectorized code, in several chunk sizes");
+
+  for (len = 0; len <= 600; len += (len < 200) ? 1 : 37)
+    {
+      guchar *data = make_random_data (len);
+      int break_lines;
+
+      for (break_lines = 0; break_lines <= 1; break_lines++)
+        {
+          gchar *expected = reference_encode (data, len, break_lines);
+          gsize expected_len = strlen (expected);
+
+          for (c = 0; c < G_N_ELEMENTS (chunk_sizes); c++)
+            {
+              gchar *text = g_malloc (len * 4 / 3 + len * 4 / (3 * 72) + 8);
+              guchar *decoded = g_malloc (len + 3);
+              gsize text_len = 0, decoded_len = 0, pos;
+              gint state = 0, save = 0;
+              guint decoder_save = 0;
+
+              for (pos = 0; pos < len; pos += chunk_sizes[c])
+                text_len += g_base64_encode_step (data + pos, MIN (chunk_sizes[c], len - pos),
+                                                  break_lines, text + text_len, &state, &save);
+              text_len += g_base64_encode_close (break_lines, text + text_len, &state, &save);
+
+              g_assert_cmpmem (text, text_len, expected, expected_len);
+
+              state = 0;
+              for (pos = 0; pos < text_len; pos += chunk_sizes[c])
+                decoded_len += g_base64_decode_step (text + pos, MIN (chunk_sizes[c], text_len - pos),
+                                                     decoded + decoded_len, &state, &decoder_save);
+
+              g_assert_cmpmem (decoded, decoded_len, data, len);
+
+              g_free (decoded);
+              g_free (text);
+            }
+
+          g_free (expected);
+        }
+
+      g_free (data);
+    }
+}
+
+static void
+test_base64_decode_skipped_chars (void)
+{
+  guchar *data, *decoded;
+  gchar *encoded;
+  GString *text;
+  gsize i, len = 500, decoded_len;
+
+  g_test_summary ("Check that whitespace and invalid characters are skipped "
+                  "when decoding, wherever they are");
+
+  data = make_random_data (len);
+  encoded = g_base64_encode (data, len);
+
+  /* Insert some characters that are not in the alphabet at
+   * irregular intervals, including bytes above 0x7f
+   */
+  text = g_string_new (NULL);
+  for (i = 0; encoded[i] != '\0'; i++)
+    {
+      g_string_append_c (text, encoded[i]);
+      if (i % 29 == 28)
+        g_string_append (text, "\r\n");
+      else if (i % 43 == 42)
+        g_string_append (text, " \t");
+      else if (i % 71 == 70)
+        g_string_append (text, "\xc3\xa9*");
+    }
+
+  decoded = g_base64_decode (text->str, &decoded_len);
+  g_assert_cmpmem (decoded, decoded_len, data, len);
+
+  g_free (decoded);
+  g_string_free (text, TRUE);
+  g_free (encoded);
+  g_free (data);
+}
+
+static void
+test_base64_performance (void)
+{
+  gsize size;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  for (size = 64; size <= 64 * 1024 * 1024; size *= 16)
+    {
+      guchar *data = make_random_data (size);
+      guint n_iterations = MAX (1, 64 * 1024 * 1024 / size);
+      gchar *text = NULL;
+      guchar *decoded = NULL;
+      gsize decoded_len;
+      gdouble elapsed;
+      guint i;
+
+      g_test_timer_start ();
+      for (i = 0; i < n_iterations; i++)
+        {
+          g_free (text);
+          text = g_base64_encode (data, size);
+        }
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_maximized_result ((gdouble) size * n_iterations / elapsed / (1024 * 1024),
+                               "Encoded %" G_GSIZE_FORMAT " bytes at %.1f MB/s", size,
+                               (gdouble) size * n_iterations / elapsed / (1024 * 1024));
+
+      g_test_timer_start ();
+      for (i = 0; i < n_iterations; i++)
+        {
+          g_free (decoded);
+          decoded = g_base64_decode (text, &decoded_len);
+        }
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_maximized_result ((gdouble) size * n_iterations / elapsed / (1024 * 1024),
+                               "Decoded %" G_GSIZE_FORMAT " bytes at %.1f MB/s", size,
+                               (gdouble) size * n_iterations / elapsed / (1024 * 1024));
+
+      g_assert_cmpmem (decoded, decoded_len, data, size);
+
+      g_free (decoded);
+      g_free (text);
+      g_free (data);
+    }
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -537,6 +739,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/base64/decode/empty", test_base64_decode_empty);
 
   g_test_add_func ("/base64/encode-decode/rfc4648", test_base64_encode_decode_rfc4648);
+  g_test_add_func ("/base64/encode-decode/blocks", test_base64_blocks);
+  g_test_add_func ("/base64/decode/skipped-chars", test_base64_decode_skipped_chars);
+  g_test_add_func ("/base64/performance", test_base64_performance);
 
   return g_test_run ();
 }
@@ -1175,6 +1175,225 @@ test_unsupported (void)
   g_assert (g_checksum_new (20) == NULL);
 }
 
+static guint8 *
+make_test_data (gsize length)
+{
+  guint8 *data = g_malloc (length);
+  guint32 seed = 42;
+  gsize i;
+
+  /* A cheap LCG, so that the data is the same in each process */
+  for (i = 0; i < length; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      data[i] = seed >> 16;
+    }
+
+  return data;
+}
+
+static void
+test_checksum_many (void)
+{
+  const GChecksumType types[] = {
+    G_CHECKSUM_MD5, G_CHECKSUM_SHA1, G_CHECKSUM_SHA256,
+    G_CHECKSUM_SHA384, G_CHECKSUM_SHA512
+  };
+  const guint8 *buffers[300];
+  gsize lengths[300];
+  guint8 *data;
+  gsize i, t;
+
+  g_test_summary ("Check that g_checksum_digest_many() computes the same "
+                  "digests as GChecksum, for many lengths and alignments");
+
+  data = make_test_data (4096);
+
+  for (i = 0; i < G_N_ELEMENTS (buffers); i++)
+    {
+      buffers[i] = data + (i * 7) % 64;
+      lengths[i] = i;
+    }
+
+  for (t = 0; t < G_N_ELEMENTS (types); t++)
+    {
+      gsize digest_len = g_checksum_type_get_length (types[t]);
+      guint8 *digests = g_malloc (digest_len * G_N_ELEMENTS (buffers));
+
+      g_checksum_digest_many (types[t], buffers, lengths, G_N_ELEMENTS (buffers), digests);
+
+      for (i = 0; i < G_N_ELEMENTS (buffers); i++)
+        {
+          GChecksum *checksum = g_checksum_new (types[t]);
+          guint8 digest[64];
+          gsize len = sizeof (digest);
+
+          g_checksum_update (checksum, buffers[i], lengths[i]);
+          g_checksum_get_digest (checksum, digest, &len);
+          g_assert_cmpmem (digests + i * digest_len, digest_len, digest, len);
+
+          g_checksum_free (checksum);
+        }
+
+      g_free (digests);
+    }
+
+  g_free (data);
+}
+
+/* Hashes buffers of many lengths and alignments, in one go and in
+ * odd-sized chunks, and returns a digest of all the results
+ */
+static gchar *
+checksum_many_lengths (GChecksumType checksum_type)
+{
+  GChecksum *all;
+  guint8 *data;
+  gsize length;
+  gchar *result;
+
+  data = make_test_data (2048);
+  all = g_checksum_new (G_CHECKSUM_SHA256);
+
+  for (length = 0; length <= 1024; length++)
+    {
+      GChecksum *checksum = g_checksum_new (checksum_type);
+      gsize offset;
+
+      g_checksum_update (checksum, data + length % 16, length);
+      g_checksum_update (all, (const guchar *) g_checksum_get_string (checksum), -1);
+      g_checksum_free (checksum);
+
+      checksum = g_checksum_new (checksum_type);
+      for (offset = 0; offset < length; offset += 37)
+        g_checksum_update (checksum, data + offset, MIN (37, length - offset));
+      g_checksum_update (all, (const guchar *) g_checksum_get_string (checksum), -1);
+      g_checksum_free (checksum);
+    }
+
+  result = g_strdup (g_checksum_get_string (all));
+
+  g_checksum_free (all);
+  g_free (data);
+
+  return result;
+}
+
+static void
+test_checksum_portable (void)
+{
+  if (g_test_subprocess ())
+    {
+      gchar *sha1 = checksum_many_lengths (G_CHECKSUM_SHA1);
+      gchar *sha256 = checksum_many_lengths (G_CHECKSUM_SHA256);
+
+      g_print ("%s %s\n", sha1, sha256);
+
+      g_free (sha1);
+      g_free (sha256);
+    }
+  else
+    {
+      gchar **envp = g_environ_setenv (g_get_environ (), "G_CHECKSUM_NO_HWACCEL", "1", TRUE);
+      gchar *sha1 = checksum_many_lengths (G_CHECKSUM_SHA1);
+      gchar *sha256 = checksum_many_lengths (G_CHECKSUM_SHA256);
+      gchar *expected = g_strdup_printf ("%s %s\n", sha1, sha256);
+
+      g_test_summary ("Check that the hardware accelerated SHA-1 and SHA-256 "
+                      "implementations, if any, match the portable ones");
+
+      g_test_trap_subprocess_with_envp (NULL, (const gchar * const *) envp, 0,
+                                        G_TEST_SUBPROCESS_DEFAULT);
+      g_test_trap_assert_passed ();
+      g_test_trap_assert_stdout (expected);
+
+      g_free (expected);
+      g_free (sha1);
+      g_free (sha256);
+      g_strfreev (envp);
+    }
+}
+
+#define PERF_LARGE_SIZE (64 * 1024 * 1024)
+#define PERF_N_SMALL 200000
+#define PERF_SMALL_SIZE 64
+
+/* Run with G_CHECKSUM_NO_HWACCEL=1 in the environment to measure
+ * the portable SHA-1 and SHA-256 implementations
+ */
+static void
+test_checksum_performance (void)
+{
+  const GChecksumType types[] = {
+    G_CHECKSUM_MD5, G_CHECKSUM_SHA1, G_CHECKSUM_SHA256, G_CHECKSUM_SHA512
+  };
+  const char *names[] = { "MD5", "SHA1", "SHA256", "SHA512" };
+  const char *impl;
+  const guint8 **buffers;
+  gsize *lengths;
+  guint8 *digests;
+  guint8 *data;
+  gsize i, t;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  impl = g_getenv ("G_CHECKSUM_NO_HWACCEL") ? "portable" : "default";
+
+  data = make_test_data (PERF_LARGE_SIZE);
+  buffers = g_new (const guint8 *, PERF_N_SMALL);
+  lengths = g_new (gsize, PERF_N_SMALL);
+  digests = g_malloc (PERF_N_SMALL * 64);
+
+  for (i = 0; i < PERF_N_SMALL; i++)
+    {
+      buffers[i] = data + i * PERF_SMALL_SIZE;
+      lengths[i] = PERF_SMALL_SIZE;
+    }
+
+  for (t = 0; t < G_N_ELEMENTS (types); t++)
+    {
+      gdouble elapsed;
+      gchar *str;
+
+      g_test_timer_start ();
+      str = g_compute_checksum_for_data (types[t], data, PERF_LARGE_SIZE);
+      elapsed = g_test_timer_elapsed ();
+      g_free (str);
+
+      g_test_maximized_result (PERF_LARGE_SIZE / elapsed / (1024 * 1024),
+                               "%s (%s): %.1f MB/s for a %d MB buffer",
+                               names[t], impl,
+                               PERF_LARGE_SIZE / elapsed / (1024 * 1024),
+                               PERF_LARGE_SIZE / (1024 * 1024));
+
+      g_test_timer_start ();
+      for (i = 0; i < PERF_N_SMALL; i++)
+        g_free (g_compute_checksum_for_data (types[t], buffers[i], lengths[i]));
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_minimized_result (elapsed,
+                               "%s (%s): %d buffers of %d bytes one at a time in %.3f seconds",
+                               names[t], impl, PERF_N_SMALL, PERF_SMALL_SIZE, elapsed);
+
+      g_test_timer_start ();
+      g_checksum_digest_many (types[t], buffers, lengths, PERF_N_SMALL, digests);
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_minimized_result (elapsed,
+                               "%s (%s): %d buffers of %d bytes in a batch in %.3f seconds",
+                               names[t], impl, PERF_N_SMALL, PERF_SMALL_SIZE, elapsed);
+    }
+
+  g_free (digests);
+  g_free (lengths);
+  g_free (buffers);
+  g_free (data);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1209,5 +1428,9 @@ main (int argc, char *argv[])
   add_checksum_string_test (G_CHECKSUM_SHA512, "SHA512", SHA512_sums);
   add_checksum_bytes_test (G_CHECKSUM_SHA512, "SHA512", SHA512_sums);
 
+  g_test_add_func ("/checksum/many", test_checksum_many);
+  g_test_add_func ("/checksum/portable", test_checksum_portable);
+  g_test_add_func ("/checksum/performance", test_checksum_performance);
+
   return g_test_run ();
 }
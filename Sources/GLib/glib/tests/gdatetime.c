@@ -2846,6 +2846,85 @@ test_find_interval (void)
   g_time_zone_unref (tz);
 }
 
+static void
+check_local_times (GTimeZone    *tz,
+                   const gint64 *times,
+                   gsize         n_times)
+{
+  GTimeZoneLocalTime *local_times = g_new0 (GTimeZoneLocalTime, n_times);
+  gsize i;
+
+  g_time_zone_to_local_times (tz, times, n_times, local_times);
+
+  for (i = 0; i < n_times; i++)
+    {
+      GDateTime *utc = g_date_time_new_from_unix_utc (times[i]);
+      GDateTime *dt = g_date_time_to_timezone (utc, tz);
+      GTimeZoneLocalTime *local = &local_times[i];
+
+      g_assert_cmpint (local->year, ==, g_date_time_get_year (dt));
+      g_assert_cmpint (local->month, ==, g_date_time_get_month (dt));
+      g_assert_cmpint (local->day, ==, g_date_time_get_day_of_month (dt));
+      g_assert_cmpint (local->hour, ==, g_date_time_get_hour (dt));
+      g_assert_cmpint (local->minute, ==, g_date_time_get_minute (dt));
+      g_assert_cmpint (local->second, ==, g_date_time_get_second (dt));
+      g_assert_cmpint (local->day_of_week, ==, g_date_time_get_day_of_week (dt));
+      g_assert_cmpint (local->day_of_year, ==, g_date_time_get_day_of_year (dt));
+      g_assert_cmpint (local->utc_offset, ==, g_date_time_get_utc_offset (dt) / G_USEC_PER_SEC);
+      g_assert_cmpint (local->is_dst, ==, g_date_time_is_daylight_savings (dt));
+      g_assert_cmpint (local->utc_offset, ==, g_time_zone_get_offset (tz, local->interval));
+
+      g_date_time_unref (dt);
+      g_date_time_unref (utc);
+    }
+
+  g_free (local_times);
+}
+
+static void
+test_to_local_times (void)
+{
+  const gchar *identifiers[] = {
+#ifdef G_OS_UNIX
+    "America/Toronto", "Europe/London", "Australia/Lord_Howe",
+#elif defined G_OS_WIN32
+    "Eastern Standard Time", "GMT Standard Time",
+#endif
+    "UTC", "+05:30",
+  };
+  gint64 *times;
+  gsize n_times = 2000, i, j;
+
+  g_test_summary ("Test that g_time_zone_to_local_times() agrees with GDateTime");
+
+  times = g_new (gint64, n_times);
+
+  for (i = 0; i < G_N_ELEMENTS (identifiers); i++)
+    {
+      GTimeZone *tz = g_time_zone_new_identifier (identifiers[i]);
+
+      g_assert_nonnull (tz);
+
+      /* Sorted, hourly across two years spanning several transitions */
+      for (j = 0; j < n_times; j++)
+        times[j] = 1262304000 + (gint64) j * 3600 * 9 - 7;
+      check_local_times (tz, times, n_times);
+
+      /* Scattered, including times before 1970 and leap days */
+      for (j = 0; j < n_times; j++)
+        times[j] = g_test_rand_int_range (-2000000000, G_MAXINT32) * (gint64) 2;
+      times[0] = 951782400;     /* 2000-02-29 */
+      times[1] = -2208988800;   /* 1900-01-01 */
+      times[2] = 0;
+      times[3] = -1;
+      check_local_times (tz, times, n_times);
+
+      g_time_zone_unref (tz);
+    }
+
+  g_free (times);
+}
+
 static void
 test_adjust_time (void)
 {
@@ -3338,8 +3417,9 @@ test_time_zone_caching (void)
 
   g_test_summary ("GTimeZone instances are cached");
 
-  /* Check a specific (arbitrary) timezone. These are only cached while third
-   * party code holds a ref to at least one instance. */
+  /* Check a specific (arbitrary) timezone. These are cached while third
+   * party code holds a ref to at least one instance, and for a while after
+   * that if they were looked up recently. */
 #ifdef G_OS_UNIX
   tz1 = g_time_zone_new_identifier ("Europe/London");
   g_assert_nonnull (tz1);
@@ -3359,6 +3439,13 @@ test_time_zone_caching (void)
   /* Only compare pointers */
   g_assert_true (tz1 == tz2);
 
+#ifdef G_OS_UNIX
+  /* Both refs have been dropped, but the zone is retained as recently used */
+  tz2 = g_time_zone_new_identifier ("Europe/London");
+  g_assert_true (tz1 == tz2);
+  g_time_zone_unref (tz2);
+#endif
+
   /* Check the default timezone, local and UTC. These are cached internally in
    * GLib, so should persist even after the last third party reference is
    * dropped.
@@ -3512,6 +3599,7 @@ main (gint   argc,
 
   g_test_add_func ("/GTimeZone/find-interval", test_find_interval);
   g_test_add_func ("/GTimeZone/adjust-time", test_adjust_time);
+  g_test_add_func ("/GTimeZone/to-local-times", test_to_local_times);
   g_test_add_func ("/GTimeZone/no-header", test_no_header);
   g_test_add_func ("/GTimeZone/no-header-identifier", test_no_header_identifier);
   g_test_add_func ("/GTimeZone/posix-parse", test_posix_parse);
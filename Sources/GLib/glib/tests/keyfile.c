@@ -1926,6 +1926,341 @@ test_free_when_not_last_ref (void)
   g_key_file_unref (kf);
 }
 
+/* Loads @data with and without %G_KEY_FILE_READ_ONLY and checks that
+ * everything that can be looked up without modifying the key file is
+ * the same in both.
+ */
+static void
+check_read_only_matches (const gchar   *data,
+                         GKeyFileFlags  flags)
+{
+  GKeyFile *regular, *read_only;
+  GError *regular_error = NULL, *read_only_error = NULL;
+  gchar **groups, **ro_groups;
+  gchar *start, *ro_start;
+  gboolean loaded;
+  gsize i, j, n_groups, n_ro_groups;
+
+  g_test_message ("Checking %s", data);
+
+  regular = g_key_file_new ();
+  loaded = g_key_file_load_from_data (regular, data, -1, flags, &regular_error);
+  read_only = g_key_file_new ();
+  g_assert_cmpint (g_key_file_load_from_data (read_only, data, -1,
+                                              flags | G_KEY_FILE_READ_ONLY,
+                                              &read_only_error), ==, loaded);
+
+  if (!loaded)
+    {
+      g_assert_nonnull (regular_error);
+      g_assert_error (read_only_error, regular_error->domain, regular_error->code);
+      g_assert_cmpstr (read_only_error->message, ==, regular_error->message);
+      g_clear_error (&regular_error);
+      g_clear_error (&read_only_error);
+      g_key_file_free (regular);
+      g_key_file_free (read_only);
+      return;
+    }
+
+  g_assert_no_error (read_only_error);
+
+  start = g_key_file_get_start_group (regular);
+  ro_start = g_key_file_get_start_group (read_only);
+  g_assert_cmpstr (ro_start, ==, start);
+  g_free (start);
+  g_free (ro_start);
+
+  groups = g_key_file_get_groups (regular, &n_groups);
+  ro_groups = g_key_file_get_groups (read_only, &n_ro_groups);
+  g_assert_cmpuint (n_ro_groups, ==, n_groups);
+  g_assert_cmpstrv (ro_groups, groups);
+
+  for (i = 0; groups[i] != NULL; i++)
+    {
+      gchar **keys, **ro_keys;
+      gsize n_keys, n_ro_keys;
+
+      g_assert_true (g_key_file_has_group (read_only, groups[i]));
+
+      keys = g_key_file_get_keys (regular, groups[i], &n_keys, NULL);
+      ro_keys = g_key_file_get_keys (read_only, groups[i], &n_ro_keys, NULL);
+      g_assert_cmpuint (n_ro_keys, ==, n_keys);
+      g_assert_cmpstrv (ro_keys, keys);
+
+      for (j = 0; keys[j] != NULL; j++)
+        {
+          gchar *value, *ro_value;
+
+          g_assert_true (g_key_file_has_key (read_only, groups[i], keys[j], NULL));
+
+          value = g_key_file_get_value (regular, groups[i], keys[j], NULL);
+          ro_value = g_key_file_get_value (read_only, groups[i], keys[j], NULL);
+          g_assert_cmpstr (ro_value, ==, value);
+          g_free (value);
+          g_free (ro_value);
+        }
+
+      g_assert_false (g_key_file_has_key (read_only, groups[i], "no-such-key", &read_only_error));
+      g_assert_no_error (read_only_error);
+      g_assert_null (g_key_file_get_value (read_only, groups[i], "no-such-key", &read_only_error));
+      check_error (&read_only_error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_KEY_NOT_FOUND);
+
+      g_strfreev (keys);
+      g_strfreev (ro_keys);
+    }
+
+  g_assert_false (g_key_file_has_group (read_only, "no-such-group"));
+  g_assert_null (g_key_file_get_keys (read_only, "no-such-group", NULL, &read_only_error));
+  check_error (&read_only_error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND);
+  g_assert_null (g_key_file_get_value (read_only, "no-such-group", "key", &read_only_error));
+  check_error (&read_only_error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND);
+
+  g_strfreev (groups);
+  g_strfreev (ro_groups);
+  g_key_file_free (regular);
+  g_key_file_free (read_only);
+}
+
+static void
+test_read_only (void)
+{
+  const gchar *data[] = {
+    "",
+    "\n\n# only a comment\n",
+    "[group]\nkey=value\n",
+    "[group]\nkey=value",
+    "[group]\r\nkey=value\r\nkey2=value2\r",
+    "  [group]  \t\n  key  =   value with trailing spaces   \n\tk e y=\n",
+    "[a]\nkey=1\n[b]\nkey=2\n\n[c]\n",
+    "[group]\nkey=a=b\nempty=\n  =x\n",
+    "[group]\nkey=value\nkey[de]=Wert\nkey[fr]=valeur\nkey[x-no-such]=value\nkey[]=empty\n",
+    "[group]\nName=Files\nName[de_DE@euro]=Dateien\nkey[de]=x\n",
+    "[group]\nkey=\\s\\n\\t\\\\\nlist=a;b\\;c;\n",
+    "[Desktop Entry]\nEncoding=UTF-8\n",
+    "[Desktop Entry]\nEncoding=utf-8\n",
+    "[Desktop Entry]\nEncoding=ISO-8859-1\n",
+    "[Desktop Entry]\n[Other]\nEncoding=ISO-8859-1\n",
+    "key=value\n[group]\n",
+    "[group]\nkey=1\nkey=2\n",
+    "[a]\nkey=1\n[b]\n[a]\nother=2\n",
+    "[]\n",
+    "[gro[up]\n",
+    "[group] x\n",
+    "[group]\nnot a key value pair\n",
+    "[group]\n=value\n",
+    "[group]\n key =value\n",
+    "[group]\nkey [de]=value\n",
+    "[group]\nkey[de=value\n",
+    "[group]\nkey\r=value\n",
+    "[gröup]\nkéy=välue\n",
+  };
+  gsize i;
+
+  g_setenv ("LANGUAGE", "de:fr", TRUE);
+  setlocale (LC_ALL, "");
+
+  for (i = 0; i < G_N_ELEMENTS (data); i++)
+    {
+      check_read_only_matches (data[i], G_KEY_FILE_NONE);
+      check_read_only_matches (data[i], G_KEY_FILE_KEEP_TRANSLATIONS);
+    }
+
+  g_unsetenv ("LANGUAGE");
+  setlocale (LC_ALL, "");
+}
+
+static void
+test_read_only_modify (void)
+{
+  GKeyFile *keyfile;
+  gchar *data, *value;
+  GError *error = NULL;
+
+  keyfile = load_data ("[a]\nkey=1\n[b]\nkey=2\n", G_KEY_FILE_READ_ONLY);
+
+  g_key_file_set_integer (keyfile, "b", "other", 3);
+  g_assert_true (g_key_file_remove_key (keyfile, "a", "key", &error));
+  g_assert_no_error (error);
+
+  check_integer_value (keyfile, "b", "key", 2);
+  check_integer_value (keyfile, "b", "other", 3);
+  g_assert_false (g_key_file_has_key (keyfile, "a", "key", &error));
+  g_assert_no_error (error);
+
+  data = g_key_file_to_data (keyfile, NULL, NULL);
+  g_assert_cmpstr (data, ==, "[a]\n\n[b]\nkey=2\nother=3\n");
+  g_free (data);
+  g_key_file_free (keyfile);
+
+  /* Comments are looked at the same way they would be without the flag */
+  keyfile = load_data ("# top\n[a]\n# above key\nkey=1\n", G_KEY_FILE_READ_ONLY);
+  value = g_key_file_get_comment (keyfile, "a", "key", &error);
+  g_assert_no_error (error);
+  g_assert_null (value);
+  g_key_file_free (keyfile);
+
+  /* G_KEY_FILE_KEEP_COMMENTS takes precedence */
+  keyfile = load_data ("# top\n[a]\n# above key\nkey=1\n",
+                       G_KEY_FILE_READ_ONLY | G_KEY_FILE_KEEP_COMMENTS);
+  value = g_key_file_get_comment (keyfile, "a", "key", &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (value, ==, " above key");
+  g_free (value);
+  g_key_file_free (keyfile);
+}
+
+static void
+test_read_only_file (void)
+{
+  gchar *dir, *path;
+  GString *contents;
+  GKeyFile *keyfile;
+  GError *error = NULL;
+  GBytes *bytes;
+  guint i;
+
+  dir = g_dir_make_tmp ("keyfile-XXXXXX", &error);
+  g_assert_no_error (error);
+  path = g_build_filename (dir, "test.desktop", NULL);
+
+  /* Small enough to be read, and large enough to be mapped */
+  contents = g_string_new ("[Desktop Entry]\nName=Test\n");
+  for (i = 0; i < 2; i++)
+    {
+      g_assert_true (g_file_set_contents (path, contents->str, contents->len, &error));
+      g_assert_no_error (error);
+
+      keyfile = g_key_file_new ();
+      g_assert_true (g_key_file_load_from_file (keyfile, path, G_KEY_FILE_READ_ONLY, &error));
+      g_assert_no_error (error);
+      check_string_value (keyfile, "Desktop Entry", "Name", "Test");
+      g_key_file_free (keyfile);
+
+      while (contents->len < 8192)
+        g_string_append (contents, "# padding, padding, padding\n");
+      g_string_append (contents, "[Other]\nkey=value");
+    }
+
+  keyfile = g_key_file_new ();
+  g_assert_true (g_key_file_load_from_file (keyfile, path, G_KEY_FILE_READ_ONLY, &error));
+  g_assert_no_error (error);
+  check_string_value (keyfile, "Other", "key", "value");
+  g_key_file_free (keyfile);
+
+  /* Errors are reported as without the flag */
+  g_assert_true (g_file_set_contents (path, "[Desktop Entry]\nbroken\n", -1, &error));
+  g_assert_no_error (error);
+  keyfile = g_key_file_new ();
+  g_assert_false (g_key_file_load_from_file (keyfile, path, G_KEY_FILE_READ_ONLY, &error));
+  check_error (&error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_PARSE);
+  g_key_file_free (keyfile);
+
+  /* The index points into the bytes, which must stay alive */
+  bytes = g_bytes_new (contents->str, contents->len);
+  keyfile = g_key_file_new ();
+  g_assert_true (g_key_file_load_from_bytes (keyfile, bytes, G_KEY_FILE_READ_ONLY, &error));
+  g_assert_no_error (error);
+  g_bytes_unref (bytes);
+  check_string_value (keyfile, "Desktop Entry", "Name", "Test");
+  check_string_value (keyfile, "Other", "key", "value");
+  g_key_file_free (keyfile);
+
+  g_remove (path);
+  g_rmdir (dir);
+  g_string_free (contents, TRUE);
+  g_free (path);
+  g_free (dir);
+}
+
+static gdouble
+load_desktop_files (gchar         **paths,
+                    GKeyFileFlags   flags)
+{
+  gsize i;
+
+  g_test_timer_start ();
+
+  for (i = 0; paths[i] != NULL; i++)
+    {
+      GKeyFile *keyfile;
+      gchar *value;
+
+      keyfile = g_key_file_new ();
+      g_assert_true (g_key_file_load_from_file (keyfile, paths[i], flags, NULL));
+      value = g_key_file_get_locale_string (keyfile, "Desktop Entry", "Name", NULL, NULL);
+      g_assert_nonnull (value);
+      g_free (value);
+      value = g_key_file_get_string (keyfile, "Desktop Entry", "Exec", NULL);
+      g_assert_nonnull (value);
+      g_free (value);
+      g_key_file_free (keyfile);
+    }
+
+  return g_test_timer_elapsed ();
+}
+
+static void
+test_read_only_performance (void)
+{
+  const guint n_files = 2000;
+  GPtrArray *paths;
+  gchar *dir;
+  GError *error = NULL;
+  gdouble regular, read_only;
+  guint i, j;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  dir = g_dir_make_tmp ("keyfile-perf-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  paths = g_ptr_array_new_with_free_func (g_free);
+  for (i = 0; i < n_files; i++)
+    {
+      GString *contents;
+      gchar *path;
+
+      contents = g_string_new ("[Desktop Entry]\nType=Application\n");
+      g_string_append_printf (contents, "Name=Application %u\n", i);
+      for (j = 0; j < 40; j++)
+        g_string_append_printf (contents, "Name[l%u]=Application %u in l%u\n", j, i, j);
+      for (j = 0; j < 40; j++)
+        g_string_append_printf (contents, "Comment[l%u]=Does things number %u\n", j, i);
+      g_string_append_printf (contents, "Exec=application-%u %%U\nIcon=application-%u\n"
+                              "Categories=Utility;\nMimeType=text/plain;\n"
+                              "\n[Desktop Action new-window]\nName=New Window\n"
+                              "Exec=application-%u --new-window\n", i, i, i);
+
+      path = g_strdup_printf ("%s/application-%u.desktop", dir, i);
+      g_assert_true (g_file_set_contents (path, contents->str, contents->len, &error));
+      g_assert_no_error (error);
+      g_ptr_array_add (paths, path);
+      g_string_free (contents, TRUE);
+    }
+  g_ptr_array_add (paths, NULL);
+
+  /* Warm up the page cache */
+  load_desktop_files ((gchar **) paths->pdata, G_KEY_FILE_NONE);
+
+  regular = load_desktop_files ((gchar **) paths->pdata, G_KEY_FILE_NONE);
+  read_only = load_desktop_files ((gchar **) paths->pdata, G_KEY_FILE_READ_ONLY);
+
+  g_test_message ("Loaded %u desktop files in %.3f ms, %.3f ms read-only",
+                  n_files, regular * 1000, read_only * 1000);
+  g_test_minimized_result (read_only, "read-only load of %u desktop files: %.3f s",
+                           n_files, read_only);
+
+  for (i = 0; i < n_files; i++)
+    g_remove (g_ptr_array_index (paths, i));
+  g_rmdir (dir);
+  g_ptr_array_unref (paths);
+  g_free (dir);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1971,6 +2306,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/keyfile/bytes", test_bytes);
   g_test_add_func ("/keyfile/get-locale", test_get_locale);
   g_test_add_func ("/keyfile/free-when-not-last-ref", test_free_when_not_last_ref);
+  g_test_add_func ("/keyfile/read-only", test_read_only);
+  g_test_add_func ("/keyfile/read-only/modify", test_read_only_modify);
+  g_test_add_func ("/keyfile/read-only/file", test_read_only_file);
+  g_test_add_func ("/keyfile/read-only/performance", test_read_only_performance);
 
   return g_test_run ();
 }
@@ -1731,6 +1731,205 @@ test_unix_fd_priority (void)
   close (fd2);
 }
 
+static gboolean
+count_and_drain (gint         fd,
+                 GIOCondition condition,
+                 gpointer     user_data)
+{
+  guint *count = user_data;
+  gchar buffer[16];
+
+  if (condition & G_IO_IN)
+    g_assert_cmpint (read (fd, buffer, sizeof buffer), >, 0);
+  (*count)++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+count_fd_calls (gint         fd,
+                GIOCondition condition,
+                gpointer     user_data)
+{
+  guint *count = user_data;
+
+  (*count)++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static guint n_custom_polls;
+
+static gint
+counting_poll (GPollFD *ufds,
+               guint    nfsd,
+               gint     timeout_)
+{
+  n_custom_polls++;
+
+  return g_poll (ufds, nfsd, timeout_);
+}
+
+/* Only the sources whose fds became ready get dispatched on an epoll
+ * context, events changes made through g_source_modify_unix_fd() are picked
+ * up, fds epoll refuses still behave like with poll(), and a custom poll
+ * function takes over from epoll. */
+static void
+test_epoll_context (void)
+{
+  enum { N_PIPES = 64 };
+  GMainContext *context;
+  gint fds[N_PIPES][2];
+  guint counts[N_PIPES] = { 0, };
+  GSourceFuncs flag_funcs = {
+    NULL, NULL, return_true, NULL, NULL, NULL
+  };
+  GSource *out_source;
+  gpointer out_tag;
+  GSource *file_source;
+  guint file_count = 0;
+  gchar *file_name;
+  gint file_fd;
+  gsize i;
+
+  context = g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_EPOLL);
+
+  for (i = 0; i < N_PIPES; i++)
+    {
+      GSource *source;
+
+      g_assert_no_errno (pipe (fds[i]));
+      source = g_unix_fd_source_new (fds[i][0], G_IO_IN);
+      g_source_set_callback (source, (GSourceFunc) count_and_drain, &counts[i], NULL);
+      g_source_attach (source, context);
+      g_source_unref (source);
+    }
+
+  while (g_main_context_iteration (context, FALSE));
+  for (i = 0; i < N_PIPES; i++)
+    g_assert_cmpuint (counts[i], ==, 0);
+
+  g_assert_cmpint (write (fds[3][1], "x", 1), ==, 1);
+  g_assert_cmpint (write (fds[42][1], "x", 1), ==, 1);
+  g_assert_true (g_main_context_iteration (context, TRUE));
+  while (g_main_context_iteration (context, FALSE));
+
+  for (i = 0; i < N_PIPES; i++)
+    g_assert_cmpuint (counts[i], ==, (i == 3 || i == 42) ? 1 : 0);
+
+  /* Start out not interested in anything, then ask for G_IO_OUT. */
+  out_source = g_source_new (&flag_funcs, sizeof (FlagSource));
+  out_tag = g_source_add_unix_fd (out_source, fds[0][1], 0);
+  g_source_attach (out_source, context);
+
+  while (g_main_context_iteration (context, FALSE));
+  assert_not_flagged (out_source);
+
+  g_source_modify_unix_fd (out_source, out_tag, G_IO_OUT);
+  g_assert_true (g_main_context_iteration (context, TRUE));
+  assert_flagged (out_source);
+
+  g_source_destroy (out_source);
+  g_source_unref (out_source);
+
+  /* epoll refuses regular files, which are always ready for poll(). */
+  file_fd = g_file_open_tmp ("glib-test-epoll-XXXXXX", &file_name, NULL);
+  g_assert_cmpint (file_fd, >=, 0);
+  file_source = g_unix_fd_source_new (file_fd, G_IO_IN);
+  g_source_set_callback (file_source, (GSourceFunc) count_fd_calls, &file_count, NULL);
+  g_source_attach (file_source, context);
+
+  g_assert_true (g_main_context_iteration (context, TRUE));
+  g_assert_cmpuint (file_count, ==, 1);
+
+  g_source_destroy (file_source);
+  g_source_unref (file_source);
+  close (file_fd);
+  g_unlink (file_name);
+  g_free (file_name);
+
+  /* A custom poll function is still honoured. */
+  g_main_context_set_poll_func (context, counting_poll);
+  g_assert_cmpint (write (fds[7][1], "x", 1), ==, 1);
+  g_assert_true (g_main_context_iteration (context, TRUE));
+  g_assert_cmpuint (counts[7], ==, 1);
+  g_assert_cmpuint (n_custom_polls, >, 0);
+  g_main_context_set_poll_func (context, NULL);
+
+  g_main_context_unref (context);
+
+  for (i = 0; i < N_PIPES; i++)
+    {
+      close (fds[i][0]);
+      close (fds[i][1]);
+    }
+}
+
+/* On an epoll context, fd sources without prepare() or check() are only
+ * looked at when their fds fire; make sure priorities still hold between
+ * them and the other sources, and that a ready time is still honoured. */
+static void
+test_epoll_context_priorities (void)
+{
+  GMainContext *context;
+  GSource *fd_source, *idle;
+  guint fd_count = 0;
+  gint idle_count = 0;
+  gint fds[2];
+  gchar c;
+
+  context = g_main_context_new_with_flags (G_MAIN_CONTEXT_FLAGS_EPOLL);
+
+  g_assert_no_errno (pipe (fds));
+  fd_source = g_unix_fd_source_new (fds[0], G_IO_IN);
+  g_source_set_callback (fd_source, (GSourceFunc) count_fd_calls, &fd_count, NULL);
+  g_source_set_priority (fd_source, G_PRIORITY_HIGH);
+  g_source_attach (fd_source, context);
+
+  idle = g_idle_source_new ();
+  g_source_set_callback (idle, count_calls, &idle_count, NULL);
+  g_source_attach (idle, context);
+
+  /* The ready fd source outranks the idle source. */
+  g_assert_cmpint (write (fds[1], "x", 1), ==, 1);
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  g_assert_cmpuint (fd_count, ==, 1);
+  g_assert_cmpint (idle_count, ==, 0);
+
+  /* And is not dispatched ahead of a higher priority source. */
+  g_source_set_priority (fd_source, G_PRIORITY_LOW);
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  g_assert_cmpuint (fd_count, ==, 1);
+  g_assert_cmpint (idle_count, ==, 1);
+
+  g_source_destroy (idle);
+  g_source_unref (idle);
+
+  /* The fd is still readable, so it is reported again. */
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  g_assert_cmpuint (fd_count, ==, 2);
+
+  /* Drain the pipe; a ready time still makes the source fire. */
+  g_assert_cmpint (read (fds[0], &c, 1), ==, 1);
+  g_assert_false (g_main_context_iteration (context, FALSE));
+  g_source_set_ready_time (fd_source, 0);
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  g_assert_cmpuint (fd_count, ==, 3);
+
+  g_source_set_ready_time (fd_source, -1);
+  g_assert_false (g_main_context_iteration (context, FALSE));
+  g_assert_cmpint (write (fds[1], "x", 1), ==, 1);
+  g_assert_true (g_main_context_iteration (context, FALSE));
+  g_assert_cmpuint (fd_count, ==, 4);
+
+  g_source_destroy (fd_source);
+  g_source_unref (fd_source);
+  g_main_context_unref (context);
+
+  close (fds[0]);
+  close (fds[1]);
+}
+
 #endif
 
 #ifdef G_OS_UNIX
@@ -2527,6 +2726,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/mainloop/wait", test_mainloop_wait);
   g_test_add_func ("/mainloop/unix-file-poll", test_unix_file_poll);
   g_test_add_func ("/mainloop/unix-fd-priority", test_unix_fd_priority);
+  g_test_add_func ("/mainloop/epoll-context", test_epoll_context);
+  g_test_add_func ("/mainloop/epoll-context-priorities", test_epoll_context_priorities);
 #endif
   g_test_add_func ("/mainloop/nfds", test_nfds);
   g_test_add_func ("/mainloop/steal-fd", test_steal_fd);
@@ -2539,6 +2539,150 @@ test_compiled_regex_after_jit_failure (void)
   g_regex_unref (regex);
 }
 
+static void
+test_match_many (void)
+{
+  const gchar *lines[] = { "aa#bb", "no match here", "cc#dd ee#ff", "", "#", "x#y" };
+  const gssize lengths[] = { -1, -1, 5, 0, -1, 1 };
+  const gchar *anchored_lines[] = { "aa#bb", " aa#bb" };
+  gboolean matches[G_N_ELEMENTS (lines)];
+  GRegexCompileFlags compile_flags[] = { G_REGEX_DEFAULT, G_REGEX_OPTIMIZE };
+  gsize i, j;
+
+  g_test_summary ("Test matching one regex against many strings at once");
+
+  for (i = 0; i < G_N_ELEMENTS (compile_flags); i++)
+    {
+      GRegex *regex;
+      GError *error = NULL;
+      gsize n_matches = 0;
+
+      regex = g_regex_new ("(\\w+)#(\\w+)", compile_flags[i], G_REGEX_MATCH_DEFAULT, &error);
+      g_assert_no_error (error);
+
+      g_assert_true (g_regex_match_many (regex, lines, NULL, G_N_ELEMENTS (lines),
+                                         G_REGEX_MATCH_DEFAULT, matches, &n_matches, &error));
+      g_assert_no_error (error);
+      g_assert_cmpuint (n_matches, ==, 3);
+      for (j = 0; j < G_N_ELEMENTS (lines); j++)
+        g_assert_cmpint (matches[j], ==, g_regex_match (regex, lines[j], G_REGEX_MATCH_DEFAULT, NULL));
+
+      g_assert_true (g_regex_match_many (regex, lines, lengths, G_N_ELEMENTS (lines),
+                                         G_REGEX_MATCH_DEFAULT, matches, &n_matches, &error));
+      g_assert_no_error (error);
+      g_assert_cmpuint (n_matches, ==, 2);
+      g_assert_true (matches[0]);
+      g_assert_false (matches[1]);
+      g_assert_true (matches[2]);
+      g_assert_false (matches[3]);
+      g_assert_false (matches[4]);
+      g_assert_false (matches[5]);
+
+      g_assert_true (g_regex_match_many (regex, anchored_lines, NULL, G_N_ELEMENTS (anchored_lines),
+                                         G_REGEX_MATCH_ANCHORED, matches, &n_matches, &error));
+      g_assert_no_error (error);
+      g_assert_cmpuint (n_matches, ==, 1);
+      g_assert_true (matches[0]);
+      g_assert_false (matches[1]);
+
+      g_assert_true (g_regex_match_many (regex, NULL, NULL, 0, G_REGEX_MATCH_DEFAULT,
+                                         NULL, &n_matches, &error));
+      g_assert_no_error (error);
+      g_assert_cmpuint (n_matches, ==, 0);
+
+      g_regex_unref (regex);
+    }
+}
+
+static void
+test_match_stats (void)
+{
+  GRegex *regex;
+  GMatchInfo *info;
+  guint64 n_jit = 0, n_interpreted = 0;
+  const gchar *lines[] = { "a1", "b", "c3" };
+
+  g_test_summary ("Test the counts of JIT and interpreted matches");
+
+  regex = g_regex_new ("[a-z][0-9]", G_REGEX_DEFAULT, G_REGEX_MATCH_DEFAULT, NULL);
+  g_regex_get_match_stats (regex, &n_jit, &n_interpreted);
+  g_assert_cmpuint (n_jit, ==, 0);
+  g_assert_cmpuint (n_interpreted, ==, 0);
+
+  g_assert_true (g_regex_match (regex, "a1 b2", G_REGEX_MATCH_DEFAULT, &info));
+  g_assert_true (g_match_info_next (info, NULL));
+  g_match_info_free (info);
+  g_assert_true (g_regex_match_many (regex, lines, NULL, G_N_ELEMENTS (lines),
+                                     G_REGEX_MATCH_DEFAULT, NULL, NULL, NULL));
+
+  /* Without G_REGEX_OPTIMIZE the JIT is never used */
+  g_regex_get_match_stats (regex, &n_jit, &n_interpreted);
+  g_assert_cmpuint (n_jit, ==, 0);
+  g_assert_cmpuint (n_interpreted, ==, 5);
+  g_regex_unref (regex);
+
+  regex = g_regex_new ("[a-z][0-9]", G_REGEX_OPTIMIZE, G_REGEX_MATCH_DEFAULT, NULL);
+  g_assert_true (g_regex_match (regex, "a1", G_REGEX_MATCH_DEFAULT, NULL));
+  g_assert_true (g_regex_match (regex, "a1", G_REGEX_MATCH_ANCHORED, NULL));
+  g_assert_true (g_regex_match_many (regex, lines, NULL, G_N_ELEMENTS (lines),
+                                     G_REGEX_MATCH_DEFAULT, NULL, NULL, NULL));
+  g_assert_true (g_regex_match_all (regex, "a1", G_REGEX_MATCH_DEFAULT, NULL));
+
+  /* Whether the JIT is available depends on the platform */
+  g_regex_get_match_stats (regex, &n_jit, NULL);
+  g_regex_get_match_stats (regex, NULL, &n_interpreted);
+  g_assert_cmpuint (n_jit + n_interpreted, ==, 6);
+  g_assert_cmpuint (n_interpreted, >=, 1);
+  g_regex_unref (regex);
+}
+
+static gpointer
+match_many_thread (gpointer data)
+{
+  GRegex *regex = data;
+  const gchar *lines[] = { "ERROR: disk full", "INFO: all good", "ERROR: again" };
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      gboolean matches[G_N_ELEMENTS (lines)];
+      gsize n_matches = 0;
+
+      g_assert_true (g_regex_match_many (regex, lines, NULL, G_N_ELEMENTS (lines),
+                                         G_REGEX_MATCH_DEFAULT, matches, &n_matches, NULL));
+      g_assert_cmpuint (n_matches, ==, 2);
+      g_assert_true (matches[0]);
+      g_assert_false (matches[1]);
+      g_assert_true (matches[2]);
+      g_assert_true (g_regex_match (regex, lines[0], G_REGEX_MATCH_ANCHORED, NULL));
+    }
+
+  return NULL;
+}
+
+static void
+test_match_threads (void)
+{
+  GRegex *regex;
+  GThread *threads[4];
+  guint64 n_jit = 0, n_interpreted = 0;
+  gsize i;
+
+  g_test_summary ("Test matching a shared regex from several threads");
+
+  regex = g_regex_new ("^ERROR: (\\w+)", G_REGEX_OPTIMIZE, G_REGEX_MATCH_DEFAULT, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("match-many", match_many_thread, regex);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  g_regex_get_match_stats (regex, &n_jit, &n_interpreted);
+  g_assert_cmpuint (n_jit + n_interpreted, ==, G_N_ELEMENTS (threads) * 1000 * 4);
+
+  g_regex_unref (regex);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -2560,6 +2704,9 @@ main (int argc, char *argv[])
   g_test_add_func ("/regex/jit-unsupported-matching", test_jit_unsupported_matching_options);
   g_test_add_func ("/regex/unmatched-named-subpattern", test_unmatched_named_subpattern);
   g_test_add_func ("/regex/compiled-regex-after-jit-failure", test_compiled_regex_after_jit_failure);
+  g_test_add_func ("/regex/match-many", test_match_many);
+  g_test_add_func ("/regex/match-stats", test_match_stats);
+  g_test_add_func ("/regex/match-threads", test_match_threads);
 
   /* TEST_NEW(pattern, compile_opts, match_opts) */
   TEST_NEW("[A-Z]+", G_REGEX_CASELESS | G_REGEX_EXTENDED | G_REGEX_OPTIMIZE, G_REGEX_MATCH_NOTBOL | G_REGEX_MATCH_PARTIAL);
@@ -0,0 +1,216 @@
+/* GLIB - Library of useful routines for C programming
+ *
+ * Copyright 2023 GNOME Foundation Inc.
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <glib/glib.h>
+
+static guint num_iterations = 0;
+
+typedef void (* GrindFunc) (const char *, gsize);
+
+#define GRIND_LOOP_BEGIN                 \
+  {                                      \
+    guint i;                             \
+    for (i = 0; i < num_iterations; i++)
+
+#define GRIND_LOOP_END \
+  }
+
+static void
+grind_str_is_ascii (const char *str, gsize len)
+{
+  GRIND_LOOP_BEGIN
+    g_assert_true (g_str_is_ascii (str));
+  GRIND_LOOP_END;
+}
+
+static void
+grind_ascii_strdown (const char *str, gsize len)
+{
+  GRIND_LOOP_BEGIN
+    g_free (g_ascii_strdown (str, (gssize) len));
+  GRIND_LOOP_END;
+}
+
+static void
+grind_ascii_strup (const char *str, gsize len)
+{
+  GRIND_LOOP_BEGIN
+    g_free (g_ascii_strup (str, (gssize) len));
+  GRIND_LOOP_END;
+}
+
+static void
+grind_strsplit (const char *str, gsize len)
+{
+  GRIND_LOOP_BEGIN
+    g_strfreev (g_strsplit (str, " ", -1));
+  GRIND_LOOP_END;
+}
+
+static void
+grind_strsplit_multibyte (const char *str, gsize len)
+{
+  GRIND_LOOP_BEGIN
+    g_strfreev (g_strsplit (str, "ox", -1));
+  GRIND_LOOP_END;
+}
+
+static void
+grind_strjoinv (const char *str, gsize len)
+{
+  gchar **words = g_strsplit (str, " ", -1);
+
+  GRIND_LOOP_BEGIN
+    g_free (g_strjoinv (" ", words));
+  GRIND_LOOP_END;
+
+  g_strfreev (words);
+}
+
+static void
+grind_has_prefix_suffix (const char *str, gsize len)
+{
+  GRIND_LOOP_BEGIN
+    {
+      g_assert_false (g_str_has_prefix (str, "The quick brown fox jumps over the lazy cat"));
+      g_assert_false (g_str_has_suffix (str, "jumps over the lazy cat"));
+    }
+  GRIND_LOOP_END;
+}
+
+static void
+grind_string_replace (const char *str, gsize len)
+{
+  GString *string = g_string_sized_new (len * 2);
+
+  GRIND_LOOP_BEGIN
+    {
+      g_string_assign (string, str);
+      g_string_replace (string, "the", "a", 0);
+    }
+  GRIND_LOOP_END;
+
+  g_string_free (string, TRUE);
+}
+
+static void
+grind_string_replace_same_length (const char *str, gsize len)
+{
+  GString *string = g_string_sized_new (len);
+
+  GRIND_LOOP_BEGIN
+    {
+      g_string_assign (string, str);
+      g_string_replace (string, "fox", "cat", 0);
+    }
+  GRIND_LOOP_END;
+
+  g_string_free (string, TRUE);
+}
+
+static void
+grind_string_ascii_down (const char *str, gsize len)
+{
+  GString *string = g_string_new (str);
+
+  GRIND_LOOP_BEGIN
+    g_string_ascii_down (string);
+  GRIND_LOOP_END;
+
+  g_string_free (string, TRUE);
+}
+
+typedef struct _GrindData {
+  GrindFunc func;
+  gsize n_sentences;
+} GrindData;
+
+static void
+perform (gconstpointer data)
+{
+  const GrindData *gd = data;
+  GString *text;
+  gsize i;
+  gdouble bytes_ground;
+  gdouble time_elapsed;
+  gdouble result;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < gd->n_sentences; i++)
+    g_string_append (text, "The quick brown fox jumps over the lazy dog ");
+
+  bytes_ground = (gdouble) text->len * num_iterations;
+
+  g_test_timer_start ();
+
+  gd->func (text->str, text->len);
+
+  time_elapsed = g_test_timer_elapsed ();
+
+  result = (bytes_ground / time_elapsed) * 1.0e-6;
+
+  g_test_maximized_result (result, "%7.1f MB/s", result);
+
+  g_string_free (text, TRUE);
+}
+
+static void
+add_cases (const char *path,
+           GrindFunc   func)
+{
+  static const gsize sizes[] = { 1, 16, 256 };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      GrindData *gd;
+      gchar *full_path;
+
+      gd = g_new0 (GrindData, 1);
+      gd->func = func;
+      gd->n_sentences = sizes[i];
+      full_path = g_strdup_printf ("%s/%" G_GSIZE_FORMAT, path, sizes[i]);
+      g_test_add_data_func_full (full_path, gd, perform, g_free);
+      g_free (full_path);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  num_iterations = g_test_perf () ? 100000 : 1;
+
+  add_cases ("/strfuncs/perf/str_is_ascii", grind_str_is_ascii);
+  add_cases ("/strfuncs/perf/ascii_strdown", grind_ascii_strdown);
+  add_cases ("/strfuncs/perf/ascii_strup", grind_ascii_strup);
+  add_cases ("/strfuncs/perf/strsplit", grind_strsplit);
+  add_cases ("/strfuncs/perf/strsplit-multibyte", grind_strsplit_multibyte);
+  add_cases ("/strfuncs/perf/strjoinv", grind_strjoinv);
+  add_cases ("/strfuncs/perf/has_prefix-suffix", grind_has_prefix_suffix);
+  add_cases ("/strfuncs/perf/string_replace", grind_string_replace);
+  add_cases ("/strfuncs/perf/string_replace-same-length", grind_string_replace_same_length);
+  add_cases ("/strfuncs/perf/string_ascii_down", grind_string_ascii_down);
+
+  return g_test_run ();
+}
@@ -493,6 +493,50 @@ test_ascii_strup (void)
   g_free (str);
 }
 
+/* Testing g_ascii_strdown(), g_ascii_strup() and g_str_is_ascii() against a
+ * byte-at-a-time reference, for lengths and alignments which exercise both
+ * the vectorized and the tail code paths */
+static void
+test_ascii_case_lengths (void)
+{
+  const gchar samples[] = "@AMZ[`amz{09 ~\x7f\x80\xc1\xda\xe1\xfa\xff";
+  gchar buf[160];
+  gsize len, offset, i;
+
+  for (len = 0; len < 140; len++)
+    for (offset = 0; offset < 8; offset++)
+      {
+        gchar *src = buf + offset;
+        gchar *down, *up;
+
+        for (i = 0; i < len; i++)
+          src[i] = samples[(i * 7 + offset + len) % (sizeof (samples) - 1)];
+        src[len] = '\0';
+
+        down = g_ascii_strdown (src, (gssize) len);
+        up = g_ascii_strup (src, (gssize) len);
+        for (i = 0; i < len; i++)
+          {
+            g_assert_cmpint (down[i], ==, g_ascii_tolower (src[i]));
+            g_assert_cmpint (up[i], ==, g_ascii_toupper (src[i]));
+          }
+        g_assert_cmpint (down[len], ==, '\0');
+        g_assert_cmpint (up[len], ==, '\0');
+        g_free (down);
+        g_free (up);
+
+        /* Only the last byte is non-ASCII */
+        for (i = 0; i < len; i++)
+          src[i] = samples[i % 12];
+        g_assert_true (g_str_is_ascii (src));
+        if (len > 0)
+          {
+            src[len - 1] = '\xc3';
+            g_assert_false (g_str_is_ascii (src));
+          }
+      }
+}
+
 /* Testing g_strdup() function with various positive and negative cases */
 static void
 test_strdup (void)
@@ -2731,6 +2775,7 @@ main (int   argc,
   g_test_add_func ("/strfuncs/ascii_strdown", test_ascii_strdown);
   g_test_add_func ("/strfuncs/ascii_strdup", test_ascii_strup);
   g_test_add_func ("/strfuncs/ascii_strtod", test_ascii_strtod);
+  g_test_add_func ("/strfuncs/ascii-case-lengths", test_ascii_case_lengths);
   g_test_add_func ("/strfuncs/bounds-check", test_bounds);
   g_test_add_func ("/strfuncs/has-prefix", test_has_prefix);
   g_test_add_func ("/strfuncs/has-prefix-macro", test_has_prefix_macro);
@@ -590,6 +590,18 @@ test_string_up_down (void)
   g_string_up (s);
   g_assert_cmpstr (s->str, ==, "MIXED CASE STRING !?");
 
+  /* Long enough for the vectorized paths, with non-ASCII bytes and an
+   * embedded nul */
+  g_string_assign (s, "The Quick Brown Fox \xc3\x89 Jumps Over The Lazy Dog [@`{]");
+  g_string_append_c (s, '\0');
+  g_string_append (s, "AbC");
+  g_string_ascii_down (s);
+  g_assert_cmpmem (s->str, s->len,
+                   "the quick brown fox \xc3\x89 jumps over the lazy dog [@`{]\0abc", 56);
+  g_string_ascii_up (s);
+  g_assert_cmpmem (s->str, s->len,
+                   "THE QUICK BROWN FOX \xc3\x89 JUMPS OVER THE LAZY DOG [@`{]\0ABC", 56);
+
   g_string_free (s, TRUE);
 }
 
@@ -668,6 +680,12 @@ test_string_replace (void)
       "x", 1 },
     { "", "", "", 0,
       "", 1 },
+    { "foo", "", "-", 2,
+      "-f-oo", 2 },
+    { "abcabcabc", "abc", "xyz", 2,
+      "xyzxyzabc", 2 },
+    { "a, b, c, d", ", ", ",", 0,
+      "a,b,c,d", 3 },
   };
   gsize i;
 
@@ -692,6 +710,32 @@ test_string_replace (void)
     }
 }
 
+static void
+test_string_replace_nul (void)
+{
+  GString *s;
+  guint n;
+
+  /* Like strstr(), matching stops at the first nul, but everything after
+   * it is kept */
+  s = g_string_new_len ("a-b\0a-b", 7);
+
+  n = g_string_replace (s, "-", "+", 0);
+  g_assert_cmpuint (n, ==, 1);
+  g_assert_cmpmem (s->str, s->len, "a+b\0a-b", 7);
+
+  n = g_string_replace (s, "+", "--", 0);
+  g_assert_cmpuint (n, ==, 1);
+  g_assert_cmpmem (s->str, s->len, "a--b\0a-b", 8);
+  g_assert_cmpint (s->str[s->len], ==, '\0');
+
+  n = g_string_replace (s, "", "|", 0);
+  g_assert_cmpuint (n, ==, 5);
+  g_assert_cmpmem (s->str, s->len, "|a|-|-|b|\0a-b", 13);
+
+  g_string_free (s, TRUE);
+}
+
 static void
 test_string_steal (void)
 {
@@ -778,6 +822,7 @@ main (int   argc,
   g_test_add_func ("/string/test-string-set-size", test_string_set_size);
   g_test_add_func ("/string/test-string-to-bytes", test_string_to_bytes);
   g_test_add_func ("/string/test-string-replace", test_string_replace);
+  g_test_add_func ("/string/test-string-replace-nul", test_string_replace_nul);
   g_test_add_func ("/string/test-string-steal", test_string_steal);
   g_test_add_func ("/string/test-string-new-take", test_string_new_take);
   g_test_add_func ("/string/test-string-new-take/null", test_string_new_take_null);
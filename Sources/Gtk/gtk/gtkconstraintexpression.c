@@ -24,6 +24,8 @@
 #include "gtkconstraintexpressionprivate.h"
 #include "gtkconstraintsolverprivate.h"
 
+#include <string.h>
+
 /* {{{ Variables */
 
 typedef enum {
@@ -371,8 +373,8 @@ gtk_constraint_variable_is_dummy (const GtkConstraintVariable *variable)
  * A set of variables.
  */
 struct _GtkConstraintVariableSet {
-  /* List<Variable>, owns a reference */
-  GSequence *set;
+  /* Vec<Variable>, sorted by the id of the variables; owns a reference */
+  GPtrArray *set;
 
   /* Age of the set, to guard against mutations while iterating */
   gint64 age;
@@ -389,7 +391,7 @@ gtk_constraint_variable_set_free (GtkConstraintVariableSet *set)
 {
   g_return_if_fail (set != NULL);
 
-  g_sequence_free (set->set);
+  g_ptr_array_unref (set->set);
 
   g_free (set);
 }
@@ -406,24 +408,43 @@ gtk_constraint_variable_set_new (void)
 {
   GtkConstraintVariableSet *res = g_new (GtkConstraintVariableSet, 1);
 
-  res->set = g_sequence_new ((GDestroyNotify) gtk_constraint_variable_unref);
+  res->set = g_ptr_array_new_with_free_func ((GDestroyNotify) gtk_constraint_variable_unref);
 
   res->age = 0;
 
   return res;
 }
 
-static int
-sort_by_variable_id (gconstpointer a,
-                     gconstpointer b,
-                     gpointer      data)
+/* Finds @variable in the @set; if it is not there, @index_p is set to
+ * the position where it would have to be inserted
+ */
+static gboolean
+gtk_constraint_variable_set_find (GtkConstraintVariableSet *set,
+                                  GtkConstraintVariable *variable,
+                                  guint *index_p)
 {
-  const GtkConstraintVariable *va = a, *vb = b;
+  guint lo = 0, hi = set->set->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+      const GtkConstraintVariable *v = g_ptr_array_index (set->set, mid);
+
+      if (v == variable)
+        {
+          *index_p = mid;
+          return TRUE;
+        }
+
+      if (v->_id < variable->_id)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
 
-  if (va == vb)
-    return 0;
+  *index_p = lo;
 
-  return va->_id - vb->_id;
+  return FALSE;
 }
 
 /*< private >
@@ -444,17 +465,12 @@ gboolean
 gtk_constraint_variable_set_add (GtkConstraintVariableSet *set,
                                  GtkConstraintVariable *variable)
 {
-  GSequenceIter *iter;
+  guint index_;
 
-  iter = g_sequence_search (set->set, variable, sort_by_variable_id, NULL);
-  if (!g_sequence_iter_is_end (iter))
-    {
-      GtkConstraintVariable *v = g_sequence_get (iter);
-      if (v->_id == variable->_id)
-        return FALSE;
-    }
+  if (gtk_constraint_variable_set_find (set, variable, &index_))
+    return FALSE;
 
-  g_sequence_insert_before (iter, gtk_constraint_variable_ref (variable));
+  g_ptr_array_insert (set->set, index_, gtk_constraint_variable_ref (variable));
 
   set->age += 1;
 
@@ -477,12 +493,11 @@ gboolean
 gtk_constraint_variable_set_remove (GtkConstraintVariableSet *set,
                                     GtkConstraintVariable *variable)
 {
-  GSequenceIter *iter;
+  guint index_;
 
-  iter = g_sequence_lookup (set->set, variable, sort_by_variable_id, NULL);
-  if (iter != NULL)
+  if (gtk_constraint_variable_set_find (set, variable, &index_))
     {
-      g_sequence_remove (iter);
+      g_ptr_array_remove_index (set->set, index_);
       set->age += 1;
 
       return TRUE;
@@ -502,19 +517,19 @@ gtk_constraint_variable_set_remove (GtkConstraintVariableSet *set,
 int
 gtk_constraint_variable_set_size (GtkConstraintVariableSet *set)
 {
-  return g_sequence_get_length (set->set);
+  return set->set->len;
 }
 
 gboolean
 gtk_constraint_variable_set_is_empty (GtkConstraintVariableSet *set)
 {
-  return g_sequence_is_empty (set->set);
+  return set->set->len == 0;
 }
 
 gboolean
 gtk_constraint_variable_set_is_singleton (GtkConstraintVariableSet *set)
 {
-  return g_sequence_iter_next (g_sequence_get_begin_iter (set->set)) == g_sequence_get_end_iter (set->set);
+  return set->set->len <= 1;
 }
 
 /*< private >
@@ -525,7 +540,7 @@ gtk_constraint_variable_set_is_singleton (GtkConstraintVariableSet *set)
 /* Keep in sync with GtkConstraintVariableSetIter */
 typedef struct {
   GtkConstraintVariableSet *set;
-  GSequenceIter *iter;
+  gsize index;
   gint64 age;
 } RealVariableSetIter;
 
@@ -548,7 +563,7 @@ gtk_constraint_variable_set_iter_init (GtkConstraintVariableSetIter *iter,
   g_return_if_fail (set != NULL);
 
   riter->set = set;
-  riter->iter = g_sequence_get_begin_iter (set->set);
+  riter->index = 0;
   riter->age = set->age;
 }
 
@@ -572,11 +587,11 @@ gtk_constraint_variable_set_iter_next (GtkConstraintVariableSetIter *iter,
 
   g_assert (riter->age == riter->set->age);
 
-  if (g_sequence_iter_is_end (riter->iter))
+  if (riter->index >= riter->set->set->len)
     return FALSE;
 
-  *variable_p = g_sequence_get (riter->iter);
-  riter->iter = g_sequence_iter_next (riter->iter);
+  *variable_p = g_ptr_array_index (riter->set->set, riter->index);
+  riter->index += 1;
 
   return TRUE;
 }
@@ -628,67 +643,107 @@ gtk_constraint_variable_pair_free (GtkConstraintVariablePair *pair)
  * Term:
  * @variable: a `GtkConstraintVariable`
  * @coefficient: the coefficient applied to the @variable
- * @next: the next term in the expression
- * @prev: the previous term in the expression;
  *
  * A tuple of (@variable, @coefficient) in an equation.
  *
- * The term acquires a reference on the variable.
+ * The term holds a reference on the variable.
  */
-typedef struct _Term Term;
-
-struct _Term {
+typedef struct {
   GtkConstraintVariable *variable;
   double coefficient;
+} Term;
+
+struct _GtkConstraintExpression
+{
+  double constant;
 
-  Term *next;
-  Term *prev;
+  /* Array<Term>, sorted by the id of the variables; rows in the
+   * tableau are sparse, and are mostly walked in full while pivoting,
+   * so we keep the terms packed in a single allocation, and find them
+   * with a binary search, instead of using a hash table with a list
+   * of terms
+   */
+  Term *terms;
+  guint n_terms;
+  guint terms_size;
+
+  /* Used by GtkConstraintExpressionIter to guard against changes
+   * in the expression while iterating
+   */
+  gint64 age;
 };
 
-static Term *
-term_new (GtkConstraintVariable *variable,
-          double coefficient)
+/* Finds the term for @variable; if there is none, @index_p is set
+ * to the position where the term would have to be inserted
+ */
+static gboolean
+gtk_constraint_expression_find_term (const GtkConstraintExpression *self,
+                                     const GtkConstraintVariable *variable,
+                                     guint *index_p)
 {
-  Term *res = g_new (Term, 1);
+  guint lo = 0, hi = self->n_terms;
 
-  res->variable = gtk_constraint_variable_ref (variable);
-  res->coefficient = coefficient;
-  res->next = res->prev = NULL;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+      const GtkConstraintVariable *v = self->terms[mid].variable;
 
-  return res;
+      if (v == variable)
+        {
+          *index_p = mid;
+          return TRUE;
+        }
+
+      if (v->_id < variable->_id)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  *index_p = lo;
+
+  return FALSE;
 }
 
 static void
-term_free (gpointer data)
+gtk_constraint_expression_insert_term (GtkConstraintExpression *self,
+                                       guint index_,
+                                       GtkConstraintVariable *variable,
+                                       double coefficient)
 {
-  Term *term = data;
+  if (self->n_terms == self->terms_size)
+    {
+      self->terms_size = MAX (4, self->terms_size * 2);
+      self->terms = g_renew (Term, self->terms, self->terms_size);
+    }
 
-  if (term == NULL)
-    return;
+  if (index_ < self->n_terms)
+    memmove (&self->terms[index_ + 1], &self->terms[index_], (self->n_terms - index_) * sizeof (Term));
 
-  gtk_constraint_variable_unref (term->variable);
+  self->terms[index_].variable = gtk_constraint_variable_ref (variable);
+  self->terms[index_].coefficient = coefficient;
+  self->n_terms += 1;
 
-  g_free (term);
+  /* Increase the age of the expression, so that we can catch
+   * mutations from within an iteration over the terms
+   */
+  self->age += 1;
 }
 
-struct _GtkConstraintExpression
+static void
+gtk_constraint_expression_remove_term_at (GtkConstraintExpression *self,
+                                          guint index_)
 {
-  double constant;
+  GtkConstraintVariable *variable = self->terms[index_].variable;
 
-  /* HashTable<Variable, Term>; the key is the term's variable,
-   * and the value is owned by the hash table
-   */
-  GHashTable *terms;
+  self->n_terms -= 1;
+  if (index_ < self->n_terms)
+    memmove (&self->terms[index_], &self->terms[index_ + 1], (self->n_terms - index_) * sizeof (Term));
 
-  /* List of terms, in insertion order */
-  Term *first_term;
-  Term *last_term;
+  gtk_constraint_variable_unref (variable);
 
-  /* Used by GtkConstraintExpressionIter to guard against changes
-   * in the expression while iterating
-   */
-  gint64 age;
-};
+  self->age += 1;
+}
 
 /*< private >
  * gtk_constraint_expression_add_term:
@@ -706,84 +761,25 @@ gtk_constraint_expression_add_term (GtkConstraintExpression *self,
                                     GtkConstraintVariable *variable,
                                     double coefficient)
 {
-  Term *term;
+  guint index_;
 
-  if (self->terms == NULL)
+  if (gtk_constraint_expression_find_term (self, variable, &index_))
     {
-      g_assert (self->first_term == NULL && self->last_term == NULL);
-      self->terms = g_hash_table_new_full (NULL, NULL,
-                                           NULL,
-                                           term_free);
+      self->terms[index_].coefficient = coefficient;
+      return;
     }
 
-  term = term_new (variable, coefficient);
-
-  g_hash_table_insert (self->terms, term->variable, term);
-
-  if (self->first_term == NULL)
-    self->first_term = term;
-
-  term->prev = self->last_term;
-
-  if (self->last_term != NULL)
-    self->last_term->next = term;
-
-  self->last_term = term;
-
-  /* Increase the age of the expression, so that we can catch
-   * mutations from within an iteration over the terms
-   */
-  self->age += 1;
+  gtk_constraint_expression_insert_term (self, index_, variable, coefficient);
 }
 
 static void
 gtk_constraint_expression_remove_term (GtkConstraintExpression *self,
                                        GtkConstraintVariable *variable)
 {
-  Term *term, *iter;
+  guint index_;
 
-  if (self->terms == NULL)
-    return;
-
-  term = g_hash_table_lookup (self->terms, variable);
-  if (term == NULL)
-    return;
-
-  /* Keep the variable alive for the duration of the function */
-  gtk_constraint_variable_ref (variable);
-
-  iter = self->first_term;
-  while (iter != NULL)
-    {
-      Term *next = iter->next;
-      Term *prev = iter->prev;
-
-      if (iter == term)
-        {
-          if (prev != NULL)
-            prev->next = next;
-          if (next != NULL)
-            next->prev = prev;
-
-          if (iter == self->first_term)
-            self->first_term = next;
-          if (iter == self->last_term)
-            self->last_term = prev;
-
-          iter->next = NULL;
-          iter->prev = NULL;
-
-          break;
-        }
-
-      iter = next;
-    }
-
-  g_hash_table_remove (self->terms, variable);
-
-  gtk_constraint_variable_unref (variable);
-
-  self->age += 1;
+  if (gtk_constraint_expression_find_term (self, variable, &index_))
+    gtk_constraint_expression_remove_term_at (self, index_);
 }
 
 /*< private >
@@ -801,8 +797,8 @@ gtk_constraint_expression_new (double constant)
 
   res->age = 0;
   res->terms = NULL;
-  res->first_term = NULL;
-  res->last_term = NULL;
+  res->n_terms = 0;
+  res->terms_size = 0;
   res->constant = constant;
 
   return res;
@@ -847,13 +843,17 @@ static void
 gtk_constraint_expression_clear (gpointer data)
 {
   GtkConstraintExpression *self = data;
+  guint i;
 
-  g_clear_pointer (&self->terms, g_hash_table_unref);
+  for (i = 0; i < self->n_terms; i++)
+    gtk_constraint_variable_unref (self->terms[i].variable);
+
+  g_clear_pointer (&self->terms, g_free);
 
   self->age = 0;
   self->constant = 0.0;
-  self->first_term = NULL;
-  self->last_term = NULL;
+  self->n_terms = 0;
+  self->terms_size = 0;
 }
 
 /*< private >
@@ -879,7 +879,7 @@ gtk_constraint_expression_unref (GtkConstraintExpression *expression)
 gboolean
 gtk_constraint_expression_is_constant (const GtkConstraintExpression *expression)
 {
-  return expression->terms == NULL;
+  return expression->n_terms == 0;
 }
 
 /*< private >
@@ -918,17 +918,18 @@ GtkConstraintExpression *
 gtk_constraint_expression_clone (GtkConstraintExpression *expression)
 {
   GtkConstraintExpression *res;
-  Term *iter;
+  guint i;
 
   res = gtk_constraint_expression_new (expression->constant);
 
-  iter = expression->first_term;
-  while (iter != NULL)
-    {
-      gtk_constraint_expression_add_term (res, iter->variable, iter->coefficient);
+  if (expression->n_terms == 0)
+    return res;
 
-      iter = iter->next;
-    }
+  res->terms = g_memdup2 (expression->terms, expression->n_terms * sizeof (Term));
+  res->n_terms = res->terms_size = expression->n_terms;
+
+  for (i = 0; i < res->n_terms; i++)
+    gtk_constraint_variable_ref (res->terms[i].variable);
 
   return res;
 }
@@ -959,37 +960,34 @@ gtk_constraint_expression_add_variable (GtkConstraintExpression *expression,
                                         GtkConstraintVariable *subject,
                                         GtkConstraintSolver *solver)
 {
+  guint index_;
+
   /* If the expression already contains the variable, update the coefficient */
-  if (expression->terms != NULL)
+  if (gtk_constraint_expression_find_term (expression, variable, &index_))
     {
-      Term *t = g_hash_table_lookup (expression->terms, variable);
+      double new_coefficient = expression->terms[index_].coefficient + coefficient;
 
-      if (t != NULL)
+      /* Setting the coefficient to 0 will remove the variable */
+      if (G_APPROX_VALUE (new_coefficient, 0.0, 0.001))
         {
-          double new_coefficient = t->coefficient + coefficient;
-
-          /* Setting the coefficient to 0 will remove the variable */
-          if (G_APPROX_VALUE (new_coefficient, 0.0, 0.001))
-            {
-              /* Update the tableau if needed */
-              if (solver != NULL)
-                gtk_constraint_solver_note_removed_variable (solver, variable, subject);
-
-              gtk_constraint_expression_remove_term (expression, variable);
-            }
-          else
-            {
-              t->coefficient = new_coefficient;
-            }
+          /* Update the tableau if needed */
+          if (solver != NULL)
+            gtk_constraint_solver_note_removed_variable (solver, variable, subject);
 
-          return;
+          gtk_constraint_expression_remove_term_at (expression, index_);
+        }
+      else
+        {
+          expression->terms[index_].coefficient = new_coefficient;
         }
+
+      return;
     }
 
   /* Otherwise, add the variable if the coefficient is non-zero */
   if (!G_APPROX_VALUE (coefficient, 0.0, 0.001))
     {
-      gtk_constraint_expression_add_term (expression, variable, coefficient);
+      gtk_constraint_expression_insert_term (expression, index_, variable, coefficient);
 
       if (solver != NULL)
         gtk_constraint_solver_note_added_variable (solver, variable, subject);
@@ -1029,17 +1027,6 @@ gtk_constraint_expression_set_variable (GtkConstraintExpression *expression,
                                         GtkConstraintVariable *variable,
                                         double coefficient)
 {
-  if (expression->terms != NULL)
-    {
-      Term *t = g_hash_table_lookup (expression->terms, variable);
-
-      if (t != NULL)
-        {
-          t->coefficient = coefficient;
-          return;
-        }
-    }
-
   gtk_constraint_expression_add_term (expression, variable, coefficient);
 }
 
@@ -1076,21 +1063,18 @@ gtk_constraint_expression_add_expression (GtkConstraintExpression *a_expr,
                                           GtkConstraintVariable *subject,
                                           GtkConstraintSolver *solver)
 {
-  Term *iter;
+  guint i;
 
   a_expr->constant += (n * b_expr->constant);
 
-  iter = b_expr->last_term;
-  while (iter != NULL)
+  for (i = 0; i < b_expr->n_terms; i++)
     {
-      Term *next = iter->prev;
+      const Term *t = &b_expr->terms[i];
 
       gtk_constraint_expression_add_variable (a_expr,
-                                              iter->variable, n * iter->coefficient,
+                                              t->variable, n * t->coefficient,
                                               subject,
                                               solver);
-
-      iter = next;
     }
 }
 
@@ -1196,21 +1180,12 @@ GtkConstraintExpression *
 gtk_constraint_expression_multiply_by (GtkConstraintExpression *expression,
                                        double factor)
 {
-  GHashTableIter iter;
-  gpointer value_p;
+  guint i;
 
   expression->constant *= factor;
 
-  if (expression->terms == NULL)
-    return expression;
-
-  g_hash_table_iter_init (&iter, expression->terms);
-  while (g_hash_table_iter_next (&iter, NULL, &value_p))
-    {
-      Term *t = value_p;
-
-      t->coefficient *= factor;
-    }
+  for (i = 0; i < expression->n_terms; i++)
+    expression->terms[i].coefficient *= factor;
 
   return expression;
 }
@@ -1265,17 +1240,18 @@ gtk_constraint_expression_new_subject (GtkConstraintExpression *expression,
                                        GtkConstraintVariable *subject)
 {
   double reciprocal = 1.0;
-  Term *term;
+  gboolean found G_GNUC_UNUSED;
+  guint index_;
 
   g_assert (!gtk_constraint_expression_is_constant (expression));
 
-  term = g_hash_table_lookup (expression->terms, subject);
-  g_assert (term != NULL);
-  g_assert (!G_APPROX_VALUE (term->coefficient, 0.0, 0.001));
+  found = gtk_constraint_expression_find_term (expression, subject, &index_);
+  g_assert (found);
+  g_assert (!G_APPROX_VALUE (expression->terms[index_].coefficient, 0.0, 0.001));
 
-  reciprocal = 1.0 / term->coefficient;
+  reciprocal = 1.0 / expression->terms[index_].coefficient;
 
-  gtk_constraint_expression_remove_term (expression, subject);
+  gtk_constraint_expression_remove_term_at (expression, index_);
   gtk_constraint_expression_multiply_by (expression, -reciprocal);
 
   return reciprocal;
@@ -1329,19 +1305,15 @@ double
 gtk_constraint_expression_get_coefficient (GtkConstraintExpression *expression,
                                            GtkConstraintVariable *variable)
 {
-  const Term *term;
+  guint index_;
 
   g_return_val_if_fail (expression != NULL, 0.0);
   g_return_val_if_fail (variable != NULL, 0.0);
 
-  if (expression->terms == NULL)
+  if (!gtk_constraint_expression_find_term (expression, variable, &index_))
     return 0.0;
 
-  term = g_hash_table_lookup (expression->terms, variable);
-  if (term == NULL)
-    return 0.0;
-
-  return term->coefficient;
+  return expression->terms[index_].coefficient;
 }
 
 /*< private >
@@ -1365,9 +1337,10 @@ gtk_constraint_expression_substitute_out (GtkConstraintExpression *expression,
                                           GtkConstraintSolver *solver)
 {
   double multiplier;
-  Term *iter;
+  Term *terms;
+  guint i, j, n, size;
 
-  if (expression->terms == NULL)
+  if (expression->n_terms == 0)
     return;
 
   multiplier = gtk_constraint_expression_get_coefficient (expression, out_var);
@@ -1375,39 +1348,64 @@ gtk_constraint_expression_substitute_out (GtkConstraintExpression *expression,
 
   expression->constant = expression->constant + multiplier * expr->constant;
 
-  iter = expr->first_term;
-  while (iter != NULL)
+  if (expr->n_terms == 0)
+    return;
+
+  /* Both rows are sorted, so we can merge them in a single pass
+   * into a new array, instead of looking up every term of @expr
+   */
+  size = expression->n_terms + expr->n_terms;
+  terms = g_new (Term, size);
+  i = j = n = 0;
+
+  while (i < expression->n_terms || j < expr->n_terms)
     {
-      GtkConstraintVariable *clv = iter->variable;
-      double coeff = iter->coefficient;
-      Term *next = iter->next;
+      const Term *a = i < expression->n_terms ? &expression->terms[i] : NULL;
+      const Term *b = j < expr->n_terms ? &expr->terms[j] : NULL;
 
-      if (expression->terms != NULL &&
-          g_hash_table_contains (expression->terms, clv))
+      if (b == NULL || (a != NULL && a->variable->_id < b->variable->_id))
+        {
+          terms[n++] = *a;
+          i += 1;
+        }
+      else if (a == NULL || b->variable->_id < a->variable->_id)
         {
-          double old_coefficient = gtk_constraint_expression_get_coefficient (expression, clv);
-          double new_coefficient = old_coefficient + multiplier * coeff;
+          terms[n].variable = gtk_constraint_variable_ref (b->variable);
+          terms[n].coefficient = multiplier * b->coefficient;
+          n += 1;
+          j += 1;
+
+          if (solver != NULL)
+            gtk_constraint_solver_note_added_variable (solver, b->variable, subject);
+        }
+      else
+        {
+          double new_coefficient = a->coefficient + multiplier * b->coefficient;
 
           if (G_APPROX_VALUE (new_coefficient, 0.0, 0.001))
             {
               if (solver != NULL)
-                gtk_constraint_solver_note_removed_variable (solver, clv, subject);
+                gtk_constraint_solver_note_removed_variable (solver, a->variable, subject);
 
-              gtk_constraint_expression_remove_term (expression, clv);
+              gtk_constraint_variable_unref (a->variable);
             }
           else
-            gtk_constraint_expression_set_variable (expression, clv, new_coefficient);
-        }
-      else
-        {
-          gtk_constraint_expression_set_variable (expression, clv, multiplier * coeff);
+            {
+              terms[n].variable = a->variable;
+              terms[n].coefficient = new_coefficient;
+              n += 1;
+            }
 
-          if (solver != NULL)
-            gtk_constraint_solver_note_added_variable (solver, clv, subject);
+          i += 1;
+          j += 1;
         }
-
-      iter = next;
     }
+
+  g_free (expression->terms);
+  expression->terms = terms;
+  expression->n_terms = n;
+  expression->terms_size = size;
+  expression->age += 1;
 }
 
 /*< private >
@@ -1422,23 +1420,18 @@ gtk_constraint_expression_substitute_out (GtkConstraintExpression *expression,
 GtkConstraintVariable *
 gtk_constraint_expression_get_pivotable_variable (GtkConstraintExpression *expression)
 {
-  Term *iter;
+  guint i;
 
-  if (expression->terms == NULL)
+  if (expression->n_terms == 0)
     {
       g_critical ("Expression %p is a constant", expression);
       return NULL;
     }
 
-  iter = expression->first_term;
-  while (iter != NULL)
+  for (i = 0; i < expression->n_terms; i++)
     {
-      Term *next = iter->next;
-
-      if (gtk_constraint_variable_is_pivotable (iter->variable))
-        return iter->variable;
-
-      iter = next;
+      if (gtk_constraint_variable_is_pivotable (expression->terms[i].variable))
+        return expression->terms[i].variable;
     }
 
   return NULL;
@@ -1459,7 +1452,7 @@ gtk_constraint_expression_to_string (const GtkConstraintExpression *expression)
 {
   gboolean needs_plus = FALSE;
   GString *buf;
-  Term *iter;
+  guint i;
 
   if (expression == NULL)
     return g_strdup ("<null>");
@@ -1470,33 +1463,27 @@ gtk_constraint_expression_to_string (const GtkConstraintExpression *expression)
     {
       g_string_append_printf (buf, "%g", expression->constant);
 
-      if (expression->terms != NULL)
+      if (expression->n_terms != 0)
         needs_plus = TRUE;
     }
 
-  if (expression->terms == NULL)
-    return g_string_free (buf, FALSE);
-
-  iter = expression->first_term;
-  while (iter != NULL)
+  for (i = 0; i < expression->n_terms; i++)
     {
-      char *str = gtk_constraint_variable_to_string (iter->variable);
-      Term *next = iter->next;
+      const Term *t = &expression->terms[i];
+      char *str = gtk_constraint_variable_to_string (t->variable);
 
       if (needs_plus)
         g_string_append (buf, " + ");
 
-      if (G_APPROX_VALUE (iter->coefficient, 1.0, 0.001))
+      if (G_APPROX_VALUE (t->coefficient, 1.0, 0.001))
         g_string_append_printf (buf, "%s", str);
       else
-        g_string_append_printf (buf, "(%g * %s)", iter->coefficient, str);
+        g_string_append_printf (buf, "(%g * %s)", t->coefficient, str);
 
       g_free (str);
 
       if (!needs_plus)
         needs_plus = TRUE;
-
-      iter = next;
     }
 
   return g_string_free (buf, FALSE);
@@ -1505,7 +1492,7 @@ gtk_constraint_expression_to_string (const GtkConstraintExpression *expression)
 /* Keep in sync with GtkConstraintExpressionIter */
 typedef struct {
   GtkConstraintExpression *expression;
-  Term *current;
+  gssize current;
   gint64 age;
 } RealExpressionIter;
 
@@ -1525,7 +1512,7 @@ gtk_constraint_expression_iter_init (GtkConstraintExpressionIter *iter,
   RealExpressionIter *riter = REAL_EXPRESSION_ITER (iter);
 
   riter->expression = expression;
-  riter->current = NULL;
+  riter->current = -1;
   riter->age = expression->age;
 }
 
@@ -1550,18 +1537,18 @@ gtk_constraint_expression_iter_next (GtkConstraintExpressionIter *iter,
 
   g_assert (riter->age == riter->expression->age);
 
-  if (riter->current == NULL)
-    riter->current = riter->expression->first_term;
-  else
-    riter->current = riter->current->next;
+  if (riter->current < 0)
+    riter->current = 0;
+  else if (riter->current < riter->expression->n_terms)
+    riter->current += 1;
 
-  if (riter->current != NULL)
-    {
-      *coefficient = riter->current->coefficient;
-      *variable = riter->current->variable;
-    }
+  if (riter->current >= riter->expression->n_terms)
+    return FALSE;
 
-  return riter->current != NULL;
+  *coefficient = riter->expression->terms[riter->current].coefficient;
+  *variable = riter->expression->terms[riter->current].variable;
+
+  return TRUE;
 }
 
 /*< private >
@@ -1585,18 +1572,18 @@ gtk_constraint_expression_iter_prev (GtkConstraintExpressionIter *iter,
 
   g_assert (riter->age == riter->expression->age);
 
-  if (riter->current == NULL)
-    riter->current = riter->expression->last_term;
-  else
-    riter->current = riter->current->prev;
+  if (riter->current < 0)
+    riter->current = riter->expression->n_terms;
 
-  if (riter->current != NULL)
-    {
-      *coefficient = riter->current->coefficient;
-      *variable = riter->current->variable;
-    }
+  if (riter->current == 0)
+    return FALSE;
+
+  riter->current -= 1;
 
-  return riter->current != NULL;
+  *coefficient = riter->expression->terms[riter->current].coefficient;
+  *variable = riter->expression->terms[riter->current].variable;
+
+  return TRUE;
 }
 
 typedef enum {
@@ -139,6 +139,8 @@ gtk_constraint_guide_update_constraint (GtkConstraintGuide *guide,
   if (!solver)
     return;
 
+  gtk_constraint_layout_release_allocation (guide->layout);
+
   if (guide->constraints[index] != NULL)
     {
       gtk_constraint_solver_remove_constraint (solver, guide->constraints[index]);
@@ -263,6 +263,17 @@ struct _GtkConstraintLayout
 
   GListStore *constraints_observer;
   GListStore *guides_observer;
+
+  /* The required stay constraints that keep the layout within the
+   * bounds of its allocation; we keep them installed between
+   * allocations, and move them to the new size, so that the solver
+   * can re-optimize from the previous solution instead of rebuilding
+   * the tableau rows every time
+   */
+  GtkConstraintRef *stay_top;
+  GtkConstraintRef *stay_left;
+  GtkConstraintRef *stay_width;
+  GtkConstraintRef *stay_height;
 };
 
 G_DEFINE_TYPE (GtkConstraintLayoutChild, gtk_constraint_layout_child, GTK_TYPE_LAYOUT_CHILD)
@@ -289,6 +300,34 @@ gtk_constraint_layout_get_solver (GtkConstraintLayout *self)
   return self->solver;
 }
 
+/*< private >
+ * gtk_constraint_layout_release_allocation:
+ * @self: a `GtkConstraintLayout`
+ *
+ * Removes the allocation stay constraints from the solver.
+ *
+ * This must be called before changing the constraints of the layout,
+ * as the required stays may conflict with new required constraints.
+ */
+void
+gtk_constraint_layout_release_allocation (GtkConstraintLayout *self)
+{
+  if (self->stay_width == NULL)
+    return;
+
+  g_assert (self->solver != NULL);
+
+  gtk_constraint_solver_remove_constraint (self->solver, self->stay_width);
+  gtk_constraint_solver_remove_constraint (self->solver, self->stay_height);
+  gtk_constraint_solver_remove_constraint (self->solver, self->stay_top);
+  gtk_constraint_solver_remove_constraint (self->solver, self->stay_left);
+
+  self->stay_width = NULL;
+  self->stay_height = NULL;
+  self->stay_top = NULL;
+  self->stay_left = NULL;
+}
+
 static const char * const attribute_names[] = {
   [GTK_CONSTRAINT_ATTRIBUTE_NONE]     = "none",
   [GTK_CONSTRAINT_ATTRIBUTE_LEFT]     = "left",
@@ -770,6 +809,8 @@ layout_add_constraint (GtkConstraintLayout *self,
   if (solver == NULL)
     return;
 
+  gtk_constraint_layout_release_allocation (self);
+
   attr = gtk_constraint_get_target_attribute (constraint);
   target = gtk_constraint_get_target (constraint);
   if (target == NULL || target == GTK_CONSTRAINT_TARGET (layout_widget))
@@ -928,6 +969,12 @@ gtk_constraint_layout_measure (GtkLayoutManager *manager,
   if (solver == NULL)
     return;
 
+  /* The size of the layout must be free to move while measuring; this
+   * only happens when the size request of the widget changes, as the
+   * measurements are cached, so plain resizes still keep the stays
+   */
+  gtk_constraint_layout_release_allocation (self);
+
   gtk_constraint_solver_freeze (solver);
 
   /* We measure each child in the layout and impose restrictions on the
@@ -1018,17 +1065,17 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
                                 int               baseline)
 {
   GtkConstraintLayout *self = GTK_CONSTRAINT_LAYOUT (manager);
-  GtkConstraintRef *stay_w, *stay_h, *stay_t, *stay_l;
   GtkConstraintSolver *solver;
   GtkConstraintVariable *layout_top, *layout_height;
   GtkConstraintVariable *layout_left, *layout_width;
   GtkWidget *child;
+  gboolean keep_stays;
 
   solver = gtk_constraint_layout_get_solver (self);
   if (solver == NULL)
     return;
 
-  /* We add required stay constraints to ensure that the layout remains
+  /* We add stay constraints to ensure that the layout remains
    * within the bounds of the allocation
    */
   layout_top = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_TOP);
@@ -1036,22 +1083,41 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
   layout_width = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_WIDTH);
   layout_height = get_layout_attribute (self, widget, GTK_CONSTRAINT_ATTRIBUTE_HEIGHT);
 
-  gtk_constraint_variable_set_value (layout_top, 0.0);
-  stay_t = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_top,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
-  gtk_constraint_variable_set_value (layout_left, 0.0);
-  stay_l = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_left,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
-  gtk_constraint_variable_set_value (layout_width, width);
-  stay_w = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_width,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
-  gtk_constraint_variable_set_value (layout_height, height);
-  stay_h = gtk_constraint_solver_add_stay_variable (solver,
-                                                    layout_height,
-                                                    GTK_CONSTRAINT_STRENGTH_REQUIRED);
+  /* The stays are still installed from the previous allocation, so
+   * we only need to move them to the new size; if the new size does
+   * not fit the required constraints of the layout, we start over
+   */
+  if (self->stay_width != NULL &&
+      (!gtk_constraint_solver_update_stay_value (solver, self->stay_width, width) ||
+       !gtk_constraint_solver_update_stay_value (solver, self->stay_height, height)))
+    gtk_constraint_layout_release_allocation (self);
+
+  if (self->stay_width == NULL)
+    {
+      gtk_constraint_variable_set_value (layout_top, 0.0);
+      self->stay_top = gtk_constraint_solver_add_stay_variable (solver,
+                                                                layout_top,
+                                                                GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_variable_set_value (layout_left, 0.0);
+      self->stay_left = gtk_constraint_solver_add_stay_variable (solver,
+                                                                 layout_left,
+                                                                 GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_variable_set_value (layout_width, width);
+      self->stay_width = gtk_constraint_solver_add_stay_variable (solver,
+                                                                  layout_width,
+                                                                  GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_variable_set_value (layout_height, height);
+      self->stay_height = gtk_constraint_solver_add_stay_variable (solver,
+                                                                   layout_height,
+                                                                   GTK_CONSTRAINT_STRENGTH_REQUIRED);
+    }
+
+  /* The solver drops required stays that cannot be satisfied, so
+   * we cannot move them later on
+   */
+  keep_stays = G_APPROX_VALUE (gtk_constraint_variable_get_value (layout_width), width, 0.001) &&
+               G_APPROX_VALUE (gtk_constraint_variable_get_value (layout_height), height, 0.001);
+
   GTK_DEBUG (LAYOUT, "Layout [%p]: { .x: %g, .y: %g, .w: %g, .h: %g }",
                      self,
                      gtk_constraint_variable_get_value (layout_left),
@@ -1123,11 +1189,8 @@ gtk_constraint_layout_allocate (GtkLayoutManager *manager,
     }
 #endif
 
-  /* The allocation stay constraints are not needed any more */
-  gtk_constraint_solver_remove_constraint (solver, stay_w);
-  gtk_constraint_solver_remove_constraint (solver, stay_h);
-  gtk_constraint_solver_remove_constraint (solver, stay_t);
-  gtk_constraint_solver_remove_constraint (solver, stay_l);
+  if (!keep_stays)
+    gtk_constraint_layout_release_allocation (self);
 }
 
 static void
@@ -1167,6 +1230,8 @@ gtk_constraint_layout_unroot (GtkLayoutManager *manager)
   GHashTableIter iter;
   gpointer key;
 
+  gtk_constraint_layout_release_allocation (self);
+
   /* Detach all constraints we're holding, as we're removing the layout
    * from the global solver, and they should not contribute to the other
    * layouts
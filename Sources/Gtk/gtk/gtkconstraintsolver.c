@@ -207,6 +207,14 @@ typedef struct {
 
 typedef struct {
   GtkConstraintRef *constraint;
+
+  /* Required stays use a dummy marker variable for
+   * both error variables
+   */
+  GtkConstraintVariable *eplus;
+  GtkConstraintVariable *eminus;
+
+  double prev_constant;
 } StayInfo;
 
 struct _GtkConstraintSolver
@@ -250,6 +258,7 @@ struct _GtkConstraintSolver
   int dummy_counter;
   int optimize_count;
   int freeze_count;
+  int stay_update_count;
 
   /* Bitfields; keep at the end */
   guint auto_solve : 1;
@@ -344,6 +353,7 @@ gtk_constraint_solver_init (GtkConstraintSolver *self)
 
   self->slack_counter = 0;
   self->dummy_counter = 0;
+  self->stay_update_count = 0;
   self->artificial_counter = 0;
   self->freeze_count = 0;
 
@@ -976,10 +986,9 @@ gtk_constraint_solver_new_expression (GtkConstraintSolver *self,
           gtk_constraint_solver_insert_error_variable (self, constraint, eminus);
 
           if (constraint->is_stay)
-            {
-              g_ptr_array_add (self->stay_error_vars, gtk_constraint_variable_pair_new (eplus, eminus));
-            }
-          else if (constraint->is_edit)
+            g_ptr_array_add (self->stay_error_vars, gtk_constraint_variable_pair_new (eplus, eminus));
+
+          if (constraint->is_stay || constraint->is_edit)
             {
               if (eplus_p != NULL)
                 *eplus_p = eplus;
@@ -1000,7 +1009,10 @@ gtk_constraint_solver_new_expression (GtkConstraintSolver *self,
   return expr;
 }
 
-static void
+/* Returns FALSE if the required constraints cannot be satisfied, in
+ * which case the tableau is left in an infeasible state
+ */
+static gboolean
 gtk_constraint_solver_dual_optimize (GtkConstraintSolver *self)
 {
   GtkConstraintExpression *z_row = g_hash_table_lookup (self->rows, self->objective);
@@ -1050,13 +1062,15 @@ gtk_constraint_solver_dual_optimize (GtkConstraintSolver *self)
         }
 
       if (ratio == DBL_MAX)
-        g_critical ("INTERNAL: ratio == DBL_MAX in dual_optimize");
+        return FALSE;
 
       gtk_constraint_solver_pivot (self, entry_var, exit_var);
     }
 
   GTK_DEBUG (CONSTRAINTS, "dual_optimize.time := %.3f ms",
                           (float) (g_get_monotonic_time () - start_time) / 1000.f);
+
+  return TRUE;
 }
 
 static void
@@ -1329,6 +1343,9 @@ gtk_constraint_solver_add_constraint_internal (GtkConstraintSolver *self,
       StayInfo *si = g_new (StayInfo, 1);
 
       si->constraint = constraint;
+      si->eplus = eplus;
+      si->eminus = eminus;
+      si->prev_constant = prev_constant;
 
       g_hash_table_insert (self->stay_var_map, constraint->variable, si);
     }
@@ -1500,7 +1517,8 @@ gtk_constraint_solver_resolve (GtkConstraintSolver *solver)
 
   g_return_if_fail (GTK_IS_CONSTRAINT_SOLVER (solver));
 
-  gtk_constraint_solver_dual_optimize (solver);
+  if (!gtk_constraint_solver_dual_optimize (solver))
+    g_critical ("INTERNAL: ratio == DBL_MAX in dual_optimize");
   gtk_constraint_solver_set_external_variables (solver);
 
   g_ptr_array_set_size (solver->infeasible_rows, 0);
@@ -1669,6 +1687,135 @@ gtk_constraint_solver_remove_stay_variable (GtkConstraintSolver *self,
   gtk_constraint_solver_remove_constraint (self, si->constraint);
 }
 
+/* The value of @variable in the current basic solution of the tableau */
+static double
+get_tableau_value (GtkConstraintSolver   *self,
+                   GtkConstraintVariable *variable)
+{
+  GtkConstraintExpression *expr = g_hash_table_lookup (self->rows, variable);
+
+  if (expr == NULL)
+    return 0.0;
+
+  return gtk_constraint_expression_get_constant (expr);
+}
+
+/*< private >
+ * gtk_constraint_solver_update_stay_value:
+ * @self: a `GtkConstraintSolver`
+ * @stay: a stay constraint
+ * @value: the new value of the stay variable
+ *
+ * Moves the anchor of a stay constraint to @value.
+ *
+ * This is equivalent to removing @stay and adding a new stay constraint
+ * with the same strength on the same variable, but instead of rebuilding
+ * the tableau rows for the constraint it only shifts the constants of
+ * the rows that depend on it, and re-optimizes the tableau from the
+ * current solution.
+ *
+ * If the solver is frozen, the re-optimization is deferred until
+ * gtk_constraint_solver_thaw().
+ *
+ * Returns: %FALSE if @stay is required, and @value cannot be satisfied
+ *   together with the other required constraints; the stay keeps its
+ *   previous value in that case
+ */
+gboolean
+gtk_constraint_solver_update_stay_value (GtkConstraintSolver *self,
+                                         GtkConstraintRef *stay,
+                                         double value)
+{
+  StayInfo *si;
+  double delta;
+
+  g_return_val_if_fail (GTK_IS_CONSTRAINT_SOLVER (self), FALSE);
+  g_return_val_if_fail (stay != NULL && stay->is_stay, FALSE);
+
+  si = g_hash_table_lookup (self->stay_var_map, stay->variable);
+  if (si == NULL || si->constraint != stay || si->eplus == NULL)
+    {
+      g_critical ("Updating the value of an unknown stay constraint");
+      return FALSE;
+    }
+
+  /* Non-required stays are moved to the current value of their variable
+   * every time the solver resets the stay constants, so we need to get
+   * the current anchor out of the tableau, from:
+   *
+   *   anchor - variable - eplus + eminus = 0
+   */
+  if (si->eplus != si->eminus)
+    si->prev_constant = get_tableau_value (self, stay->variable)
+                      + get_tableau_value (self, si->eplus)
+                      - get_tableau_value (self, si->eminus);
+
+  delta = value - si->prev_constant;
+  if (delta == 0.0)
+    return TRUE;
+
+  si->prev_constant = value;
+  gtk_constraint_expression_set_constant (stay->expression, value);
+
+  self->stay_update_count += 1;
+
+  /* Required stays use the same dummy marker for both error variables;
+   * the dummy is added to the row like the minus error variable of a
+   * non-required stay, so that is the only one we pass along
+   */
+  if (si->eplus == si->eminus)
+    gtk_constraint_solver_delta_edit_constant (self, delta, NULL, si->eminus);
+  else
+    gtk_constraint_solver_delta_edit_constant (self, delta, si->eplus, si->eminus);
+
+  self->needs_solving = TRUE;
+
+  if (self->auto_solve)
+    {
+      gboolean res = TRUE;
+
+      if (!gtk_constraint_solver_dual_optimize (self))
+        {
+          GHashTableIter iter;
+          gpointer key_p, value_p;
+
+          GTK_DEBUG (CONSTRAINTS, "Unable to satisfy a required stay (update): %g", value);
+
+          /* Move the stay back; the dual simplex keeps the tableau
+           * optimal, so we only need to make it feasible again, but
+           * the pivots so far may have left infeasible rows that do
+           * not depend on the stay
+           */
+          si->prev_constant -= delta;
+          gtk_constraint_expression_set_constant (stay->expression, si->prev_constant);
+          if (si->eplus == si->eminus)
+            gtk_constraint_solver_delta_edit_constant (self, -delta, NULL, si->eminus);
+          else
+            gtk_constraint_solver_delta_edit_constant (self, -delta, si->eplus, si->eminus);
+
+          g_hash_table_iter_init (&iter, self->rows);
+          while (g_hash_table_iter_next (&iter, &key_p, &value_p))
+            {
+              if (gtk_constraint_variable_is_restricted (key_p) &&
+                  gtk_constraint_expression_get_constant (value_p) < 0.0)
+                g_ptr_array_add (self->infeasible_rows, key_p);
+            }
+
+          if (!gtk_constraint_solver_dual_optimize (self))
+            g_critical ("INTERNAL: ratio == DBL_MAX in dual_optimize");
+
+          res = FALSE;
+        }
+
+      gtk_constraint_solver_set_external_variables (self);
+      g_ptr_array_set_size (self->infeasible_rows, 0);
+
+      return res;
+    }
+
+  return TRUE;
+}
+
 /*< private >
  * gtk_constraint_solver_add_edit_variable:
  * @self: a `GtkConstraintSolver`
@@ -1775,11 +1922,12 @@ gtk_constraint_solver_remove_constraint (GtkConstraintSolver *self,
         {
           GtkConstraintExpression *e = g_hash_table_lookup (self->rows, v);
 
+          /* Take the error variables out of the objective function */
           if (e == NULL)
             {
               gtk_constraint_expression_add_variable (z_row,
                                                       v,
-                                                      constraint->strength,
+                                                      -constraint->strength,
                                                       self->objective,
                                                       self);
             }
@@ -1787,7 +1935,7 @@ gtk_constraint_solver_remove_constraint (GtkConstraintSolver *self,
             {
               gtk_constraint_expression_add_expression (z_row,
                                                         e,
-                                                        constraint->strength,
+                                                        -constraint->strength,
                                                         self->objective,
                                                         self);
             }
@@ -2111,6 +2259,7 @@ gtk_constraint_solver_clear (GtkConstraintSolver *solver)
 
   solver->slack_counter = 0;
   solver->dummy_counter = 0;
+  solver->stay_update_count = 0;
   solver->artificial_counter = 0;
   solver->freeze_count = 0;
 
@@ -2215,6 +2364,7 @@ gtk_constraint_solver_statistics (GtkConstraintSolver *solver)
   g_string_append_printf (buf, "Dummy vars: %d\n", solver->dummy_counter);
   g_string_append_printf (buf, "Stay vars: %d\n", g_hash_table_size (solver->stay_var_map));
   g_string_append_printf (buf, "Optimize count: %d\n", solver->optimize_count);
+  g_string_append_printf (buf, "Stay updates: %d\n", solver->stay_update_count);
   g_string_append_printf (buf, "Rows: %d\n", g_hash_table_size (solver->rows));
   g_string_append_printf (buf, "Columns: %d\n", g_hash_table_size (solver->columns));
 
@@ -67,6 +67,11 @@ void
 gtk_constraint_solver_remove_stay_variable (GtkConstraintSolver   *solver,
                                             GtkConstraintVariable *variable);
 
+gboolean
+gtk_constraint_solver_update_stay_value (GtkConstraintSolver   *solver,
+                                         GtkConstraintRef      *stay,
+                                         double                 value);
+
 gboolean
 gtk_constraint_solver_has_stay_variable (GtkConstraintSolver   *solver,
                                          GtkConstraintVariable *variable);
@@ -125,6 +125,8 @@ static int invalidated_nodes;
 static int created_styles;
 static guint invalidated_nodes_counter;
 static guint created_styles_counter;
+static guint style_cache_hits_counter;
+static guint style_cache_bytes_saved_counter;
 
 static void
 gtk_css_node_set_invalid (GtkCssNode *node,
@@ -304,6 +306,16 @@ may_use_global_parent_cache (GtkCssNode *node)
   return TRUE;
 }
 
+/* The styles of the children of a root node only depend on its
+ * declaration and its style provider, unless it is animated.
+ */
+static gboolean
+may_share_root_cache (GtkCssNode *node)
+{
+  return node->parent == NULL &&
+         GTK_IS_CSS_STATIC_STYLE (node->style);
+}
+
 static GtkCssStyle *
 lookup_in_global_parent_cache (GtkCssNode                  *node,
                                const GtkCssNodeDeclaration *decl)
@@ -316,6 +328,12 @@ lookup_in_global_parent_cache (GtkCssNode                  *node,
       !may_use_global_parent_cache (node))
     return NULL;
 
+  /* Another root node that looks the same may have cached styles
+   * for its children already, so pick up its cache. */
+  if (parent->cache == NULL && may_share_root_cache (parent))
+    parent->cache = gtk_css_node_style_cache_lookup_root (gtk_css_node_get_declaration (parent),
+                                                          gtk_css_node_get_style_provider (parent));
+
   if (parent->cache == NULL)
     return NULL;
 
@@ -346,7 +364,14 @@ store_in_global_parent_cache (GtkCssNode                  *node,
     return;
 
   if (parent->cache == NULL)
-    parent->cache = gtk_css_node_style_cache_new (parent->style);
+    {
+      if (may_share_root_cache (parent))
+        parent->cache = gtk_css_node_style_cache_new_root (parent->style,
+                                                           gtk_css_node_get_declaration (parent),
+                                                           gtk_css_node_get_style_provider (parent));
+      else
+        parent->cache = gtk_css_node_style_cache_new (parent->style);
+    }
 
   node->cache = gtk_css_node_style_cache_insert (parent->cache,
                                                  (GtkCssNodeDeclaration *) decl,
@@ -605,6 +630,8 @@ gtk_css_node_class_init (GtkCssNodeClass *klass)
     {
       invalidated_nodes_counter = gdk_profiler_define_int_counter ("invalidated-nodes", "CSS Node Invalidations");
       created_styles_counter = gdk_profiler_define_int_counter ("created-styles", "CSS Style Creations");
+      style_cache_hits_counter = gdk_profiler_define_int_counter ("style-cache-hits", "CSS Style Cache Hits");
+      style_cache_bytes_saved_counter = gdk_profiler_define_int_counter ("style-cache-bytes-saved", "CSS Style Cache Bytes Saved");
     }
 }
 
@@ -1363,9 +1390,15 @@ gtk_css_node_validate (GtkCssNode *cssnode)
 
   if (GDK_PROFILER_IS_RUNNING)
     {
+      GtkCssNodeStyleCacheStats stats;
+
+      gtk_css_node_style_cache_get_stats (&stats);
+
       gdk_profiler_end_mark (before,  "css validation", "");
       gdk_profiler_set_int_counter (invalidated_nodes_counter, invalidated_nodes);
       gdk_profiler_set_int_counter (created_styles_counter, created_styles);
+      gdk_profiler_set_int_counter (style_cache_hits_counter, stats.n_hits);
+      gdk_profiler_set_int_counter (style_cache_bytes_saved_counter, stats.bytes_saved);
       invalidated_nodes = 0;
       created_styles = 0;
     }
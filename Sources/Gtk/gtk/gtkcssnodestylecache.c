@@ -21,17 +21,94 @@
 
 #include "gtkdebug.h"
 #include "gtkcssstaticstyleprivate.h"
+#include "gtkstyleproviderprivate.h"
 
 struct _GtkCssNodeStyleCache {
-  guint        ref_count;
-  GtkCssStyle *style;
-  GHashTable  *children;
+  guint                  ref_count;
+  GtkCssStyle           *style;
+  GHashTable            *children;
+  gsize                  style_size;
+
+  /* only set for caches of root nodes, see below */
+  GtkCssNodeDeclaration *decl;
+  GtkStyleProvider      *provider;
+  guint                  generation;
 };
 
+/* Caches form a tree that mirrors the node tree: the cache of a node is
+ * the one its parent's cache has stored for the node's declaration, so
+ * nodes only share caches when their whole ancestor chains match.
+ *
+ * Root nodes have no ancestors, so caches of roots are hash-consed on
+ * the root's declaration and its style provider, including the
+ * provider's generation so that caches from before a theme change are
+ * never picked up again. That way all windows, popovers and other
+ * toplevels that look the same share one tree of caches. The table
+ * does not own the caches, they remove themselves when the last
+ * reference goes away.
+ */
+static GHashTable *root_caches;
+static GtkCssNodeStyleCacheStats stats;
+
 #define UNPACK_DECLARATION(packed) ((GtkCssNodeDeclaration *) (GPOINTER_TO_SIZE (packed) & ~0x3))
 #define UNPACK_FLAGS(packed) (GPOINTER_TO_SIZE (packed) & 0x3)
 #define PACK(decl, first_child, last_child) GSIZE_TO_POINTER (GPOINTER_TO_SIZE (decl) | ((first_child) ? 0x2 : 0) | ((last_child) ? 0x1 : 0))
 
+static guint
+gtk_css_node_style_cache_root_hash (gconstpointer item)
+{
+  const GtkCssNodeStyleCache *cache = item;
+
+  return gtk_css_node_declaration_hash (cache->decl) ^
+         (g_direct_hash (cache->provider) << 1) ^
+         cache->generation;
+}
+
+static gboolean
+gtk_css_node_style_cache_root_equal (gconstpointer item1,
+                                     gconstpointer item2)
+{
+  const GtkCssNodeStyleCache *cache1 = item1;
+  const GtkCssNodeStyleCache *cache2 = item2;
+
+  return cache1->provider == cache2->provider &&
+         cache1->generation == cache2->generation &&
+         gtk_css_node_declaration_equal (cache1->decl, cache2->decl);
+}
+
+static gsize
+gtk_css_node_style_cache_compute_style_size (GtkCssStyle *style)
+{
+  GtkCssValues *groups[] = {
+    (GtkCssValues *) style->core,
+    (GtkCssValues *) style->background,
+    (GtkCssValues *) style->border,
+    (GtkCssValues *) style->icon,
+    (GtkCssValues *) style->outline,
+    (GtkCssValues *) style->font,
+    (GtkCssValues *) style->font_variant,
+    (GtkCssValues *) style->animation,
+    (GtkCssValues *) style->transition,
+    (GtkCssValues *) style->size,
+    (GtkCssValues *) style->other,
+  };
+  gsize size;
+  guint i;
+
+  size = sizeof (GtkCssStaticStyle);
+
+  /* Only count value groups that were computed for this style,
+   * inherited and initial groups are shared already.
+   */
+  for (i = 0; i < G_N_ELEMENTS (groups); i++)
+    {
+      if (groups[i] && groups[i]->ref_count == 1)
+        size += gtk_css_values_get_size (groups[i]);
+    }
+
+  return size;
+}
+
 GtkCssNodeStyleCache *
 gtk_css_node_style_cache_new (GtkCssStyle *style)
 {
@@ -42,6 +119,75 @@ gtk_css_node_style_cache_new (GtkCssStyle *style)
   result->ref_count = 1;
   result->style = g_object_ref (style);
 
+  stats.n_caches++;
+
+  return result;
+}
+
+/*
+ * gtk_css_node_style_cache_lookup_root:
+ * @decl: the declaration of the root node
+ * @provider: the style provider of the root node
+ *
+ * Looks up the cache of another root node with the same declaration
+ * and style provider.
+ *
+ * Returns: (transfer full) (nullable): the cache or %NULL if none exists
+ */
+GtkCssNodeStyleCache *
+gtk_css_node_style_cache_lookup_root (const GtkCssNodeDeclaration *decl,
+                                      GtkStyleProvider            *provider)
+{
+  GtkCssNodeStyleCache key = { 0, };
+  GtkCssNodeStyleCache *result;
+
+  if (root_caches == NULL)
+    return NULL;
+
+  key.decl = (GtkCssNodeDeclaration *) decl;
+  key.provider = provider;
+  key.generation = gtk_style_provider_get_generation (provider);
+
+  result = g_hash_table_lookup (root_caches, &key);
+  if (result == NULL)
+    return NULL;
+
+  stats.shared_hits++;
+
+  return gtk_css_node_style_cache_ref (result);
+}
+
+/*
+ * gtk_css_node_style_cache_new_root:
+ * @style: the style of the root node
+ * @decl: the declaration of the root node
+ * @provider: the style provider of the root node
+ *
+ * Creates the cache for children of a root node and makes it
+ * available to gtk_css_node_style_cache_lookup_root().
+ *
+ * Returns: (transfer full): the new cache
+ */
+GtkCssNodeStyleCache *
+gtk_css_node_style_cache_new_root (GtkCssStyle                 *style,
+                                   const GtkCssNodeDeclaration *decl,
+                                   GtkStyleProvider            *provider)
+{
+  GtkCssNodeStyleCache *result;
+
+  result = gtk_css_node_style_cache_new (style);
+
+  result->decl = gtk_css_node_declaration_ref ((GtkCssNodeDeclaration *) decl);
+  result->provider = g_object_ref (provider);
+  result->generation = gtk_style_provider_get_generation (provider);
+
+  if (root_caches == NULL)
+    root_caches = g_hash_table_new (gtk_css_node_style_cache_root_hash,
+                                    gtk_css_node_style_cache_root_equal);
+
+  /* If an equal root cache exists already, the newest one wins */
+  g_hash_table_replace (root_caches, result, result);
+
   return result;
 }
 
@@ -61,6 +207,16 @@ gtk_css_node_style_cache_unref (GtkCssNodeStyleCache *cache)
   if (cache->ref_count > 0)
     return;
 
+  stats.n_caches--;
+
+  if (cache->decl)
+    {
+      if (g_hash_table_lookup (root_caches, cache) == cache)
+        g_hash_table_remove (root_caches, cache);
+      gtk_css_node_declaration_unref (cache->decl);
+      g_object_unref (cache->provider);
+    }
+
   g_object_unref (cache->style);
   if (cache->children)
     g_hash_table_unref (cache->children);
@@ -154,6 +310,9 @@ gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
                                               (GDestroyNotify) gtk_css_node_style_cache_unref);
 
   result = gtk_css_node_style_cache_new (style);
+  result->style_size = gtk_css_node_style_cache_compute_style_size (style);
+
+  stats.n_stored++;
 
   g_hash_table_insert (parent->children,
                        PACK (gtk_css_node_declaration_ref (decl), is_first, is_last),
@@ -170,6 +329,8 @@ gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache        *parent,
 {
   GtkCssNodeStyleCache *result;
 
+  stats.n_lookups++;
+
   if (parent->children == NULL)
     return NULL;
 
@@ -177,6 +338,21 @@ gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache        *parent,
   if (result == NULL)
     return NULL;
 
+  stats.n_hits++;
+  stats.bytes_saved += result->style_size;
+
   return gtk_css_node_style_cache_ref (result);
 }
 
+/*
+ * gtk_css_node_style_cache_get_stats:
+ * @out_stats: (out caller-allocates): return location for the statistics
+ *
+ * Retrieves the process-wide statistics of the style cache.
+ */
+void
+gtk_css_node_style_cache_get_stats (GtkCssNodeStyleCacheStats *out_stats)
+{
+  *out_stats = stats;
+}
+
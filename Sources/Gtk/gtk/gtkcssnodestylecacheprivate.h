@@ -19,12 +19,28 @@
 
 #include "gtkcssnodedeclarationprivate.h"
 #include "gtkcssstyleprivate.h"
+#include "gtkstyleprovider.h"
 
 G_BEGIN_DECLS
 
 typedef struct _GtkCssNodeStyleCache GtkCssNodeStyleCache;
+typedef struct _GtkCssNodeStyleCacheStats GtkCssNodeStyleCacheStats;
+
+struct _GtkCssNodeStyleCacheStats {
+  guint64 n_lookups;    /* lookups of a child style */
+  guint64 n_hits;       /* lookups that found a computed style */
+  guint64 n_stored;     /* computed styles stored in the cache */
+  guint64 shared_hits;  /* caches of root nodes reused for another root node */
+  guint64 bytes_saved;  /* approximate size of the styles that were not recomputed */
+  guint   n_caches;     /* caches currently alive */
+};
 
 GtkCssNodeStyleCache *  gtk_css_node_style_cache_new            (GtkCssStyle            *style);
+GtkCssNodeStyleCache *  gtk_css_node_style_cache_new_root       (GtkCssStyle                 *style,
+                                                                 const GtkCssNodeDeclaration *decl,
+                                                                 GtkStyleProvider            *provider);
+GtkCssNodeStyleCache *  gtk_css_node_style_cache_lookup_root    (const GtkCssNodeDeclaration *decl,
+                                                                 GtkStyleProvider            *provider);
 GtkCssNodeStyleCache *  gtk_css_node_style_cache_ref            (GtkCssNodeStyleCache   *cache);
 void                    gtk_css_node_style_cache_unref          (GtkCssNodeStyleCache   *cache);
 
@@ -40,5 +56,7 @@ GtkCssNodeStyleCache *  gtk_css_node_style_cache_lookup         (GtkCssNodeStyle
                                                                  gboolean                     is_first,
                                                                  gboolean                     is_last);
 
+void                    gtk_css_node_style_cache_get_stats      (GtkCssNodeStyleCacheStats   *out_stats);
+
 G_END_DECLS
 
@@ -805,6 +805,12 @@ void gtk_css_values_unref (GtkCssValues *values)
     gtk_css_values_free (values);
 }
 
+gsize
+gtk_css_values_get_size (GtkCssValues *values)
+{
+  return VALUES_SIZE (values->type);
+}
+
 GtkCssValues *
 gtk_css_values_copy (GtkCssValues *values)
 {
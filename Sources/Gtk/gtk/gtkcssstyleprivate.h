@@ -271,6 +271,7 @@ PangoFontDescription *  gtk_css_style_get_pango_font            (GtkCssStyle
 GtkCssValues *gtk_css_values_new   (GtkCssValuesType  type);
 GtkCssValues *gtk_css_values_ref   (GtkCssValues     *values);
 void          gtk_css_values_unref (GtkCssValues     *values);
+gsize         gtk_css_values_get_size (GtkCssValues  *values);
 GtkCssValues *gtk_css_values_copy  (GtkCssValues     *values);
 
 void gtk_css_core_values_compute_changes_and_affects (GtkCssStyle *style1,
@@ -87,6 +87,7 @@ struct _GtkGridView
 
   GtkListItemManager *item_manager;
   GtkListItemFactory *factory;
+  GtkListItemFactory *pool_factory; /* factory held in the row pool */
   guint min_columns;
   guint max_columns;
   gboolean single_click_activate;
@@ -267,18 +268,42 @@ gtk_grid_view_is_inert (GtkGridView *self)
          gtk_widget_get_root (widget) == NULL;
 }
 
+static void
+gtk_grid_view_set_pool_factory (GtkGridView        *self,
+                                GtkListItemFactory *factory)
+{
+  GtkListItemFactory *old_factory = self->pool_factory;
+
+  if (factory == old_factory)
+    return;
+
+  /* Rows are shared with other views through a pool, which only keeps
+   * rows of factories that a view is using or used until recently. */
+  if (factory)
+    gtk_list_item_widget_pool_hold (g_object_ref (factory));
+  self->pool_factory = factory;
+  if (old_factory)
+    {
+      gtk_list_item_widget_pool_release (old_factory);
+      g_object_unref (old_factory);
+    }
+}
+
 static void
 gtk_grid_view_update_factories_with (GtkGridView        *self,
                                      GtkListItemFactory *factory)
 {
   GtkListTile *tile;
 
+  gtk_grid_view_set_pool_factory (self, factory);
+
   for (tile = gtk_list_item_manager_get_first (self->item_manager);
        tile != NULL;
        tile = gtk_rb_tree_node_get_next (tile))
     {
+      /* Rows of other views with the factory may be waiting in the pool */
       if (tile->widget)
-        gtk_list_factory_widget_set_factory (GTK_LIST_FACTORY_WIDGET (tile->widget), factory);
+        tile->widget = gtk_list_item_widget_switch_factory (GTK_LIST_ITEM_WIDGET (tile->widget), factory);
     }
 }
 
@@ -307,9 +332,9 @@ gtk_grid_view_create_list_widget (GtkListBase *base)
   else
     factory = self->factory;
 
-  result = gtk_list_item_widget_new (factory,
-                                     "child",
-                                     GTK_ACCESSIBLE_ROLE_GRID_CELL);
+  result = gtk_list_item_widget_new_recycled (factory,
+                                              "child",
+                                              GTK_ACCESSIBLE_ROLE_GRID_CELL);
 
   gtk_list_factory_widget_set_single_click_activate (GTK_LIST_FACTORY_WIDGET (result), self->single_click_activate);
 
@@ -951,6 +976,7 @@ gtk_grid_view_dispose (GObject *object)
 
   self->item_manager = NULL;
 
+  gtk_grid_view_set_pool_factory (self, NULL);
   g_clear_object (&self->factory);
 
   G_OBJECT_CLASS (gtk_grid_view_parent_class)->dispose (object);
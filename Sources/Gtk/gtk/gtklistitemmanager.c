@@ -75,6 +75,16 @@ gtk_list_item_change_init (GtkListItemChange *change)
   g_queue_init (&change->recycled_headers);
 }
 
+static void
+gtk_list_item_change_dispose_item (gpointer widget)
+{
+  /* Give rows to other views using the same factory */
+  if (GTK_IS_LIST_ITEM_WIDGET (widget))
+    gtk_list_item_widget_recycle (widget);
+  else
+    gtk_widget_unparent (widget);
+}
+
 static void
 gtk_list_item_change_finish (GtkListItemChange *change)
 {
@@ -83,7 +93,7 @@ gtk_list_item_change_finish (GtkListItemChange *change)
   g_clear_pointer (&change->deleted_items, g_hash_table_destroy);
 
   while ((widget = g_queue_pop_head (&change->recycled_items)))
-    gtk_widget_unparent (widget);
+    gtk_list_item_change_dispose_item (widget);
   while ((widget = g_queue_pop_head (&change->recycled_headers)))
     gtk_widget_unparent (widget);
 }
@@ -112,7 +122,7 @@ gtk_list_item_change_release (GtkListItemChange *change,
                               GtkListItemBase   *widget)
 {
   if (change->deleted_items == NULL)
-    change->deleted_items = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) gtk_widget_unparent);
+    change->deleted_items = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, gtk_list_item_change_dispose_item);
 
   if (!g_hash_table_replace (change->deleted_items, gtk_list_item_base_get_item (GTK_LIST_ITEM_BASE (widget)), widget))
     {
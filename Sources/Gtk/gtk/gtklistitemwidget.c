@@ -30,8 +30,154 @@
 #include "gtkwidget.h"
 #include "gtkwidgetprivate.h"
 
+#include "gdk/gdkprivate.h"
+
+/* Rows that a view does not need anymore are kept in a process-wide
+ * pool instead of being destroyed. They are unbound, but stay set up,
+ * so that a view using the same factory - after a model swap, when
+ * items are removed and added again, or when a view is destroyed and
+ * a new one is created - does not have to run the factory's setup
+ * again. A view that is unrooted or hidden hands its rows to the pool
+ * too, see gtk_list_item_widget_switch_factory().
+ * Rows are only pooled while a view is using their factory, see
+ * gtk_list_item_widget_pool_hold(), and for a short grace period after
+ * the last view stopped using it. After that, the rows for that factory
+ * are destroyed, so the pool never keeps a factory alive for long.
+ * The pool is bounded per factory and in total, and is emptied when
+ * it has not been used for a while.
+ * GtkColumnView rows are not pooled: their cells belong to the columns
+ * of the view that created them.
+ */
+#define POOL_MAX_PER_KEY 256
+#define POOL_MAX_TOTAL 1024
+#define POOL_TRIM_TIMEOUT 30 /* seconds */
+#define POOL_GRACE_PERIOD 2 /* seconds */
+
+typedef struct _PoolKey PoolKey;
+
+struct _PoolKey
+{
+  GtkListItemFactory *factory;
+  const char *css_name; /* interned */
+  GtkAccessibleRole role;
+};
+
+static GHashTable *pool; /* PoolKey => GQueue of GtkListItemWidget */
+static GQuark pool_users_quark; /* number of views using a factory */
+static GQuark pool_grace_quark; /* grace period timeout of an unused factory */
+static guint pool_size;
+static guint pool_trim_id;
+static GtkListItemWidgetPoolStats pool_stats;
+
 G_DEFINE_TYPE (GtkListItemWidget, gtk_list_item_widget, GTK_TYPE_LIST_FACTORY_WIDGET)
 
+static guint
+pool_key_hash (gconstpointer data)
+{
+  const PoolKey *key = data;
+
+  return g_direct_hash (key->factory) ^ g_direct_hash (key->css_name) ^ key->role;
+}
+
+static gboolean
+pool_key_equal (gconstpointer a,
+                gconstpointer b)
+{
+  const PoolKey *key_a = a;
+  const PoolKey *key_b = b;
+
+  return key_a->factory == key_b->factory &&
+         key_a->css_name == key_b->css_name &&
+         key_a->role == key_b->role;
+}
+
+static void
+pool_queue_free (gpointer data)
+{
+  GQueue *queue = data;
+
+  pool_size -= g_queue_get_length (queue);
+  g_queue_free_full (queue, g_object_unref);
+}
+
+static gboolean
+pool_trim_cb (gpointer data)
+{
+  pool_stats.n_trimmed += pool_size;
+  g_hash_table_remove_all (pool);
+  pool_trim_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static guint
+pool_get_users (GtkListItemFactory *factory)
+{
+  if (pool_users_quark == 0)
+    return 0;
+
+  return GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (factory), pool_users_quark));
+}
+
+static gboolean
+pool_is_active (GtkListItemFactory *factory)
+{
+  return pool_get_users (factory) > 0 ||
+         (pool_grace_quark != 0 && g_object_get_qdata (G_OBJECT (factory), pool_grace_quark) != NULL);
+}
+
+static gboolean
+pool_key_has_factory (gpointer key,
+                      gpointer value,
+                      gpointer data)
+{
+  PoolKey *pool_key = key;
+
+  if (pool_key->factory != data)
+    return FALSE;
+
+  pool_stats.n_trimmed += g_queue_get_length (value);
+
+  return TRUE;
+}
+
+static gboolean
+pool_grace_cb (gpointer data)
+{
+  GtkListItemFactory *factory = data;
+
+  g_object_set_qdata (G_OBJECT (factory), pool_grace_quark, NULL);
+
+  if (pool != NULL)
+    g_hash_table_foreach_remove (pool, pool_key_has_factory, factory);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+pool_cancel_grace (GtkListItemFactory *factory)
+{
+  guint id;
+
+  if (pool_grace_quark == 0)
+    return;
+
+  id = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (factory), pool_grace_quark));
+  if (id == 0)
+    return;
+
+  g_object_set_qdata (G_OBJECT (factory), pool_grace_quark, NULL);
+  g_source_remove (id);
+}
+
+static void
+pool_queue_trim (void)
+{
+  g_clear_handle_id (&pool_trim_id, g_source_remove);
+  pool_trim_id = g_timeout_add_seconds (POOL_TRIM_TIMEOUT, pool_trim_cb, NULL);
+  gdk_source_set_static_name_by_id (pool_trim_id, "[gtk] gtk_list_item_widget_pool_trim");
+}
+
 static gboolean
 gtk_list_item_widget_focus (GtkWidget        *widget,
                             GtkDirectionType  direction)
@@ -227,6 +373,273 @@ gtk_list_item_widget_new (GtkListItemFactory *factory,
                        NULL);
 }
 
+static GtkWidget *
+pool_take (GtkListItemFactory *factory,
+           const char         *css_name,
+           GtkAccessibleRole   role)
+{
+  PoolKey key = { factory, g_intern_string (css_name), role };
+  GtkWidget *result;
+  GQueue *queue;
+
+  if (factory == NULL || pool == NULL)
+    return NULL;
+
+  queue = g_hash_table_lookup (pool, &key);
+  if (queue == NULL)
+    return NULL;
+
+  result = g_queue_pop_head (queue);
+  pool_size--;
+  if (g_queue_is_empty (queue))
+    g_hash_table_remove (pool, &key);
+
+  pool_stats.n_hits++;
+
+  /* Hand it out like a freshly created widget */
+  g_object_force_floating (G_OBJECT (result));
+
+  return result;
+}
+
+/*
+ * gtk_list_item_widget_new_recycled:
+ * @factory: (nullable): the factory to set up the row with
+ * @css_name: the CSS name of the row
+ * @role: the accessible role of the row
+ *
+ * Like gtk_list_item_widget_new(), but reuses a row that was
+ * given to gtk_list_item_widget_recycle() by a view using the
+ * same factory, if there is one.
+ *
+ * Returns: (transfer floating): a new or recycled row
+ */
+GtkWidget *
+gtk_list_item_widget_new_recycled (GtkListItemFactory *factory,
+                                   const char         *css_name,
+                                   GtkAccessibleRole   role)
+{
+  GtkWidget *result;
+
+  g_return_val_if_fail (css_name != NULL, NULL);
+
+  result = pool_take (factory, css_name, role);
+  if (result)
+    return result;
+
+  pool_stats.n_misses++;
+
+  return gtk_list_item_widget_new (factory, css_name, role);
+}
+
+/*
+ * gtk_list_item_widget_recycle:
+ * @self: a row that is not needed anymore
+ *
+ * Unbinds the row and removes it from its parent. If a view still
+ * uses the row's factory, or did so until recently, and there is room
+ * in the pool, the row is kept there for reuse by
+ * gtk_list_item_widget_new_recycled(), otherwise it is destroyed.
+ */
+void
+gtk_list_item_widget_recycle (GtkListItemWidget *self)
+{
+  GtkListItemFactory *factory;
+  PoolKey *key;
+  GQueue *queue;
+
+  factory = gtk_list_factory_widget_get_factory (GTK_LIST_FACTORY_WIDGET (self));
+  if (factory == NULL || !pool_is_active (factory))
+    {
+      gtk_widget_unparent (GTK_WIDGET (self));
+      return;
+    }
+
+  if (pool == NULL)
+    pool = g_hash_table_new_full (pool_key_hash, pool_key_equal, g_free, pool_queue_free);
+
+  key = g_new (PoolKey, 1);
+  key->factory = factory;
+  key->css_name = g_intern_string (gtk_widget_get_css_name (GTK_WIDGET (self)));
+  key->role = gtk_accessible_get_accessible_role (GTK_ACCESSIBLE (self));
+
+  queue = g_hash_table_lookup (pool, key);
+  if (pool_size >= POOL_MAX_TOTAL ||
+      (queue && g_queue_get_length (queue) >= POOL_MAX_PER_KEY))
+    {
+      pool_stats.n_dropped++;
+      g_free (key);
+      gtk_widget_unparent (GTK_WIDGET (self));
+      return;
+    }
+
+  if (queue == NULL)
+    {
+      queue = g_queue_new ();
+      g_hash_table_insert (pool, key, queue);
+    }
+  else
+    g_free (key);
+
+  gtk_list_item_base_update (GTK_LIST_ITEM_BASE (self), GTK_INVALID_LIST_POSITION, NULL, FALSE);
+
+  g_object_ref (self);
+  if (gtk_widget_get_parent (GTK_WIDGET (self)))
+    gtk_widget_unparent (GTK_WIDGET (self));
+
+  g_queue_push_head (queue, self);
+  pool_size++;
+  pool_stats.n_recycled++;
+
+  pool_queue_trim ();
+}
+
+/*
+ * gtk_list_item_widget_switch_factory:
+ * @self: a row of a view
+ * @factory: (nullable): the factory the view switches to
+ *
+ * Does the same as gtk_list_factory_widget_set_factory(), but goes
+ * through the pool instead of tearing @self down and setting it up
+ * again: when a view stops using its factory, @self is given to the
+ * pool and replaced by a row without factory, and when a view starts
+ * using @factory, a pooled row takes the place of @self if there is
+ * one.
+ *
+ * Returns: (transfer none): the row that is now in the place of @self
+ */
+GtkWidget *
+gtk_list_item_widget_switch_factory (GtkListItemWidget  *self,
+                                     GtkListItemFactory *factory)
+{
+  GtkListItemBase *base = GTK_LIST_ITEM_BASE (self);
+  GtkListItemFactory *old_factory;
+  GtkWidget *widget = GTK_WIDGET (self);
+  GtkWidget *replacement;
+  const char *css_name;
+  GtkAccessibleRole role;
+
+  old_factory = gtk_list_factory_widget_get_factory (GTK_LIST_FACTORY_WIDGET (self));
+  if (old_factory == factory)
+    return widget;
+
+  css_name = gtk_widget_get_css_name (widget);
+  role = gtk_accessible_get_accessible_role (GTK_ACCESSIBLE (self));
+
+  if (gtk_widget_get_parent (widget) == NULL)
+    replacement = NULL;
+  else if (old_factory == NULL)
+    replacement = pool_take (factory, css_name, role);
+  else if (factory == NULL && pool_is_active (old_factory))
+    replacement = gtk_list_item_widget_new (NULL, css_name, role);
+  else
+    replacement = NULL;
+
+  if (replacement == NULL)
+    {
+      gtk_list_factory_widget_set_factory (GTK_LIST_FACTORY_WIDGET (self), factory);
+      return widget;
+    }
+
+  gtk_list_factory_widget_set_single_click_activate (GTK_LIST_FACTORY_WIDGET (replacement),
+                                                     gtk_list_factory_widget_get_single_click_activate (GTK_LIST_FACTORY_WIDGET (self)));
+  gtk_list_item_base_update (GTK_LIST_ITEM_BASE (replacement),
+                             gtk_list_item_base_get_position (base),
+                             gtk_list_item_base_get_item (base),
+                             gtk_list_item_base_get_selected (base));
+  gtk_widget_insert_before (replacement, gtk_widget_get_parent (widget), widget);
+
+  gtk_list_item_widget_recycle (self);
+
+  return replacement;
+}
+
+/*
+ * gtk_list_item_widget_pool_hold:
+ * @factory: the factory a view starts using
+ *
+ * Tells the pool that a view uses @factory for its rows. Rows are only
+ * pooled for factories that are in use by at least one view.
+ *
+ * Every call must be balanced by gtk_list_item_widget_pool_release().
+ */
+void
+gtk_list_item_widget_pool_hold (GtkListItemFactory *factory)
+{
+  if (pool_users_quark == 0)
+    pool_users_quark = g_quark_from_static_string ("gtk-list-item-widget-pool-users");
+
+  pool_cancel_grace (factory);
+
+  g_object_set_qdata (G_OBJECT (factory), pool_users_quark,
+                      GUINT_TO_POINTER (pool_get_users (factory) + 1));
+}
+
+/*
+ * gtk_list_item_widget_pool_release:
+ * @factory: the factory a view stops using
+ *
+ * Undoes gtk_list_item_widget_pool_hold(). When no view uses @factory
+ * anymore, its rows stay pooled for a grace period, so that a view
+ * which is destroyed and created again can pick them up. After that,
+ * they are destroyed.
+ */
+void
+gtk_list_item_widget_pool_release (GtkListItemFactory *factory)
+{
+  guint n_users = pool_get_users (factory);
+  guint id;
+
+  g_return_if_fail (n_users > 0);
+
+  g_object_set_qdata (G_OBJECT (factory), pool_users_quark,
+                      GUINT_TO_POINTER (n_users - 1));
+
+  if (n_users > 1)
+    return;
+
+  if (pool_grace_quark == 0)
+    pool_grace_quark = g_quark_from_static_string ("gtk-list-item-widget-pool-grace");
+
+  id = g_timeout_add_seconds_full (G_PRIORITY_DEFAULT, POOL_GRACE_PERIOD,
+                                   pool_grace_cb,
+                                   g_object_ref (factory), g_object_unref);
+  gdk_source_set_static_name_by_id (id, "[gtk] gtk_list_item_widget_pool_grace");
+  g_object_set_qdata (G_OBJECT (factory), pool_grace_quark, GUINT_TO_POINTER (id));
+}
+
+/*
+ * gtk_list_item_widget_pool_flush:
+ * @factory: a factory
+ *
+ * Ends the grace period of @factory right away, destroying its
+ * pooled rows if no view uses it anymore.
+ */
+void
+gtk_list_item_widget_pool_flush (GtkListItemFactory *factory)
+{
+  if (pool_get_users (factory) > 0)
+    return;
+
+  pool_cancel_grace (factory);
+
+  if (pool != NULL)
+    g_hash_table_foreach_remove (pool, pool_key_has_factory, factory);
+}
+
+/*
+ * gtk_list_item_widget_get_pool_stats:
+ * @stats: (out caller-allocates): return location for the statistics
+ *
+ * Retrieves statistics about the reuse of rows between views.
+ */
+void
+gtk_list_item_widget_get_pool_stats (GtkListItemWidgetPoolStats *stats)
+{
+  *stats = pool_stats;
+  stats->n_pooled = pool_size;
+}
+
 void
 gtk_list_item_widget_set_child (GtkListItemWidget *self,
                                 GtkWidget         *child)
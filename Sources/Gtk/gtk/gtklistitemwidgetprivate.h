@@ -32,6 +32,7 @@ G_BEGIN_DECLS
 
 typedef struct _GtkListItemWidget GtkListItemWidget;
 typedef struct _GtkListItemWidgetClass GtkListItemWidgetClass;
+typedef struct _GtkListItemWidgetPoolStats GtkListItemWidgetPoolStats;
 
 struct _GtkListItemWidget
 {
@@ -43,11 +44,31 @@ struct _GtkListItemWidgetClass
   GtkListFactoryWidgetClass parent_class;
 };
 
+struct _GtkListItemWidgetPoolStats
+{
+  guint64 n_hits;       /* rows taken from the pool */
+  guint64 n_misses;     /* rows that had to be created */
+  guint64 n_recycled;   /* rows put into the pool */
+  guint64 n_dropped;    /* rows destroyed because the pool was full */
+  guint64 n_trimmed;    /* rows destroyed because the pool or their factory was unused */
+  guint   n_pooled;     /* rows currently in the pool */
+};
+
 GType                   gtk_list_item_widget_get_type           (void) G_GNUC_CONST;
 
 GtkWidget *             gtk_list_item_widget_new                (GtkListItemFactory     *factory,
                                                                  const char             *css_name,
                                                                  GtkAccessibleRole       role);
+GtkWidget *             gtk_list_item_widget_new_recycled       (GtkListItemFactory     *factory,
+                                                                 const char             *css_name,
+                                                                 GtkAccessibleRole       role);
+void                    gtk_list_item_widget_recycle            (GtkListItemWidget      *self);
+GtkWidget *             gtk_list_item_widget_switch_factory     (GtkListItemWidget      *self,
+                                                                 GtkListItemFactory     *factory);
+void                    gtk_list_item_widget_pool_hold          (GtkListItemFactory     *factory);
+void                    gtk_list_item_widget_pool_release       (GtkListItemFactory     *factory);
+void                    gtk_list_item_widget_pool_flush         (GtkListItemFactory     *factory);
+void                    gtk_list_item_widget_get_pool_stats     (GtkListItemWidgetPoolStats *stats);
 
 void                    gtk_list_item_widget_set_child          (GtkListItemWidget      *self,
                                                                  GtkWidget              *child);
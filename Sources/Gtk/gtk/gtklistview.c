@@ -211,6 +211,27 @@ gtk_list_view_is_inert (GtkListView *self)
          gtk_widget_get_root (widget) == NULL;
 }
 
+static void
+gtk_list_view_set_pool_factory (GtkListView        *self,
+                                GtkListItemFactory *factory)
+{
+  GtkListItemFactory *old_factory = self->pool_factory;
+
+  if (factory == old_factory)
+    return;
+
+  /* Rows are shared with other views through a pool, which only keeps
+   * rows of factories that a view is using or used until recently. */
+  if (factory)
+    gtk_list_item_widget_pool_hold (g_object_ref (factory));
+  self->pool_factory = factory;
+  if (old_factory)
+    {
+      gtk_list_item_widget_pool_release (old_factory);
+      g_object_unref (old_factory);
+    }
+}
+
 static void
 gtk_list_view_update_factories_with (GtkListView        *self,
                                      GtkListItemFactory *factory,
@@ -218,6 +239,8 @@ gtk_list_view_update_factories_with (GtkListView        *self,
 {
   GtkListTile *tile;
 
+  gtk_list_view_set_pool_factory (self, factory);
+
   for (tile = gtk_list_item_manager_get_first (self->item_manager);
        tile != NULL;
        tile = gtk_rb_tree_node_get_next (tile))
@@ -225,7 +248,12 @@ gtk_list_view_update_factories_with (GtkListView        *self,
       switch (tile->type)
         {
         case GTK_LIST_TILE_ITEM:
-          if (tile->widget)
+          if (tile->widget == NULL)
+            break;
+          /* Rows of other views with the factory may be waiting in the pool */
+          if (GTK_IS_LIST_ITEM_WIDGET (tile->widget))
+            tile->widget = gtk_list_item_widget_switch_factory (GTK_LIST_ITEM_WIDGET (tile->widget), factory);
+          else
             gtk_list_factory_widget_set_factory (GTK_LIST_FACTORY_WIDGET (tile->widget), factory);
           break;
         case GTK_LIST_TILE_HEADER:
@@ -271,9 +299,9 @@ gtk_list_view_create_list_widget (GtkListBase *base)
   else
     factory = self->factory;
 
-  result = gtk_list_item_widget_new (factory,
-                                     "row",
-                                     GTK_ACCESSIBLE_ROLE_LIST_ITEM);
+  result = gtk_list_item_widget_new_recycled (factory,
+                                              "row",
+                                              GTK_ACCESSIBLE_ROLE_LIST_ITEM);
 
   gtk_list_factory_widget_set_single_click_activate (GTK_LIST_FACTORY_WIDGET (result), self->single_click_activate);
 
@@ -727,6 +755,7 @@ gtk_list_view_dispose (GObject *object)
 
   self->item_manager = NULL;
 
+  gtk_list_view_set_pool_factory (self, NULL);
   g_clear_object (&self->factory);
   g_clear_object (&self->header_factory);
 
@@ -31,6 +31,7 @@ struct _GtkListView
   GtkListItemManager *item_manager;
   GtkListItemFactory *factory;
   GtkListItemFactory *header_factory;
+  GtkListItemFactory *pool_factory; /* factory held in the row pool */
   gboolean show_separators;
   gboolean single_click_activate;
 };
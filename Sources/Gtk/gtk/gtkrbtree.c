@@ -19,6 +19,8 @@
 
 #include "gtkrbtreeprivate.h"
 
+#include <string.h>
+
 #include "gtkdebug.h"
 
 /* Define the following to print adds and removals to stdout.
@@ -31,6 +33,19 @@
 #undef DUMP_MODIFICATION
 
 typedef struct _GtkRbNode GtkRbNode;
+typedef struct _GtkRbNodeChunk GtkRbNodeChunk;
+
+/* Nodes are not allocated one by one, but carved out of chunks that
+ * grow geometrically up to MAX_CHUNK_NODES. Freed nodes are put on a
+ * free list and reused. This keeps nodes that were inserted together
+ * close in memory and avoids a malloc() per item for large models.
+ * All chunks are released when the tree becomes empty.
+ */
+#define MIN_CHUNK_NODES 16
+#define MAX_CHUNK_NODES 4096
+
+#define NODE_ALIGNMENT (2 * sizeof (gpointer))
+#define ALIGN_NODE_SIZE(size) (((size) + NODE_ALIGNMENT - 1) & ~(NODE_ALIGNMENT - 1))
 
 struct _GtkRbTree
 {
@@ -43,8 +58,23 @@ struct _GtkRbTree
   GDestroyNotify clear_augment_func;
 
   GtkRbNode *root;
+
+  gsize node_size;
+  gsize n_nodes;
+  GtkRbNodeChunk *chunks;
+  gsize chunk_used;
+  GtkRbNode *free_nodes;
 };
 
+struct _GtkRbNodeChunk
+{
+  GtkRbNodeChunk *next;
+  gsize n_nodes;
+};
+
+#define CHUNK_HEADER_SIZE ALIGN_NODE_SIZE (sizeof (GtkRbNodeChunk))
+#define CHUNK_NODE(tree, chunk, i) ((GtkRbNode *) (((guchar *) (chunk)) + CHUNK_HEADER_SIZE + (i) * (tree)->node_size))
+
 struct _GtkRbNode
 {
   guint red :1;
@@ -112,12 +142,67 @@ gtk_rb_node_get_size (GtkRbTree *tree)
   return sizeof (GtkRbNode) + tree->element_size + tree->augment_size;
 }
 
+static void
+gtk_rb_tree_free_chunks (GtkRbTree *tree)
+{
+  GtkRbNodeChunk *chunk, *next;
+
+  for (chunk = tree->chunks; chunk; chunk = next)
+    {
+      next = chunk->next;
+      g_free (chunk);
+    }
+
+  tree->chunks = NULL;
+  tree->chunk_used = 0;
+  tree->free_nodes = NULL;
+}
+
+static GtkRbNode *
+gtk_rb_node_alloc (GtkRbTree *tree)
+{
+  GtkRbNodeChunk *chunk;
+  GtkRbNode *result;
+
+  if (tree->free_nodes)
+    {
+      result = tree->free_nodes;
+      tree->free_nodes = result->left;
+    }
+  else
+    {
+      if (tree->chunks == NULL || tree->chunk_used == tree->chunks->n_nodes)
+        {
+          gsize n_nodes;
+
+          if (tree->chunks)
+            n_nodes = MIN (tree->chunks->n_nodes * 2, MAX_CHUNK_NODES);
+          else
+            n_nodes = MIN_CHUNK_NODES;
+
+          chunk = g_malloc (CHUNK_HEADER_SIZE + n_nodes * tree->node_size);
+          chunk->n_nodes = n_nodes;
+          chunk->next = tree->chunks;
+          tree->chunks = chunk;
+          tree->chunk_used = 0;
+        }
+
+      result = CHUNK_NODE (tree, tree->chunks, tree->chunk_used);
+      tree->chunk_used++;
+    }
+
+  tree->n_nodes++;
+  memset (result, 0, gtk_rb_node_get_size (tree));
+
+  return result;
+}
+
 static GtkRbNode *
 gtk_rb_node_new (GtkRbTree *tree)
 {
   GtkRbNode *result;
 
-  result = g_malloc0 (gtk_rb_node_get_size (tree));
+  result = gtk_rb_node_alloc (tree);
 
   result->red = TRUE;
   result->dirty = TRUE;
@@ -134,7 +219,15 @@ gtk_rb_node_free (GtkRbTree *tree,
   if (tree->clear_augment_func)
     tree->clear_augment_func (NODE_TO_AUG_POINTER (tree, node));
 
-  g_free (node);
+  tree->n_nodes--;
+  if (tree->n_nodes == 0)
+    {
+      gtk_rb_tree_free_chunks (tree);
+      return;
+    }
+
+  node->left = tree->free_nodes;
+  tree->free_nodes = node;
 }
 
 static void
@@ -520,6 +613,8 @@ gtk_rb_tree_new_for_size (gsize                element_size,
   tree->clear_func = clear_func;
   tree->clear_augment_func = clear_augment_func;
 
+  tree->node_size = ALIGN_NODE_SIZE (gtk_rb_node_get_size (tree));
+
   return tree;
 }
 
@@ -541,6 +636,9 @@ gtk_rb_tree_unref (GtkRbTree *tree)
   if (tree->root)
     gtk_rb_node_free_deep (tree, tree->root);
 
+  g_assert (tree->n_nodes == 0);
+  gtk_rb_tree_free_chunks (tree);
+
   g_free (tree);
 }
 
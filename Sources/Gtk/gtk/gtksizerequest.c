@@ -129,6 +129,79 @@ get_box_padding (GtkCssStyle *style,
   border->right = get_number (style->size->padding_right);
 }
 
+static void gtk_widget_query_size_for_orientation (GtkWidget        *widget,
+                                                   GtkOrientation    orientation,
+                                                   int               for_size,
+                                                   int              *minimum,
+                                                   int              *natural,
+                                                   int              *minimum_baseline,
+                                                   int              *natural_baseline);
+
+static gboolean
+child_requests_unchanged (GtkWidget                 *child,
+                          const SizeRequestSnapshot *saved)
+{
+  int min, nat, min_baseline, nat_baseline;
+
+  if (!saved->usable)
+    return FALSE;
+
+  if (saved->request_mode_valid &&
+      gtk_widget_get_request_mode (child) != saved->request_mode)
+    return FALSE;
+
+  if (saved->size_valid & (1 << GTK_ORIENTATION_HORIZONTAL))
+    {
+      gtk_widget_query_size_for_orientation (child, GTK_ORIENTATION_HORIZONTAL, -1,
+                                             &min, &nat, NULL, NULL);
+      if (min != saved->size_x.minimum_size ||
+          nat != saved->size_x.natural_size)
+        return FALSE;
+    }
+
+  if (saved->size_valid & (1 << GTK_ORIENTATION_VERTICAL))
+    {
+      gtk_widget_query_size_for_orientation (child, GTK_ORIENTATION_VERTICAL, -1,
+                                             &min, &nat, &min_baseline, &nat_baseline);
+      if (min != saved->size_y.minimum_size ||
+          nat != saved->size_y.natural_size ||
+          min_baseline != saved->size_y.minimum_baseline ||
+          nat_baseline != saved->size_y.natural_baseline)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* The cached sizes of a widget are kept when one of its children
+ * queues a resize; before using them, we check whether the base
+ * requests of the resized children actually changed.
+ */
+static void
+gtk_widget_revalidate_request_cache (GtkWidget        *widget,
+                                     SizeRequestCache *cache)
+{
+  gboolean unchanged = TRUE;
+  GtkWidget *child;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL && unchanged;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      SizeRequestCache *child_cache = _gtk_widget_peek_request_cache (child);
+
+      /* Hidden children are measured as 0, whatever their requests */
+      if (!_gtk_widget_get_visible (child))
+        continue;
+
+      if (child_cache->saved.valid)
+        unchanged = child_requests_unchanged (child, &child_cache->saved);
+    }
+
+  _gtk_size_request_cache_revalidate (cache, unchanged);
+  gtk_widget_forget_child_requests (widget);
+}
+
 static void
 gtk_widget_query_size_for_orientation (GtkWidget        *widget,
                                        GtkOrientation    orientation,
@@ -151,6 +224,9 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
    * any wfh/hfw handling. If it doesn't, we reset for_size to -1 and ensure
    * that we only cache one size for the widget (i.e. a lot more cache hits). */
   cache = _gtk_widget_peek_request_cache (widget);
+  if (G_UNLIKELY (cache->stale))
+    gtk_widget_revalidate_request_cache (widget, cache);
+
   if (G_UNLIKELY (!cache->request_mode_valid))
     {
       cache->request_mode = fetch_request_mode (widget);
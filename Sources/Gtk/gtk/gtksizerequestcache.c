@@ -25,6 +25,8 @@
 
 #include <string.h>
 
+static GtkSizeRequestCacheStats stats;
+
 void
 _gtk_size_request_cache_init (SizeRequestCache *cache)
 {
@@ -65,8 +67,91 @@ _gtk_size_request_cache_free (SizeRequestCache *cache)
 void
 _gtk_size_request_cache_clear (SizeRequestCache *cache)
 {
+  SizeRequestSnapshot saved = cache->saved;
+  gboolean children_saved = cache->children_saved;
+
   _gtk_size_request_cache_free (cache);
   _gtk_size_request_cache_init (cache);
+
+  /* The snapshots describe the sizes the parent has seen,
+   * so they need to outlive the cached sizes
+   */
+  cache->saved = saved;
+  cache->children_saved = children_saved;
+}
+
+/* Remembers the current base requests, so that they can be compared
+ * with the new ones once the widget is measured again. If there is a
+ * snapshot already, the parent has not looked at it yet, so we keep
+ * the older one.
+ *
+ * A snapshot is only usable if no for_size requests were cached: we
+ * don't know which of them the parent relied on.
+ */
+void
+_gtk_size_request_cache_save (SizeRequestCache *cache,
+                              gboolean          usable)
+{
+  SizeRequestSnapshot *saved = &cache->saved;
+
+  if (saved->valid)
+    return;
+
+  saved->valid = TRUE;
+  saved->usable = usable &&
+                  cache->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests == 0 &&
+                  cache->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests == 0;
+  saved->request_mode = cache->request_mode;
+  saved->request_mode_valid = cache->request_mode_valid;
+  saved->size_valid = 0;
+
+  if (cache->flags[GTK_ORIENTATION_HORIZONTAL].cached_size_valid)
+    {
+      saved->size_x = cache->cached_size_x;
+      saved->size_valid |= 1 << GTK_ORIENTATION_HORIZONTAL;
+    }
+
+  if (cache->flags[GTK_ORIENTATION_VERTICAL].cached_size_valid)
+    {
+      saved->size_y = cache->cached_size_y;
+      saved->size_valid |= 1 << GTK_ORIENTATION_VERTICAL;
+    }
+}
+
+void
+_gtk_size_request_cache_forget (SizeRequestCache *cache)
+{
+  memset (&cache->saved, 0, sizeof (SizeRequestSnapshot));
+}
+
+/* Keeps the cached sizes around after a child was resized; they
+ * are revalidated the next time the widget is measured.
+ */
+void
+_gtk_size_request_cache_mark_stale (SizeRequestCache *cache)
+{
+  cache->stale = TRUE;
+
+  /* The request mode may depend on the children */
+  cache->request_mode_valid = FALSE;
+}
+
+void
+_gtk_size_request_cache_revalidate (SizeRequestCache *cache,
+                                    gboolean          unchanged)
+{
+  g_assert (cache->stale);
+
+  if (unchanged)
+    {
+      cache->stale = FALSE;
+      stats.n_reused++;
+    }
+  else
+    {
+      _gtk_size_request_cache_clear (cache);
+      stats.n_invalidated++;
+    }
 }
 
 void
@@ -80,6 +165,10 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 {
   guint         i, n_sizes;
 
+  /* Don't mix new sizes with ones that were never revalidated */
+  if (G_UNLIKELY (cache->stale))
+    _gtk_size_request_cache_clear (cache);
+
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
       g_assert (minimum_baseline == -1);
@@ -208,14 +297,14 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
  * Note that this caching code was originally derived from
  * the Clutter toolkit but has evolved for other GTK requirements.
  */
-gboolean
-_gtk_size_request_cache_lookup (const SizeRequestCache *cache,
-                                GtkOrientation          orientation,
-                                int                     for_size,
-                                int                    *minimum,
-                                int                    *natural,
-                                int                    *minimum_baseline,
-                                int                    *natural_baseline)
+static gboolean
+gtk_size_request_cache_lookup (const SizeRequestCache *cache,
+                               GtkOrientation          orientation,
+                               int                     for_size,
+                               int                    *minimum,
+                               int                    *natural,
+                               int                    *minimum_baseline,
+                               int                    *natural_baseline)
 {
   guint i, p;
 
@@ -298,3 +387,34 @@ _gtk_size_request_cache_lookup (const SizeRequestCache *cache,
     }
 }
 
+
+gboolean
+_gtk_size_request_cache_lookup (const SizeRequestCache *cache,
+                                GtkOrientation          orientation,
+                                int                     for_size,
+                                int                    *minimum,
+                                int                    *natural,
+                                int                    *minimum_baseline,
+                                int                    *natural_baseline)
+{
+  /* A stale cache must be revalidated against the children first; if
+   * that did not happen, treat it as a miss and measure again
+   */
+  if (!cache->stale &&
+      gtk_size_request_cache_lookup (cache, orientation, for_size,
+                                     minimum, natural,
+                                     minimum_baseline, natural_baseline))
+    {
+      stats.n_hits++;
+      return TRUE;
+    }
+
+  stats.n_misses++;
+  return FALSE;
+}
+
+void
+_gtk_size_request_cache_get_stats (GtkSizeRequestCacheStats *out_stats)
+{
+  *out_stats = stats;
+}
@@ -63,6 +63,21 @@ typedef struct
   CachedSizeY cached_size;
 } SizeRequestY;
 
+/* The base requests of a widget at the time its cache was last
+ * invalidated; the parent compares them with the new requests to
+ * find out whether its own cached sizes are still correct
+ */
+typedef struct {
+  CachedSizeX  size_x;
+  CachedSizeY  size_y;
+
+  guint       request_mode          : 3; /* GtkSizeRequestMode */
+  guint       request_mode_valid    : 1;
+  guint       size_valid            : 2; /* Mask of orientations */
+  guint       valid                 : 1;
+  guint       usable                : 1; /* No for_size requests were cached */
+} SizeRequestSnapshot;
+
 typedef struct {
   SizeRequestX **requests_x;
   SizeRequestY **requests_y;
@@ -70,8 +85,12 @@ typedef struct {
   CachedSizeX  cached_size_x;
   CachedSizeY  cached_size_y;
 
+  SizeRequestSnapshot saved;
+
   guint       request_mode          : 3; /* GtkSizeRequestMode */
   guint       request_mode_valid    : 1;
+  guint       stale                 : 1; /* A child was resized */
+  guint       children_saved        : 1; /* A child has a snapshot */
   struct {
     guint       n_cached_requests   : 15;
     guint       last_cached_request : 15;
@@ -83,6 +102,12 @@ void            _gtk_size_request_cache_init                    (SizeRequestCach
 void            _gtk_size_request_cache_free                    (SizeRequestCache       *cache);
 
 void            _gtk_size_request_cache_clear                   (SizeRequestCache       *cache);
+void            _gtk_size_request_cache_save                    (SizeRequestCache       *cache,
+                                                                 gboolean                usable);
+void            _gtk_size_request_cache_forget                  (SizeRequestCache       *cache);
+void            _gtk_size_request_cache_mark_stale              (SizeRequestCache       *cache);
+void            _gtk_size_request_cache_revalidate              (SizeRequestCache       *cache,
+                                                                 gboolean                unchanged);
 void            _gtk_size_request_cache_commit                  (SizeRequestCache       *cache,
                                                                  GtkOrientation          orientation,
                                                                  int                     for_size,
@@ -98,5 +123,14 @@ gboolean        _gtk_size_request_cache_lookup                  (const SizeReque
                                                                  int                    *minimum_baseline,
                                                                  int                    *natural_baseline);
 
+typedef struct {
+  guint64 n_hits;
+  guint64 n_misses;
+  guint64 n_reused;       /* Stale caches that turned out to be valid */
+  guint64 n_invalidated;  /* Stale caches that had to be dropped */
+} GtkSizeRequestCacheStats;
+
+void            _gtk_size_request_cache_get_stats               (GtkSizeRequestCacheStats *stats);
+
 G_END_DECLS
 
@@ -44,10 +44,13 @@ enum {
 G_DEFINE_INTERFACE (GtkStyleProvider, gtk_style_provider, G_TYPE_OBJECT)
 
 static guint signals[LAST_SIGNAL];
+static GQuark generation_quark;
 
 static void
 gtk_style_provider_default_init (GtkStyleProviderInterface *iface)
 {
+  generation_quark = g_quark_from_static_string ("gtk-style-provider-generation");
+
   signals[CHANGED] = g_signal_new (I_("gtk-private-changed"),
                                    G_TYPE_FROM_INTERFACE (iface),
                                    G_SIGNAL_RUN_LAST,
@@ -122,11 +125,34 @@ gtk_style_provider_lookup (GtkStyleProvider             *provider,
 void
 gtk_style_provider_changed (GtkStyleProvider *provider)
 {
+  guint generation;
+
   gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
 
+  generation = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (provider), generation_quark));
+  g_object_set_qdata (G_OBJECT (provider), generation_quark, GUINT_TO_POINTER (generation + 1));
+
   g_signal_emit (provider, signals[CHANGED], 0);
 }
 
+/*
+ * gtk_style_provider_get_generation:
+ * @provider: a `GtkStyleProvider`
+ *
+ * Returns a counter that is increased every time @provider
+ * changes, so that styles computed with an older set of rules
+ * can be told apart from current ones.
+ *
+ * Returns: the generation of @provider
+ */
+guint
+gtk_style_provider_get_generation (GtkStyleProvider *provider)
+{
+  gtk_internal_return_val_if_fail (GTK_IS_STYLE_PROVIDER (provider), 0);
+
+  return GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (provider), generation_quark));
+}
+
 GtkSettings *
 gtk_style_provider_get_settings (GtkStyleProvider *provider)
 {
@@ -2606,6 +2606,9 @@ gtk_widget_unparent (GtkWidget *widget)
   priv->prev_sibling = NULL;
   priv->next_sibling = NULL;
 
+  /* The snapshot of the requests is only meaningful to the old parent */
+  _gtk_size_request_cache_forget (&priv->requests);
+
   /* parent may no longer expand if the removed
    * child was expand=TRUE and could therefore
    * be forcing it to.
@@ -3552,24 +3555,77 @@ gtk_widget_get_resize_needed (GtkWidget *widget)
   return priv->resize_needed;
 }
 
+/*
+ * gtk_widget_forget_child_requests:
+ * @widget: a `GtkWidget`
+ *
+ * Drops the snapshots of the base requests of the children
+ * of @widget, once the cached sizes of @widget don't depend
+ * on them anymore.
+ */
+void
+gtk_widget_forget_child_requests (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+  GtkWidget *child;
+
+  if (!priv->requests.children_saved)
+    return;
+
+  for (child = priv->first_child; child != NULL; child = child->priv->next_sibling)
+    _gtk_size_request_cache_forget (&child->priv->requests);
+
+  priv->requests.children_saved = FALSE;
+}
+
+static void
+gtk_widget_clear_request_cache (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
+
+  _gtk_size_request_cache_clear (&priv->requests);
+  gtk_widget_forget_child_requests (widget);
+}
+
 /*
  * gtk_widget_queue_resize_internal:
  * @widget: a `GtkWidget`
+ * @from_child: whether the resize was queued by a child of @widget
  *
  * Queue a resize on a widget, and on all other widgets
  * grouped with this widget.
+ *
+ * If the resize comes from a child, the cached sizes of @widget are
+ * kept, and only dropped when it is measured again if the requests
+ * of the child changed.
  */
 static void
-gtk_widget_queue_resize_internal (GtkWidget *widget)
+gtk_widget_queue_resize_internal (GtkWidget *widget,
+                                  gboolean   from_child)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (widget);
   GSList *groups, *l, *widgets;
 
   if (gtk_widget_get_resize_needed (widget))
-    return;
+    {
+      if (!from_child && priv->requests.stale)
+        gtk_widget_clear_request_cache (widget);
+      return;
+    }
 
   priv->resize_needed = TRUE;
-  _gtk_size_request_cache_clear (&priv->requests);
+
+  if (priv->parent != NULL)
+    {
+      _gtk_size_request_cache_save (&priv->requests, !priv->have_size_groups);
+      priv->parent->priv->requests.children_saved = TRUE;
+    }
+
+  if (from_child)
+    _gtk_size_request_cache_mark_stale (&priv->requests);
+  else
+    gtk_widget_clear_request_cache (widget);
+
   gtk_widget_set_alloc_needed (widget);
 
   if (priv->resize_func)
@@ -3580,7 +3636,7 @@ gtk_widget_queue_resize_internal (GtkWidget *widget)
   for (l = groups; l; l = l->next)
     {
       for (widgets = gtk_size_group_get_widgets (l->data); widgets; widgets = widgets->next)
-        gtk_widget_queue_resize_internal (widgets->data);
+        gtk_widget_queue_resize_internal (widgets->data, FALSE);
     }
 
   if (_gtk_widget_get_visible (widget))
@@ -3591,7 +3647,7 @@ gtk_widget_queue_resize_internal (GtkWidget *widget)
           if (GTK_IS_NATIVE (widget))
             gtk_widget_queue_allocate (parent);
           else
-            gtk_widget_queue_resize_internal (parent);
+            gtk_widget_queue_resize_internal (parent, TRUE);
         }
     }
 }
@@ -3622,7 +3678,7 @@ gtk_widget_queue_resize (GtkWidget *widget)
   if (_gtk_widget_get_realized (widget))
     gtk_widget_queue_draw (widget);
 
-  gtk_widget_queue_resize_internal (widget);
+  gtk_widget_queue_resize_internal (widget, FALSE);
 }
 
 /**
@@ -8170,10 +8226,19 @@ gtk_widget_queue_compute_expand (GtkWidget *widget)
     }
 
   /* recomputing expand always requires
-   * a relayout as well
+   * a relayout as well; the parents may measure their children
+   * differently depending on their expand flags, so their cached
+   * sizes can't be kept
    */
   if (changed_anything)
-    gtk_widget_queue_resize (widget);
+    {
+      gtk_widget_queue_resize (widget);
+
+      for (parent = widget->priv->parent;
+           parent != NULL && !GTK_IS_NATIVE (parent);
+           parent = parent->priv->parent)
+        gtk_widget_queue_resize_internal (parent, FALSE);
+    }
 }
 
 /**
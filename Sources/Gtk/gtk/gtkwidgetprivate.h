@@ -240,6 +240,7 @@ void         _gtk_widget_add_sizegroup         (GtkWidget    *widget,
 void         _gtk_widget_remove_sizegroup      (GtkWidget    *widget,
 						gpointer      group);
 GSList      *_gtk_widget_get_sizegroups        (GtkWidget    *widget);
+void         gtk_widget_forget_child_requests  (GtkWidget    *widget);
 
 void              _gtk_widget_set_has_default              (GtkWidget *widget,
                                                             gboolean   has_default);
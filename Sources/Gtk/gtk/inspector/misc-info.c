@@ -33,6 +33,7 @@
 #include "gtkwidgetprivate.h"
 #include "gtkbinlayout.h"
 #include "gtkwidgetprivate.h"
+#include "gtksizerequestcacheprivate.h"
 
 struct _GtkInspectorMiscInfo
 {
@@ -56,6 +57,8 @@ struct _GtkInspectorMiscInfo
   GtkWidget *mnemonic_label;
   GtkWidget *request_mode_row;
   GtkWidget *request_mode;
+  GtkWidget *size_cache_row;
+  GtkWidget *size_cache;
   GtkWidget *measure_info_row;
   GtkWidget *measure_row;
   GtkWidget *measure_expand_toggle;
@@ -348,6 +351,23 @@ update_direction (GtkInspectorMiscInfo *sl)
     }
 }
 
+static void
+update_size_cache (GtkInspectorMiscInfo *sl)
+{
+  GtkSizeRequestCacheStats stats;
+  char *tmp;
+
+  _gtk_size_request_cache_get_stats (&stats);
+
+  /* The counters are global, not per widget */
+  tmp = g_strdup_printf ("%" G_GUINT64_FORMAT " hits, %" G_GUINT64_FORMAT " misses, "
+                         "%" G_GUINT64_FORMAT " reused, %" G_GUINT64_FORMAT " invalidated",
+                         stats.n_hits, stats.n_misses,
+                         stats.n_reused, stats.n_invalidated);
+  gtk_label_set_label (GTK_LABEL (sl->size_cache), tmp);
+  g_free (tmp);
+}
+
 static gboolean
 update_info (gpointer data)
 {
@@ -378,6 +398,7 @@ update_info (gpointer data)
       GList *list, *l;
 
       update_direction (sl);
+      update_size_cache (sl);
 
       while ((child = gtk_widget_get_first_child (sl->mnemonic_label)))
         gtk_box_remove (GTK_BOX (sl->mnemonic_label), child);
@@ -506,6 +527,7 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
   gtk_widget_set_visible (sl->state_row, GTK_IS_WIDGET (object));
   gtk_widget_set_visible (sl->direction_row, GTK_IS_WIDGET (object));
   gtk_widget_set_visible (sl->request_mode_row, GTK_IS_WIDGET (object));
+  gtk_widget_set_visible (sl->size_cache_row, GTK_IS_WIDGET (object));
   gtk_widget_set_visible (sl->bounds_row, GTK_IS_WIDGET (object));
   gtk_widget_set_visible (sl->baseline_row, GTK_IS_WIDGET (object));
   /* Don't autoshow, it may be slow, we have a button for this */
@@ -610,6 +632,8 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, mnemonic_label);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, request_mode_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, request_mode);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, size_cache_row);
+  gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, size_cache);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, measure_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, measure_info_row);
   gtk_widget_class_bind_template_child (widget_class, GtkInspectorMiscInfo, measure_expand_toggle);
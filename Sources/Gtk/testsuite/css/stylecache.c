@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026 GNOME Foundation Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include "gtk/gtkcssnodeprivate.h"
+#include "gtk/gtkcssnodestylecacheprivate.h"
+#include "gtk/gtkcsscolorvalueprivate.h"
+#include "gtk/gtkcssstyleprivate.h"
+
+/* Use node names that no theme has rules for, so only the rules
+ * of the test provider apply.
+ */
+static GtkCssNode *
+node_new (GtkCssNode *parent,
+          const char *name,
+          const char *style_class)
+{
+  GtkCssNode *node;
+
+  node = gtk_css_node_new ();
+  gtk_css_node_set_name (node, g_quark_from_string (name));
+  if (style_class)
+    gtk_css_node_add_class (node, g_quark_from_string (style_class));
+  if (parent)
+    {
+      gtk_css_node_set_parent (node, parent);
+      g_object_unref (node);
+    }
+
+  return node;
+}
+
+static void
+assert_color (GtkCssNode *node,
+              const char *expected)
+{
+  GtkCssStyle *style;
+  GdkRGBA color;
+
+  gdk_rgba_parse (&color, expected);
+  style = gtk_css_node_get_style (node);
+
+  g_assert_true (gdk_rgba_equal (gtk_css_color_value_get_rgba (style->core->color), &color));
+}
+
+static GtkStyleProvider *
+add_provider (const char *css)
+{
+  GtkCssProvider *provider;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_string (provider, css);
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  return GTK_STYLE_PROVIDER (provider);
+}
+
+static void
+remove_provider (GtkStyleProvider *provider)
+{
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (), provider);
+  g_object_unref (provider);
+}
+
+/* Two roots that only differ in a class must not share styles */
+static void
+test_descendant_roots (void)
+{
+  GtkStyleProvider *provider;
+  GtkCssNode *root1, *root2, *label1, *label2;
+
+  provider = add_provider ("cachelabel { color: blue; }\n"
+                           "cacheroot.dark cachebox cachelabel { color: red; }\n");
+
+  root1 = node_new (NULL, "cacheroot", NULL);
+  label1 = node_new (node_new (root1, "cachebox", NULL), "cachelabel", NULL);
+  root2 = node_new (NULL, "cacheroot", "dark");
+  label2 = node_new (node_new (root2, "cachebox", NULL), "cachelabel", NULL);
+
+  assert_color (label1, "blue");
+  assert_color (label2, "red");
+
+  g_object_unref (root1);
+  g_object_unref (root2);
+  remove_provider (provider);
+}
+
+/* Two parents with equal styles but different ancestors must not
+ * share styles either.
+ */
+static void
+test_descendant_parents (void)
+{
+  GtkStyleProvider *provider;
+  GtkCssNode *root, *label1, *label2;
+
+  provider = add_provider ("cachelabel { color: blue; }\n"
+                           "cacheouter.dark cachebox cachelabel { color: red; }\n");
+
+  root = node_new (NULL, "cacheroot", NULL);
+  label1 = node_new (node_new (node_new (root, "cacheouter", NULL), "cachebox", NULL), "cachelabel", NULL);
+  label2 = node_new (node_new (node_new (root, "cacheouter", "dark"), "cachebox", NULL), "cachelabel", NULL);
+
+  assert_color (label1, "blue");
+  assert_color (label2, "red");
+
+  g_object_unref (root);
+  remove_provider (provider);
+}
+
+/* Changing the provider must not bring back styles from before */
+static void
+test_provider_change (void)
+{
+  GtkCssProvider *provider;
+  GtkCssNode *root1, *root2, *label1, *label2;
+
+  provider = GTK_CSS_PROVIDER (add_provider ("cachelabel { color: blue; }\n"));
+
+  root1 = node_new (NULL, "cacheroot", NULL);
+  label1 = node_new (root1, "cachelabel", NULL);
+  assert_color (label1, "blue");
+
+  gtk_css_provider_load_from_string (provider, "cachelabel { color: red; }\n");
+
+  /* root1 keeps its cache alive while root2 is styled */
+  root2 = node_new (NULL, "cacheroot", NULL);
+  label2 = node_new (root2, "cachelabel", NULL);
+  assert_color (label2, "red");
+
+  g_object_unref (root1);
+  g_object_unref (root2);
+  remove_provider (GTK_STYLE_PROVIDER (provider));
+}
+
+static void
+test_stats (void)
+{
+  GtkStyleProvider *provider;
+  GtkCssNodeStyleCacheStats before, after;
+  GtkCssNode *root1, *root2, *box, *label;
+  int i;
+
+  provider = add_provider ("cachelabel { color: blue; }\n");
+
+  root1 = node_new (NULL, "cacheroot", NULL);
+  box = node_new (root1, "cachebox", NULL);
+  for (i = 0; i < 10; i++)
+    node_new (box, "cachelabel", NULL);
+
+  gtk_css_node_style_cache_get_stats (&before);
+  for (label = gtk_css_node_get_first_child (box); label; label = gtk_css_node_get_next_sibling (label))
+    assert_color (label, "blue");
+  gtk_css_node_style_cache_get_stats (&after);
+
+  /* The box and the first and last labels get their own
+   * entries, the labels in the middle share one.
+   */
+  g_assert_cmpuint (after.n_stored - before.n_stored, ==, 4);
+  g_assert_cmpuint (after.n_hits - before.n_hits, ==, 7);
+  g_assert_cmpuint (after.bytes_saved, >, before.bytes_saved);
+
+  /* Another root that looks the same reuses the whole tree */
+  root2 = node_new (NULL, "cacheroot", NULL);
+  box = node_new (root2, "cachebox", NULL);
+  for (i = 0; i < 3; i++)
+    node_new (box, "cachelabel", NULL);
+
+  gtk_css_node_style_cache_get_stats (&before);
+  for (label = gtk_css_node_get_first_child (box); label; label = gtk_css_node_get_next_sibling (label))
+    assert_color (label, "blue");
+  gtk_css_node_style_cache_get_stats (&after);
+
+  g_assert_cmpuint (after.shared_hits - before.shared_hits, ==, 1);
+  g_assert_cmpuint (after.n_hits - before.n_hits, ==, 4);
+  g_assert_cmpuint (after.n_stored, ==, before.n_stored);
+
+  g_object_unref (root1);
+  g_object_unref (root2);
+  remove_provider (provider);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/stylecache/descendant/roots", test_descendant_roots);
+  g_test_add_func ("/stylecache/descendant/parents", test_descendant_parents);
+  g_test_add_func ("/stylecache/provider-change", test_provider_change);
+  g_test_add_func ("/stylecache/stats", test_stats);
+
+  return g_test_run ();
+}
@@ -360,6 +360,393 @@ constraint_solver_paper (void)
   g_object_unref (solver);
 }
 
+static void
+constraint_solver_stay_update (void)
+{
+  GtkConstraintSolver *solver = gtk_constraint_solver_new ();
+
+  GtkConstraintVariable *width = gtk_constraint_solver_create_variable (solver, NULL, "width", 500.0);
+  GtkConstraintVariable *x = gtk_constraint_solver_create_variable (solver, NULL, "x", 1000.0);
+  GtkConstraintRef *stay;
+
+  gtk_constraint_solver_add_stay_variable (solver, x, GTK_CONSTRAINT_STRENGTH_WEAK);
+  stay = gtk_constraint_solver_add_stay_variable (solver, width, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+  gtk_constraint_solver_add_constraint (solver,
+                                        x, GTK_CONSTRAINT_RELATION_LE,
+                                        gtk_constraint_expression_new_from_variable (width),
+                                        GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (width), 500.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (x), 500.0, 0.001);
+
+  gtk_constraint_solver_update_stay_value (solver, stay, 2000.0);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (width), 2000.0, 0.001);
+  g_assert_cmpfloat (gtk_constraint_variable_get_value (x), <=, 2000.0);
+
+  gtk_constraint_solver_update_stay_value (solver, stay, 100.0);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (width), 100.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (x), 100.0, 0.001);
+
+  gtk_constraint_solver_freeze (solver);
+  gtk_constraint_solver_update_stay_value (solver, stay, 50.0);
+  gtk_constraint_solver_update_stay_value (solver, stay, 75.0);
+  gtk_constraint_solver_thaw (solver);
+
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (width), 75.0, 0.001);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (x), 75.0, 0.001);
+
+  gtk_constraint_solver_remove_constraint (solver, stay);
+
+  gtk_constraint_variable_unref (width);
+  gtk_constraint_variable_unref (x);
+
+  g_object_unref (solver);
+}
+
+#define N_STAY_BOXES 6
+#define N_STAY_VARS (2 * N_STAY_BOXES + 1)
+
+/* A row of boxes packed from the left edge of a container, each with
+ * a required minimum width and a preferred width of a different
+ * strength, so that there is only one optimal solution for any
+ * container width; returns the stay on the container width
+ */
+static GtkConstraintRef *
+add_stay_boxes (GtkConstraintSolver    *solver,
+                GtkConstraintVariable **vars,
+                double                  width,
+                int                     strength)
+{
+  GtkConstraintRef *stay;
+  int i;
+
+  vars[0] = gtk_constraint_solver_create_variable (solver, "super", "width", width);
+  stay = gtk_constraint_solver_add_stay_variable (solver, vars[0], strength);
+
+  for (i = 0; i < N_STAY_BOXES; i++)
+    {
+      GtkConstraintVariable *left = gtk_constraint_solver_create_variable (solver, "box", "left", 0.0);
+      GtkConstraintVariable *w = gtk_constraint_solver_create_variable (solver, "box", "width", 0.0);
+
+      if (i == 0)
+        gtk_constraint_solver_add_constraint (solver,
+                                              left, GTK_CONSTRAINT_RELATION_EQ,
+                                              gtk_constraint_expression_new (0.0),
+                                              GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      else
+        {
+          GtkConstraintExpressionBuilder builder;
+
+          gtk_constraint_expression_builder_init (&builder, solver);
+          gtk_constraint_expression_builder_term (&builder, vars[2 * i - 1]);
+          gtk_constraint_expression_builder_plus (&builder);
+          gtk_constraint_expression_builder_term (&builder, vars[2 * i]);
+          gtk_constraint_solver_add_constraint (solver,
+                                                left, GTK_CONSTRAINT_RELATION_EQ,
+                                                gtk_constraint_expression_builder_finish (&builder),
+                                                GTK_CONSTRAINT_STRENGTH_REQUIRED);
+        }
+
+      gtk_constraint_solver_add_constraint (solver,
+                                            w, GTK_CONSTRAINT_RELATION_GE,
+                                            gtk_constraint_expression_new (5.0),
+                                            GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_solver_add_constraint (solver,
+                                            w, GTK_CONSTRAINT_RELATION_EQ,
+                                            gtk_constraint_expression_new (10.0 * (i + 1)),
+                                            GTK_CONSTRAINT_STRENGTH_MEDIUM * (i + 1));
+
+      if (i == N_STAY_BOXES - 1)
+        {
+          GtkConstraintExpressionBuilder builder;
+
+          gtk_constraint_expression_builder_init (&builder, solver);
+          gtk_constraint_expression_builder_term (&builder, vars[0]);
+          gtk_constraint_expression_builder_minus (&builder);
+          gtk_constraint_expression_builder_term (&builder, w);
+          gtk_constraint_solver_add_constraint (solver,
+                                                left, GTK_CONSTRAINT_RELATION_LE,
+                                                gtk_constraint_expression_builder_finish (&builder),
+                                                GTK_CONSTRAINT_STRENGTH_REQUIRED);
+        }
+
+      vars[2 * i + 1] = left;
+      vars[2 * i + 2] = w;
+    }
+
+  return stay;
+}
+
+/* Checks that the solution in @vars is the one of a new solver */
+static void
+assert_stay_boxes_solved (GtkConstraintVariable **vars,
+                          double                  width,
+                          int                     strength)
+{
+  GtkConstraintSolver *solver = gtk_constraint_solver_new ();
+  GtkConstraintVariable *expected[N_STAY_VARS];
+  int i;
+
+  add_stay_boxes (solver, expected, width, strength);
+
+  for (i = 0; i < N_STAY_VARS; i++)
+    {
+      g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (vars[i]),
+                                      gtk_constraint_variable_get_value (expected[i]),
+                                      0.001);
+      gtk_constraint_variable_unref (expected[i]);
+    }
+
+  g_object_unref (solver);
+}
+
+static void
+constraint_solver_stay_update_cold (void)
+{
+  const double widths[] = { 150.0, 40.0, 500.0, 90.0, 30.0, 300.0 };
+  const int strengths[] = { GTK_CONSTRAINT_STRENGTH_REQUIRED, G_MAXINT };
+  int i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (strengths); i++)
+    {
+      GtkConstraintSolver *solver = gtk_constraint_solver_new ();
+      GtkConstraintVariable *vars[N_STAY_VARS];
+      GtkConstraintRef *stay;
+
+      stay = add_stay_boxes (solver, vars, 300.0, strengths[i]);
+      assert_stay_boxes_solved (vars, 300.0, strengths[i]);
+
+      for (j = 0; j < G_N_ELEMENTS (widths); j++)
+        {
+          gtk_constraint_solver_update_stay_value (solver, stay, widths[j]);
+
+          g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (vars[0]), widths[j], 0.001);
+          assert_stay_boxes_solved (vars, widths[j], strengths[i]);
+        }
+
+      for (j = 0; j < N_STAY_VARS; j++)
+        gtk_constraint_variable_unref (vars[j]);
+
+      g_object_unref (solver);
+    }
+}
+
+/* Required stays must win over any number of non-required constraints,
+ * like the allocation of a constraint layout over the preferred sizes
+ * of its children
+ */
+static void
+constraint_solver_stay_required (void)
+{
+  const double widths[] = { 200.0, 300.0, 150.0 };
+  GtkConstraintSolver *solver = gtk_constraint_solver_new ();
+  GtkConstraintVariable *width, *children[3];
+  GtkConstraintRef *stay;
+  int i, j;
+
+  width = gtk_constraint_solver_create_variable (solver, "super", "width", widths[0]);
+  stay = gtk_constraint_solver_add_stay_variable (solver, width, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  for (i = 0; i < G_N_ELEMENTS (children); i++)
+    {
+      children[i] = gtk_constraint_solver_create_variable (solver, "child", "width", 0.0);
+
+      gtk_constraint_solver_add_constraint (solver,
+                                            children[i], GTK_CONSTRAINT_RELATION_EQ,
+                                            gtk_constraint_expression_new (100.0),
+                                            GTK_CONSTRAINT_STRENGTH_STRONG);
+      gtk_constraint_solver_add_constraint (solver,
+                                            children[i], GTK_CONSTRAINT_RELATION_EQ,
+                                            gtk_constraint_expression_new_from_variable (width),
+                                            GTK_CONSTRAINT_STRENGTH_REQUIRED);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (widths); i++)
+    {
+      g_assert_true (gtk_constraint_solver_update_stay_value (solver, stay, widths[i]));
+
+      g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (width), widths[i], 0.001);
+      for (j = 0; j < G_N_ELEMENTS (children); j++)
+        g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (children[j]), widths[i], 0.001);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (children); i++)
+    gtk_constraint_variable_unref (children[i]);
+  gtk_constraint_variable_unref (width);
+
+  g_object_unref (solver);
+}
+
+/* Moving a required stay to a value that conflicts with the other
+ * required constraints fails, and keeps the previous solution
+ */
+static void
+constraint_solver_stay_infeasible (void)
+{
+  GtkConstraintSolver *solver = gtk_constraint_solver_new ();
+  GtkConstraintVariable *vars[N_STAY_VARS];
+  GtkConstraintRef *stay;
+  int i;
+
+  stay = add_stay_boxes (solver, vars, 300.0, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  /* Every box is at least 5 wide */
+  g_assert_false (gtk_constraint_solver_update_stay_value (solver, stay, 5.0 * N_STAY_BOXES - 10.0));
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (vars[0]), 300.0, 0.001);
+  assert_stay_boxes_solved (vars, 300.0, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  g_assert_true (gtk_constraint_solver_update_stay_value (solver, stay, 100.0));
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (vars[0]), 100.0, 0.001);
+  assert_stay_boxes_solved (vars, 100.0, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+
+  for (i = 0; i < N_STAY_VARS; i++)
+    gtk_constraint_variable_unref (vars[i]);
+
+  g_object_unref (solver);
+}
+
+#define N_PERF_CONSTRAINTS 1000
+#define N_PERF_BOXES (N_PERF_CONSTRAINTS / 4)
+#define N_PERF_RESIZES 20
+
+/* A row of boxes packed from the left edge of a container, with a
+ * preferred width for each box, and the last box constrained to end
+ * within the container; this gives us 4 constraints per box, which
+ * is what a typical constraint layout looks like
+ */
+static GtkConstraintVariable *
+add_perf_boxes (GtkConstraintSolver    *solver,
+                GtkConstraintVariable **vars)
+{
+  GtkConstraintVariable *width;
+  int i;
+
+  width = gtk_constraint_solver_create_variable (solver, "super", "width", 1000.0);
+
+  for (i = 0; i < N_PERF_BOXES; i++)
+    {
+      GtkConstraintVariable *left = gtk_constraint_solver_create_variable (solver, "box", "left", 0.0);
+      GtkConstraintVariable *w = gtk_constraint_solver_create_variable (solver, "box", "width", 10.0);
+
+      if (i == 0)
+        gtk_constraint_solver_add_constraint (solver,
+                                              left, GTK_CONSTRAINT_RELATION_GE,
+                                              gtk_constraint_expression_new (0.0),
+                                              GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      else
+        {
+          GtkConstraintExpressionBuilder builder;
+
+          gtk_constraint_expression_builder_init (&builder, solver);
+          gtk_constraint_expression_builder_term (&builder, vars[2 * i - 2]);
+          gtk_constraint_expression_builder_plus (&builder);
+          gtk_constraint_expression_builder_term (&builder, vars[2 * i - 1]);
+          gtk_constraint_solver_add_constraint (solver,
+                                                left, GTK_CONSTRAINT_RELATION_EQ,
+                                                gtk_constraint_expression_builder_finish (&builder),
+                                                GTK_CONSTRAINT_STRENGTH_REQUIRED);
+        }
+
+      gtk_constraint_solver_add_constraint (solver,
+                                            w, GTK_CONSTRAINT_RELATION_GE,
+                                            gtk_constraint_expression_new (1.0),
+                                            GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      gtk_constraint_solver_add_constraint (solver,
+                                            w, GTK_CONSTRAINT_RELATION_EQ,
+                                            gtk_constraint_expression_new (10.0),
+                                            GTK_CONSTRAINT_STRENGTH_MEDIUM);
+
+      if (i == N_PERF_BOXES - 1)
+        {
+          GtkConstraintExpressionBuilder builder;
+
+          gtk_constraint_expression_builder_init (&builder, solver);
+          gtk_constraint_expression_builder_term (&builder, width);
+          gtk_constraint_expression_builder_minus (&builder);
+          gtk_constraint_expression_builder_term (&builder, w);
+          gtk_constraint_solver_add_constraint (solver,
+                                                left, GTK_CONSTRAINT_RELATION_LE,
+                                                gtk_constraint_expression_builder_finish (&builder),
+                                                GTK_CONSTRAINT_STRENGTH_REQUIRED);
+        }
+
+      vars[2 * i] = left;
+      vars[2 * i + 1] = w;
+    }
+
+  return width;
+}
+
+static void
+constraint_solver_performance (void)
+{
+  GtkConstraintVariable *vars[2 * N_PERF_BOXES];
+  GtkConstraintVariable *width;
+  GtkConstraintSolver *solver;
+  GtkConstraintRef *stay;
+  double elapsed;
+  int i, pass;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  solver = gtk_constraint_solver_new ();
+
+  g_test_timer_start ();
+  width = add_perf_boxes (solver, vars);
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "added %d constraints in %6.3f seconds", N_PERF_CONSTRAINTS, elapsed);
+
+  /* The boxes need 2500 pixels; below that, the solver has to shrink
+   * some of them, which needs pivoting the tableau on every resize
+   */
+  for (pass = 0; pass < 2; pass++)
+    {
+      int base = pass == 0 ? 3000 : 1000;
+      const char *kind = pass == 0 ? "unconstrained" : "constrained";
+
+      /* Cold: a new stay on the container size for every resize */
+      g_test_timer_start ();
+      for (i = 0; i < N_PERF_RESIZES; i++)
+        {
+          gtk_constraint_variable_set_value (width, base + (i % 10) * 100);
+          stay = gtk_constraint_solver_add_stay_variable (solver, width, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+          gtk_constraint_solver_remove_constraint (solver, stay);
+        }
+      elapsed = g_test_timer_elapsed ();
+      g_test_minimized_result (elapsed, "cold re-solved %d %s sizes in %6.3f seconds", N_PERF_RESIZES, kind, elapsed);
+
+      /* Warm: keep the stay installed, and move it */
+      gtk_constraint_variable_set_value (width, base);
+      stay = gtk_constraint_solver_add_stay_variable (solver, width, GTK_CONSTRAINT_STRENGTH_REQUIRED);
+      g_test_timer_start ();
+      for (i = 0; i < N_PERF_RESIZES; i++)
+        gtk_constraint_solver_update_stay_value (solver, stay, base + (i % 10) * 100);
+      elapsed = g_test_timer_elapsed ();
+      g_test_minimized_result (elapsed, "warm re-solved %d %s sizes in %6.3f seconds", N_PERF_RESIZES, kind, elapsed);
+
+      if (pass == 0)
+        gtk_constraint_solver_remove_constraint (solver, stay);
+    }
+
+  gtk_constraint_solver_update_stay_value (solver, stay, 3000.0);
+  g_assert_cmpfloat_with_epsilon (gtk_constraint_variable_get_value (vars[2 * N_PERF_BOXES - 1]), 10.0, 0.001);
+  gtk_constraint_solver_update_stay_value (solver, stay, 1000.0);
+  g_assert_cmpfloat (gtk_constraint_variable_get_value (vars[2 * N_PERF_BOXES - 2]) +
+                     gtk_constraint_variable_get_value (vars[2 * N_PERF_BOXES - 1]), <=, 1000.001);
+
+  for (i = 0; i < 2 * N_PERF_BOXES; i++)
+    gtk_constraint_variable_unref (vars[i]);
+  gtk_constraint_variable_unref (width);
+
+  g_object_unref (solver);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -376,6 +763,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/constraint-solver/cassowary", constraint_solver_cassowary);
   g_test_add_func ("/constraint-solver/edit/required", constraint_solver_edit_var_required);
   g_test_add_func ("/constraint-solver/edit/suggest", constraint_solver_edit_var_suggest);
+  g_test_add_func ("/constraint-solver/stay/update", constraint_solver_stay_update);
+  g_test_add_func ("/constraint-solver/stay/update-cold", constraint_solver_stay_update_cold);
+  g_test_add_func ("/constraint-solver/stay/required", constraint_solver_stay_required);
+  g_test_add_func ("/constraint-solver/stay/infeasible", constraint_solver_stay_infeasible);
+  g_test_add_func ("/constraint-solver/performance", constraint_solver_performance);
 
   return g_test_run ();
 }
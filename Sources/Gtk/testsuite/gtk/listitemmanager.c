@@ -20,6 +20,7 @@
 #include <gtk/gtk.h>
 #include "gtk/gtklistitemmanagerprivate.h"
 #include "gtk/gtklistbaseprivate.h"
+#include "gtk/gtklistitemwidgetprivate.h"
 
 static GListModel *
 create_source_model (guint min_size, guint max_size)
@@ -378,6 +379,146 @@ test_create_with_items (void)
   gtk_window_destroy (GTK_WINDOW (widget));
 }
 
+static GtkListItemBase *
+create_factory_item (GtkWidget *widget)
+{
+  GtkListItemFactory *factory = g_object_get_data (G_OBJECT (widget), "the-factory");
+
+  return GTK_LIST_ITEM_BASE (gtk_list_item_widget_new_recycled (factory, "row", GTK_ACCESSIBLE_ROLE_LIST_ITEM));
+}
+
+static void
+count_setup_cb (GtkSignalListItemFactory *factory,
+                GObject                  *list_item,
+                gpointer                  data)
+{
+  guint *n_setup = data;
+
+  (*n_setup)++;
+}
+
+static void
+test_recycle (void)
+{
+  GtkListItemWidgetPoolStats before, after;
+  GtkListItemFactory *factory;
+  GtkListItemTracker *tracker;
+  GtkNoSelection *selection;
+  GtkListItemManager *items;
+  GtkWidget *widget;
+  guint n_setup = 0;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (count_setup_cb), &n_setup);
+
+  widget = gtk_window_new ();
+  g_object_set_data_full (G_OBJECT (widget), "the-factory", factory, g_object_unref);
+  items = gtk_list_item_manager_new (widget,
+                                     split_simple,
+                                     create_factory_item,
+                                     prepare_simple,
+                                     create_simple_header);
+  g_object_set_data_full (G_OBJECT (widget), "the-items", items, g_object_unref);
+  tracker = gtk_list_item_tracker_new (items);
+
+  /* Rows are only pooled while a view uses the factory */
+  gtk_list_item_widget_pool_hold (factory);
+
+  gtk_list_item_widget_get_pool_stats (&before);
+
+  selection = gtk_no_selection_new (create_source_model (20, 50));
+  gtk_list_item_manager_set_model (items, GTK_SELECTION_MODEL (selection));
+  gtk_list_item_tracker_set_position (items, tracker, 0, 0, 9);
+  g_object_unref (selection);
+  g_assert_cmpuint (n_setup, ==, 10);
+
+  /* Swapping the model must reuse the rows that were set up already */
+  selection = gtk_no_selection_new (create_source_model (20, 50));
+  gtk_list_item_manager_set_model (items, GTK_SELECTION_MODEL (selection));
+  gtk_list_item_tracker_set_position (items, tracker, 0, 0, 9);
+  g_object_unref (selection);
+  g_assert_cmpuint (n_setup, ==, 10);
+
+  gtk_list_item_widget_get_pool_stats (&after);
+  g_assert_cmpuint (after.n_recycled - before.n_recycled, ==, 10);
+  g_assert_cmpuint (after.n_hits - before.n_hits, ==, 10);
+
+  /* Removing the items pools the rows... */
+  gtk_list_item_manager_set_model (items, NULL);
+  gtk_list_item_widget_get_pool_stats (&before);
+  g_assert_cmpuint (before.n_pooled - after.n_pooled, ==, 10);
+
+  /* ...and keeps them for a while after no view uses the factory, so a
+   * view that is created again can still pick them up... */
+  gtk_list_item_widget_pool_release (factory);
+  gtk_list_item_widget_get_pool_stats (&after);
+  g_assert_cmpuint (after.n_pooled, ==, before.n_pooled);
+
+  gtk_list_item_widget_pool_hold (factory);
+  selection = gtk_no_selection_new (create_source_model (20, 50));
+  gtk_list_item_manager_set_model (items, GTK_SELECTION_MODEL (selection));
+  gtk_list_item_tracker_set_position (items, tracker, 0, 0, 9);
+  g_object_unref (selection);
+  g_assert_cmpuint (n_setup, ==, 10);
+  gtk_list_item_manager_set_model (items, NULL);
+
+  /* ...but not after the grace period */
+  gtk_list_item_widget_pool_release (factory);
+  gtk_list_item_widget_get_pool_stats (&before);
+  gtk_list_item_widget_pool_flush (factory);
+  gtk_list_item_widget_get_pool_stats (&after);
+  g_assert_cmpuint (after.n_pooled, ==, before.n_pooled - 10);
+  g_assert_cmpuint (after.n_trimmed - before.n_trimmed, ==, 10);
+
+  gtk_list_item_tracker_free (items, tracker);
+  gtk_window_destroy (GTK_WINDOW (widget));
+}
+
+static void
+count_bind_cb (GtkSignalListItemFactory *factory,
+               GtkListItem              *list_item,
+               gpointer                  data)
+{
+  guint *n_bind = data;
+
+  (*n_bind)++;
+}
+
+/* A list view that is destroyed and created again, like a GtkStack
+ * page, gets the rows of the old one back from the pool. */
+static void
+test_recycle_recreate (void)
+{
+  GtkListItemFactory *factory;
+  GtkSelectionModel *selection;
+  GtkWidget *window, *view;
+  guint n_setup = 0, n_bind = 0, n_first;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (count_setup_cb), &n_setup);
+  g_signal_connect (factory, "bind", G_CALLBACK (count_bind_cb), &n_bind);
+  selection = GTK_SELECTION_MODEL (gtk_no_selection_new (create_source_model (20, 50)));
+
+  window = gtk_window_new ();
+  view = gtk_list_view_new (g_object_ref (selection), g_object_ref (factory));
+  gtk_window_set_child (GTK_WINDOW (window), view);
+  n_first = n_setup;
+  g_assert_cmpuint (n_bind, ==, n_first);
+
+  gtk_window_set_child (GTK_WINDOW (window), NULL);
+
+  view = gtk_list_view_new (g_object_ref (selection), g_object_ref (factory));
+  gtk_window_set_child (GTK_WINDOW (window), view);
+  g_assert_cmpuint (n_setup, ==, n_first);
+  g_assert_cmpuint (n_bind, ==, 2 * n_first);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  gtk_list_item_widget_pool_flush (factory);
+
+  g_object_unref (selection);
+  g_object_unref (factory);
+}
+
 #define N_TRACKERS 3
 #define N_WIDGETS_PER_TRACKER 10
 #define N_RUNS 500
@@ -533,6 +674,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/listitemmanager/create", test_create);
   g_test_add_func ("/listitemmanager/create_with_items", test_create_with_items);
   g_test_add_func ("/listitemmanager/exhaustive", test_exhaustive);
+  g_test_add_func ("/listitemmanager/recycle", test_recycle);
+  g_test_add_func ("/listitemmanager/recycle-recreate", test_recycle_recreate);
 
   return g_test_run ();
 }
@@ -289,6 +289,46 @@ test_crash2 (void)
   gtk_rb_tree_unref (tree);
 }
 
+#define N_PERF_ITEMS 1000000
+
+static void
+test_performance (void)
+{
+  GtkRbTree *tree;
+  double elapsed;
+  guint i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  tree = gtk_rb_tree_new (Node, Aug, augment, NULL, NULL);
+
+  g_test_timer_start ();
+  for (i = 0; i < N_PERF_ITEMS; i++)
+    add (tree, g_test_rand_int_range (0, i + 1));
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "inserted %u items in %6.3f seconds", N_PERF_ITEMS, elapsed);
+
+  g_test_timer_start ();
+  for (i = 0; i < N_PERF_ITEMS; i++)
+    g_assert_nonnull (get (tree, g_test_rand_int_range (0, N_PERF_ITEMS)));
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "looked up %u items in %6.3f seconds", N_PERF_ITEMS, elapsed);
+
+  g_test_timer_start ();
+  for (i = 0; i < N_PERF_ITEMS; i++)
+    delete (tree, g_test_rand_int_range (0, N_PERF_ITEMS - i));
+  elapsed = g_test_timer_elapsed ();
+  g_test_minimized_result (elapsed, "removed %u items in %6.3f seconds", N_PERF_ITEMS, elapsed);
+
+  g_assert_null (gtk_rb_tree_get_root (tree));
+
+  gtk_rb_tree_unref (tree);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -297,6 +337,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/rbtree/crash", test_crash);
   g_test_add_func ("/rbtree/crash2", test_crash2);
+  g_test_add_func ("/rbtree/performance", test_performance);
 
   return g_test_run ();
 }
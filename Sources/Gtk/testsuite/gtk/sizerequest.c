@@ -0,0 +1,226 @@
+#include <gtk/gtk.h>
+
+/* A leaf widget with a fixed size, counting how often it is measured */
+#define TEST_TYPE_LEAF (test_leaf_get_type ())
+G_DECLARE_FINAL_TYPE (TestLeaf, test_leaf, TEST, LEAF, GtkWidget)
+
+struct _TestLeaf
+{
+  GtkWidget parent_instance;
+
+  int size;
+  guint n_measured;
+};
+
+G_DEFINE_TYPE (TestLeaf, test_leaf, GTK_TYPE_WIDGET)
+
+static void
+test_leaf_measure (GtkWidget      *widget,
+                   GtkOrientation  orientation,
+                   int             for_size,
+                   int            *minimum,
+                   int            *natural,
+                   int            *minimum_baseline,
+                   int            *natural_baseline)
+{
+  TestLeaf *self = TEST_LEAF (widget);
+
+  self->n_measured++;
+
+  *minimum = *natural = self->size;
+}
+
+static void
+test_leaf_class_init (TestLeafClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  widget_class->measure = test_leaf_measure;
+}
+
+static void
+test_leaf_init (TestLeaf *self)
+{
+  self->size = 10;
+}
+
+static TestLeaf *
+test_leaf_new (void)
+{
+  return g_object_new (TEST_TYPE_LEAF, NULL);
+}
+
+static void
+test_leaf_set_size (TestLeaf *self,
+                    int       size)
+{
+  self->size = size;
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+}
+
+/* A container adding up the sizes of its children */
+#define TEST_TYPE_STACK (test_stack_get_type ())
+G_DECLARE_FINAL_TYPE (TestStack, test_stack, TEST, STACK, GtkWidget)
+
+struct _TestStack
+{
+  GtkWidget parent_instance;
+
+  guint n_measured;
+};
+
+G_DEFINE_TYPE (TestStack, test_stack, GTK_TYPE_WIDGET)
+
+static void
+test_stack_measure (GtkWidget      *widget,
+                    GtkOrientation  orientation,
+                    int             for_size,
+                    int            *minimum,
+                    int            *natural,
+                    int            *minimum_baseline,
+                    int            *natural_baseline)
+{
+  TestStack *self = TEST_STACK (widget);
+  GtkWidget *child;
+
+  self->n_measured++;
+
+  *minimum = *natural = 0;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      int child_min, child_nat;
+
+      gtk_widget_measure (child, orientation, -1, &child_min, &child_nat, NULL, NULL);
+      *minimum += child_min;
+      *natural += child_nat;
+    }
+}
+
+static void
+test_stack_dispose (GObject *object)
+{
+  GtkWidget *child;
+
+  while ((child = gtk_widget_get_first_child (GTK_WIDGET (object))))
+    gtk_widget_unparent (child);
+
+  G_OBJECT_CLASS (test_stack_parent_class)->dispose (object);
+}
+
+static void
+test_stack_class_init (TestStackClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->dispose = test_stack_dispose;
+  widget_class->measure = test_stack_measure;
+}
+
+static void
+test_stack_init (TestStack *self)
+{
+}
+
+static int
+measure_width (GtkWidget *widget)
+{
+  int min;
+
+  gtk_widget_measure (widget, GTK_ORIENTATION_HORIZONTAL, -1, &min, NULL, NULL, NULL);
+
+  return min;
+}
+
+static void
+test_resize_unchanged (void)
+{
+  TestStack *outer, *inner;
+  TestLeaf *a, *b;
+
+  outer = g_object_ref_sink (g_object_new (TEST_TYPE_STACK, NULL));
+  inner = g_object_new (TEST_TYPE_STACK, NULL);
+  a = test_leaf_new ();
+  b = test_leaf_new ();
+
+  gtk_widget_set_parent (GTK_WIDGET (inner), GTK_WIDGET (outer));
+  gtk_widget_set_parent (GTK_WIDGET (a), GTK_WIDGET (inner));
+  gtk_widget_set_parent (GTK_WIDGET (b), GTK_WIDGET (outer));
+
+  g_assert_cmpint (measure_width (GTK_WIDGET (outer)), ==, 20);
+  g_assert_cmpuint (outer->n_measured, ==, 1);
+  g_assert_cmpuint (inner->n_measured, ==, 1);
+  g_assert_cmpuint (a->n_measured, ==, 1);
+  g_assert_cmpuint (b->n_measured, ==, 1);
+
+  /* The leaf is measured again, but its size did not change,
+   * so the cached sizes of its ancestors are still valid
+   */
+  test_leaf_set_size (a, 10);
+
+  g_assert_cmpint (measure_width (GTK_WIDGET (outer)), ==, 20);
+  g_assert_cmpuint (outer->n_measured, ==, 1);
+  g_assert_cmpuint (inner->n_measured, ==, 1);
+  g_assert_cmpuint (a->n_measured, ==, 2);
+  g_assert_cmpuint (b->n_measured, ==, 1);
+
+  /* Now the size of the leaf changed, and the ancestors
+   * need to be measured again
+   */
+  test_leaf_set_size (a, 30);
+
+  g_assert_cmpint (measure_width (GTK_WIDGET (outer)), ==, 40);
+  g_assert_cmpuint (outer->n_measured, ==, 2);
+  g_assert_cmpuint (inner->n_measured, ==, 2);
+  g_assert_cmpuint (a->n_measured, ==, 3);
+  g_assert_cmpuint (b->n_measured, ==, 1);
+
+  /* A resize queued on a widget itself always drops its cached sizes */
+  gtk_widget_queue_resize (GTK_WIDGET (inner));
+
+  g_assert_cmpint (measure_width (GTK_WIDGET (outer)), ==, 40);
+  g_assert_cmpuint (outer->n_measured, ==, 2);
+  g_assert_cmpuint (inner->n_measured, ==, 3);
+  g_assert_cmpuint (a->n_measured, ==, 3);
+
+  g_object_unref (outer);
+}
+
+static void
+test_resize_hidden (void)
+{
+  TestStack *stack;
+  TestLeaf *a, *b;
+
+  stack = g_object_ref_sink (g_object_new (TEST_TYPE_STACK, NULL));
+  a = test_leaf_new ();
+  b = test_leaf_new ();
+
+  gtk_widget_set_parent (GTK_WIDGET (a), GTK_WIDGET (stack));
+  gtk_widget_set_parent (GTK_WIDGET (b), GTK_WIDGET (stack));
+
+  g_assert_cmpint (measure_width (GTK_WIDGET (stack)), ==, 20);
+
+  gtk_widget_set_visible (GTK_WIDGET (b), FALSE);
+  g_assert_cmpint (measure_width (GTK_WIDGET (stack)), ==, 10);
+
+  gtk_widget_set_visible (GTK_WIDGET (b), TRUE);
+  test_leaf_set_size (b, 10);
+  g_assert_cmpint (measure_width (GTK_WIDGET (stack)), ==, 20);
+
+  g_object_unref (stack);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/sizerequest/resize/unchanged", test_resize_unchanged);
+  g_test_add_func ("/sizerequest/resize/hidden", test_resize_hidden);
+
+  return g_test_run ();
+}